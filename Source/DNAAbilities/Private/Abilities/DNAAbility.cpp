@@ -176,20 +176,17 @@ bool UDNAAbility::DoesAbilitySatisfyTagRequirements(const UDNAAbilitySystemCompo
 		bBlocked = true;
 	}
 
-	// Check to see the required/blocked tags for this ability
+	// Check to see the required/blocked tags for this ability. The owner's tags are matched as bitsets, which avoids copying them into a container
 	if (ActivationBlockedTags.Num() || ActivationRequiredTags.Num())
 	{
-		static FDNATagContainer DNAAbilitySystemComponentTags;
-		DNAAbilitySystemComponentTags.Reset();
+		const FDNATagBitContainer& DNAAbilitySystemComponentTagBits = DNAAbilitySystemComponent.GetOwnedDNATagBits();
 
-		DNAAbilitySystemComponent.GetOwnedDNATags(DNAAbilitySystemComponentTags);
-
-		if (DNAAbilitySystemComponentTags.HasAny(ActivationBlockedTags))
+		if (ActivationBlockedTags.Num() && DNAAbilitySystemComponentTagBits.HasAny(ActivationBlockedTagBits.Get(ActivationBlockedTags)))
 		{
 			bBlocked = true;
 		}
 
-		if (!DNAAbilitySystemComponentTags.HasAll(ActivationRequiredTags))
+		if (ActivationRequiredTags.Num() && !DNAAbilitySystemComponentTagBits.HasAll(ActivationRequiredTagBits.Get(ActivationRequiredTags)))
 		{
 			bMissing = true;
 		}
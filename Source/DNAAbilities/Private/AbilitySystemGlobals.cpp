@@ -2,6 +2,8 @@
 
 #include "Core.h"
 #include "AbilitySystemGlobals.h"
+#include "DNAEffectTimerWheel.h"
+#include "Engine/World.h"
 #include "Abilities/DNAAbilityTypes.h"
 #include "AbilitySystemStats.h"
 #include "DNACueInterface.h"
@@ -21,8 +23,10 @@ UDNAAbilitySystemGlobals::UDNAAbilitySystemGlobals(const FObjectInitializer& Obj
 	DNAAbilitySystemGlobalsClassName = FStringClassReference(TEXT("/Script/DNAAbilities.DNAAbilitySystemGlobals"));
 
 	PredictTargetDNAEffects = true;
+	bSkipUnreadTargetTagCaptures = false;
 
 	MinimalReplicationTagCountBits = 5;
+	bDeltaSerializeMinimalReplicationTags = false;
 
 	bAllowDNAModEvaluationChannels = false;
 
@@ -467,6 +471,44 @@ void UDNAAbilitySystemGlobals::HandlePreLoadMap(const FString& MapName)
 	ResetCachedData();
 }
 
+FDNAEffectTimerWheel& UDNAAbilitySystemGlobals::GetEffectTimerWheel(UWorld* World)
+{
+	TSharedPtr<FDNAEffectTimerWheel>* ExistingWheel = EffectTimerWheels.Find(World);
+	if (ExistingWheel && ExistingWheel->IsValid())
+	{
+		return **ExistingWheel;
+	}
+
+	// Drop the wheels of worlds that were destroyed without a cleanup
+	for (auto It = EffectTimerWheels.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	if (!WorldCleanupHandle.IsValid())
+	{
+		WorldCleanupHandle = FWorldDelegates::OnWorldCleanup.AddUObject(this, &UDNAAbilitySystemGlobals::HandleWorldCleanup);
+	}
+
+	TSharedPtr<FDNAEffectTimerWheel>& Wheel = EffectTimerWheels.FindOrAdd(World);
+	Wheel = MakeShareable(new FDNAEffectTimerWheel(World));
+	return *Wheel;
+}
+
+FDNAEffectTimerWheel* UDNAAbilitySystemGlobals::FindEffectTimerWheel(UWorld* World) const
+{
+	const TSharedPtr<FDNAEffectTimerWheel>* Wheel = EffectTimerWheels.Find(World);
+	return Wheel ? Wheel->Get() : nullptr;
+}
+
+void UDNAAbilitySystemGlobals::HandleWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources)
+{
+	EffectTimerWheels.Remove(World);
+}
+
 void UDNAAbilitySystemGlobals::Notify_OpenAssetInEditor(FString AssetName, int AssetType)
 {
 	AbilityOpenAssetInEditorCallbacks.Broadcast(AssetName, AssetType);
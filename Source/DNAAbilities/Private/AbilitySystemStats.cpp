@@ -24,6 +24,10 @@ DEFINE_STAT(STAT_InitAttributeSetDefaults);
 DEFINE_STAT(STAT_TickDNAAbilityTasks);
 DEFINE_STAT(STAT_FindAbilitySpecFromHandle);
 DEFINE_STAT(STAT_AggregatorEvaluate);
+DEFINE_STAT(STAT_AggregatorEvaluateCacheHits);
+DEFINE_STAT(STAT_AggregatorEvaluateCacheMisses);
+DEFINE_STAT(STAT_DNAEffectTargetTagCaptures);
+DEFINE_STAT(STAT_DNAEffectTargetTagCapturesSkipped);
 DEFINE_STAT(STAT_HasApplicationImmunityToSpec);
 DEFINE_STAT(STAT_HasMatchingDNATag);
 DEFINE_STAT(STAT_HandleDNACueNotifyStatic);
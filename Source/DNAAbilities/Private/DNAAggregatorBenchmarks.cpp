@@ -0,0 +1,117 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "Core.h"
+#include "Misc/AutomationTest.h"
+#include "DNATagContainer.h"
+#include "DNATagsManager.h"
+#include "DNABenchmarkReport.h"
+#include "DNAEffectTypes.h"
+#include "DNAEffectAggregator.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/**
+ * Micro-benchmark of attribute aggregation with many mods per attribute, comparing the grouped evaluation of FAggregatorModChannel against
+ * qualifying every mod, which evaluations that ignore handles still do. Run headless with
+ *   UE4Editor-Cmd <Project> -ExecCmds="Automation RunTests System.DNAAbilities.AggregatorBenchmark;Quit" -unattended -nullrhi
+ * Timings are reported by FDNABenchmarkReport as "DNAAggregatorBenchmark,<mods>,<operation>,<iterations>,<ns per op>" and written to DNAAggregatorBenchmark.csv.
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDNAAggregatorBenchmark, "System.DNAAbilities.AggregatorBenchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+namespace DNAAggregatorBenchmark
+{
+	/** Mods on the aggregated attribute */
+	static const int32 ModCounts[] = { 50, 100, 200 };
+
+	/** One mod in this many has tag requirements */
+	static const int32 ConditionalModInterval = 4;
+
+	/** Distinct sets of tag requirements among the conditional mods, like a handful of effect definitions applied many times */
+	static const int32 NumRequirementSets = 8;
+
+	/** Iterations of every operation, the same for every count so the timings compare */
+	static const int32 NumIterations = 100000;
+}
+
+bool FDNAAggregatorBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace DNAAggregatorBenchmark;
+
+	// Requirements need real tags, take them from whatever the project has
+	FDNATagContainer AllTags;
+	UDNATagsManager::Get().RequestAllDNATags(AllTags, true);
+	if (AllTags.Num() < NumRequirementSets)
+	{
+		AddWarning(FString::Printf(TEXT("Only %d tags in the dictionary, conditional mods will be measured without tag requirements"), AllTags.Num()));
+	}
+
+	FDNATagRequirements RequirementSets[NumRequirementSets];
+	FDNATagContainer EvaluationTags;
+	for (int32 SetIdx = 0; SetIdx < NumRequirementSets && SetIdx < AllTags.Num(); ++SetIdx)
+	{
+		const FDNATag& Tag = AllTags.GetByIndex(SetIdx);
+		RequirementSets[SetIdx].RequireTags.AddTag(Tag);
+
+		// Half of the sets are met
+		if (SetIdx % 2 == 0)
+		{
+			EvaluationTags.AddTag(Tag);
+		}
+	}
+
+	FDNABenchmarkReport Bench(TEXT("DNAAggregatorBenchmark"), TEXT("Mods"), NumIterations);
+
+	for (int32 NumMods : ModCounts)
+	{
+		FRandomStream Random(NumMods);
+
+		// A typical stat: mostly flat bonuses, some percentage bonuses, a few in a later channel
+		FAggregatorModChannelContainer Channels;
+		for (int32 ModIdx = 0; ModIdx < NumMods; ++ModIdx)
+		{
+			const EDNAModEvaluationChannel Channel = (ModIdx % 10 == 9) ? EDNAModEvaluationChannel::Channel1 : EDNAModEvaluationChannel::Channel0;
+			const EDNAModOp::Type ModOp = (ModIdx % 3 == 2) ? EDNAModOp::Multiplicitive : EDNAModOp::Additive;
+			const float Magnitude = (ModOp == EDNAModOp::Multiplicitive) ? Random.FRandRange(1.f, 1.1f) : Random.FRandRange(1.f, 10.f);
+			const FDNATagRequirements* SourceTagReqs = (ModIdx % ConditionalModInterval == 0) ? &RequirementSets[Random.RandRange(0, NumRequirementSets - 1)] : nullptr;
+
+			Channels.FindOrAddModChannel(Channel).AddMod(Magnitude, ModOp, SourceTagReqs, nullptr, false, FActiveDNAEffectHandle(ModIdx + 1));
+		}
+
+		FAggregatorEvaluateParameters GroupedParameters;
+		GroupedParameters.SourceTags = &EvaluationTags;
+
+		// Ignoring a handle no mod has qualifies every mod, like the evaluation did before mods were grouped
+		FAggregatorEvaluateParameters PerModParameters(GroupedParameters);
+		PerModParameters.IgnoreHandles.Add(FActiveDNAEffectHandle(NumMods + 1));
+
+		const float GroupedValue = Channels.EvaluateWithBase(100.f, GroupedParameters);
+		const float PerModValue = Channels.EvaluateWithBase(100.f, PerModParameters);
+		TestTrue(FString::Printf(TEXT("Grouped and per mod evaluations agree with %d mods"), NumMods), FMath::IsNearlyEqual(GroupedValue, PerModValue, KINDA_SMALL_NUMBER * FMath::Abs(PerModValue)));
+
+		Bench.Measure(NumMods, TEXT("Evaluate PerMod"), [&](int32 Iteration)
+		{
+			return Channels.EvaluateWithBase(100.f + Iteration, PerModParameters);
+		});
+
+		Bench.Measure(NumMods, TEXT("Evaluate Grouped"), [&](int32 Iteration)
+		{
+			return Channels.EvaluateWithBase(100.f + Iteration, GroupedParameters);
+		});
+
+		// Replacing a mod before every evaluation, so every evaluation rebuilds the groups of its channel
+		FAggregatorModChannel& Channel0 = Channels.FindOrAddModChannel(EDNAModEvaluationChannel::Channel0);
+		const FActiveDNAEffectHandle ChurnHandle(NumMods + 2);
+		Bench.Measure(NumMods, TEXT("Replace mod and Evaluate Grouped"), [&](int32 Iteration)
+		{
+			Channel0.RemoveModsWithActiveHandle(ChurnHandle);
+			Channel0.AddMod(1.f + (Iteration & 7), EDNAModOp::Additive, &RequirementSets[Iteration % NumRequirementSets], nullptr, false, ChurnHandle);
+			return Channels.EvaluateWithBase(100.f, GroupedParameters);
+		});
+	}
+
+	Bench.Finish(*this);
+
+	return !HasAnyErrors();
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
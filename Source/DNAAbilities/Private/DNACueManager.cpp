@@ -82,6 +82,7 @@ void UDNACueManager::OnEngineInitComplete()
 	AssetRegistryModule.Get().OnInMemoryAssetDeleted().AddUObject(this, &UDNACueManager::HandleAssetDeleted);
 	AssetRegistryModule.Get().OnAssetRenamed().AddUObject(this, &UDNACueManager::HandleAssetRenamed);
 	FWorldDelegates::OnPreWorldInitialization.AddUObject(this, &UDNACueManager::ReloadObjectLibrary);
+	IDNATagsModule::OnDNATagTreeChangeSet.AddUObject(this, &UDNACueManager::HandleDNATagTreeChangeSet);
 
 	InitializeEditorObjectLibrary();
 #endif
@@ -1025,6 +1026,19 @@ bool UDNACueManager::VerifyNotifyAssetIsInValidPath(FString Path)
 	return ValidPath;
 }
 
+void UDNACueManager::HandleDNATagTreeChangeSet(const FDNATagTreeChangeSet& ChangeSet)
+{
+	if (RuntimeDNACueObjectLibrary.CueSet)
+	{
+		RuntimeDNACueObjectLibrary.CueSet->UpdateAccelerationMapForTagChanges(ChangeSet);
+	}
+
+	if (EditorDNACueObjectLibrary.CueSet)
+	{
+		EditorDNACueObjectLibrary.CueSet->UpdateAccelerationMapForTagChanges(ChangeSet);
+	}
+}
+
 #endif
 
 
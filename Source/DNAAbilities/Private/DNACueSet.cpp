@@ -141,6 +141,53 @@ void UDNACueSet::UpdateCueByStringRefs(const FStringAssetReference& CueToRemove,
 	}
 }
 
+void UDNACueSet::UpdateAccelerationMapForTagChanges(const FDNATagTreeChangeSet& ChangeSet)
+{
+	const FDNATag BaseTag = BaseDNACueTag();
+	if (!BaseTag.IsValid() || ChangeSet.AddedTags.Contains(BaseTag) || ChangeSet.RemovedTags.Contains(BaseTag))
+	{
+		// The whole cue hierarchy came or went
+		BuildAccelerationMap_Internal();
+		return;
+	}
+
+	// Removed tags lose their entry unless cue data uses them, a full rebuild keeps those too
+	for (const FDNATag& RemovedTag : ChangeSet.RemovedTags)
+	{
+		const int32* DataIdx = DNACueDataMap.Find(RemovedTag);
+		if (DataIdx && (*DataIdx == INDEX_NONE || DNACueData[*DataIdx].DNACueTag != RemovedTag))
+		{
+			DNACueDataMap.Remove(RemovedTag);
+		}
+	}
+
+	// New cue tags point at the closest parent with a notify. Parents come before their children, so the direct parent is always mapped already
+	bool bParentsChanged = false;
+	for (const FDNATag& AddedTag : ChangeSet.AddedTags)
+	{
+		if (!AddedTag.MatchesTag(BaseTag))
+		{
+			continue;
+		}
+
+		if (DNACueDataMap.Contains(AddedTag))
+		{
+			// Cue data was waiting for this tag, and is now the closest notify for the tags below it
+			bParentsChanged = true;
+			continue;
+		}
+
+		const int32* ParentValue = DNACueDataMap.Find(AddedTag.RequestDirectParent());
+		DNACueDataMap.Add(AddedTag, ParentValue ? *ParentValue : INDEX_NONE);
+	}
+
+	if (bParentsChanged)
+	{
+		// Rare enough that the plain rebuild is fine
+		BuildAccelerationMap_Internal();
+	}
+}
+
 void UDNACueSet::CopyCueDataToSetForEditorPreview(FDNATag Tag, UDNACueSet* DestinationSet)
 {
 	const int32 SourceIdx = DNACueData.IndexOfByPredicate([&Tag](const FDNACueNotifyData& Data) { return Data.DNACueTag == Tag; });
@@ -30,6 +30,10 @@ const float UDNAEffect::NO_PERIOD = FDNAEffectConstants::NO_PERIOD;
 const float UDNAEffect::INVALID_LEVEL = FDNAEffectConstants::INVALID_LEVEL;
 
 DECLARE_CYCLE_STAT(TEXT("MakeQuery"), STAT_MakeDNAEffectQuery, STATGROUP_DNAAbilitySystem);
+DECLARE_CYCLE_STAT(TEXT("CompileExecutionPlan"), STAT_CompileDNAEffectExecutionPlan, STATGROUP_DNAAbilitySystem);
+
+static int32 DNAEffectBakeCurveMagnitudes = 1;
+static FAutoConsoleVariableRef CVarDNAEffectBakeCurveMagnitudes(TEXT("DNAAbilitySystem.BakeCurveMagnitudes"), DNAEffectBakeCurveMagnitudes, TEXT("Bake curve table modifier magnitudes into effect execution plans. 0: never, 1: outside the editor, 2: always. Takes effect for plans compiled after it is changed."), ECVF_Default );
 
 // --------------------------------------------------------------------------------------------------------------------------------------------------------
 //
@@ -49,6 +53,7 @@ UDNAEffect::UDNAEffect(const FObjectInitializer& ObjectInitializer)
 	StackDurationRefreshPolicy = EDNAEffectStackingDurationPolicy::RefreshOnSuccessfulApplication;
 	StackPeriodResetPolicy = EDNAEffectStackingPeriodPolicy::ResetOnSuccessfulApplication;
 	bRequireModifierSuccessToTriggerCues = true;
+	bExecutionPlanCompiled = false;
 
 #if WITH_EDITORONLY_DATA
 	ShowAllProperties = true;
@@ -97,6 +102,7 @@ void UDNAEffect::PostLoad()
 	}
 
 	HasGrantedApplicationImmunityQuery = !GrantedApplicationImmunityQuery.IsEmpty();
+	InvalidateExecutionPlan();
 
 #if WITH_EDITOR
 	GETCURVE_REPORTERROR(Period.Curve);
@@ -161,6 +167,7 @@ void UDNAEffect::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEv
 	}
 
 	HasGrantedApplicationImmunityQuery = !GrantedApplicationImmunityQuery.IsEmpty();
+	InvalidateExecutionPlan();
 }
 
 #endif // #if WITH_EDITOR
@@ -171,6 +178,119 @@ void UDNAEffect::PreSave(const class ITargetPlatform* TargetPlatform)
 	HasGrantedApplicationImmunityQuery = !GrantedApplicationImmunityQuery.IsEmpty();
 }
 
+const FDNAEffectExecutionPlan& UDNAEffect::GetExecutionPlan() const
+{
+	if (!bExecutionPlanCompiled || ExecutionPlan.CurveGeneration != FScalableFloat::GetGlobalCachedCurveID() || ExecutionPlan.Modifiers.Num() != Modifiers.Num())
+	{
+		CompileExecutionPlan();
+	}
+	return ExecutionPlan;
+}
+
+void UDNAEffect::InvalidateExecutionPlan()
+{
+	bExecutionPlanCompiled = false;
+}
+
+void UDNAEffect::CompileExecutionPlan() const
+{
+	SCOPE_CYCLE_COUNTER(STAT_CompileDNAEffectExecutionPlan);
+
+	FDNAEffectExecutionPlan& Plan = ExecutionPlan;
+	Plan = FDNAEffectExecutionPlan();
+	Plan.CurveGeneration = FScalableFloat::GetGlobalCachedCurveID();
+	Plan.bReadsTargetTagsOnExecute = DNACues.Num() > 0;
+
+	TArray<FDNAEffectAttributeCaptureDefinition> CaptureDefs;
+
+	// Specs capture the duration attributes first, before anything the definition asks for
+	if (DurationPolicy == EDNAEffectDurationType::HasDuration)
+	{
+		Plan.AttributeCaptureDefinitions.Add(UDNAAbilitySystemComponent::GetOutgoingDurationCapture());
+		Plan.AttributeCaptureDefinitions.AddUnique(UDNAAbilitySystemComponent::GetIncomingDurationCapture());
+	}
+
+	DurationMagnitude.GetAttributeCaptureDefinitions(CaptureDefs);
+	for (const FDNAEffectAttributeCaptureDefinition& CurCaptureDef : CaptureDefs)
+	{
+		Plan.AttributeCaptureDefinitions.AddUnique(CurCaptureDef);
+	}
+
+	static const FString PlanContextString(TEXT("UDNAEffect::CompileExecutionPlan"));
+
+	Plan.Modifiers.Reserve(Modifiers.Num());
+	for (const FDNAModifierInfo& ModDef : Modifiers)
+	{
+		FDNAEffectPlannedModifier& PlannedMod = Plan.Modifiers[Plan.Modifiers.AddDefaulted()];
+
+		switch (ModDef.ModifierMagnitude.GetMagnitudeCalculationType())
+		{
+			case EDNAEffectMagnitudeCalculation::ScalableFloat:
+			{
+				const FScalableFloat& ScalableFloat = ModDef.ModifierMagnitude.ScalableFloatMagnitude;
+				PlannedMod.BakedCoefficient = ScalableFloat.Value;
+				PlannedMod.BakedCurve = ScalableFloat.Curve;
+
+				if (ScalableFloat.Curve.CurveTable == nullptr)
+				{
+					PlannedMod.BakedMagnitudes.Add(ScalableFloat.Value);
+				}
+				else if (DNAEffectBakeCurveMagnitudes > 1 || (DNAEffectBakeCurveMagnitudes > 0 && !GIsEditor))
+				{
+					// Curve tables can be edited in place in the editor, so by default only games bake them
+					FRichCurve* Curve = ScalableFloat.Curve.GetCurve(PlanContextString);
+					if (Curve)
+					{
+						float MinTime = 0.f;
+						float MaxTime = 0.f;
+						Curve->GetTimeRange(MinTime, MaxTime);
+
+						const int32 NumBakedLevels = FMath::Clamp(FMath::CeilToInt(MaxTime), 0, FDNAEffectExecutionPlan::MaxBakedLevel) + 1;
+						PlannedMod.bMagnitudeScalesWithLevel = true;
+						PlannedMod.BakedMagnitudes.SetNumUninitialized(NumBakedLevels);
+						for (int32 Level = 0; Level < NumBakedLevels; ++Level)
+						{
+							PlannedMod.BakedMagnitudes[Level] = ScalableFloat.GetValueAtLevel(Level, &PlanContextString);
+						}
+					}
+				}
+			}
+			break;
+
+			case EDNAEffectMagnitudeCalculation::AttributeBased:
+			case EDNAEffectMagnitudeCalculation::CustomCalculationClass:
+			{
+				// Both evaluate with the spec's target tags
+				Plan.bReadsTargetTagsOnExecute = true;
+			}
+			break;
+		}
+
+		ModDef.ModifierMagnitude.GetAttributeCaptureDefinitions(CaptureDefs);
+		for (const FDNAEffectAttributeCaptureDefinition& CurCaptureDef : CaptureDefs)
+		{
+			Plan.AttributeCaptureDefinitions.AddUnique(CurCaptureDef);
+		}
+	}
+
+	for (const FDNAEffectExecutionDefinition& Exec : Executions)
+	{
+		// Custom executions get the target tags in their parameters
+		if (Exec.CalculationClass)
+		{
+			Plan.bReadsTargetTagsOnExecute = true;
+		}
+
+		Exec.GetAttributeCaptureDefinitions(CaptureDefs);
+		for (const FDNAEffectAttributeCaptureDefinition& CurCaptureDef : CaptureDefs)
+		{
+			Plan.AttributeCaptureDefinitions.AddUnique(CurCaptureDef);
+		}
+	}
+
+	bExecutionPlanCompiled = true;
+}
+
 void UDNAEffect::UpdateInheritedTagProperties()
 {
 	UDNAEffect* Parent = Cast<UDNAEffect>(GetClass()->GetSuperClass()->GetDefaultObject());
@@ -771,49 +891,10 @@ void FDNAEffectSpec::Initialize(const UDNAEffect* InDef, const FDNAEffectContext
 
 void FDNAEffectSpec::SetupAttributeCaptureDefinitions()
 {
-	// Add duration if required
-	if (Def->DurationPolicy == EDNAEffectDurationType::HasDuration)
-	{
-		CapturedRelevantAttributes.AddCaptureDefinition(UDNAAbilitySystemComponent::GetOutgoingDurationCapture());
-		CapturedRelevantAttributes.AddCaptureDefinition(UDNAAbilitySystemComponent::GetIncomingDurationCapture());
-	}
-
-	TArray<FDNAEffectAttributeCaptureDefinition> CaptureDefs;
-
-	// Gather capture definitions from duration	
+	// Duration captures if required, then everything the duration, modifiers and executions capture, gathered once per definition
+	for (const FDNAEffectAttributeCaptureDefinition& CurCaptureDef : Def->GetAttributeCaptureDefinitions())
 	{
-		CaptureDefs.Reset();
-		Def->DurationMagnitude.GetAttributeCaptureDefinitions(CaptureDefs);
-		for (const FDNAEffectAttributeCaptureDefinition& CurDurationCaptureDef : CaptureDefs)
-		{
-			CapturedRelevantAttributes.AddCaptureDefinition(CurDurationCaptureDef);
-		}
-	}
-
-	// Gather all capture definitions from modifiers
-	for (int32 ModIdx = 0; ModIdx < Modifiers.Num(); ++ModIdx)
-	{
-		const FDNAModifierInfo& ModDef = Def->Modifiers[ModIdx];
-		const FModifierSpec& ModSpec = Modifiers[ModIdx];
-
-		CaptureDefs.Reset();
-		ModDef.ModifierMagnitude.GetAttributeCaptureDefinitions(CaptureDefs);
-		
-		for (const FDNAEffectAttributeCaptureDefinition& CurCaptureDef : CaptureDefs)
-		{
-			CapturedRelevantAttributes.AddCaptureDefinition(CurCaptureDef);
-		}
-	}
-
-	// Gather all capture definitions from executions
-	for (const FDNAEffectExecutionDefinition& Exec : Def->Executions)
-	{
-		CaptureDefs.Reset();
-		Exec.GetAttributeCaptureDefinitions(CaptureDefs);
-		for (const FDNAEffectAttributeCaptureDefinition& CurExecCaptureDef : CaptureDefs)
-		{
-			CapturedRelevantAttributes.AddCaptureDefinition(CurExecCaptureDef);
-		}
+		CapturedRelevantAttributes.AddCaptureDefinition(CurCaptureDef);
 	}
 }
 
@@ -966,11 +1047,19 @@ float FDNAEffectSpec::GetModifierMagnitude(int32 ModifierIdx, bool bFactorInStac
 
 void FDNAEffectSpec::CalculateModifierMagnitudes()
 {
+	const FDNAEffectExecutionPlan& Plan = Def->GetExecutionPlan();
+
 	for(int32 ModIdx = 0; ModIdx < Modifiers.Num(); ++ModIdx)
 	{
 		const FDNAModifierInfo& ModDef = Def->Modifiers[ModIdx];
 		FModifierSpec& ModSpec = Modifiers[ModIdx];
 
+		// Static magnitudes come baked from the plan
+		if (Plan.Modifiers.IsValidIndex(ModIdx) && Plan.Modifiers[ModIdx].GetBakedMagnitude(ModDef, GetLevel(), ModSpec.EvaluatedMagnitude))
+		{
+			continue;
+		}
+
 		if (ModDef.ModifierMagnitude.AttemptCalculateMagnitude(*this, ModSpec.EvaluatedMagnitude) == false)
 		{
 			ModSpec.EvaluatedMagnitude = 0.f;
@@ -1550,6 +1639,9 @@ void FActiveDNAEffect::PreReplicatedRemove(const struct FActiveDNAEffectsContain
 	ABILITY_LOG(Verbose, TEXT("PreReplicatedRemove: %s %s Marked as Pending Remove: %s"), *Handle.ToString(), *Spec.Def->GetName(), IsPendingRemove ? TEXT("TRUE") : TEXT("FALSE"));
 
 	const_cast<FActiveDNAEffectsContainer&>(InArray).InternalOnActiveDNAEffectRemoved(*this, !bIsInhibited);	// Const cast is ok. It is there to prevent mutation of the DNAEffects array, which this wont do.
+
+	// Like the server does when it removes an effect, give the client generated handle's slot back
+	Handle.RemoveFromGlobalMap();
 }
 
 void FActiveDNAEffect::PostReplicatedAdd(const struct FActiveDNAEffectsContainer &InArray)
@@ -1607,6 +1699,7 @@ void FActiveDNAEffect::PostReplicatedAdd(const struct FActiveDNAEffectsContainer
 
 	// Handles are not replicated, so create a new one.
 	Handle = FActiveDNAEffectHandle::GenerateNewHandle(InArray.Owner);
+	InArray.bHandleToIndexMapDirty = true;
 
 	// Do stuff for adding GEs (add mods, tags, *invoke callbacks*
 	const_cast<FActiveDNAEffectsContainer&>(InArray).InternalOnActiveDNAEffectAdded(*this);	// Const cast is ok. It is there to prevent mutation of the DNAEffects array, which this wont do.
@@ -1666,6 +1759,8 @@ void FActiveDNAEffect::RecomputeStartWorldTime(const FActiveDNAEffectsContainer&
 FActiveDNAEffectsContainer::FActiveDNAEffectsContainer()
 	: Owner(nullptr)
 	, OwnerIsNetAuthority(false)
+	, bHandleToIndexMapDirty(false)
+	, bStackingIndexDirty(false)
 	, ScopedLockCount(0)
 	, PendingRemoves(0)
 	, PendingDNAEffectHead(nullptr)
@@ -1698,15 +1793,39 @@ void FActiveDNAEffectsContainer::RegisterWithOwner(UDNAAbilitySystemComponent* I
 }
 
 /** This is the main function that executes a DNAEffect on Attributes and ActiveDNAEffects */
+bool FActiveDNAEffectsContainer::ShouldCaptureTargetTagsOnExecute(const FDNAEffectSpec& Spec) const
+{
+	// Attribute sets may read the target tags during execution, so skipping is opt in
+	if (!UDNAAbilitySystemGlobals::Get().ShouldSkipUnreadTargetTagCaptures() || Spec.Def->ReadsTargetTagsOnExecute())
+	{
+		return true;
+	}
+
+	// Instant effects are reported as applied, periodic ones as executed, both with the spec that was just executed
+	if (Owner->OnDNAEffectAppliedDelegateToSelf.IsBound() || Owner->OnPeriodicDNAEffectExecuteDelegateOnSelf.IsBound())
+	{
+		return true;
+	}
+
+	const UDNAAbilitySystemComponent* InstigatorASC = Spec.GetContext().GetInstigatorDNAAbilitySystemComponent();
+	return InstigatorASC && (InstigatorASC->OnDNAEffectAppliedDelegateToTarget.IsBound() || InstigatorASC->OnPeriodicDNAEffectExecuteDelegateOnTarget.IsBound());
+}
+
 void FActiveDNAEffectsContainer::ExecuteActiveEffectsFrom(FDNAEffectSpec &Spec, FPredictionKey PredictionKey)
 {
 	FDNAEffectSpec& SpecToUse = Spec;
 
-	// Capture our own tags.
-	// TODO: We should only capture them if we need to. We may have snapshotted target tags (?) (in the case of dots with exotic setups?)
-
-	SpecToUse.CapturedTargetTags.GetActorTags().Reset();
-	Owner->GetOwnedDNATags(SpecToUse.CapturedTargetTags.GetActorTags());
+	// Capture our own tags. With bSkipUnreadTargetTagCaptures, only if the execution or the delegates broadcast after it read them, otherwise a periodic effect keeps the tags captured on application
+	if (ShouldCaptureTargetTagsOnExecute(SpecToUse))
+	{
+		INC_DWORD_STAT(STAT_DNAEffectTargetTagCaptures);
+		SpecToUse.CapturedTargetTags.GetActorTags().Reset();
+		Owner->GetOwnedDNATags(SpecToUse.CapturedTargetTags.GetActorTags());
+	}
+	else
+	{
+		INC_DWORD_STAT(STAT_DNAEffectTargetTagCapturesSkipped);
+	}
 
 	SpecToUse.CalculateModifierMagnitudes();
 
@@ -1865,11 +1984,13 @@ void FActiveDNAEffectsContainer::ExecutePeriodicDNAEffect(FActiveDNAEffectHandle
 
 FActiveDNAEffect* FActiveDNAEffectsContainer::GetActiveDNAEffect(const FActiveDNAEffectHandle Handle)
 {
-	for (FActiveDNAEffect& Effect : this)
+	const int32 Idx = FindActiveDNAEffectIndex(Handle);
+	if (Idx != INDEX_NONE)
 	{
-		if (Effect.Handle == Handle)
+		FActiveDNAEffect* Effect = GetActiveDNAEffect(Idx);
+		if (Effect && !Effect->IsPendingRemove)
 		{
-			return &Effect;
+			return Effect;
 		}
 	}
 	return nullptr;
@@ -1877,14 +1998,70 @@ FActiveDNAEffect* FActiveDNAEffectsContainer::GetActiveDNAEffect(const FActiveDN
 
 const FActiveDNAEffect* FActiveDNAEffectsContainer::GetActiveDNAEffect(const FActiveDNAEffectHandle Handle) const
 {
-	for (const FActiveDNAEffect& Effect : this)
+	return const_cast<FActiveDNAEffectsContainer*>(this)->GetActiveDNAEffect(Handle);
+}
+
+int32 FActiveDNAEffectsContainer::FindActiveDNAEffectIndex(FActiveDNAEffectHandle Handle) const
+{
+	if (!Handle.IsValid())
 	{
-		if (Effect.Handle == Handle)
+		return INDEX_NONE;
+	}
+
+	for (int32 Attempt = 0; Attempt < 2; ++Attempt)
+	{
+		if (bHandleToIndexMapDirty)
+		{
+			RebuildHandleToIndexMap();
+		}
+
+		const int32* IdxPtr = HandleToIndexMap.Find(Handle);
+		if (IdxPtr == nullptr)
+		{
+			break;
+		}
+
+		if (DNAEffects_Internal.IsValidIndex(*IdxPtr) && DNAEffects_Internal[*IdxPtr].Handle == Handle)
 		{
-			return &Effect;
+			return *IdxPtr;
 		}
+
+		// The array changed underneath the map, e.g. replication removed an effect after calling PreReplicatedRemove
+		bHandleToIndexMapDirty = true;
+	}
+
+	// Effects added while scope locked wait on the pending list, which is bounded by the array slack so a walk is fine
+	int32 Idx = DNAEffects_Internal.Num();
+	for (const FActiveDNAEffect* PendingDNAEffect = PendingDNAEffectHead; PendingDNAEffect && PendingDNAEffect != *PendingDNAEffectNext; PendingDNAEffect = PendingDNAEffect->PendingNext)
+	{
+		if (PendingDNAEffect->Handle == Handle)
+		{
+			return Idx;
+		}
+		++Idx;
+	}
+
+	return INDEX_NONE;
+}
+
+void FActiveDNAEffectsContainer::RebuildHandleToIndexMap() const
+{
+	HandleToIndexMap.Reset();
+	for (int32 Idx = 0; Idx < DNAEffects_Internal.Num(); ++Idx)
+	{
+		HandleToIndexMap.Add(DNAEffects_Internal[Idx].Handle, Idx);
+	}
+	bHandleToIndexMapDirty = false;
+}
+
+void FActiveDNAEffectsContainer::RemoveDNAEffectAtSwap(int32 Idx, bool bAllowShrinking)
+{
+	HandleToIndexMap.Remove(DNAEffects_Internal[Idx].Handle);
+	DNAEffects_Internal.RemoveAtSwap(Idx, 1, bAllowShrinking);
+	if (Idx < DNAEffects_Internal.Num())
+	{
+		HandleToIndexMap.Add(DNAEffects_Internal[Idx].Handle, Idx);
 	}
-	return nullptr;
 }
 
 FAggregatorRef& FActiveDNAEffectsContainer::FindOrCreateAttributeAggregator(FDNAAttribute Attribute)
@@ -2108,30 +2285,149 @@ void FActiveDNAEffectsContainer::UpdateAggregatorModMagnitudes(const TSet<FDNAAt
 	}
 }
 
+void FActiveDNAEffectsContainer::AddAggregatorDependencies(const FActiveDNAEffect& Effect)
+{
+	const FDNAEffectSpec& Spec = Effect.Spec;
+
+	// Periodic effects execute on the base value. Their mods are never on the aggregators, so they do not update them when a capture changes
+	if (Spec.Def == nullptr || Spec.GetPeriod() > UDNAEffect::NO_PERIOD)
+	{
+		return;
+	}
+
+	TArray<FDNAEffectAttributeCaptureDefinition> CaptureDefs;
+	for (int32 ModIdx = 0; ModIdx < Spec.Modifiers.Num(); ++ModIdx)
+	{
+		const FDNAModifierInfo& ModDef = Spec.Def->Modifiers[ModIdx];
+		if (!Owner || Owner->HasAttributeSetForAttribute(ModDef.Attribute) == false)
+		{
+			continue;
+		}
+
+		// Only the captures this modifier's magnitude uses, the same ones OnMagnitudeDependencyChange recalculates it for
+		CaptureDefs.Reset();
+		ModDef.ModifierMagnitude.GetAttributeCaptureDefinitions(CaptureDefs);
+		for (const FDNAEffectAttributeCaptureDefinition& CaptureDef : CaptureDefs)
+		{
+			const FDNAEffectAttributeCaptureSpec* CaptureSpec = CaptureDef.bSnapshot ? nullptr : Spec.CapturedRelevantAttributes.FindCaptureSpecByDefinition(CaptureDef, true);
+			if (CaptureSpec && !AggregatorDependencies.AddDependency(Effect.Handle, CaptureSpec->AttributeAggregator, FindOrCreateAttributeAggregator(ModDef.Attribute)))
+			{
+				ABILITY_LOG(Warning, TEXT("%s modifies %s by a magnitude that captures %s, which already depends on %s. These attributes depend on each other in a cycle, changes to them will not be fully recomputed (%s)"),
+					*Spec.Def->GetName(), *ModDef.Attribute.GetName(), *CaptureDef.AttributeToCapture.GetName(), *ModDef.Attribute.GetName(), *Owner->GetPathName());
+			}
+		}
+	}
+}
+
 FActiveDNAEffect* FActiveDNAEffectsContainer::FindStackableActiveDNAEffect(const FDNAEffectSpec& Spec)
 {
-	FActiveDNAEffect* StackableGE = nullptr;
 	const UDNAEffect* GEDef = Spec.Def;
 	EDNAEffectStackingType StackingType = GEDef->StackingType;
 
-	if (StackingType != EDNAEffectStackingType::None && Spec.GetDuration() != UDNAEffect::INSTANT_APPLICATION)
+	if (StackingType == EDNAEffectStackingType::None || Spec.GetDuration() == UDNAEffect::INSTANT_APPLICATION)
+	{
+		return nullptr;
+	}
+
+	// Aggregate by source stacking additionally requires the source ability component to match
+	const FStackingIndexKey Key(Spec);
+	if (StackingType == EDNAEffectStackingType::AggregateBySource && Key.SourceASC == nullptr)
 	{
-		// Iterate through DNAEffects to see if we find a match. Note that we could cache off a handle in a map but we would still
-		// do a linear search through DNAEffects to find the actual FActiveDNAEffect (due to unstable nature of the DNAEffects array).
-		// If this becomes a slow point in the profiler, the map may still be useful as an early out to avoid an unnecessary sweep.
-		UDNAAbilitySystemComponent* SourceASC = Spec.GetContext().GetInstigatorDNAAbilitySystemComponent();
-		for (FActiveDNAEffect& ActiveEffect: this)
+		return nullptr;
+	}
+
+	for (int32 Attempt = 0; Attempt < 2; ++Attempt)
+	{
+		if (bStackingIndexDirty)
 		{
-			// Aggregate by source stacking additionally requires the source ability component to match
-			if (ActiveEffect.Spec.Def == Spec.Def && ((StackingType == EDNAEffectStackingType::AggregateByTarget) || (SourceASC && SourceASC == ActiveEffect.Spec.GetContext().GetInstigatorDNAAbilitySystemComponent())))
-			{
-				StackableGE = &ActiveEffect;
-				break;
-			}
+			RebuildStackingIndex();
+		}
+
+		const FStackingIndexEntry* Entry = StackingIndex.Find(Key);
+		if (Entry == nullptr)
+		{
+			return nullptr;
 		}
+
+		// A source component can be destroyed and another one created at its address, so check the effect still matches
+		FActiveDNAEffect* ActiveEffect = GetActiveDNAEffect(Entry->Handle);
+		if (ActiveEffect && FStackingIndexKey(ActiveEffect->Spec) == Key)
+		{
+			return ActiveEffect;
+		}
+
+		bStackingIndexDirty = true;
+	}
+
+	return nullptr;
+}
+
+FActiveDNAEffectsContainer::FStackingIndexKey::FStackingIndexKey(const FDNAEffectSpec& Spec)
+	: Def(Spec.Def)
+	, SourceASC(Spec.Def && Spec.Def->StackingType == EDNAEffectStackingType::AggregateBySource ? Spec.GetContext().GetInstigatorDNAAbilitySystemComponent() : nullptr)
+{
+}
+
+void FActiveDNAEffectsContainer::AddToStackingIndex(const FActiveDNAEffect& Effect)
+{
+	if (Effect.Spec.Def->StackingType == EDNAEffectStackingType::None)
+	{
+		return;
+	}
+
+	FStackingIndexEntry* Entry = StackingIndex.Find(FStackingIndexKey(Effect.Spec));
+	if (Entry)
+	{
+		Entry->NumEffects++;
+	}
+	else
+	{
+		FStackingIndexEntry NewEntry;
+		NewEntry.Handle = Effect.Handle;
+		NewEntry.NumEffects = 1;
+		StackingIndex.Add(FStackingIndexKey(Effect.Spec), NewEntry);
+	}
+}
+
+void FActiveDNAEffectsContainer::RemoveFromStackingIndex(const FActiveDNAEffect& Effect)
+{
+	if (Effect.Spec.Def->StackingType == EDNAEffectStackingType::None)
+	{
+		return;
 	}
 
-	return StackableGE;
+	const FStackingIndexKey Key(Effect.Spec);
+	FStackingIndexEntry* Entry = StackingIndex.Find(Key);
+	if (Entry == nullptr)
+	{
+		// The key changed since the effect was added, start over
+		bStackingIndexDirty = true;
+		return;
+	}
+
+	if (--Entry->NumEffects <= 0)
+	{
+		StackingIndex.Remove(Key);
+	}
+	else if (Entry->Handle == Effect.Handle)
+	{
+		// Another effect with this key takes over, which one depends on the iteration order
+		bStackingIndexDirty = true;
+	}
+}
+
+void FActiveDNAEffectsContainer::RebuildStackingIndex()
+{
+	StackingIndex.Reset();
+	bStackingIndexDirty = false;
+
+	for (const FActiveDNAEffect& Effect : this)
+	{
+		if (Effect.Spec.Def)
+		{
+			AddToStackingIndex(Effect);
+		}
+	}
 }
 
 bool FActiveDNAEffectsContainer::HandleActiveDNAEffectStackOverflow(const FActiveDNAEffect& ActiveStackableGE, const FDNAEffectSpec& OldSpec, const FDNAEffectSpec& OverflowingSpec)
@@ -2199,17 +2495,11 @@ void FActiveDNAEffectsContainer::GetDNAEffectStartTimeAndDuration(FActiveDNAEffe
 	EffectStartTime = UDNAEffect::INFINITE_DURATION;
 	EffectDuration = UDNAEffect::INFINITE_DURATION;
 
-	if (Handle.IsValid())
+	if (const FActiveDNAEffect* ActiveEffect = GetActiveDNAEffect(Handle))
 	{
-		for (const FActiveDNAEffect& ActiveEffect : this)
-		{
-			if (ActiveEffect.Handle == Handle)
-			{
-				EffectStartTime = ActiveEffect.StartWorldTime;
-				EffectDuration = ActiveEffect.GetDuration();
-				return;
-			}
-		}
+		EffectStartTime = ActiveEffect->StartWorldTime;
+		EffectDuration = ActiveEffect->GetDuration();
+		return;
 	}
 
 	ABILITY_LOG(Warning, TEXT("GetDNAEffectStartTimeAndDuration called with invalid Handle: %s"), *Handle.ToString());
@@ -2217,19 +2507,16 @@ void FActiveDNAEffectsContainer::GetDNAEffectStartTimeAndDuration(FActiveDNAEffe
 
 float FActiveDNAEffectsContainer::GetDNAEffectMagnitude(FActiveDNAEffectHandle Handle, FDNAAttribute Attribute) const
 {
-	for (const FActiveDNAEffect& Effect : this)
+	if (const FActiveDNAEffect* Effect = GetActiveDNAEffect(Handle))
 	{
-		if (Effect.Handle == Handle)
+		for(int32 ModIdx = 0; ModIdx < Effect->Spec.Modifiers.Num(); ++ModIdx)
 		{
-			for(int32 ModIdx = 0; ModIdx < Effect.Spec.Modifiers.Num(); ++ModIdx)
+			const FDNAModifierInfo& ModDef = Effect->Spec.Def->Modifiers[ModIdx];
+			const FModifierSpec& ModSpec = Effect->Spec.Modifiers[ModIdx];
+		
+			if (ModDef.Attribute == Attribute)
 			{
-				const FDNAModifierInfo& ModDef = Effect.Spec.Def->Modifiers[ModIdx];
-				const FModifierSpec& ModSpec = Effect.Spec.Modifiers[ModIdx];
-			
-				if (ModDef.Attribute == Attribute)
-				{
-					return ModSpec.GetEvaluatedMagnitude();
-				}
+				return ModSpec.GetEvaluatedMagnitude();
 			}
 		}
 	}
@@ -2240,28 +2527,22 @@ float FActiveDNAEffectsContainer::GetDNAEffectMagnitude(FActiveDNAEffectHandle H
 
 void FActiveDNAEffectsContainer::SetActiveDNAEffectLevel(FActiveDNAEffectHandle ActiveHandle, int32 NewLevel)
 {
-	for (FActiveDNAEffect& Effect : this)
+	if (FActiveDNAEffect* Effect = GetActiveDNAEffect(ActiveHandle))
 	{
-		if (Effect.Handle == ActiveHandle)
-		{
-			Effect.Spec.SetLevel(NewLevel);
-			MarkItemDirty(Effect);
-			Effect.Spec.CalculateModifierMagnitudes();
-			UpdateAllAggregatorModMagnitudes(Effect);
-			break;
-		}
+		Effect->Spec.SetLevel(NewLevel);
+		MarkItemDirty(*Effect);
+		Effect->Spec.CalculateModifierMagnitudes();
+		UpdateAllAggregatorModMagnitudes(*Effect);
 	}
 }
 
 const FDNATagContainer* FActiveDNAEffectsContainer::GetDNAEffectSourceTagsFromHandle(FActiveDNAEffectHandle Handle) const
 {
 	// @todo: Need to consider this with tag changes
-	for (const FActiveDNAEffect& Effect : this)
+	const FActiveDNAEffect* Effect = GetActiveDNAEffect(Handle);
+	if (Effect)
 	{
-		if (Effect.Handle == Handle)
-		{
-			return Effect.Spec.CapturedSourceTags.GetAggregatedTags();
-		}
+		return Effect->Spec.CapturedSourceTags.GetAggregatedTags();
 	}
 
 	return nullptr;
@@ -2521,6 +2802,7 @@ FActiveDNAEffect* FActiveDNAEffectsContainer::ApplyDNAEffectSpec(const FDNAEffec
 		// Need to unregister callbacks because the source aggregators could potentially be different with the new application. They will be
 		// re-registered later below, as necessary.
 		ExistingSpec.CapturedRelevantAttributes.UnregisterLinkedAggregatorCallbacks(ExistingStackableGE->Handle);
+		AggregatorDependencies.RemoveDependencies(ExistingStackableGE->Handle);
 
 		// @todo: If dynamically granted tags differ (which they shouldn't), we'll actually have to diff them
 		// and cause a removal and add of only the ones that have changed. For now, ensure on this happening and come
@@ -2600,6 +2882,7 @@ FActiveDNAEffect* FActiveDNAEffectsContainer::ApplyDNAEffectSpec(const FDNAEffec
 
 			// [#3] If you change this, please change #1-3!!!
 			AppliedActiveGE = new(DNAEffects_Internal) FActiveDNAEffect(NewHandle, Spec, GetWorldTime(), GetServerWorldTime(), InPredictionKey);
+			HandleToIndexMap.Add(NewHandle, DNAEffects_Internal.Num() - 1);
 		}
 	}
 
@@ -2651,6 +2934,7 @@ FActiveDNAEffect* FActiveDNAEffectsContainer::ApplyDNAEffectSpec(const FDNAEffec
 
 	// Register Source and Target non snapshot capture delegates here
 	AppliedEffectSpec.CapturedRelevantAttributes.RegisterLinkedAggregatorCallbacks(AppliedActiveGE->Handle);
+	AddAggregatorDependencies(*AppliedActiveGE);
 	
 	if (bSetDuration)
 	{
@@ -2683,31 +2967,30 @@ FActiveDNAEffect* FActiveDNAEffectsContainer::ApplyDNAEffectSpec(const FDNAEffec
 
 			// ABILITY_LOG(Warning, TEXT("SetDuration for %s. Base: %.2f, Final: %.2f"), *NewEffect.Spec.Def->GetName(), DurationBaseValue, FinalDuration);
 
-			// Register duration callbacks with the timer manager
+			// Register duration callbacks with the effect timer wheel
 			if (Owner)
 			{
-				FTimerManager& TimerManager = Owner->GetWorld()->GetTimerManager();
-				FTimerDelegate Delegate = FTimerDelegate::CreateUObject(Owner, &UDNAAbilitySystemComponent::CheckDurationExpired, AppliedActiveGE->Handle);
-				TimerManager.SetTimer(AppliedActiveGE->DurationHandle, Delegate, FinalDuration, false);
+				FDNAEffectTimerWheel& TimerWheel = UDNAAbilitySystemGlobals::Get().GetEffectTimerWheel(Owner->GetWorld());
+				TimerWheel.SetTimer(AppliedActiveGE->DurationHandle, Owner, AppliedActiveGE->Handle, EDNAEffectTimerType::Duration, FinalDuration);
 			}
 		}
 	}
 	
-	// Register period callbacks with the timer manager
+	// Register period callbacks with the effect timer wheel
 	if (Owner && (AppliedEffectSpec.GetPeriod() != UDNAEffect::NO_PERIOD))
 	{
-		FTimerManager& TimerManager = Owner->GetWorld()->GetTimerManager();
-		FTimerDelegate Delegate = FTimerDelegate::CreateUObject(Owner, &UDNAAbilitySystemComponent::ExecutePeriodicEffect, AppliedActiveGE->Handle);
-			
-		// The timer manager moves things from the pending list to the active list after checking the active list on the first tick so we need to execute here
+		FDNAEffectTimerWheel& TimerWheel = UDNAAbilitySystemGlobals::Get().GetEffectTimerWheel(Owner->GetWorld());
+
+		// Executes on the next frame, like the periods themselves. Nothing needs to clear it, a removed effect is simply not found
 		if (AppliedEffectSpec.Def->bExecutePeriodicEffectOnApplication)
 		{
-			TimerManager.SetTimerForNextTick(Delegate);
+			FDNAEffectTimerHandle ApplicationHandle;
+			TimerWheel.SetTimer(ApplicationHandle, Owner, AppliedActiveGE->Handle, EDNAEffectTimerType::Period, 0.f);
 		}
 
 		if (bSetPeriod)
 		{
-			TimerManager.SetTimer(AppliedActiveGE->PeriodHandle, Delegate, AppliedEffectSpec.GetPeriod(), true);
+			TimerWheel.SetTimer(AppliedActiveGE->PeriodHandle, Owner, AppliedActiveGE->Handle, EDNAEffectTimerType::Period, AppliedEffectSpec.GetPeriod(), AppliedEffectSpec.GetPeriod());
 		}
 	}
 
@@ -2758,6 +3041,8 @@ void FActiveDNAEffectsContainer::InternalOnActiveDNAEffectAdded(FActiveDNAEffect
 	DNAEFFECT_SCOPE_LOCK();
 	UE_VLOG(Owner->OwnerActor ? Owner->OwnerActor : Owner->GetOuter(), LogDNAEffects, Log, TEXT("Added: %s"), *GetNameSafe(EffectDef->GetClass()));
 
+	AddToStackingIndex(Effect);
+
 	// Add our ongoing tag requirements to the dependency map. We will actually check for these tags below.
 	for (const FDNATag& Tag : EffectDef->OngoingTagRequirements.IgnoreTags)
 	{
@@ -2825,18 +3110,31 @@ void FActiveDNAEffectsContainer::AddActiveDNAEffectGrantedTagsAndModifiers(FActi
 		}
 	}
 
-	// Update our owner with the tags this DNAEffect grants them
-	Owner->UpdateTagMap(Effect.Spec.Def->InheritableOwnedTagsContainer.CombinedTags, 1);
-	Owner->UpdateTagMap(Effect.Spec.DynamicGrantedTags, 1);
-	if (ShouldUseMinimalReplication())
+	TArray<FDNATag> UpdatedOwnerTags;
 	{
-		Owner->AddMinimalReplicationDNATags(Effect.Spec.Def->InheritableOwnedTagsContainer.CombinedTags);
-		Owner->AddMinimalReplicationDNATags(Effect.Spec.DynamicGrantedTags);
+		// Tag count delegates fire once per tag with the final counts, instead of once per granted tag and parent
+		FDNATagCountContainer::FScopedBatch OwnerTagBatch(Owner->DNATagCountContainer);
+		FDNATagCountContainer::FScopedBatch ImmunityTagBatch(ApplicationImmunityDNATagCountContainer);
+
+		// Update our owner with the tags this DNAEffect grants them
+		Owner->UpdateTagMapDeferred(Effect.Spec.Def->InheritableOwnedTagsContainer.CombinedTags, 1, UpdatedOwnerTags);
+		Owner->UpdateTagMapDeferred(Effect.Spec.DynamicGrantedTags, 1, UpdatedOwnerTags);
+		if (ShouldUseMinimalReplication())
+		{
+			Owner->AddMinimalReplicationDNATags(Effect.Spec.Def->InheritableOwnedTagsContainer.CombinedTags);
+			Owner->AddMinimalReplicationDNATags(Effect.Spec.DynamicGrantedTags);
+		}
+
+		// Immunity
+		ApplicationImmunityDNATagCountContainer.UpdateTagCount(Effect.Spec.Def->GrantedApplicationImmunityTags.RequireTags, 1);
+		ApplicationImmunityDNATagCountContainer.UpdateTagCount(Effect.Spec.Def->GrantedApplicationImmunityTags.IgnoreTags, 1);
 	}
 
-	// Immunity
-	ApplicationImmunityDNATagCountContainer.UpdateTagCount(Effect.Spec.Def->GrantedApplicationImmunityTags.RequireTags, 1);
-	ApplicationImmunityDNATagCountContainer.UpdateTagCount(Effect.Spec.Def->GrantedApplicationImmunityTags.IgnoreTags, 1);
+	// After the count delegates, as when each tag is updated on its own
+	for (const FDNATag& Tag : UpdatedOwnerTags)
+	{
+		Owner->OnTagUpdated(Tag, true);
+	}
 
 	if (Effect.Spec.Def->HasGrantedApplicationImmunityQuery)
 	{	
@@ -2890,12 +3188,12 @@ void FActiveDNAEffectsContainer::AddActiveDNAEffectGrantedTagsAndModifiers(FActi
 /** Called on server to remove a DNAEffect */
 bool FActiveDNAEffectsContainer::RemoveActiveDNAEffect(FActiveDNAEffectHandle Handle, int32 StacksToRemove)
 {
-	// Iterating through manually since this is a removal operation and we need to pass the index into InternalRemoveActiveDNAEffect
-	int32 NumDNAEffects = GetNumDNAEffects();
-	for (int32 ActiveGEIdx = 0; ActiveGEIdx < NumDNAEffects; ++ActiveGEIdx)
+	// Looking up the index since this is a removal operation and we need to pass it into InternalRemoveActiveDNAEffect
+	const int32 ActiveGEIdx = FindActiveDNAEffectIndex(Handle);
+	if (ActiveGEIdx != INDEX_NONE)
 	{
 		FActiveDNAEffect& Effect = *GetActiveDNAEffect(ActiveGEIdx);
-		if (Effect.Handle == Handle && Effect.IsPendingRemove == false)
+		if (Effect.IsPendingRemove == false)
 		{
 			UE_VLOG(Owner->OwnerActor, LogDNAEffects, Log, TEXT("Removed: %s"), *GetNameSafe(Effect.Spec.Def->GetClass()));
 			if (UE_LOG_ACTIVE(VLogDNAAbilitySystem, Log))
@@ -2963,13 +3261,12 @@ bool FActiveDNAEffectsContainer::InternalRemoveActiveDNAEffect(int32 Idx, int32
 		// Mark the effect pending remove, and remove all side effects from the effect
 		InternalOnActiveDNAEffectRemoved(Effect, ShouldInvokeDNACueEvent);
 
-		if (Effect.DurationHandle.IsValid())
-		{
-			Owner->GetWorld()->GetTimerManager().ClearTimer(Effect.DurationHandle);
-		}
-		if (Effect.PeriodHandle.IsValid())
+		// Effects are also removed while their world is cleaned up, after its wheel and all of its timers are gone
+		FDNAEffectTimerWheel* TimerWheel = UDNAAbilitySystemGlobals::Get().FindEffectTimerWheel(Owner->GetWorld());
+		if (TimerWheel)
 		{
-			Owner->GetWorld()->GetTimerManager().ClearTimer(Effect.PeriodHandle);
+			TimerWheel->ClearTimer(Effect.DurationHandle);
+			TimerWheel->ClearTimer(Effect.PeriodHandle);
 		}
 
 		if (bIsNetAuthority && Owner->OwnerActor)
@@ -3002,7 +3299,7 @@ bool FActiveDNAEffectsContainer::InternalRemoveActiveDNAEffect(int32 Idx, int32
 			// in a pending remove being set.
 			check(Idx < DNAEffects_Internal.Num());
 
-			DNAEffects_Internal.RemoveAtSwap(Idx);
+			RemoveDNAEffectAtSwap(Idx, true);
 			ModifiedArray = true;
 		}
 
@@ -3030,6 +3327,9 @@ void FActiveDNAEffectsContainer::InternalOnActiveDNAEffectRemoved(FActiveDNAEffe
 
 	if (Effect.Spec.Def)
 	{
+		RemoveFromStackingIndex(Effect);
+		AggregatorDependencies.RemoveDependencies(Effect.Handle);
+
 		// Remove our tag requirements from the dependency map
 		RemoveActiveEffectTagDependency(Effect.Spec.Def->OngoingTagRequirements.IgnoreTags, Effect.Handle);
 		RemoveActiveEffectTagDependency(Effect.Spec.Def->OngoingTagRequirements.RequireTags, Effect.Handle);
@@ -3069,19 +3369,30 @@ void FActiveDNAEffectsContainer::RemoveActiveDNAEffectGrantedTagsAndModifiers(co
 		}
 	}
 
-	// Update DNAtag count and broadcast delegate if we are at 0
-	Owner->UpdateTagMap(Effect.Spec.Def->InheritableOwnedTagsContainer.CombinedTags, -1);
-	Owner->UpdateTagMap(Effect.Spec.DynamicGrantedTags, -1);
-
-	if (ShouldUseMinimalReplication())
+	TArray<FDNATag> UpdatedOwnerTags;
 	{
-		Owner->RemoveMinimalReplicationDNATags(Effect.Spec.Def->InheritableOwnedTagsContainer.CombinedTags);
-		Owner->RemoveMinimalReplicationDNATags(Effect.Spec.DynamicGrantedTags);
+		FDNATagCountContainer::FScopedBatch OwnerTagBatch(Owner->DNATagCountContainer);
+		FDNATagCountContainer::FScopedBatch ImmunityTagBatch(ApplicationImmunityDNATagCountContainer);
+
+		// Update DNAtag count and broadcast delegate if we are at 0
+		Owner->UpdateTagMapDeferred(Effect.Spec.Def->InheritableOwnedTagsContainer.CombinedTags, -1, UpdatedOwnerTags);
+		Owner->UpdateTagMapDeferred(Effect.Spec.DynamicGrantedTags, -1, UpdatedOwnerTags);
+
+		if (ShouldUseMinimalReplication())
+		{
+			Owner->RemoveMinimalReplicationDNATags(Effect.Spec.Def->InheritableOwnedTagsContainer.CombinedTags);
+			Owner->RemoveMinimalReplicationDNATags(Effect.Spec.DynamicGrantedTags);
+		}
+
+		// Immunity
+		ApplicationImmunityDNATagCountContainer.UpdateTagCount(Effect.Spec.Def->GrantedApplicationImmunityTags.RequireTags, -1);
+		ApplicationImmunityDNATagCountContainer.UpdateTagCount(Effect.Spec.Def->GrantedApplicationImmunityTags.IgnoreTags, -1);
 	}
 
-	// Immunity
-	ApplicationImmunityDNATagCountContainer.UpdateTagCount(Effect.Spec.Def->GrantedApplicationImmunityTags.RequireTags, -1);
-	ApplicationImmunityDNATagCountContainer.UpdateTagCount(Effect.Spec.Def->GrantedApplicationImmunityTags.IgnoreTags, -1);
+	for (const FDNATag& Tag : UpdatedOwnerTags)
+	{
+		Owner->OnTagUpdated(Tag, false);
+	}
 
 	if (Effect.Spec.Def->HasGrantedApplicationImmunityQuery)
 	{
@@ -3437,6 +3748,14 @@ bool FActiveDNAEffectsContainer::NetDeltaSerialize(FNetDeltaSerializeInfo& Delta
 
 	bool RetVal = FastArrayDeltaSerialize<FActiveDNAEffect>(DNAEffects_Internal, DeltaParms, *this);
 
+	if (DeltaParms.Writer == nullptr)
+	{
+		// Replication adds, removes and reorders elements without going through our bookkeeping,
+		// and can map an effect's instigator after it was added, which changes its stacking key
+		bHandleToIndexMapDirty = true;
+		bStackingIndexDirty = true;
+	}
+
 	// After the array has been replicated, invoke GC events ONLY if the effect is not inhibited
 	// We postpone this check because in the same net update we could receive multiple GEs that affect if one another is inhibited
 	
@@ -3501,103 +3820,98 @@ float FActiveDNAEffectsContainer::GetWorldTime() const
 void FActiveDNAEffectsContainer::CheckDuration(FActiveDNAEffectHandle Handle)
 {
 	DNAEFFECT_SCOPE_LOCK();
-	// Intentionally iterating through only the internal list since we need to pass the index for removal
+	// Intentionally only looking in the internal list since we need to pass the index for removal
 	// and pending effects will never need to be checked for duration expiration (They will be added to the real list first)
-	for (int32 ActiveGEIdx = 0; ActiveGEIdx < DNAEffects_Internal.Num(); ++ActiveGEIdx)
+	const int32 ActiveGEIdx = FindActiveDNAEffectIndex(Handle);
+	if (ActiveGEIdx == INDEX_NONE || ActiveGEIdx >= DNAEffects_Internal.Num())
 	{
-		FActiveDNAEffect& Effect = DNAEffects_Internal[ActiveGEIdx];
-		if (Effect.Handle == Handle)
-		{
-			if (Effect.IsPendingRemove)
-			{
-				// break is this effect is pending remove. 
-				// (Note: don't combine this with the above if statement that is looking for the effect via handle, since we want to stop iteration if we find a matching handle but are pending remove).
-				break;
-			}
+		return;
+	}
 
-			FTimerManager& TimerManager = Owner->GetWorld()->GetTimerManager();
+	FActiveDNAEffect& Effect = DNAEffects_Internal[ActiveGEIdx];
+	if (Effect.IsPendingRemove)
+	{
+		return;
+	}
 
-			// The duration may have changed since we registered this callback with the timer manager.
-			// Make sure that this effect should really be destroyed now
-			float Duration = Effect.GetDuration();
-			float CurrentTime = GetWorldTime();
+	// The duration may have changed since we registered this callback with the timer manager.
+	// Make sure that this effect should really be destroyed now
+	float Duration = Effect.GetDuration();
+	float CurrentTime = GetWorldTime();
 
-			int32 StacksToRemove = -2;
-			bool RefreshStartTime = false;
-			bool RefreshDurationTimer = false;
-			bool CheckForFinalPeriodicExec = false;
+	int32 StacksToRemove = -2;
+	bool RefreshStartTime = false;
+	bool RefreshDurationTimer = false;
+	bool CheckForFinalPeriodicExec = false;
 
-			if (Duration > 0.f && (((Effect.StartWorldTime + Duration) < CurrentTime) || FMath::IsNearlyZero(CurrentTime - Duration - Effect.StartWorldTime, KINDA_SMALL_NUMBER)))
-			{
-				// Figure out what to do based on the expiration policy
-				switch(Effect.Spec.Def->StackExpirationPolicy)
-				{
-				case EDNAEffectStackingExpirationPolicy::ClearEntireStack:
-					StacksToRemove = -1; // Remove all stacks
-					CheckForFinalPeriodicExec = true;					
-					break;
-
-				case EDNAEffectStackingExpirationPolicy::RemoveSingleStackAndRefreshDuration:
-					StacksToRemove = 1;
-					CheckForFinalPeriodicExec = (Effect.Spec.StackCount == 1);
-					RefreshStartTime = true;
-					RefreshDurationTimer = true;
-					break;
-				case EDNAEffectStackingExpirationPolicy::RefreshDuration:
-					RefreshStartTime = true;
-					RefreshDurationTimer = true;
-					break;
-				};					
-			}
-			else
-			{
-				// Effect isn't finished, just refresh its duration timer
-				RefreshDurationTimer = true;
-			}
+	if (Duration > 0.f && (((Effect.StartWorldTime + Duration) < CurrentTime) || FMath::IsNearlyZero(CurrentTime - Duration - Effect.StartWorldTime, KINDA_SMALL_NUMBER)))
+	{
+		// Figure out what to do based on the expiration policy
+		switch(Effect.Spec.Def->StackExpirationPolicy)
+		{
+		case EDNAEffectStackingExpirationPolicy::ClearEntireStack:
+			StacksToRemove = -1; // Remove all stacks
+			CheckForFinalPeriodicExec = true;					
+			break;
 
-			if (CheckForFinalPeriodicExec)
-			{
-				// This DNA effect has hit its duration. Check if it needs to execute one last time before removing it.
-				if (Effect.PeriodHandle.IsValid() && TimerManager.TimerExists(Effect.PeriodHandle))
-				{
-					float PeriodTimeRemaining = TimerManager.GetTimerRemaining(Effect.PeriodHandle);
-					if (PeriodTimeRemaining <= KINDA_SMALL_NUMBER && !Effect.bIsInhibited)
-					{
-						ExecuteActiveEffectsFrom(Effect.Spec);
+		case EDNAEffectStackingExpirationPolicy::RemoveSingleStackAndRefreshDuration:
+			StacksToRemove = 1;
+			CheckForFinalPeriodicExec = (Effect.Spec.StackCount == 1);
+			RefreshStartTime = true;
+			RefreshDurationTimer = true;
+			break;
+		case EDNAEffectStackingExpirationPolicy::RefreshDuration:
+			RefreshStartTime = true;
+			RefreshDurationTimer = true;
+			break;
+		};					
+	}
+	else
+	{
+		// Effect isn't finished, just refresh its duration timer
+		RefreshDurationTimer = true;
+	}
 
-						// The above call to ExecuteActiveEffectsFrom could cause this effect to be explicitly removed
-						// (for example it could kill the owner and cause the effect to be wiped via death).
-						// In that case, we need to early out instead of possibly continueing to the below calls to InternalRemoveActiveDNAEffect
-						if ( Effect.IsPendingRemove )
-						{
-							break;
-						}
-					}
+	if (CheckForFinalPeriodicExec)
+	{
+		// This DNA effect has hit its duration. Check if it needs to execute one last time before removing it.
+		FDNAEffectTimerWheel* TimerWheel = UDNAAbilitySystemGlobals::Get().FindEffectTimerWheel(Owner->GetWorld());
+		if (TimerWheel && TimerWheel->TimerExists(Effect.PeriodHandle))
+		{
+			float PeriodTimeRemaining = TimerWheel->GetTimerRemaining(Effect.PeriodHandle);
+			if (PeriodTimeRemaining <= KINDA_SMALL_NUMBER && !Effect.bIsInhibited)
+			{
+				ExecuteActiveEffectsFrom(Effect.Spec);
 
-					// Forcibly clear the periodic ticks because this effect is going to be removed
-					TimerManager.ClearTimer(Effect.PeriodHandle);
+				// The above call to ExecuteActiveEffectsFrom could cause this effect to be explicitly removed
+				// (for example it could kill the owner and cause the effect to be wiped via death).
+				// In that case, we need to early out instead of possibly continueing to the below calls to InternalRemoveActiveDNAEffect
+				if ( Effect.IsPendingRemove )
+				{
+					return;
 				}
 			}
 
-			if (StacksToRemove >= -1)
-			{
-				InternalRemoveActiveDNAEffect(ActiveGEIdx, StacksToRemove, false);
-			}
+			// Forcibly clear the periodic ticks because this effect is going to be removed
+			TimerWheel->ClearTimer(Effect.PeriodHandle);
+		}
+	}
 
-			if (RefreshStartTime)
-			{
-				RestartActiveDNAEffectDuration(Effect);
-			}
+	if (StacksToRemove >= -1)
+	{
+		InternalRemoveActiveDNAEffect(ActiveGEIdx, StacksToRemove, false);
+	}
 
-			if (RefreshDurationTimer)
-			{
-				// Always reset the timer, since the duration might have been modified
-				FTimerDelegate Delegate = FTimerDelegate::CreateUObject(Owner, &UDNAAbilitySystemComponent::CheckDurationExpired, Effect.Handle);
-				TimerManager.SetTimer(Effect.DurationHandle, Delegate, (Effect.StartWorldTime + Duration) - CurrentTime, false);
-			}
+	if (RefreshStartTime)
+	{
+		RestartActiveDNAEffectDuration(Effect);
+	}
 
-			break;
-		}
+	if (RefreshDurationTimer)
+	{
+		// Always reset the timer, since the duration might have been modified
+		FDNAEffectTimerWheel& TimerWheel = UDNAAbilitySystemGlobals::Get().GetEffectTimerWheel(Owner->GetWorld());
+		TimerWheel.SetTimer(Effect.DurationHandle, Owner, Effect.Handle, EDNAEffectTimerType::Duration, (Effect.StartWorldTime + Duration) - CurrentTime);
 	}
 }
 
@@ -3979,7 +4293,12 @@ void FActiveDNAEffectsContainer::CloneFrom(const FActiveDNAEffectsContainer& Sou
 	// Make a full copy of the source's DNA effects
 	DNAEffects_Internal = Source.DNAEffects_Internal;
 
+	// The copies get new handles below
+	bHandleToIndexMapDirty = true;
+	bStackingIndexDirty = true;
+
 	// Build our AttributeAggregatorMap by deep copying the source's
+	AggregatorDependencies.Reset();
 	AttributeAggregatorMap.Reset();
 
 	TArray< TPair<FAggregatorRef, FAggregatorRef> >	SwappedAggregators;
@@ -3996,8 +4315,10 @@ void FActiveDNAEffectsContainer::CloneFrom(const FActiveDNAEffectsContainer& Sou
 		// Make full copy of the source aggregator
 		*NewAggregator = *SourceAggregatorRef.Get();
 
-		// But restore the OnDirty delegate to point to our proxy ASC
+		// But restore the OnDirty delegate to point to our proxy ASC, and drop the source's dependents, which are its own aggregators.
+		// Ours are added by AddAggregatorDependencies once every aggregator has been copied
 		NewAggregator->OnDirty = OnDirtyDelegate;
+		NewAggregator->DependentAggregators.Reset();
 
 		TPair<FAggregatorRef, FAggregatorRef> SwappedPair;
 		SwappedPair.Key = SourceAggregatorRef;
@@ -4030,6 +4351,8 @@ void FActiveDNAEffectsContainer::CloneFrom(const FActiveDNAEffectsContainer& Sou
 		{
 			Effect.Spec.CapturedRelevantAttributes.SwapAggregator( SwapAgg.Key, SwapAgg.Value );
 		}
+
+		AddAggregatorDependencies(Effect);
 	}	
 
 	// Now go through our aggregator map and replace dependency references to the source's GEs with our GEs.
@@ -4060,32 +4383,80 @@ void FActiveDNAEffectsContainer::CloneFrom(const FActiveDNAEffectsContainer& Sou
 
 namespace GlobalActiveDNAEffectHandles
 {
-	static TMap<FActiveDNAEffectHandle, TWeakObjectPtr<UDNAAbilitySystemComponent>>	Map;
+	struct FSlot
+	{
+		FSlot()
+			: Generation(1)
+			, bInUse(false)
+		{
+		}
+
+		TWeakObjectPtr<UDNAAbilitySystemComponent> Owner;
+
+		/** Starts at one so handles constructed by hand with a zero generation never resolve */
+		int32 Generation;
+
+		bool bInUse;
+	};
+
+	static TArray<FSlot> Slots;
+	static TArray<int32> FreeSlots;
+
+	static FSlot* FindSlot(int32 SlotIdx, int32 Generation)
+	{
+		if (Slots.IsValidIndex(SlotIdx) && Slots[SlotIdx].bInUse && Slots[SlotIdx].Generation == Generation)
+		{
+			return &Slots[SlotIdx];
+		}
+		return nullptr;
+	}
+
+	static void FreeSlot(int32 SlotIdx)
+	{
+		FSlot& Slot = Slots[SlotIdx];
+		Slot.Owner.Reset();
+		Slot.bInUse = false;
+
+		// Skip the generations that would read as invalid handles when wrapping around
+		if (++Slot.Generation <= 0)
+		{
+			Slot.Generation = 1;
+		}
+
+		FreeSlots.Add(SlotIdx);
+	}
 }
 
 void FActiveDNAEffectHandle::ResetGlobalHandleMap()
 {
-	GlobalActiveDNAEffectHandles::Map.Reset();
+	for (int32 SlotIdx = 0; SlotIdx < GlobalActiveDNAEffectHandles::Slots.Num(); ++SlotIdx)
+	{
+		if (GlobalActiveDNAEffectHandles::Slots[SlotIdx].bInUse)
+		{
+			GlobalActiveDNAEffectHandles::FreeSlot(SlotIdx);
+		}
+	}
 }
 
 FActiveDNAEffectHandle FActiveDNAEffectHandle::GenerateNewHandle(UDNAAbilitySystemComponent* OwningComponent)
 {
-	static int32 GHandleID=0;
-	FActiveDNAEffectHandle NewHandle(GHandleID++);
+	check(IsInGameThread());
 
-	TWeakObjectPtr<UDNAAbilitySystemComponent> WeakPtr(OwningComponent);
+	const int32 SlotIdx = GlobalActiveDNAEffectHandles::FreeSlots.Num() > 0 ? GlobalActiveDNAEffectHandles::FreeSlots.Pop(false) : GlobalActiveDNAEffectHandles::Slots.AddDefaulted();
 
-	GlobalActiveDNAEffectHandles::Map.Add(NewHandle, WeakPtr);
+	GlobalActiveDNAEffectHandles::FSlot& Slot = GlobalActiveDNAEffectHandles::Slots[SlotIdx];
+	Slot.Owner = OwningComponent;
+	Slot.bInUse = true;
 
-	return NewHandle;
+	return FActiveDNAEffectHandle(SlotIdx, Slot.Generation);
 }
 
 UDNAAbilitySystemComponent* FActiveDNAEffectHandle::GetOwningDNAAbilitySystemComponent()
 {
-	TWeakObjectPtr<UDNAAbilitySystemComponent>* Ptr = GlobalActiveDNAEffectHandles::Map.Find(*this);
-	if (Ptr)
+	GlobalActiveDNAEffectHandles::FSlot* Slot = GlobalActiveDNAEffectHandles::FindSlot(Handle, Generation);
+	if (Slot)
 	{
-		return Ptr->Get();
+		return Slot->Owner.Get();
 	}
 
 	return nullptr;	
@@ -4093,10 +4464,10 @@ UDNAAbilitySystemComponent* FActiveDNAEffectHandle::GetOwningDNAAbilitySystemCom
 
 const UDNAAbilitySystemComponent* FActiveDNAEffectHandle::GetOwningDNAAbilitySystemComponent() const
 {
-	TWeakObjectPtr<UDNAAbilitySystemComponent>* Ptr = GlobalActiveDNAEffectHandles::Map.Find(*this);
-	if (Ptr)
+	GlobalActiveDNAEffectHandles::FSlot* Slot = GlobalActiveDNAEffectHandles::FindSlot(Handle, Generation);
+	if (Slot)
 	{
-		return Ptr->Get();
+		return Slot->Owner.Get();
 	}
 
 	return nullptr;
@@ -4104,7 +4475,10 @@ const UDNAAbilitySystemComponent* FActiveDNAEffectHandle::GetOwningDNAAbilitySys
 
 void FActiveDNAEffectHandle::RemoveFromGlobalMap()
 {
-	GlobalActiveDNAEffectHandles::Map.Remove(*this);
+	if (GlobalActiveDNAEffectHandles::FindSlot(Handle, Generation))
+	{
+		GlobalActiveDNAEffectHandles::FreeSlot(Handle);
+	}
 }
 
 // -----------------------------------------------------------------
@@ -4205,10 +4579,10 @@ bool FDNAEffectQuery::Matches(const FDNAEffectSpec& Spec) const
 
 	if (OwningTagQuery.IsEmpty() == false)
 	{
-		// Combine tags from the definition and the spec into one container to match queries that may span both
+		// Combine tags from the definition and the spec into one bit container to match queries that may span both
 		// static to avoid memory allocations every time we do a query
 		check(IsInGameThread());
-		static FDNATagContainer TargetTags;
+		static FDNATagBitContainer TargetTags;
 		TargetTags.Reset();
 		if (Spec.Def->InheritableDNAEffectTags.CombinedTags.Num() > 0)
 		{
@@ -4231,10 +4605,10 @@ bool FDNAEffectQuery::Matches(const FDNAEffectSpec& Spec) const
 
 	if (EffectTagQuery.IsEmpty() == false)
 	{
-		// Combine tags from the definition and the spec into one container to match queries that may span both
+		// Combine tags from the definition and the spec into one bit container to match queries that may span both
 		// static to avoid memory allocations every time we do a query
 		check(IsInGameThread());
-		static FDNATagContainer GETags;
+		static FDNATagBitContainer GETags;
 		GETags.Reset();
 		if (Spec.Def->InheritableDNAEffectTags.CombinedTags.Num() > 0)
 		{
@@ -4508,7 +4882,8 @@ void FActiveDNAEffectsContainer::DecrementLock()
 		{
 			if (!PendingDNAEffect->IsPendingRemove)
 			{
-				DNAEffects_Internal.Add(MoveTemp(*PendingDNAEffect));
+				const FActiveDNAEffectHandle PendingHandle = PendingDNAEffect->Handle;
+				HandleToIndexMap.Add(PendingHandle, DNAEffects_Internal.Add(MoveTemp(*PendingDNAEffect)));
 				ModifiedArray = true;
 			}
 			else
@@ -4531,7 +4906,7 @@ void FActiveDNAEffectsContainer::DecrementLock()
 			if (Effect.IsPendingRemove)
 			{
 				ABILITY_LOG(Verbose, TEXT("DecrementLock decrementing a pending remove: Auth: %s Handle: %s Def: %s"), IsNetAuthority() ? TEXT("TRUE") : TEXT("FALSE"), *Effect.Handle.ToString(), Effect.Spec.Def ? *Effect.Spec.Def->GetName() : TEXT("NONE"));
-				DNAEffects_Internal.RemoveAtSwap(idx, 1, false);
+				RemoveDNAEffectAtSwap(idx, false);
 				ModifiedArray = true;
 				PendingRemoves--;
 			}
@@ -5,11 +5,43 @@
 #include "UObject/UObjectHash.h"
 #include "UObject/UObjectIterator.h"
 #include "AbilitySystemComponent.h"
+#include "AbilitySystemStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("FScopedAggregatorOnDirtyBatch::FlushDirtyAggregators"), STAT_AggregatorFlushDirty, STATGROUP_DNAAbilitySystem);
+
+const FDNATagBitContainer& FAggregatorEvaluateParameters::GetSourceTagBits() const
+{
+	if (!bSourceTagBitsValid)
+	{
+		SourceTagBits.Reset();
+		if (SourceTags)
+		{
+			SourceTagBits.AppendTags(*SourceTags);
+		}
+		bSourceTagBitsValid = true;
+	}
+	return SourceTagBits;
+}
+
+const FDNATagBitContainer& FAggregatorEvaluateParameters::GetTargetTagBits() const
+{
+	if (!bTargetTagBitsValid)
+	{
+		TargetTagBits.Reset();
+		if (TargetTags)
+		{
+			TargetTagBits.AppendTags(*TargetTags);
+		}
+		bTargetTagBitsValid = true;
+	}
+	return TargetTagBits;
+}
 
 bool FAggregatorMod::Qualifies(const FAggregatorEvaluateParameters& Parameters) const
 {
-	bool bSourceMet = (!SourceTagReqs || SourceTagReqs->IsEmpty()) || (Parameters.SourceTags && SourceTagReqs->RequirementsMet(*Parameters.SourceTags));
-	bool bTargetMet = (!TargetTagReqs || TargetTagReqs->IsEmpty()) || (Parameters.TargetTags && TargetTagReqs->RequirementsMet(*Parameters.TargetTags));
+	// Requirements are matched against bitsets of the evaluation tags, which are built once per evaluation and shared by every mod
+	bool bSourceMet = (!SourceTagReqs || SourceTagReqs->IsEmpty()) || (Parameters.SourceTags && SourceTagReqs->RequirementsMet(Parameters.GetSourceTagBits()));
+	bool bTargetMet = (!TargetTagReqs || TargetTagReqs->IsEmpty()) || (Parameters.TargetTags && TargetTagReqs->RequirementsMet(Parameters.GetTargetTagBits()));
 
 	bool bSourceFilterMet = (Parameters.AppliedSourceTagFilter.Num() == 0);
 	bool bTargetFilterMet = (Parameters.AppliedTargetTagFilter.Num() == 0);
@@ -51,6 +83,8 @@ bool FAggregatorMod::Qualifies(const FAggregatorEvaluateParameters& Parameters)
 
 float FAggregatorModChannel::EvaluateWithBase(float InlineBaseValue, const FAggregatorEvaluateParameters& Parameters) const
 {
+	Parameters.ResetTagBits();
+
 	for (const FAggregatorMod& Mod : Mods[EDNAModOp::Override])
 	{
 		if (Mod.Qualifies(Parameters))
@@ -59,9 +93,10 @@ float FAggregatorModChannel::EvaluateWithBase(float InlineBaseValue, const FAggr
 		}
 	}
 
-	float Additive = SumMods(Mods[EDNAModOp::Additive], DNAEffectUtilities::GetModifierBiasByModifierOp(EDNAModOp::Additive), Parameters);
-	float Multiplicitive = SumMods(Mods[EDNAModOp::Multiplicitive], DNAEffectUtilities::GetModifierBiasByModifierOp(EDNAModOp::Multiplicitive), Parameters);
-	float Division = SumMods(Mods[EDNAModOp::Division], DNAEffectUtilities::GetModifierBiasByModifierOp(EDNAModOp::Division), Parameters);
+	float Additive = 0.f;
+	float Multiplicitive = 0.f;
+	float Division = 0.f;
+	SumNumericMods(Parameters, Additive, Multiplicitive, Division);
 
 	if (FMath::IsNearlyZero(Division))
 	{
@@ -74,6 +109,8 @@ float FAggregatorModChannel::EvaluateWithBase(float InlineBaseValue, const FAggr
 
 bool FAggregatorModChannel::ReverseEvaluate(float FinalValue, const FAggregatorEvaluateParameters& Parameters, OUT float& ComputedValue) const
 {
+	Parameters.ResetTagBits();
+
 	for (const FAggregatorMod& Mod : Mods[EDNAModOp::Override])
 	{
 		if (Mod.Qualifies(Parameters))
@@ -84,9 +121,10 @@ bool FAggregatorModChannel::ReverseEvaluate(float FinalValue, const FAggregatorE
 		}
 	}
 
-	float Additive = SumMods(Mods[EDNAModOp::Additive], DNAEffectUtilities::GetModifierBiasByModifierOp(EDNAModOp::Additive), Parameters);
-	float Multiplicitive = SumMods(Mods[EDNAModOp::Multiplicitive], DNAEffectUtilities::GetModifierBiasByModifierOp(EDNAModOp::Multiplicitive), Parameters);
-	float Division = SumMods(Mods[EDNAModOp::Division], DNAEffectUtilities::GetModifierBiasByModifierOp(EDNAModOp::Division), Parameters);
+	float Additive = 0.f;
+	float Multiplicitive = 0.f;
+	float Division = 0.f;
+	SumNumericMods(Parameters, Additive, Multiplicitive, Division);
 
 	if (FMath::IsNearlyZero(Division))
 	{
@@ -117,6 +155,8 @@ void FAggregatorModChannel::AddMod(float EvaluatedMagnitude, TEnumAsByte<EDNAMod
 	NewMod.StackCount = 0;
 	NewMod.ActiveHandle = ActiveHandle;
 	NewMod.IsPredicted = bIsPredicted;
+
+	bModGroupsDirty = true;
 }
 
 void FAggregatorModChannel::RemoveModsWithActiveHandle(const FActiveDNAEffectHandle& Handle)
@@ -131,6 +171,8 @@ void FAggregatorModChannel::RemoveModsWithActiveHandle(const FActiveDNAEffectHan
 		}, 
 		false);
 	}
+
+	bModGroupsDirty = true;
 }
 
 void FAggregatorModChannel::AddModsFrom(const FAggregatorModChannel& Other)
@@ -139,6 +181,8 @@ void FAggregatorModChannel::AddModsFrom(const FAggregatorModChannel& Other)
 	{
 		Mods[ModOpIdx].Append(Other.Mods[ModOpIdx]);
 	}
+
+	bModGroupsDirty = true;
 }
 
 void FAggregatorModChannel::DebugGetAllAggregatorMods(EDNAModEvaluationChannel Channel, OUT TMap<EDNAModEvaluationChannel, const TArray<FAggregatorMod>*>& OutMods) const
@@ -176,32 +220,229 @@ float FAggregatorModChannel::SumMods(const TArray<FAggregatorMod>& InMods, float
 	return Sum;
 }
 
+namespace AggregatorModGroups
+{
+	/** Requirements that test nothing group with no requirements */
+	static const FDNATagRequirements* GetGroupRequirements(const FDNATagRequirements* TagReqs)
+	{
+		return (TagReqs && !TagReqs->IsEmpty()) ? TagReqs : nullptr;
+	}
+
+	static bool IsUnconditional(const FAggregatorMod& Mod)
+	{
+		return !Mod.IsPredicted && !GetGroupRequirements(Mod.SourceTagReqs) && !GetGroupRequirements(Mod.TargetTagReqs);
+	}
+
+	/** Orders mods so that mods with the same requirements and prediction are next to each other */
+	static bool GroupLess(const FAggregatorMod& A, const FAggregatorMod& B)
+	{
+		const UPTRINT SourceA = (UPTRINT)GetGroupRequirements(A.SourceTagReqs);
+		const UPTRINT SourceB = (UPTRINT)GetGroupRequirements(B.SourceTagReqs);
+		if (SourceA != SourceB)
+		{
+			return SourceA < SourceB;
+		}
+
+		const UPTRINT TargetA = (UPTRINT)GetGroupRequirements(A.TargetTagReqs);
+		const UPTRINT TargetB = (UPTRINT)GetGroupRequirements(B.TargetTagReqs);
+		if (TargetA != TargetB)
+		{
+			return TargetA < TargetB;
+		}
+
+		return A.IsPredicted < B.IsPredicted;
+	}
+
+	/** Sums a contiguous run of magnitudes four lanes at a time */
+	static float SumMagnitudes(const float* Magnitudes, int32 NumMagnitudes)
+	{
+		VectorRegister VectorSum = VectorZero();
+		int32 MagnitudeIdx = 0;
+		for (; MagnitudeIdx + 4 <= NumMagnitudes; MagnitudeIdx += 4)
+		{
+			VectorSum = VectorAdd(VectorSum, VectorLoad(Magnitudes + MagnitudeIdx));
+		}
+
+		MS_ALIGN(16) float Lanes[4] GCC_ALIGN(16);
+		VectorStoreAligned(VectorSum, Lanes);
+
+		float Sum = (Lanes[0] + Lanes[1]) + (Lanes[2] + Lanes[3]);
+		for (; MagnitudeIdx < NumMagnitudes; ++MagnitudeIdx)
+		{
+			Sum += Magnitudes[MagnitudeIdx];
+		}
+		return Sum;
+	}
+}
+
+bool FAggregatorModChannel::FModGroup::Qualifies(const FAggregatorEvaluateParameters& Parameters) const
+{
+	// The same tests as FAggregatorMod::Qualifies, without the handle based ones the grouped view is not used for
+	if (Parameters.IncludePredictiveMods == false && bIsPredicted)
+	{
+		return false;
+	}
+
+	const bool bSourceMet = !SourceTagReqs || (Parameters.SourceTags && SourceTagReqs->RequirementsMet(Parameters.GetSourceTagBits()));
+	const bool bTargetMet = !TargetTagReqs || (Parameters.TargetTags && TargetTagReqs->RequirementsMet(Parameters.GetTargetTagBits()));
+	return bSourceMet && bTargetMet;
+}
+
+void FAggregatorModChannel::UpdateModGroups() const
+{
+	if (!bModGroupsDirty)
+	{
+		return;
+	}
+	bModGroupsDirty = false;
+
+	// Magnitudes are gathered into one flat array per group, in group order, to be summed with vector adds
+	TArray<float, TInlineAllocator<64>> Magnitudes;
+	TArray<int32, TInlineAllocator<64>> ConditionalModIndices;
+
+	for (int32 ModOpIdx = 0; ModOpIdx < EDNAModOp::Override; ++ModOpIdx)
+	{
+		const TArray<FAggregatorMod>& ModList = Mods[ModOpIdx];
+		const float Bias = DNAEffectUtilities::GetModifierBiasByModifierOp(static_cast<EDNAModOp::Type>(ModOpIdx));
+		FModOpGroups& Groups = ModGroups[ModOpIdx];
+
+		Magnitudes.Reset();
+		ConditionalModIndices.Reset();
+		for (int32 ModIdx = 0; ModIdx < ModList.Num(); ++ModIdx)
+		{
+			if (AggregatorModGroups::IsUnconditional(ModList[ModIdx]))
+			{
+				Magnitudes.Add(ModList[ModIdx].EvaluatedMagnitude - Bias);
+			}
+			else
+			{
+				ConditionalModIndices.Add(ModIdx);
+			}
+		}
+		Groups.UnconditionalSum = AggregatorModGroups::SumMagnitudes(Magnitudes.GetData(), Magnitudes.Num());
+
+		ConditionalModIndices.Sort([&ModList](int32 A, int32 B)
+		{
+			return AggregatorModGroups::GroupLess(ModList[A], ModList[B]);
+		});
+
+		Groups.ConditionalGroups.Reset();
+		for (int32 RunStart = 0; RunStart < ConditionalModIndices.Num(); )
+		{
+			const FAggregatorMod& FirstMod = ModList[ConditionalModIndices[RunStart]];
+
+			Magnitudes.Reset();
+			int32 RunEnd = RunStart;
+			for (; RunEnd < ConditionalModIndices.Num(); ++RunEnd)
+			{
+				const FAggregatorMod& Mod = ModList[ConditionalModIndices[RunEnd]];
+				if (AggregatorModGroups::GroupLess(FirstMod, Mod))
+				{
+					break;
+				}
+				Magnitudes.Add(Mod.EvaluatedMagnitude - Bias);
+			}
+
+			FModGroup& Group = Groups.ConditionalGroups[Groups.ConditionalGroups.AddUninitialized()];
+			Group.SourceTagReqs = AggregatorModGroups::GetGroupRequirements(FirstMod.SourceTagReqs);
+			Group.TargetTagReqs = AggregatorModGroups::GetGroupRequirements(FirstMod.TargetTagReqs);
+			Group.bIsPredicted = FirstMod.IsPredicted;
+			Group.Sum = AggregatorModGroups::SumMagnitudes(Magnitudes.GetData(), Magnitudes.Num());
+
+			RunStart = RunEnd;
+		}
+	}
+}
+
+void FAggregatorModChannel::SumNumericMods(const FAggregatorEvaluateParameters& Parameters, OUT float& OutAdditive, OUT float& OutMultiplicitive, OUT float& OutDivision) const
+{
+	float* OutSums[EDNAModOp::Override] = { &OutAdditive, &OutMultiplicitive, &OutDivision };
+
+	// Ignored handles and applied tag filters are per effect, so they need every mod
+	const bool bUseModGroups = Parameters.IgnoreHandles.Num() == 0 && Parameters.AppliedSourceTagFilter.Num() == 0 && Parameters.AppliedTargetTagFilter.Num() == 0;
+	if (!bUseModGroups)
+	{
+		for (int32 ModOpIdx = 0; ModOpIdx < EDNAModOp::Override; ++ModOpIdx)
+		{
+			*OutSums[ModOpIdx] = SumMods(Mods[ModOpIdx], DNAEffectUtilities::GetModifierBiasByModifierOp(static_cast<EDNAModOp::Type>(ModOpIdx)), Parameters);
+		}
+		return;
+	}
+
+	UpdateModGroups();
+
+	for (int32 ModOpIdx = 0; ModOpIdx < EDNAModOp::Override; ++ModOpIdx)
+	{
+		const FModOpGroups& Groups = ModGroups[ModOpIdx];
+
+		float Sum = DNAEffectUtilities::GetModifierBiasByModifierOp(static_cast<EDNAModOp::Type>(ModOpIdx)) + Groups.UnconditionalSum;
+		for (const FModGroup& Group : Groups.ConditionalGroups)
+		{
+			if (Group.Qualifies(Parameters))
+			{
+				Sum += Group.Sum;
+			}
+		}
+		*OutSums[ModOpIdx] = Sum;
+	}
+}
+
+void FAggregatorModChannel::GetTagRequirementUsage(OUT bool& bOutUsesSourceTags, OUT bool& bOutUsesTargetTags) const
+{
+	for (int32 ModOpIdx = 0; ModOpIdx < ARRAY_COUNT(Mods); ++ModOpIdx)
+	{
+		for (const FAggregatorMod& Mod : Mods[ModOpIdx])
+		{
+			bOutUsesSourceTags |= (Mod.SourceTagReqs && !Mod.SourceTagReqs->IsEmpty());
+			bOutUsesTargetTags |= (Mod.TargetTagReqs && !Mod.TargetTagReqs->IsEmpty());
+		}
+	}
+}
+
+FAggregatorModChannelContainer::FAggregatorModChannelContainer()
+{
+	for (int8& Slot : ModChannelSlots)
+	{
+		Slot = INDEX_NONE;
+	}
+}
+
 FAggregatorModChannel& FAggregatorModChannelContainer::FindOrAddModChannel(EDNAModEvaluationChannel Channel)
 {
-	FAggregatorModChannel* FoundChannel = ModChannelsMap.Find(Channel);
-	if (!FoundChannel)
+	const int32 ChannelIntVal = static_cast<int32>(Channel);
+	check(ChannelIntVal >= 0 && ChannelIntVal < ARRAY_COUNT(ModChannelSlots));
+
+	if (ModChannelSlots[ChannelIntVal] == INDEX_NONE)
 	{
-		// Adding a new channel, need to resort the map to preserve key order for evaluation
-		ModChannelsMap.Add(Channel);
-		ModChannelsMap.KeySort(TLess<EDNAModEvaluationChannel>());
-		FoundChannel = ModChannelsMap.Find(Channel);
+		// Adding a new channel, insert it in key order for evaluation and move the slots of the channels after it
+		int32 InsertIdx = 0;
+		while (InsertIdx < ModChannelEnums.Num() && ModChannelEnums[InsertIdx] < Channel)
+		{
+			++InsertIdx;
+		}
+
+		ModChannels.Insert(FAggregatorModChannel(), InsertIdx);
+		ModChannelEnums.Insert(Channel, InsertIdx);
+		for (int32 ModChannelIdx = InsertIdx; ModChannelIdx < ModChannelEnums.Num(); ++ModChannelIdx)
+		{
+			ModChannelSlots[static_cast<int32>(ModChannelEnums[ModChannelIdx])] = static_cast<int8>(ModChannelIdx);
+		}
 	}
-	check(FoundChannel);
-	return *FoundChannel;
+
+	return ModChannels[ModChannelSlots[ChannelIntVal]];
 }
 
 int32 FAggregatorModChannelContainer::GetNumChannels() const
 {
-	return ModChannelsMap.Num();
+	return ModChannels.Num();
 }
 
 float FAggregatorModChannelContainer::EvaluateWithBase(float InlineBaseValue, const FAggregatorEvaluateParameters& Parameters) const
 {
 	float ComputedValue = InlineBaseValue;
 
-	for (auto& ChannelEntry : ModChannelsMap)
+	for (const FAggregatorModChannel& CurChannel : ModChannels)
 	{
-		const FAggregatorModChannel& CurChannel = ChannelEntry.Value;
 		ComputedValue = CurChannel.EvaluateWithBase(ComputedValue, Parameters);
 	}
 
@@ -213,13 +454,12 @@ float FAggregatorModChannelContainer::EvaluateWithBaseToChannel(float InlineBase
 	float ComputedValue = InlineBaseValue;
 
 	const int32 FinalChannelIntVal = static_cast<int32>(FinalChannel);
-	for (auto& ChannelEntry : ModChannelsMap)
+	for (int32 ModChannelIdx = 0; ModChannelIdx < ModChannels.Num(); ++ModChannelIdx)
 	{
-		const int32 CurChannelIntVal = static_cast<int32>(ChannelEntry.Key);
+		const int32 CurChannelIntVal = static_cast<int32>(ModChannelEnums[ModChannelIdx]);
 		if (CurChannelIntVal <= FinalChannelIntVal)
 		{
-			const FAggregatorModChannel& CurChannel = ChannelEntry.Value;
-			ComputedValue = CurChannel.EvaluateWithBase(ComputedValue, Parameters);
+			ComputedValue = ModChannels[ModChannelIdx].EvaluateWithBase(ComputedValue, Parameters);
 		}
 		else
 		{
@@ -234,19 +474,13 @@ float FAggregatorModChannelContainer::ReverseEvaluate(float FinalValue, const FA
 {
 	float ComputedValue = FinalValue;
 
-	// TMap API doesn't allow reverse iteration, so need to request the key array and then
-	// traverse it in reverse instead
-	TArray<EDNAModEvaluationChannel> ChannelArray;
-	ModChannelsMap.GenerateKeyArray(ChannelArray);
-
-	for (int32 ModChannelIdx = ChannelArray.Num() - 1; ModChannelIdx >= 0; --ModChannelIdx)
+	for (int32 ModChannelIdx = ModChannels.Num() - 1; ModChannelIdx >= 0; --ModChannelIdx)
 	{
-		const FAggregatorModChannel& Channel = ModChannelsMap.FindRef(ChannelArray[ModChannelIdx]);
-		 if (!Channel.ReverseEvaluate(ComputedValue, Parameters, ComputedValue))
-		 {
-			 ComputedValue = FinalValue;
-			 break;
-		 }
+		if (!ModChannels[ModChannelIdx].ReverseEvaluate(ComputedValue, Parameters, ComputedValue))
+		{
+			ComputedValue = FinalValue;
+			break;
+		}
 	}
 
 	return ComputedValue;
@@ -256,9 +490,8 @@ void FAggregatorModChannelContainer::RemoveAggregatorMod(const FActiveDNAEffectH
 {
 	if (ActiveHandle.IsValid())
 	{
-		for (auto& ChannelEntry : ModChannelsMap)
+		for (FAggregatorModChannel& CurChannel : ModChannels)
 		{
-			FAggregatorModChannel& CurChannel = ChannelEntry.Value;
 			CurChannel.RemoveModsWithActiveHandle(ActiveHandle);
 		}
 	}
@@ -266,45 +499,154 @@ void FAggregatorModChannelContainer::RemoveAggregatorMod(const FActiveDNAEffectH
 
 void FAggregatorModChannelContainer::AddModsFrom(const FAggregatorModChannelContainer& Other)
 {
-	for (const auto& SourceChannelEntry : Other.ModChannelsMap)
+	for (int32 SourceChannelIdx = 0; SourceChannelIdx < Other.ModChannels.Num(); ++SourceChannelIdx)
 	{
-		EDNAModEvaluationChannel SourceChannelEnum = SourceChannelEntry.Key;
-		const FAggregatorModChannel& SourceChannel = SourceChannelEntry.Value;
-
-		FAggregatorModChannel& TargetChannel = FindOrAddModChannel(SourceChannelEnum);
-		TargetChannel.AddModsFrom(SourceChannel);
+		FAggregatorModChannel& TargetChannel = FindOrAddModChannel(Other.ModChannelEnums[SourceChannelIdx]);
+		TargetChannel.AddModsFrom(Other.ModChannels[SourceChannelIdx]);
 	}
 }
 
 void FAggregatorModChannelContainer::DebugGetAllAggregatorMods(OUT TMap<EDNAModEvaluationChannel, const TArray<FAggregatorMod>*>& OutMods) const
 {
-	for (const auto& ChannelEntry : ModChannelsMap)
+	for (int32 ModChannelIdx = 0; ModChannelIdx < ModChannels.Num(); ++ModChannelIdx)
 	{
-		EDNAModEvaluationChannel CurChannelEnum = ChannelEntry.Key;
-		const FAggregatorModChannel& CurChannel = ChannelEntry.Value;
-		
-		CurChannel.DebugGetAllAggregatorMods(CurChannelEnum, OutMods);
+		ModChannels[ModChannelIdx].DebugGetAllAggregatorMods(ModChannelEnums[ModChannelIdx], OutMods);
 	}
 }
 
 void FAggregatorModChannelContainer::OnActiveEffectDependenciesSwapped(const TMap<FActiveDNAEffectHandle, FActiveDNAEffectHandle>& SwappedDependencies)
 {
-	for (auto& ChannelEntry : ModChannelsMap)
+	for (FAggregatorModChannel& CurChannel : ModChannels)
 	{
-		FAggregatorModChannel& CurChannel = ChannelEntry.Value;
 		CurChannel.OnActiveEffectDependenciesSwapped(SwappedDependencies);
 	}
 }
 
+void FAggregatorModChannelContainer::GetTagRequirementUsage(OUT bool& bOutUsesSourceTags, OUT bool& bOutUsesTargetTags) const
+{
+	bOutUsesSourceTags = false;
+	bOutUsesTargetTags = false;
+	for (const FAggregatorModChannel& CurChannel : ModChannels)
+	{
+		CurChannel.GetTagRequirementUsage(bOutUsesSourceTags, bOutUsesTargetTags);
+	}
+}
+
 FAggregator::~FAggregator()
 {
-	int32 NumRemoved = FScopedAggregatorOnDirtyBatch::DirtyAggregators.Remove(this);
-	ensure(NumRemoved == 0);
+	// Callbacks of a flush in progress can destroy aggregators it has queued or already recomputed, that is expected. Outside of a flush nothing should
+	const bool bFlushing = FScopedAggregatorOnDirtyBatch::PendingAggregatorSet.Num() > 0 || FScopedAggregatorOnDirtyBatch::RecomputedAggregators.Num() > 0;
+	ensure(bFlushing || !FScopedAggregatorOnDirtyBatch::DirtyAggregators.Contains(this));
+
+	FScopedAggregatorOnDirtyBatch::RemoveDestroyedAggregator(this);
 }
 
 float FAggregator::Evaluate(const FAggregatorEvaluateParameters& Parameters) const
 {
-	return ModChannels.EvaluateWithBase(BaseValue, Parameters);
+	SCOPE_CYCLE_COUNTER(STAT_AggregatorEvaluate);
+
+	// Ignored handles and applied tag filters depend on the state of other effects, which we are not told about
+	const bool bCacheable = Parameters.IgnoreHandles.Num() == 0 && Parameters.AppliedSourceTagFilter.Num() == 0 && Parameters.AppliedTargetTagFilter.Num() == 0;
+	if (!bCacheable)
+	{
+		return ModChannels.EvaluateWithBase(BaseValue, Parameters);
+	}
+
+	float Value = 0.f;
+	if (FindCachedEvaluation(Parameters, Value))
+	{
+		INC_DWORD_STAT(STAT_AggregatorEvaluateCacheHits);
+		return Value;
+	}
+
+	INC_DWORD_STAT(STAT_AggregatorEvaluateCacheMisses);
+	Value = ModChannels.EvaluateWithBase(BaseValue, Parameters);
+	AddCachedEvaluation(Parameters, Value);
+	return Value;
+}
+
+namespace AggregatorEvaluationCache
+{
+	static bool TagsMatch(const FDNATagContainer& CachedTags, const FDNATagContainer& Tags)
+	{
+		if (CachedTags.Num() != Tags.Num())
+		{
+			return false;
+		}
+
+		// The same caller usually passes the same tags in the same order, only compare as sets when that fails
+		for (int32 TagIdx = 0; TagIdx < Tags.Num(); ++TagIdx)
+		{
+			if (CachedTags.GetByIndex(TagIdx) != Tags.GetByIndex(TagIdx))
+			{
+				return CachedTags == Tags;
+			}
+		}
+		return true;
+	}
+
+	static bool EvaluationTagsMatch(bool bModsUseTags, bool bCachedHasTags, const FDNATagContainer& CachedTags, const FDNATagContainer* Tags)
+	{
+		if (!bModsUseTags)
+		{
+			return true;
+		}
+
+		if (bCachedHasTags != (Tags != nullptr))
+		{
+			return false;
+		}
+
+		return Tags == nullptr || TagsMatch(CachedTags, *Tags);
+	}
+}
+
+void FAggregator::InvalidateEvaluationCache()
+{
+	CachedEvaluations.Reset();
+	NextCachedEvaluation = 0;
+	bTagRequirementUsageValid = false;
+}
+
+bool FAggregator::FindCachedEvaluation(const FAggregatorEvaluateParameters& Parameters, float& OutValue) const
+{
+	if (!bTagRequirementUsageValid)
+	{
+		ModChannels.GetTagRequirementUsage(bModsUseSourceTags, bModsUseTargetTags);
+		bTagRequirementUsageValid = true;
+	}
+
+	for (const FCachedEvaluation& Cached : CachedEvaluations)
+	{
+		if (Cached.bIncludePredictiveMods == Parameters.IncludePredictiveMods &&
+			AggregatorEvaluationCache::EvaluationTagsMatch(bModsUseSourceTags, Cached.bHasSourceTags, Cached.SourceTags, Parameters.SourceTags) &&
+			AggregatorEvaluationCache::EvaluationTagsMatch(bModsUseTargetTags, Cached.bHasTargetTags, Cached.TargetTags, Parameters.TargetTags))
+		{
+			OutValue = Cached.Value;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void FAggregator::AddCachedEvaluation(const FAggregatorEvaluateParameters& Parameters, float Value) const
+{
+	if (CachedEvaluations.Num() < MaxCachedEvaluations)
+	{
+		CachedEvaluations.AddDefaulted();
+	}
+
+	FCachedEvaluation& Cached = CachedEvaluations[NextCachedEvaluation];
+	NextCachedEvaluation = (NextCachedEvaluation + 1) % MaxCachedEvaluations;
+
+	// Only the tags the mods test are part of the key
+	Cached.bHasSourceTags = bModsUseSourceTags && Parameters.SourceTags;
+	Cached.bHasTargetTags = bModsUseTargetTags && Parameters.TargetTags;
+	Cached.SourceTags = Cached.bHasSourceTags ? *Parameters.SourceTags : FDNATagContainer::EmptyContainer;
+	Cached.TargetTags = Cached.bHasTargetTags ? *Parameters.TargetTags : FDNATagContainer::EmptyContainer;
+	Cached.bIncludePredictiveMods = Parameters.IncludePredictiveMods;
+	Cached.Value = Value;
 }
 
 float FAggregator::EvaluateToChannel(const FAggregatorEvaluateParameters& Parameters, EDNAModEvaluationChannel FinalChannel) const
@@ -348,6 +690,7 @@ float FAggregator::GetBaseValue() const
 void FAggregator::SetBaseValue(float NewBaseValue, bool BroadcastDirtyEvent)
 {
 	BaseValue = NewBaseValue;
+	InvalidateEvaluationCache();
 	if (BroadcastDirtyEvent)
 	{
 		BroadcastOnDirty();
@@ -389,6 +732,7 @@ float FAggregator::StaticExecModOnBaseValue(float BaseValue, TEnumAsByte<EDNAMod
 void FAggregator::ExecModOnBaseValue(TEnumAsByte<EDNAModOp::Type> ModifierOp, float EvaluatedMagnitude)
 {
 	BaseValue = StaticExecModOnBaseValue(BaseValue, ModifierOp, EvaluatedMagnitude);
+	InvalidateEvaluationCache();
 	BroadcastOnDirty();
 }
 
@@ -396,6 +740,7 @@ void FAggregator::AddAggregatorMod(float EvaluatedMagnitude, TEnumAsByte<EDNAMod
 {
 	FAggregatorModChannel& ModChannelToAddTo = ModChannels.FindOrAddModChannel(ModifierChannel);
 	ModChannelToAddTo.AddMod(EvaluatedMagnitude, ModifierOp, SourceTagReqs, TargetTagReqs, IsPredicted, ActiveHandle);
+	InvalidateEvaluationCache();
 
 	BroadcastOnDirty();
 }
@@ -403,6 +748,7 @@ void FAggregator::AddAggregatorMod(float EvaluatedMagnitude, TEnumAsByte<EDNAMod
 void FAggregator::RemoveAggregatorMod(FActiveDNAEffectHandle ActiveHandle)
 {
 	ModChannels.RemoveAggregatorMod(ActiveHandle);
+	InvalidateEvaluationCache();
 
 	// mark it as dirty so that all the stats get updated
 	BroadcastOnDirty();
@@ -423,6 +769,7 @@ void FAggregator::UpdateAggregatorMod(FActiveDNAEffectHandle ActiveHandle, const
 			ModChannel.AddMod(Spec.GetModifierMagnitude(ModIdx, true), ModDef.ModifierOp, &ModDef.SourceTags, &ModDef.TargetTags, bWasLocallyGenerated, InHandle);
 		}
 	}
+	InvalidateEvaluationCache();
 
 	// mark it as dirty so that all the stats get updated
 	BroadcastOnDirty();
@@ -432,6 +779,7 @@ void FAggregator::AddModsFrom(const FAggregator& SourceAggregator)
 {
 	// @todo: should this broadcast dirty?
 	ModChannels.AddModsFrom(SourceAggregator.ModChannels);
+	InvalidateEvaluationCache();
 }
 
 void FAggregator::AddDependent(FActiveDNAEffectHandle Handle)
@@ -477,42 +825,51 @@ void FAggregator::OnActiveEffectDependenciesSwapped(const TMap<FActiveDNAEffectH
 
 		ModChannels.OnActiveEffectDependenciesSwapped(SwappedDependencies);
 	}
+
+	InvalidateEvaluationCache();
 }
 
 void FAggregator::TakeSnapshotOf(const FAggregator& AggToSnapshot)
 {
 	BaseValue = AggToSnapshot.BaseValue;
 	ModChannels = AggToSnapshot.ModChannels;
+	InvalidateEvaluationCache();
 }
 
 void FAggregator::BroadcastOnDirty()
 {
-	// If we are batching on Dirty calls (and we actually have dependents registered with us) then early out.
-	if (FScopedAggregatorOnDirtyBatch::GlobalBatchCount > 0 && (Dependents.Num() > 0 || OnDirty.IsBound()))
+	if (Dependents.Num() == 0 && !OnDirty.IsBound())
 	{
-		FScopedAggregatorOnDirtyBatch::DirtyAggregators.Add(this);
 		return;
 	}
 
 	if (bIsBroadcastingDirty)
 	{
-		// Apologies for the vague warning but its very hard from this spot to call out what data has caused this. If this frequently happens we should improve this.
-		ABILITY_LOG(Warning, TEXT("FAggregator detected cyclic attribute dependencies. We are skipping a recursive dirty call. Its possible the resulting attribute values are not what you expect!"));
+		ReportCyclicBroadcast();
+		return;
+	}
 
-#if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
-		// Additional, slow, debugging that will print all aggregator/attributes that are currently dirty
-		for (TObjectIterator<UDNAAbilitySystemComponent> It; It; ++It)
-		{
-			It->DebugCyclicAggregatorBroadcasts(this);
-		}
-#endif
+	// Dirtied through a dependency after it was recomputed. If the notifying aggregator depends on this one, that dependency closes a cycle, which
+	// FAggregatorDependencyGraph refused when the effect was applied. Otherwise the graph missed a dependency, and recomputing again is still correct
+	FAggregator* NotifyingAggregator = FScopedAggregatorOnDirtyBatch::NotifyingAggregator;
+	if (NotifyingAggregator && FScopedAggregatorOnDirtyBatch::RecomputedAggregators.Contains(this) && FAggregatorDependencyGraph::DependsOn(*NotifyingAggregator, *this))
+	{
+		ReportCyclicBroadcast();
 		return;
 	}
 
+	// Recomputed in dependency order when the outermost batch ends, which is right away if there is no other
+	FScopedAggregatorOnDirtyBatch AggregatorOnDirtyBatcher;
+	FScopedAggregatorOnDirtyBatch::DirtyAggregators.Add(this);
+}
+
+void FAggregator::BroadcastOnDirtyNow()
+{
 	TGuardValue<bool> Guard(bIsBroadcastingDirty, true);
 	
 	OnDirty.Broadcast(this);
 
+	TGuardValue<FAggregator*> NotifyingGuard(FScopedAggregatorOnDirtyBatch::NotifyingAggregator, this);
 
 	static TArray<FActiveDNAEffectHandle> ValidDependents;
 	ValidDependents.Reset();
@@ -527,7 +884,169 @@ void FAggregator::BroadcastOnDirty()
 		}
 	}
 	Dependents = ValidDependents;
+}
+
+void FAggregator::ReportCyclicBroadcast()
+{
+	// Apologies for the vague warning but its very hard from this spot to call out what data has caused this. If this frequently happens we should improve this.
+	ABILITY_LOG(Warning, TEXT("FAggregator detected cyclic attribute dependencies. We are skipping a recursive dirty call. Its possible the resulting attribute values are not what you expect!"));
+
+#if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
+	// Additional, slow, debugging that will print all aggregator/attributes that are currently dirty
+	for (TObjectIterator<UDNAAbilitySystemComponent> It; It; ++It)
+	{
+		It->DebugCyclicAggregatorBroadcasts(this);
+	}
+#endif
+}
+
+FAggregatorDependencyGraph::~FAggregatorDependencyGraph()
+{
+	Reset();
+}
+
+bool FAggregatorDependencyGraph::AddDependency(FActiveDNAEffectHandle Handle, const FAggregatorRef& From, const FAggregatorRef& To)
+{
+	FAggregator* FromAggregator = From.Get();
+	FAggregator* ToAggregator = To.Get();
+	if (!FromAggregator || !ToAggregator)
+	{
+		return true;
+	}
+
+	if (DependsOn(*FromAggregator, *ToAggregator))
+	{
+		return false;
+	}
+
+	FromAggregator->DependentAggregators.Add(To.Data);
+	RaiseRank(*ToAggregator, FromAggregator->DependencyRank + 1);
+
+	FDependency Dependency;
+	Dependency.From = From.Data;
+	Dependency.To = To.Data;
+	EffectDependencies.FindOrAdd(Handle).Add(Dependency);
+	return true;
+}
+
+void FAggregatorDependencyGraph::RemoveDependencies(FActiveDNAEffectHandle Handle)
+{
+	// Ranks are left as they are, they are still above the ranks of everything each aggregator depends on
+	TArray<FDependency> Dependencies;
+	if (EffectDependencies.RemoveAndCopyValue(Handle, Dependencies))
+	{
+		for (const FDependency& Dependency : Dependencies)
+		{
+			RemoveDependency(Dependency);
+		}
+	}
+}
+
+void FAggregatorDependencyGraph::Reset()
+{
+	for (const auto& EffectEntry : EffectDependencies)
+	{
+		for (const FDependency& Dependency : EffectEntry.Value)
+		{
+			RemoveDependency(Dependency);
+		}
+	}
+	EffectDependencies.Reset();
+}
+
+int32 FAggregatorDependencyGraph::Num() const
+{
+	int32 NumDependencies = 0;
+	for (const auto& EffectEntry : EffectDependencies)
+	{
+		NumDependencies += EffectEntry.Value.Num();
+	}
+	return NumDependencies;
+}
+
+bool FAggregatorDependencyGraph::DependsOn(const FAggregator& To, const FAggregator& From)
+{
+	if (&To == &From)
+	{
+		return true;
+	}
+
+	// Ranks rise along every dependency, so only aggregators ranked below To can lead to it
+	if (From.DependencyRank >= To.DependencyRank)
+	{
+		return false;
+	}
+
+	TArray<const FAggregator*, TInlineAllocator<16>> Stack;
+	TSet<const FAggregator*> Visited;
+	Stack.Add(&From);
+	while (Stack.Num() > 0)
+	{
+		const FAggregator* Current = Stack.Pop(false);
+		for (const TWeakPtr<FAggregator>& WeakDependent : Current->DependentAggregators)
+		{
+			const FAggregator* Dependent = WeakDependent.Pin().Get();
+			if (Dependent == &To)
+			{
+				return true;
+			}
 
+			if (Dependent && Dependent->DependencyRank < To.DependencyRank && !Visited.Contains(Dependent))
+			{
+				Visited.Add(Dependent);
+				Stack.Add(Dependent);
+			}
+		}
+	}
+
+	return false;
+}
+
+void FAggregatorDependencyGraph::RaiseRank(FAggregator& Aggregator, int32 MinRank)
+{
+	if (Aggregator.DependencyRank >= MinRank)
+	{
+		return;
+	}
+	Aggregator.DependencyRank = MinRank;
+
+	// The graph has no cycles, so this stops at the aggregators nothing depends on
+	TArray<FAggregator*, TInlineAllocator<16>> Stack;
+	Stack.Add(&Aggregator);
+	while (Stack.Num() > 0)
+	{
+		FAggregator* Current = Stack.Pop(false);
+		for (const TWeakPtr<FAggregator>& WeakDependent : Current->DependentAggregators)
+		{
+			FAggregator* Dependent = WeakDependent.Pin().Get();
+			if (Dependent && Dependent->DependencyRank <= Current->DependencyRank)
+			{
+				Dependent->DependencyRank = Current->DependencyRank + 1;
+				Stack.Add(Dependent);
+			}
+		}
+	}
+}
+
+void FAggregatorDependencyGraph::RemoveDependency(const FDependency& Dependency)
+{
+	TSharedPtr<FAggregator> From = Dependency.From.Pin();
+	if (!From.IsValid())
+	{
+		return;
+	}
+
+	// Each dependency added one entry, remove one. An aggregator that is gone matches any entry that points to nothing
+	const FAggregator* To = Dependency.To.Pin().Get();
+	TArray<TWeakPtr<FAggregator>>& DependentAggregators = From->DependentAggregators;
+	for (int32 DependentIdx = 0; DependentIdx < DependentAggregators.Num(); ++DependentIdx)
+	{
+		if (DependentAggregators[DependentIdx].Pin().Get() == To)
+		{
+			DependentAggregators.RemoveAtSwap(DependentIdx, 1, false);
+			break;
+		}
+	}
 }
 
 void FAggregatorRef::TakeSnapshotOf(const FAggregatorRef& RefToSnapshot)
@@ -549,6 +1068,10 @@ int32 FScopedAggregatorOnDirtyBatch::GlobalBatchCount = 0;
 TSet<FAggregator*> FScopedAggregatorOnDirtyBatch::DirtyAggregators;
 bool FScopedAggregatorOnDirtyBatch::GlobalFromNetworkUpdate = false;
 int32 FScopedAggregatorOnDirtyBatch::NetUpdateID = 1;
+TSet<FAggregator*> FScopedAggregatorOnDirtyBatch::RecomputedAggregators;
+FAggregator* FScopedAggregatorOnDirtyBatch::NotifyingAggregator = nullptr;
+TArray<FAggregator*> FScopedAggregatorOnDirtyBatch::PendingAggregators;
+TSet<FAggregator*> FScopedAggregatorOnDirtyBatch::PendingAggregatorSet;
 
 FScopedAggregatorOnDirtyBatch::FScopedAggregatorOnDirtyBatch()
 {
@@ -569,12 +1092,67 @@ void FScopedAggregatorOnDirtyBatch::EndLock()
 	GlobalBatchCount--;
 	if (GlobalBatchCount == 0)
 	{
-		TSet<FAggregator*> LocalSet(MoveTemp(DirtyAggregators));
-		for (FAggregator* Agg : LocalSet)
+		FlushDirtyAggregators();
+	}
+}
+
+void FScopedAggregatorOnDirtyBatch::FlushDirtyAggregators()
+{
+	SCOPE_CYCLE_COUNTER(STAT_AggregatorFlushDirty);
+
+	// Aggregators the callbacks dirty are added to this flush
+	TGuardValue<int32> BatchGuard(GlobalBatchCount, 1);
+
+	while (true)
+	{
+		for (FAggregator* Agg : DirtyAggregators)
+		{
+			if (!PendingAggregatorSet.Contains(Agg))
+			{
+				PendingAggregatorSet.Add(Agg);
+				PendingAggregators.HeapPush(Agg, &IsLowerRank);
+			}
+		}
+		DirtyAggregators.Reset();
+
+		if (PendingAggregators.Num() == 0)
+		{
+			break;
+		}
+
+		FAggregator* Agg = nullptr;
+		PendingAggregators.HeapPop(Agg, &IsLowerRank, false);
+		PendingAggregatorSet.Remove(Agg);
+
+		RecomputedAggregators.Add(Agg);
+		Agg->BroadcastOnDirtyNow();
+	}
+
+	RecomputedAggregators.Reset();
+}
+
+bool FScopedAggregatorOnDirtyBatch::IsLowerRank(const FAggregator& A, const FAggregator& B)
+{
+	return A.DependencyRank < B.DependencyRank;
+}
+
+void FScopedAggregatorOnDirtyBatch::RemoveDestroyedAggregator(FAggregator* Aggregator)
+{
+	DirtyAggregators.Remove(Aggregator);
+	RecomputedAggregators.Remove(Aggregator);
+
+	if (PendingAggregatorSet.Remove(Aggregator) > 0)
+	{
+		const int32 HeapIdx = PendingAggregators.Find(Aggregator);
+		if (ensure(HeapIdx != INDEX_NONE))
 		{
-			Agg->BroadcastOnDirty();
+			PendingAggregators.HeapRemoveAt(HeapIdx, &IsLowerRank);
 		}
-		LocalSet.Empty();
+	}
+
+	if (NotifyingAggregator == Aggregator)
+	{
+		NotifyingAggregator = nullptr;
 	}
 }
 
@@ -5,17 +5,23 @@
 #include "UObject/UnrealType.h"
 #include "Engine/EngineBaseTypes.h"
 #include "Engine/DataTable.h"
+#include "Engine/CurveTable.h"
+#include "HAL/IConsoleManager.h"
 #include "Engine/Engine.h"
 #include "AttributeSet.h"
 #include "DNAEffectTypes.h"
 #include "DNAEffect.h"
+#include "DNAEffectAggregator.h"
 #include "DNAAbilitiesModule.h"
 #include "DNATagsManager.h"
 #include "DNATagsModule.h"
+#include "DNATagsSettings.h"
+#include "DNACueSet.h"
 #include "AbilitySystemComponent.h"
 #include "AbilitySystemTestPawn.h"
 #include "AbilitySystemTestAttributeSet.h"
 #include "AbilitySystemGlobals.h"
+#include "DNAEffectTimerWheel.h"
 
 #define SKILL_TEST_TEXT( Format, ... ) FString::Printf(TEXT("%s - %d: %s"), TEXT(__FILE__) , __LINE__ , *FString::Printf(TEXT(Format), ##__VA_ARGS__) )
 
@@ -227,6 +233,727 @@ public: // the tests
 		// TODO: test that the effect is no longer applied
 	}
 
+	void Test_EffectTimers()
+	{
+		const float BuffValue = 30.f;
+		const float DurationSecs = 2.f;
+		const float StartingMana = DestComponent->GetSet<UDNAAbilitySystemTestAttributeSet>()->Mana;
+		FDNAEffectTimerWheel& TimerWheel = UDNAAbilitySystemGlobals::Get().GetEffectTimerWheel(World);
+		const int32 StartingTimers = TimerWheel.GetNumTimers();
+		Test->TestTrue(SKILL_TEST_TEXT("Wheel found for the world"), UDNAAbilitySystemGlobals::Get().FindEffectTimerWheel(World) == &TimerWheel);
+
+		CONSTRUCT_CLASS(UDNAEffect, ManaBuffEffect);
+		AddModifier(ManaBuffEffect, GET_FIELD_CHECKED(UDNAAbilitySystemTestAttributeSet, Mana), EDNAModOp::Additive, FScalableFloat(BuffValue));
+		ManaBuffEffect->DurationPolicy = EDNAEffectDurationType::HasDuration;
+		ManaBuffEffect->DurationMagnitude = FDNAEffectModifierMagnitude(FScalableFloat(DurationSecs));
+
+		// an effect that runs its course is removed by its duration timer
+		SourceComponent->ApplyDNAEffectToTarget(ManaBuffEffect, DestComponent, 1.f);
+		TestEqual(SKILL_TEST_TEXT("Duration timer scheduled"), TimerWheel.GetNumTimers(), StartingTimers + 1);
+		TestEqual(SKILL_TEST_TEXT("Mana Buffed"), DestComponent->GetSet<UDNAAbilitySystemTestAttributeSet>()->Mana, StartingMana + BuffValue);
+
+		TickWorld(DurationSecs * .5f);
+		TestEqual(SKILL_TEST_TEXT("Mana Buffed"), DestComponent->GetSet<UDNAAbilitySystemTestAttributeSet>()->Mana, StartingMana + BuffValue);
+
+		TickWorld(DurationSecs);
+		TestEqual(SKILL_TEST_TEXT("Mana Restored"), DestComponent->GetSet<UDNAAbilitySystemTestAttributeSet>()->Mana, StartingMana);
+		TestEqual(SKILL_TEST_TEXT("Duration timer fired"), TimerWheel.GetNumTimers(), StartingTimers);
+
+		// an effect removed early clears its timer
+		FActiveDNAEffectHandle BuffHandle = SourceComponent->ApplyDNAEffectToTarget(ManaBuffEffect, DestComponent, 1.f);
+		DestComponent->RemoveActiveDNAEffect(BuffHandle);
+		TestEqual(SKILL_TEST_TEXT("Duration timer cleared"), TimerWheel.GetNumTimers(), StartingTimers);
+		TestEqual(SKILL_TEST_TEXT("Mana Restored"), DestComponent->GetSet<UDNAAbilitySystemTestAttributeSet>()->Mana, StartingMana);
+	}
+
+	void Test_HandleLookupChurn()
+	{
+		const int32 NumSteps = 500;
+		const float BuffValue = 1.f;
+		const float StartingMana = DestComponent->GetSet<UDNAAbilitySystemTestAttributeSet>()->Mana;
+		FRandomStream Random(1234);
+
+		CONSTRUCT_CLASS(UDNAEffect, ChurnEffect);
+		AddModifier(ChurnEffect, GET_FIELD_CHECKED(UDNAAbilitySystemTestAttributeSet, Mana), EDNAModOp::Additive, FScalableFloat(BuffValue));
+		ChurnEffect->DurationPolicy = EDNAEffectDurationType::Infinite;
+
+		TArray<FActiveDNAEffectHandle> LiveHandles;
+		TArray<FActiveDNAEffectHandle> RemovedHandles;
+		bool bLookupsMatched = true;
+
+		for (int32 Step = 0; Step < NumSteps; ++Step)
+		{
+			// Lean towards adding so the list grows, and removals swap elements from all over it
+			if (LiveHandles.Num() == 0 || Random.FRand() < 0.6f)
+			{
+				LiveHandles.Add(SourceComponent->ApplyDNAEffectToTarget(ChurnEffect, DestComponent, 1.f));
+			}
+			else
+			{
+				const int32 RemoveIdx = Random.RandRange(0, LiveHandles.Num() - 1);
+				bLookupsMatched &= DestComponent->RemoveActiveDNAEffect(LiveHandles[RemoveIdx]);
+				RemovedHandles.Add(LiveHandles[RemoveIdx]);
+				LiveHandles.RemoveAtSwap(RemoveIdx);
+			}
+
+			for (const FActiveDNAEffectHandle& Handle : LiveHandles)
+			{
+				const FActiveDNAEffect* Effect = DestComponent->GetActiveDNAEffect(Handle);
+				bLookupsMatched &= (Effect != nullptr && Effect->Handle == Handle);
+			}
+			for (const FActiveDNAEffectHandle& Handle : RemovedHandles)
+			{
+				bLookupsMatched &= (DestComponent->GetActiveDNAEffect(Handle) == nullptr);
+			}
+		}
+
+		Test->TestTrue(SKILL_TEST_TEXT("Every live handle finds its effect and no removed handle does"), bLookupsMatched);
+		TestEqual(SKILL_TEST_TEXT("Active effect count"), DestComponent->GetNumActiveDNAEffects(), LiveHandles.Num());
+		TestEqual(SKILL_TEST_TEXT("Mana Buffed"), DestComponent->GetSet<UDNAAbilitySystemTestAttributeSet>()->Mana, StartingMana + BuffValue * LiveHandles.Num());
+
+		for (const FActiveDNAEffectHandle& Handle : LiveHandles)
+		{
+			DestComponent->RemoveActiveDNAEffect(Handle);
+		}
+		TestEqual(SKILL_TEST_TEXT("Mana Restored"), DestComponent->GetSet<UDNAAbilitySystemTestAttributeSet>()->Mana, StartingMana);
+	}
+
+	void Test_HandleGenerations()
+	{
+		CONSTRUCT_CLASS(UDNAEffect, InfiniteEffect);
+		AddModifier(InfiniteEffect, GET_FIELD_CHECKED(UDNAAbilitySystemTestAttributeSet, Mana), EDNAModOp::Additive, FScalableFloat(1.f));
+		InfiniteEffect->DurationPolicy = EDNAEffectDurationType::Infinite;
+
+		FActiveDNAEffectHandle OldHandle = SourceComponent->ApplyDNAEffectToTarget(InfiniteEffect, DestComponent, 1.f);
+		Test->TestTrue(SKILL_TEST_TEXT("Handle resolves its owner"), OldHandle.GetOwningDNAAbilitySystemComponent() == DestComponent);
+
+		DestComponent->RemoveActiveDNAEffect(OldHandle);
+		Test->TestTrue(SKILL_TEST_TEXT("Removed handle no longer resolves"), OldHandle.GetOwningDNAAbilitySystemComponent() == nullptr);
+
+		// The freed slot is handed out again with a new generation
+		FActiveDNAEffectHandle NewHandle = SourceComponent->ApplyDNAEffectToTarget(InfiniteEffect, DestComponent, 1.f);
+		Test->TestTrue(SKILL_TEST_TEXT("New handle differs from the removed one"), NewHandle != OldHandle);
+		Test->TestTrue(SKILL_TEST_TEXT("New handle resolves its owner"), NewHandle.GetOwningDNAAbilitySystemComponent() == DestComponent);
+		Test->TestTrue(SKILL_TEST_TEXT("Removed handle finds no effect"), DestComponent->GetActiveDNAEffect(OldHandle) == nullptr);
+		Test->TestFalse(SKILL_TEST_TEXT("Removed handle removes nothing"), DestComponent->RemoveActiveDNAEffect(OldHandle));
+		Test->TestTrue(SKILL_TEST_TEXT("New handle still finds its effect"), DestComponent->GetActiveDNAEffect(NewHandle) != nullptr);
+
+		DestComponent->RemoveActiveDNAEffect(NewHandle);
+	}
+
+	void Test_StackingIndex()
+	{
+		const float StartingMana = DestComponent->GetSet<UDNAAbilitySystemTestAttributeSet>()->Mana;
+		const int32 StartingEffects = DestComponent->GetNumActiveDNAEffects();
+
+		CONSTRUCT_CLASS(UDNAEffect, TargetStackEffect);
+		AddModifier(TargetStackEffect, GET_FIELD_CHECKED(UDNAAbilitySystemTestAttributeSet, Mana), EDNAModOp::Additive, FScalableFloat(1.f));
+		TargetStackEffect->DurationPolicy = EDNAEffectDurationType::Infinite;
+		TargetStackEffect->StackingType = EDNAEffectStackingType::AggregateByTarget;
+		TargetStackEffect->StackLimitCount = 5;
+
+		CONSTRUCT_CLASS(UDNAEffect, SourceStackEffect);
+		AddModifier(SourceStackEffect, GET_FIELD_CHECKED(UDNAAbilitySystemTestAttributeSet, Mana), EDNAModOp::Additive, FScalableFloat(1.f));
+		SourceStackEffect->DurationPolicy = EDNAEffectDurationType::Infinite;
+		SourceStackEffect->StackingType = EDNAEffectStackingType::AggregateBySource;
+		SourceStackEffect->StackLimitCount = 5;
+
+		// by target, every source adds to the same stack
+		FActiveDNAEffectHandle TargetHandle = SourceComponent->ApplyDNAEffectToTarget(TargetStackEffect, DestComponent, 1.f);
+		SourceComponent->ApplyDNAEffectToTarget(TargetStackEffect, DestComponent, 1.f);
+		DestComponent->ApplyDNAEffectToTarget(TargetStackEffect, DestComponent, 1.f);
+		TestEqual(SKILL_TEST_TEXT("One stack by target"), DestComponent->GetNumActiveDNAEffects(), StartingEffects + 1);
+		TestEqual(SKILL_TEST_TEXT("Stack count by target"), DestComponent->GetCurrentStackCount(TargetHandle), 3);
+
+		// by source, each source has its own stack
+		FActiveDNAEffectHandle FromSourceHandle = SourceComponent->ApplyDNAEffectToTarget(SourceStackEffect, DestComponent, 1.f);
+		SourceComponent->ApplyDNAEffectToTarget(SourceStackEffect, DestComponent, 1.f);
+		FActiveDNAEffectHandle FromDestHandle = DestComponent->ApplyDNAEffectToTarget(SourceStackEffect, DestComponent, 1.f);
+		TestEqual(SKILL_TEST_TEXT("One stack per source"), DestComponent->GetNumActiveDNAEffects(), StartingEffects + 3);
+		TestEqual(SKILL_TEST_TEXT("Stack count of the first source"), DestComponent->GetCurrentStackCount(FromSourceHandle), 2);
+		TestEqual(SKILL_TEST_TEXT("Stack count of the second source"), DestComponent->GetCurrentStackCount(FromDestHandle), 1);
+
+		// a removed stack is not found again, the next application starts a new one
+		DestComponent->RemoveActiveDNAEffect(TargetHandle);
+		FActiveDNAEffectHandle NewTargetHandle = SourceComponent->ApplyDNAEffectToTarget(TargetStackEffect, DestComponent, 1.f);
+		Test->TestTrue(SKILL_TEST_TEXT("New stack after removal"), NewTargetHandle != TargetHandle);
+		TestEqual(SKILL_TEST_TEXT("Stack count of the new stack"), DestComponent->GetCurrentStackCount(NewTargetHandle), 1);
+		TestEqual(SKILL_TEST_TEXT("Mana Buffed"), DestComponent->GetSet<UDNAAbilitySystemTestAttributeSet>()->Mana, StartingMana + 4.f);
+
+		DestComponent->RemoveActiveDNAEffect(NewTargetHandle);
+		DestComponent->RemoveActiveDNAEffect(FromSourceHandle);
+		DestComponent->RemoveActiveDNAEffect(FromDestHandle);
+		TestEqual(SKILL_TEST_TEXT("Mana Restored"), DestComponent->GetSet<UDNAAbilitySystemTestAttributeSet>()->Mana, StartingMana);
+	}
+
+	void Test_AggregatorEvaluationCache()
+	{
+		const FDNATag FireTag = UDNATagsManager::Get().RequestDNATag(FName(TEXT("Damage.Fire")));
+		const FDNATag PhysicalTag = UDNATagsManager::Get().RequestDNATag(FName(TEXT("Damage.Physical")));
+
+		FDNATagRequirements FireRequirements;
+		FireRequirements.RequireTags.AddTag(FireTag);
+
+		FAggregator Aggregator(10.f);
+		const FActiveDNAEffectHandle FireHandle(1);
+		Aggregator.AddAggregatorMod(5.f, EDNAModOp::Additive, EDNAModEvaluationChannel::Channel0, &FireRequirements, nullptr, false, FireHandle);
+
+		FDNATagContainer SourceTags;
+		SourceTags.AddTag(FireTag);
+
+		FAggregatorEvaluateParameters Parameters;
+		Parameters.SourceTags = &SourceTags;
+
+		TestEqual(SKILL_TEST_TEXT("Mod qualifies"), Aggregator.Evaluate(Parameters), 15.f);
+		TestEqual(SKILL_TEST_TEXT("Cached mod qualifies"), Aggregator.Evaluate(Parameters), 15.f);
+
+		// the same container changed in place must not hit the old result
+		SourceTags.RemoveTag(FireTag);
+		SourceTags.AddTag(PhysicalTag);
+		TestEqual(SKILL_TEST_TEXT("Mod does not qualify after a tag change"), Aggregator.Evaluate(Parameters), 10.f);
+
+		Parameters.SourceTags = nullptr;
+		TestEqual(SKILL_TEST_TEXT("Mod does not qualify without tags"), Aggregator.Evaluate(Parameters), 10.f);
+
+		SourceTags.AddTag(FireTag);
+		Parameters.SourceTags = &SourceTags;
+		TestEqual(SKILL_TEST_TEXT("Mod qualifies again"), Aggregator.Evaluate(Parameters), 15.f);
+
+		// every change to the base value or the mods is seen
+		Aggregator.SetBaseValue(20.f, false);
+		TestEqual(SKILL_TEST_TEXT("New base value"), Aggregator.Evaluate(Parameters), 25.f);
+
+		Aggregator.AddAggregatorMod(1.f, EDNAModOp::Additive, EDNAModEvaluationChannel::Channel0, nullptr, nullptr, false);
+		TestEqual(SKILL_TEST_TEXT("Added mod"), Aggregator.Evaluate(Parameters), 26.f);
+
+		Aggregator.RemoveAggregatorMod(FireHandle);
+		TestEqual(SKILL_TEST_TEXT("Removed mod"), Aggregator.Evaluate(Parameters), 21.f);
+	}
+
+	void Test_AggregatorModGroups()
+	{
+		const FDNATag FireTag = UDNATagsManager::Get().RequestDNATag(FName(TEXT("Damage.Fire")));
+		const FDNATag PhysicalTag = UDNATagsManager::Get().RequestDNATag(FName(TEXT("Damage.Physical")));
+
+		FDNATagRequirements FireRequirements;
+		FireRequirements.RequireTags.AddTag(FireTag);
+		FDNATagRequirements PhysicalRequirements;
+		PhysicalRequirements.RequireTags.AddTag(PhysicalTag);
+		FDNATagRequirements EmptyRequirements;
+
+		// Enough unconditional mods for full and partial vector sums, plus a few groups of conditional ones
+		FAggregatorModChannelContainer Channels;
+		FAggregatorModChannel& Channel0 = Channels.FindOrAddModChannel(EDNAModEvaluationChannel::Channel0);
+		for (int32 ModIdx = 0; ModIdx < 11; ++ModIdx)
+		{
+			Channel0.AddMod(1.f, EDNAModOp::Additive, (ModIdx % 2) ? &EmptyRequirements : nullptr, nullptr, false, FActiveDNAEffectHandle(ModIdx + 1));
+			Channel0.AddMod(2.f, EDNAModOp::Additive, &FireRequirements, nullptr, false, FActiveDNAEffectHandle(ModIdx + 1));
+			Channel0.AddMod(4.f, EDNAModOp::Additive, &PhysicalRequirements, nullptr, false, FActiveDNAEffectHandle(ModIdx + 1));
+			Channel0.AddMod(8.f, EDNAModOp::Additive, nullptr, nullptr, true, FActiveDNAEffectHandle(ModIdx + 1));
+		}
+		Channel0.AddMod(1.5f, EDNAModOp::Multiplicitive, nullptr, nullptr, false, FActiveDNAEffectHandle(100));
+		Channel0.AddMod(1.5f, EDNAModOp::Multiplicitive, nullptr, &FireRequirements, false, FActiveDNAEffectHandle(101));
+
+		// Channels added out of order still evaluate in channel order
+		Channels.FindOrAddModChannel(EDNAModEvaluationChannel::Channel2).AddMod(2.f, EDNAModOp::Division, nullptr, nullptr, false, FActiveDNAEffectHandle(102));
+		Channels.FindOrAddModChannel(EDNAModEvaluationChannel::Channel1).AddMod(10.f, EDNAModOp::Additive, nullptr, nullptr, false, FActiveDNAEffectHandle(103));
+		TestEqual(SKILL_TEST_TEXT("Channel count"), Channels.GetNumChannels(), 3);
+
+		FDNATagContainer Tags;
+		Tags.AddTag(FireTag);
+
+		FAggregatorEvaluateParameters Parameters;
+		Parameters.SourceTags = &Tags;
+		Parameters.TargetTags = &Tags;
+
+		// Ignoring a handle no mod has takes the mod by mod path, which must agree with the grouped one
+		FAggregatorEvaluateParameters PerModParameters(Parameters);
+		PerModParameters.IgnoreHandles.Add(FActiveDNAEffectHandle(1000));
+
+		const float Expected = ((((10.f + 11.f + 22.f) * 2.f) + 10.f) / 2.f);
+		TestEqual(SKILL_TEST_TEXT("Grouped evaluation"), Channels.EvaluateWithBase(10.f, Parameters), Expected);
+		TestEqual(SKILL_TEST_TEXT("Per mod evaluation"), Channels.EvaluateWithBase(10.f, PerModParameters), Expected);
+
+		Parameters.IncludePredictiveMods = true;
+		PerModParameters.IncludePredictiveMods = true;
+		TestEqual(SKILL_TEST_TEXT("Grouped evaluation with predicted mods"), Channels.EvaluateWithBase(10.f, Parameters), Channels.EvaluateWithBase(10.f, PerModParameters));
+
+		// Removing mods rebuilds the groups
+		Channels.RemoveAggregatorMod(FActiveDNAEffectHandle(1));
+		Parameters.IncludePredictiveMods = false;
+		PerModParameters.IncludePredictiveMods = false;
+		const float ExpectedAfterRemove = ((((10.f + 10.f + 20.f) * 2.f) + 10.f) / 2.f);
+		TestEqual(SKILL_TEST_TEXT("Grouped evaluation after remove"), Channels.EvaluateWithBase(10.f, Parameters), ExpectedAfterRemove);
+		TestEqual(SKILL_TEST_TEXT("Per mod evaluation after remove"), Channels.EvaluateWithBase(10.f, PerModParameters), ExpectedAfterRemove);
+	}
+
+	void Test_AggregatorDependencyOrder()
+	{
+		// A diamond: B and C depend on A, D depends on both
+		FAggregatorRef A(new FAggregator(1.f));
+		FAggregatorRef B(new FAggregator(1.f));
+		FAggregatorRef C(new FAggregator(1.f));
+		FAggregatorRef D(new FAggregator(1.f));
+
+		FAggregatorDependencyGraph Graph;
+		Test->TestTrue(SKILL_TEST_TEXT("A to B"), Graph.AddDependency(FActiveDNAEffectHandle(1), A, B));
+		Test->TestTrue(SKILL_TEST_TEXT("A to C"), Graph.AddDependency(FActiveDNAEffectHandle(2), A, C));
+		Test->TestTrue(SKILL_TEST_TEXT("B to D"), Graph.AddDependency(FActiveDNAEffectHandle(3), B, D));
+		Test->TestTrue(SKILL_TEST_TEXT("C to D"), Graph.AddDependency(FActiveDNAEffectHandle(3), C, D));
+		TestEqual(SKILL_TEST_TEXT("Dependency count"), Graph.Num(), 4);
+
+		// cycles are refused up front
+		Test->TestFalse(SKILL_TEST_TEXT("D to A is cyclic"), Graph.AddDependency(FActiveDNAEffectHandle(4), D, A));
+		Test->TestFalse(SKILL_TEST_TEXT("A to A is cyclic"), Graph.AddDependency(FActiveDNAEffectHandle(4), A, A));
+		Test->TestTrue(SKILL_TEST_TEXT("D depends on A"), FAggregatorDependencyGraph::DependsOn(*D.Get(), *A.Get()));
+		Test->TestFalse(SKILL_TEST_TEXT("C does not depend on B"), FAggregatorDependencyGraph::DependsOn(*C.Get(), *B.Get()));
+
+		TArray<FAggregator*> Recomputed;
+		auto RecordRecompute = [&Recomputed](FAggregator* Aggregator)
+		{
+			Recomputed.Add(Aggregator);
+		};
+		for (FAggregatorRef* Ref : { &A, &B, &C, &D })
+		{
+			Ref->Get()->OnDirty.AddLambda(RecordRecompute);
+		}
+
+		// dirtied in reverse order, some twice, and recomputed once each with every aggregator after the ones it depends on
+		{
+			FScopedAggregatorOnDirtyBatch AggregatorOnDirtyBatcher;
+			D.Get()->SetBaseValue(2.f);
+			C.Get()->SetBaseValue(2.f);
+			B.Get()->SetBaseValue(2.f);
+			A.Get()->SetBaseValue(2.f);
+			D.Get()->SetBaseValue(3.f);
+			TestEqual(SKILL_TEST_TEXT("Nothing recomputed inside the batch"), Recomputed.Num(), 0);
+		}
+		TestEqual(SKILL_TEST_TEXT("Every aggregator recomputed once"), Recomputed.Num(), 4);
+		TestEqual(SKILL_TEST_TEXT("A first"), Recomputed.IndexOfByKey(A.Get()), 0);
+		TestEqual(SKILL_TEST_TEXT("D last"), Recomputed.IndexOfByKey(D.Get()), 3);
+
+		// an aggregator the callbacks destroy before the flush reaches it is dropped from the flush
+		{
+			FAggregatorRef E(new FAggregator(1.f));
+			FAggregatorRef F(new FAggregator(1.f));
+			int32 NumRecomputed = 0;
+			E.Get()->OnDirty.AddLambda([&NumRecomputed, &F](FAggregator* Aggregator) { NumRecomputed++; F.Data.Reset(); });
+			F.Get()->OnDirty.AddLambda([&NumRecomputed, &E](FAggregator* Aggregator) { NumRecomputed++; E.Data.Reset(); });
+			{
+				FScopedAggregatorOnDirtyBatch AggregatorOnDirtyBatcher;
+				E.Get()->SetBaseValue(2.f);
+				F.Get()->SetBaseValue(2.f);
+			}
+			TestEqual(SKILL_TEST_TEXT("Destroyed aggregator skipped"), NumRecomputed, 1);
+			Test->TestTrue(SKILL_TEST_TEXT("One aggregator destroyed"), E.Get() == nullptr || F.Get() == nullptr);
+		}
+
+		// without dependencies there is no order to keep
+		Graph.RemoveDependencies(FActiveDNAEffectHandle(3));
+		TestEqual(SKILL_TEST_TEXT("Dependencies removed with their effect"), Graph.Num(), 2);
+		Test->TestFalse(SKILL_TEST_TEXT("D no longer depends on A"), FAggregatorDependencyGraph::DependsOn(*D.Get(), *A.Get()));
+		Test->TestTrue(SKILL_TEST_TEXT("D to A is no longer cyclic"), Graph.AddDependency(FActiveDNAEffectHandle(4), D, A));
+
+		// the same through real effects: the container adds the dependencies of non snapshot captures when an effect is applied
+		struct FCycleWarningCounter : public FOutputDevice
+		{
+			FCycleWarningCounter() : Count(0) { GLog->AddOutputDevice(this); }
+			~FCycleWarningCounter() { GLog->RemoveOutputDevice(this); }
+
+			virtual void Serialize(const TCHAR* V, ELogVerbosity::Type Verbosity, const FName& Category) override
+			{
+				if (FCString::Strstr(V, TEXT("depend on each other in a cycle")))
+				{
+					++Count;
+				}
+			}
+
+			int32 Count;
+		};
+		FCycleWarningCounter CycleWarnings;
+
+		const float StartingHealth = DestComponent->GetSet<UDNAAbilitySystemTestAttributeSet>()->Health;
+		const float StartingMana = DestComponent->GetSet<UDNAAbilitySystemTestAttributeSet>()->Mana;
+		const float BuffValue = 10.f;
+
+		CONSTRUCT_CLASS(UDNAEffect, ManaFromHealthEffect);
+		FAttributeBasedFloat HealthBased;
+		HealthBased.BackingAttribute = FDNAEffectAttributeCaptureDefinition(FDNAAttribute(GET_FIELD_CHECKED(UDNAAbilitySystemTestAttributeSet, Health)), EDNAEffectAttributeCaptureSource::Target, false);
+		AddModifier(ManaFromHealthEffect, GET_FIELD_CHECKED(UDNAAbilitySystemTestAttributeSet, Mana), EDNAModOp::Additive, HealthBased);
+		ManaFromHealthEffect->DurationPolicy = EDNAEffectDurationType::Infinite;
+
+		CONSTRUCT_CLASS(UDNAEffect, HealthFromManaEffect);
+		FAttributeBasedFloat ManaBased;
+		ManaBased.BackingAttribute = FDNAEffectAttributeCaptureDefinition(FDNAAttribute(GET_FIELD_CHECKED(UDNAAbilitySystemTestAttributeSet, Mana)), EDNAEffectAttributeCaptureSource::Target, false);
+		AddModifier(HealthFromManaEffect, GET_FIELD_CHECKED(UDNAAbilitySystemTestAttributeSet, Health), EDNAModOp::Additive, ManaBased);
+		HealthFromManaEffect->DurationPolicy = EDNAEffectDurationType::Infinite;
+
+		CONSTRUCT_CLASS(UDNAEffect, HealthBuffEffect);
+		AddModifier(HealthBuffEffect, GET_FIELD_CHECKED(UDNAAbilitySystemTestAttributeSet, Health), EDNAModOp::Additive, FScalableFloat(BuffValue));
+		HealthBuffEffect->DurationPolicy = EDNAEffectDurationType::Infinite;
+
+		FActiveDNAEffectHandle ManaFromHealthHandle = SourceComponent->ApplyDNAEffectToTarget(ManaFromHealthEffect, DestComponent, 1.f);
+		TestEqual(SKILL_TEST_TEXT("Mana from Health"), DestComponent->GetSet<UDNAAbilitySystemTestAttributeSet>()->Mana, StartingMana + StartingHealth);
+
+		// Mana depends on Health, so it follows a change to Health
+		FActiveDNAEffectHandle HealthBuffHandle = SourceComponent->ApplyDNAEffectToTarget(HealthBuffEffect, DestComponent, 1.f);
+		TestEqual(SKILL_TEST_TEXT("Mana follows buffed Health"), DestComponent->GetSet<UDNAAbilitySystemTestAttributeSet>()->Mana, StartingMana + StartingHealth + BuffValue);
+		DestComponent->RemoveActiveDNAEffect(HealthBuffHandle);
+		TestEqual(SKILL_TEST_TEXT("Mana follows restored Health"), DestComponent->GetSet<UDNAAbilitySystemTestAttributeSet>()->Mana, StartingMana + StartingHealth);
+		TestEqual(SKILL_TEST_TEXT("No cycle yet"), CycleWarnings.Count, 0);
+
+		// Health from Mana closes a cycle, which is reported when the effect is applied
+		FActiveDNAEffectHandle HealthFromManaHandle = SourceComponent->ApplyDNAEffectToTarget(HealthFromManaEffect, DestComponent, 1.f);
+		TestEqual(SKILL_TEST_TEXT("Cycle reported"), CycleWarnings.Count, 1);
+		DestComponent->RemoveActiveDNAEffect(HealthFromManaHandle);
+
+		// removing the effect drops its dependency, so the other direction is no longer a cycle
+		DestComponent->RemoveActiveDNAEffect(ManaFromHealthHandle);
+		TestEqual(SKILL_TEST_TEXT("Health restored"), DestComponent->GetSet<UDNAAbilitySystemTestAttributeSet>()->Health, StartingHealth);
+		TestEqual(SKILL_TEST_TEXT("Mana restored"), DestComponent->GetSet<UDNAAbilitySystemTestAttributeSet>()->Mana, StartingMana);
+
+		HealthFromManaHandle = SourceComponent->ApplyDNAEffectToTarget(HealthFromManaEffect, DestComponent, 1.f);
+		TestEqual(SKILL_TEST_TEXT("No cycle after the dependency was removed"), CycleWarnings.Count, 1);
+		TestEqual(SKILL_TEST_TEXT("Health from Mana"), DestComponent->GetSet<UDNAAbilitySystemTestAttributeSet>()->Health, StartingHealth + StartingMana);
+		DestComponent->RemoveActiveDNAEffect(HealthFromManaHandle);
+	}
+
+	void Test_TargetTagCapture()
+	{
+		const FDNATag FireTag = UDNATagsManager::Get().RequestDNATag(FName(TEXT("Damage.Fire")));
+		const FDNATag BurningTag = UDNATagsManager::Get().RequestDNATag(FName(TEXT("DNACue.Burning")));
+		const FDNAAttribute HealthAttribute(GET_FIELD_CHECKED(UDNAAbilitySystemTestAttributeSet, Health));
+
+		// flat modifiers neither capture attributes nor read the target's tags
+		CONSTRUCT_CLASS(UDNAEffect, FlatEffect);
+		AddModifier(FlatEffect, GET_FIELD_CHECKED(UDNAAbilitySystemTestAttributeSet, Mana), EDNAModOp::Additive, FScalableFloat(1.f));
+		Test->TestFalse(SKILL_TEST_TEXT("Flat modifiers do not read target tags"), FlatEffect->ReadsTargetTagsOnExecute());
+		TestEqual(SKILL_TEST_TEXT("Flat modifiers capture nothing"), FlatEffect->GetAttributeCaptureDefinitions().Num(), 0);
+
+		// an attribute based modifier does both, and the same capture twice is captured once
+		CONSTRUCT_CLASS(UDNAEffect, AttributeBasedEffect);
+		FAttributeBasedFloat HealthBased;
+		HealthBased.BackingAttribute = FDNAEffectAttributeCaptureDefinition(HealthAttribute, EDNAEffectAttributeCaptureSource::Target, false);
+		AddModifier(AttributeBasedEffect, GET_FIELD_CHECKED(UDNAAbilitySystemTestAttributeSet, Mana), EDNAModOp::Additive, HealthBased);
+		AddModifier(AttributeBasedEffect, GET_FIELD_CHECKED(UDNAAbilitySystemTestAttributeSet, Damage), EDNAModOp::Additive, HealthBased);
+		Test->TestTrue(SKILL_TEST_TEXT("Attribute based modifiers read target tags"), AttributeBasedEffect->ReadsTargetTagsOnExecute());
+		TestEqual(SKILL_TEST_TEXT("Duplicate captures are gathered once"), AttributeBasedEffect->GetAttributeCaptureDefinitions().Num(), 1);
+
+		// the requirements are cached until invalidated, like on an edit of the definition
+		FlatEffect->DNACues.Add(FDNAEffectCue(BurningTag, 0.f, 1.f));
+		Test->TestFalse(SKILL_TEST_TEXT("Requirements are cached"), FlatEffect->ReadsTargetTagsOnExecute());
+		FlatEffect->InvalidateExecutionPlan();
+		Test->TestTrue(SKILL_TEST_TEXT("Cues read target tags"), FlatEffect->ReadsTargetTagsOnExecute());
+		FlatEffect->DNACues.Reset();
+		FlatEffect->InvalidateExecutionPlan();
+
+		// an applied delegate still sees the target's tags when the effect itself does not read them
+		DestComponent->AddLooseDNATag(FireTag);
+
+		bool bAppliedWithTargetTags = false;
+		FDelegateHandle AppliedHandle = DestComponent->OnDNAEffectAppliedDelegateToSelf.AddLambda([&bAppliedWithTargetTags, FireTag](UDNAAbilitySystemComponent* Source, const FDNAEffectSpec& SpecApplied, FActiveDNAEffectHandle ActiveHandle)
+		{
+			bAppliedWithTargetTags = SpecApplied.CapturedTargetTags.GetAggregatedTags()->HasTag(FireTag);
+		});
+
+		SourceComponent->ApplyDNAEffectToTarget(FlatEffect, DestComponent, 1.f);
+		Test->TestTrue(SKILL_TEST_TEXT("Target tags captured for the applied delegate"), bAppliedWithTargetTags);
+
+		DestComponent->OnDNAEffectAppliedDelegateToSelf.Remove(AppliedHandle);
+		DestComponent->RemoveLooseDNATag(FireTag);
+	}
+
+	void Test_ExecutionPlan()
+	{
+		const float BuffValue = 4.f;
+		const float StartingMana = DestComponent->GetSet<UDNAAbilitySystemTestAttributeSet>()->Mana;
+
+		CONSTRUCT_CLASS(UDNAEffect, PlannedEffect);
+		AddModifier(PlannedEffect, GET_FIELD_CHECKED(UDNAAbilitySystemTestAttributeSet, Mana), EDNAModOp::Additive, FScalableFloat(BuffValue));
+		PlannedEffect->DurationPolicy = EDNAEffectDurationType::HasDuration;
+		PlannedEffect->DurationMagnitude = FDNAEffectModifierMagnitude(FScalableFloat(10.f));
+
+		// a magnitude without a curve is baked once for every level
+		{
+			const FDNAEffectExecutionPlan& Plan = PlannedEffect->GetExecutionPlan();
+			TestEqual(SKILL_TEST_TEXT("One planned modifier"), Plan.Modifiers.Num(), 1);
+
+			float Magnitude = 0.f;
+			Test->TestTrue(SKILL_TEST_TEXT("Magnitude baked"), Plan.Modifiers[0].GetBakedMagnitude(PlannedEffect->Modifiers[0], 3.5f, Magnitude));
+			TestEqual(SKILL_TEST_TEXT("Baked magnitude"), Magnitude, BuffValue);
+
+			// a duration is always captured first
+			TestEqual(SKILL_TEST_TEXT("Duration captures"), Plan.AttributeCaptureDefinitions.Num(), 2);
+			Test->TestTrue(SKILL_TEST_TEXT("Outgoing duration captured first"), Plan.AttributeCaptureDefinitions[0] == UDNAAbilitySystemComponent::GetOutgoingDurationCapture());
+		}
+
+		FActiveDNAEffectHandle Handle = SourceComponent->ApplyDNAEffectToTarget(PlannedEffect, DestComponent, 1.f);
+		TestEqual(SKILL_TEST_TEXT("Mana Buffed from the plan"), DestComponent->GetSet<UDNAAbilitySystemTestAttributeSet>()->Mana, StartingMana + BuffValue);
+		DestComponent->RemoveActiveDNAEffect(Handle);
+
+		// a definition changed in code without invalidating the plan does not run stale magnitudes
+		PlannedEffect->Modifiers[0].ModifierMagnitude = FDNAEffectModifierMagnitude(FScalableFloat(BuffValue * 2.f));
+
+		Handle = SourceComponent->ApplyDNAEffectToTarget(PlannedEffect, DestComponent, 1.f);
+		TestEqual(SKILL_TEST_TEXT("Mana Buffed with the changed magnitude"), DestComponent->GetSet<UDNAAbilitySystemTestAttributeSet>()->Mana, StartingMana + BuffValue * 2.f);
+		DestComponent->RemoveActiveDNAEffect(Handle);
+
+		// nor misses modifiers added since, the plan is compiled again
+		int32 Idx = PlannedEffect->Modifiers.Num();
+		PlannedEffect->Modifiers.SetNum(Idx + 1);
+		PlannedEffect->Modifiers[Idx].ModifierMagnitude = FScalableFloat(BuffValue);
+		PlannedEffect->Modifiers[Idx].ModifierOp = EDNAModOp::Additive;
+		PlannedEffect->Modifiers[Idx].Attribute.SetUProperty(GET_FIELD_CHECKED(UDNAAbilitySystemTestAttributeSet, Mana));
+
+		Handle = SourceComponent->ApplyDNAEffectToTarget(PlannedEffect, DestComponent, 1.f);
+		TestEqual(SKILL_TEST_TEXT("Two planned modifiers"), PlannedEffect->GetExecutionPlan().Modifiers.Num(), 2);
+		TestEqual(SKILL_TEST_TEXT("Mana Buffed by the added modifier"), DestComponent->GetSet<UDNAAbilitySystemTestAttributeSet>()->Mana, StartingMana + BuffValue * 3.f);
+		DestComponent->RemoveActiveDNAEffect(Handle);
+		TestEqual(SKILL_TEST_TEXT("Mana Restored"), DestComponent->GetSet<UDNAAbilitySystemTestAttributeSet>()->Mana, StartingMana);
+	}
+
+	void Test_ExecutionPlanCurveBaking()
+	{
+		const float Coefficient = 2.f;
+		const float StartingMana = DestComponent->GetSet<UDNAAbilitySystemTestAttributeSet>()->Mana;
+
+		UCurveTable* CurveTable = NewObject<UCurveTable>(GetTransientPackage(), FName(TEXT("TempCurveTable")));
+		CurveTable->CreateTableFromCSVString(TEXT("Name,1,2,3\r\nManaBuff,10,20,30"));
+
+		FScalableFloat CurveMagnitude(Coefficient);
+		CurveMagnitude.Curve.CurveTable = CurveTable;
+		CurveMagnitude.Curve.RowName = FName(TEXT("ManaBuff"));
+
+		CONSTRUCT_CLASS(UDNAEffect, CurveEffect);
+		AddModifier(CurveEffect, GET_FIELD_CHECKED(UDNAAbilitySystemTestAttributeSet, Mana), EDNAModOp::Additive, CurveMagnitude);
+		CurveEffect->DurationPolicy = EDNAEffectDurationType::Infinite;
+
+		// curves are only baked outside the editor by default, force it so the baked path runs here
+		IConsoleVariable* BakeCurvesVar = IConsoleManager::Get().FindConsoleVariable(TEXT("DNAAbilitySystem.BakeCurveMagnitudes"));
+		Test->TestTrue(SKILL_TEST_TEXT("Bake setting exists"), BakeCurvesVar != nullptr);
+		if (!BakeCurvesVar)
+		{
+			return;
+		}
+
+		const int32 OldBakeCurves = BakeCurvesVar->GetInt();
+		BakeCurvesVar->Set(2);
+		CurveEffect->InvalidateExecutionPlan();
+
+		const FDNAEffectExecutionPlan& Plan = CurveEffect->GetExecutionPlan();
+		float Magnitude = 0.f;
+		Test->TestTrue(SKILL_TEST_TEXT("Curve baked at an integer level"), Plan.Modifiers[0].GetBakedMagnitude(CurveEffect->Modifiers[0], 2.f, Magnitude));
+		TestEqual(SKILL_TEST_TEXT("Baked curve magnitude"), Magnitude, Coefficient * 20.f);
+		Test->TestFalse(SKILL_TEST_TEXT("Curve not baked between levels"), Plan.Modifiers[0].GetBakedMagnitude(CurveEffect->Modifiers[0], 2.5f, Magnitude));
+		Test->TestFalse(SKILL_TEST_TEXT("Curve not baked past its last key"), Plan.Modifiers[0].GetBakedMagnitude(CurveEffect->Modifiers[0], 4.f, Magnitude));
+
+		// applied at a baked level and between levels, both agree with the curve
+		FActiveDNAEffectHandle Handle = SourceComponent->ApplyDNAEffectToTarget(CurveEffect, DestComponent, 3.f);
+		TestEqual(SKILL_TEST_TEXT("Mana Buffed from the baked curve"), DestComponent->GetSet<UDNAAbilitySystemTestAttributeSet>()->Mana, StartingMana + Coefficient * 30.f);
+		DestComponent->RemoveActiveDNAEffect(Handle);
+
+		Handle = SourceComponent->ApplyDNAEffectToTarget(CurveEffect, DestComponent, 1.5f);
+		TestEqual(SKILL_TEST_TEXT("Mana Buffed from the curve"), DestComponent->GetSet<UDNAAbilitySystemTestAttributeSet>()->Mana, StartingMana + Coefficient * 15.f);
+		DestComponent->RemoveActiveDNAEffect(Handle);
+
+		BakeCurvesVar->Set(OldBakeCurves);
+		CurveEffect->InvalidateExecutionPlan();
+		TestEqual(SKILL_TEST_TEXT("Mana Restored"), DestComponent->GetSet<UDNAAbilitySystemTestAttributeSet>()->Mana, StartingMana);
+	}
+
+	void Test_CueSetTagChanges()
+	{
+		UDNATagsManager& Manager = UDNATagsManager::Get();
+		UDNATagsSettings* Settings = GetMutableDefault<UDNATagsSettings>();
+		const bool bOldImportTagsFromConfig = Settings->ImportTagsFromConfig;
+		const TArray<FDNATagTableRow> OldTagList = Settings->DNATagList;
+
+		FDNATagTreeChangeSet LastChangeSet;
+		FDelegateHandle ChangeSetHandle = IDNATagsModule::OnDNATagTreeChangeSet.AddLambda([&LastChangeSet](const FDNATagTreeChangeSet& ChangeSet)
+		{
+			LastChangeSet = ChangeSet;
+		});
+
+		// The refresh only sees tag sources, so the cue tags go in the settings tag list
+		Settings->ImportTagsFromConfig = true;
+		Settings->DNATagList.Add(FDNATagTableRow(FName(TEXT("DNACue.RefreshTest.Notified.Kept"))));
+		Settings->DNATagList.Add(FDNATagTableRow(FName(TEXT("DNACue.RefreshTest.Notified.Removed"))));
+		Settings->DNATagList.Add(FDNATagTableRow(FName(TEXT("DNACue.RefreshTest.Plain.OldName"))));
+		Manager.EditorRefreshDNATagTree();
+
+		// Pending has cue data but no tag yet, like a notify saved before its tag was added
+		FDNATag PendingTag;
+		PendingTag.FromExportString(TEXT("(TagName=\"DNACue.RefreshTest.Pending\")"));
+
+		TArray<FDNACueReferencePair> Cues;
+		Cues.Add(FDNACueReferencePair(Manager.RequestDNATag(FName(TEXT("DNACue.RefreshTest.Notified"))), FStringAssetReference(TEXT("/Game/RefreshTest/NotifiedCue.NotifiedCue"))));
+		Cues.Add(FDNACueReferencePair(PendingTag, FStringAssetReference(TEXT("/Game/RefreshTest/PendingCue.PendingCue"))));
+
+		UDNACueSet* CueSet = NewObject<UDNACueSet>(GetTransientPackage());
+		CueSet->AddCues(Cues);
+
+		// Patching must give the same map as building it again from the current tree
+		auto TestMatchesRebuild = [this, &Cues, CueSet](const FString& What)
+		{
+			UDNACueSet* RebuiltSet = NewObject<UDNACueSet>(GetTransientPackage());
+			RebuiltSet->AddCues(Cues);
+			Test->TestTrue(What, CueSet->DNACueDataMap.OrderIndependentCompareEqual(RebuiltSet->DNACueDataMap));
+		};
+
+		// Remove a notified leaf, rename a plain leaf and add a leaf below the notify
+		Settings->DNATagList.RemoveAll([](const FDNATagTableRow& Row)
+		{
+			return Row.Tag == FName(TEXT("DNACue.RefreshTest.Notified.Removed")) || Row.Tag == FName(TEXT("DNACue.RefreshTest.Plain.OldName"));
+		});
+		Settings->DNATagList.Add(FDNATagTableRow(FName(TEXT("DNACue.RefreshTest.Plain.NewName"))));
+		Settings->DNATagList.Add(FDNATagTableRow(FName(TEXT("DNACue.RefreshTest.Notified.Added"))));
+		LastChangeSet = FDNATagTreeChangeSet();
+		Manager.EditorRefreshDNATagTree();
+
+		TestEqual(SKILL_TEST_TEXT("Tags added"), LastChangeSet.AddedTags.Num(), 2);
+		TestEqual(SKILL_TEST_TEXT("Tags removed"), LastChangeSet.RemovedTags.Num(), 2);
+		CueSet->UpdateAccelerationMapForTagChanges(LastChangeSet);
+		TestMatchesRebuild(SKILL_TEST_TEXT("Cue map patched for renamed and removed tags"));
+		const int32* AddedDataIdx = CueSet->DNACueDataMap.Find(Manager.RequestDNATag(FName(TEXT("DNACue.RefreshTest.Notified.Added"))));
+		Test->TestTrue(SKILL_TEST_TEXT("New tag uses the parent notify"), AddedDataIdx && *AddedDataIdx == 0);
+
+		// The tag the pending cue data waits for arrives, with a child that should use it
+		Settings->DNATagList.Add(FDNATagTableRow(FName(TEXT("DNACue.RefreshTest.Pending.Child"))));
+		LastChangeSet = FDNATagTreeChangeSet();
+		Manager.EditorRefreshDNATagTree();
+
+		CueSet->UpdateAccelerationMapForTagChanges(LastChangeSet);
+		TestMatchesRebuild(SKILL_TEST_TEXT("Cue map patched for a tag with pending cue data"));
+		const int32* ChildDataIdx = CueSet->DNACueDataMap.Find(Manager.RequestDNATag(FName(TEXT("DNACue.RefreshTest.Pending.Child"))));
+		Test->TestTrue(SKILL_TEST_TEXT("Child uses the pending notify"), ChildDataIdx && *ChildDataIdx == 1);
+
+		IDNATagsModule::OnDNATagTreeChangeSet.Remove(ChangeSetHandle);
+		Settings->ImportTagsFromConfig = bOldImportTagsFromConfig;
+		Settings->DNATagList = OldTagList;
+		Manager.EditorRefreshDNATagTree();
+	}
+
+	void Test_TagCountBatch()
+	{
+		const FDNATag DamageTag = UDNATagsManager::Get().RequestDNATag(FName(TEXT("Damage")));
+		const FDNATag BasicTag = UDNATagsManager::Get().RequestDNATag(FName(TEXT("Damage.Basic")));
+		const FDNATag FireTag = UDNATagsManager::Get().RequestDNATag(FName(TEXT("Damage.Fire")));
+		const FDNATag LifestealTag = UDNATagsManager::Get().RequestDNATag(FName(TEXT("Lifesteal")));
+
+		FDNATagCountContainer CountContainer;
+
+		int32 NumDamageEvents = 0;
+		int32 LastDamageCount = 0;
+		CountContainer.RegisterDNATagEvent(DamageTag).AddLambda([&NumDamageEvents, &LastDamageCount](const FDNATag Tag, int32 NewCount)
+		{
+			++NumDamageEvents;
+			LastDamageCount = NewCount;
+		});
+
+		int32 NumLifestealEvents = 0;
+		CountContainer.RegisterDNATagEvent(LifestealTag).AddLambda([&NumLifestealEvents](const FDNATag Tag, int32 NewCount)
+		{
+			++NumLifestealEvents;
+		});
+
+		// Two children of Damage in one batch add Damage once, with its final count
+		{
+			FDNATagCountContainer::FScopedBatch Batch(CountContainer);
+			CountContainer.UpdateTagCount(BasicTag, 1);
+			CountContainer.UpdateTagCount(FireTag, 1);
+
+			TestEqual(SKILL_TEST_TEXT("Counts update inside a batch"), CountContainer.GetTagCount(DamageTag), 2);
+			TestEqual(SKILL_TEST_TEXT("Events wait for the end of the batch"), NumDamageEvents, 0);
+		}
+		TestEqual(SKILL_TEST_TEXT("One event per tag per batch"), NumDamageEvents, 1);
+		TestEqual(SKILL_TEST_TEXT("Event has the final count"), LastDamageCount, 2);
+
+		// A tag added and removed in the same batch was never added or removed overall
+		{
+			FDNATagCountContainer::FScopedBatch Batch(CountContainer);
+			CountContainer.UpdateTagCount(LifestealTag, 1);
+			CountContainer.UpdateTagCount(LifestealTag, -1);
+		}
+		TestEqual(SKILL_TEST_TEXT("No event for a tag that came and went"), NumLifestealEvents, 0);
+
+		// Outside a batch events fire right away, and only when the tag is added or removed
+		CountContainer.UpdateTagCount(BasicTag, -1);
+		TestEqual(SKILL_TEST_TEXT("No event while a child remains"), NumDamageEvents, 1);
+		CountContainer.UpdateTagCount(FireTag, -1);
+		TestEqual(SKILL_TEST_TEXT("Event when the last child is removed"), NumDamageEvents, 2);
+		TestEqual(SKILL_TEST_TEXT("Removed count"), CountContainer.GetTagCount(DamageTag), 0);
+
+		// A listener that resets the container while a batch is flushed must not break the rest of the flush
+		FDNATagCountContainer ResetContainer;
+		ResetContainer.RegisterDNATagEvent(DamageTag).AddLambda([&ResetContainer](const FDNATag Tag, int32 NewCount)
+		{
+			ResetContainer.Reset();
+		});
+
+		{
+			FDNATagCountContainer::FScopedBatch Batch(ResetContainer);
+			ResetContainer.UpdateTagCount(BasicTag, 1);
+			ResetContainer.UpdateTagCount(LifestealTag, 1);
+		}
+		TestEqual(SKILL_TEST_TEXT("Reset during the flush clears the counts"), ResetContainer.GetTagCount(LifestealTag), 0);
+
+		// The pending flags are cleared by the flush, so the next batch queues its events again
+		NumLifestealEvents = 0;
+		{
+			FDNATagCountContainer::FScopedBatch Batch(CountContainer);
+			CountContainer.UpdateTagCount(LifestealTag, 1);
+		}
+		TestEqual(SKILL_TEST_TEXT("Event fires again in a later batch"), NumLifestealEvents, 1);
+		CountContainer.UpdateTagCount(LifestealTag, -1);
+
+		// A tag that is not in the dictionary only has its explicit count, which still counts as having the tag
+		FDNATag UnknownTag;
+		UnknownTag.FromExportString(TEXT("(TagName=\"Damage.NotInDictionary\")"));
+		CountContainer.UpdateTagCount(UnknownTag, 1);
+		TestEqual(SKILL_TEST_TEXT("Unindexed tag count"), CountContainer.GetTagCount(UnknownTag), 1);
+		Test->TestTrue(SKILL_TEST_TEXT("Unindexed tag matches"), CountContainer.HasMatchingDNATag(UnknownTag));
+		CountContainer.UpdateTagCount(UnknownTag, -1);
+		TestEqual(SKILL_TEST_TEXT("Unindexed tag removed"), CountContainer.GetTagCount(UnknownTag), 0);
+	}
+
+	void Test_TagRequirementsUnindexedTags()
+	{
+		const FDNATag DamageTag = UDNATagsManager::Get().RequestDNATag(FName(TEXT("Damage")));
+		const FDNATag BasicTag = UDNATagsManager::Get().RequestDNATag(FName(TEXT("Damage.Basic")));
+		FDNATag UnknownTag;
+		UnknownTag.FromExportString(TEXT("(TagName=\"Damage.NotInDictionary\")"));
+
+		FDNATagContainer OwnedTags;
+		OwnedTags.AddTag(BasicTag);
+		const FDNATagBitContainer OwnedBits(OwnedTags);
+
+		TArray<const FDNATagBitContainer*> BatchContainers;
+		BatchContainers.Add(&OwnedBits);
+		TBitArray<> BatchResults;
+
+		FDNATagRequirements Requirements;
+		Requirements.RequireTags.AddTag(DamageTag);
+		Test->TestTrue(SKILL_TEST_TEXT("Parent tag required, scalar"), Requirements.RequirementsMet(OwnedTags));
+		Test->TestTrue(SKILL_TEST_TEXT("Parent tag required, bits"), Requirements.RequirementsMet(OwnedBits));
+		Requirements.RequirementsMetBatch(BatchContainers, BatchResults);
+		Test->TestTrue(SKILL_TEST_TEXT("Parent tag required, batch"), BatchResults[0]);
+
+		// a required tag that is not in the dictionary is never met, whichever path checks it
+		Requirements.RequireTags.AddTag(UnknownTag);
+		Test->TestFalse(SKILL_TEST_TEXT("Unindexed tag required, scalar"), Requirements.RequirementsMet(OwnedTags));
+		Test->TestFalse(SKILL_TEST_TEXT("Unindexed tag required, bits"), Requirements.RequirementsMet(OwnedBits));
+		Requirements.RequirementsMetBatch(BatchContainers, BatchResults);
+		Test->TestFalse(SKILL_TEST_TEXT("Unindexed tag required, batch"), BatchResults[0]);
+
+		// and an ignored one never blocks
+		FDNATagRequirements IgnoreRequirements;
+		IgnoreRequirements.IgnoreTags.AddTag(UnknownTag);
+		Test->TestTrue(SKILL_TEST_TEXT("Unindexed tag ignored, scalar"), IgnoreRequirements.RequirementsMet(OwnedTags));
+		Test->TestTrue(SKILL_TEST_TEXT("Unindexed tag ignored, bits"), IgnoreRequirements.RequirementsMet(OwnedBits));
+		IgnoreRequirements.RequirementsMetBatch(BatchContainers, BatchResults);
+		Test->TestTrue(SKILL_TEST_TEXT("Unindexed tag ignored, batch"), BatchResults[0]);
+	}
+
 private: // test helpers
 
 	void TestEqual(const FString& TestText, float Actual, float Expected)
@@ -234,6 +961,11 @@ private: // test helpers
 		Test->TestEqual(FString::Printf(TEXT("%s: %f (actual) != %f (expected)"), *TestText, Actual, Expected), Actual, Expected);
 	}
 
+	void TestEqual(const FString& TestText, int32 Actual, int32 Expected)
+	{
+		Test->TestEqual(FString::Printf(TEXT("%s: %d (actual) != %d (expected)"), *TestText, Actual, Expected), Actual, Expected);
+	}
+
 	template<typename MODIFIER_T>
 	FDNAModifierInfo& AddModifier(UDNAEffect* Effect, UProperty* Property, EDNAModOp::Type Op, const MODIFIER_T& Magnitude)
 	{
@@ -243,6 +975,7 @@ private: // test helpers
 		Info.ModifierMagnitude = Magnitude;
 		Info.ModifierOp = Op;
 		Info.Attribute.SetUProperty(Property);
+		Effect->InvalidateExecutionPlan();
 		return Info;
 	}
 
@@ -288,6 +1021,19 @@ public:
 		ADD_TEST(Test_InstantDamageRemap);
 		ADD_TEST(Test_ManaBuff);
 		ADD_TEST(Test_PeriodicDamage);
+		ADD_TEST(Test_EffectTimers);
+		ADD_TEST(Test_HandleLookupChurn);
+		ADD_TEST(Test_HandleGenerations);
+		ADD_TEST(Test_StackingIndex);
+		ADD_TEST(Test_AggregatorEvaluationCache);
+		ADD_TEST(Test_AggregatorModGroups);
+		ADD_TEST(Test_AggregatorDependencyOrder);
+		ADD_TEST(Test_TargetTagCapture);
+		ADD_TEST(Test_ExecutionPlan);
+		ADD_TEST(Test_ExecutionPlanCurveBaking);
+		ADD_TEST(Test_TagCountBatch);
+		ADD_TEST(Test_TagRequirementsUnindexedTags);
+		ADD_TEST(Test_CueSetTagChanges);
 	}
 
 	virtual uint32 GetTestFlags() const override { return EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter; }
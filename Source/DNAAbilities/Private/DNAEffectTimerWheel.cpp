@@ -0,0 +1,290 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "Core.h"
+#include "DNAEffectTimerWheel.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
+#include "AbilitySystemStats.h"
+#include "AbilitySystemComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("FDNAEffectTimerWheel::Tick"), STAT_FDNAEffectTimerWheel_Tick, STATGROUP_DNAAbilitySystem);
+
+FDNAEffectTimerWheel::FDNAEffectTimerWheel(UWorld* InWorld)
+	: World(InWorld)
+	, NumActiveTimers(0)
+	, CurrentTick(GetTickForTime(InWorld ? InWorld->GetTimeSeconds() : 0.f))
+	, bTickScheduled(false)
+{
+}
+
+FDNAEffectTimerWheel::~FDNAEffectTimerWheel()
+{
+	UWorld* MyWorld = World.Get();
+	if (bTickScheduled && MyWorld)
+	{
+		MyWorld->GetTimerManager().ClearTimer(TickTimerHandle);
+	}
+}
+
+double FDNAEffectTimerWheel::GetWorldTime() const
+{
+	// The same clock FActiveDNAEffectsContainer::GetWorldTime uses for effect start times
+	UWorld* MyWorld = World.Get();
+	return MyWorld ? MyWorld->GetTimeSeconds() : 0.0;
+}
+
+int64 FDNAEffectTimerWheel::GetTickForTime(double Time)
+{
+	return (int64)FMath::FloorToDouble(Time * TicksPerSecond);
+}
+
+bool FDNAEffectTimerWheel::IsEntryValid(const FSlotEntry& Entry) const
+{
+	const FTimer& Timer = Timers[Entry.TimerIndex];
+	return Timer.bActive && Timer.Serial == Entry.Serial;
+}
+
+void FDNAEffectTimerWheel::SetTimer(FDNAEffectTimerHandle& InOutHandle, UDNAAbilitySystemComponent* Owner, FActiveDNAEffectHandle EffectHandle, EDNAEffectTimerType Type, float Delay, float Period)
+{
+	ClearTimer(InOutHandle);
+
+	if (NumActiveTimers == 0)
+	{
+		// Catch up with time that passed while the wheel was idle, so the new timer is placed relative to now
+		AdvanceTo(GetTickForTime(GetWorldTime()));
+	}
+
+	const int32 TimerIndex = FreeTimerIndices.Num() > 0 ? FreeTimerIndices.Pop(false) : Timers.AddZeroed();
+	FTimer& Timer = Timers[TimerIndex];
+	Timer.Owner = Owner;
+	Timer.EffectHandle = EffectHandle;
+	Timer.ExpireTime = GetWorldTime() + FMath::Max(Delay, 0.f);
+	Timer.Period = FMath::Max(Period, 0.f);
+	Timer.Type = Type;
+	Timer.bActive = true;
+	++NumActiveTimers;
+
+	InOutHandle.Index = TimerIndex;
+	InOutHandle.Serial = Timer.Serial;
+
+	FSlotEntry Entry;
+	Entry.TimerIndex = TimerIndex;
+	Entry.Serial = Timer.Serial;
+	InsertEntry(Entry);
+
+	ScheduleTick();
+}
+
+void FDNAEffectTimerWheel::ClearTimer(FDNAEffectTimerHandle& InOutHandle)
+{
+	if (TimerExists(InOutHandle))
+	{
+		FreeTimer(InOutHandle.Index);
+	}
+	InOutHandle.Invalidate();
+}
+
+bool FDNAEffectTimerWheel::TimerExists(const FDNAEffectTimerHandle& Handle) const
+{
+	return Handle.IsValid() && Timers.IsValidIndex(Handle.Index) && Timers[Handle.Index].bActive && Timers[Handle.Index].Serial == Handle.Serial;
+}
+
+float FDNAEffectTimerWheel::GetTimerRemaining(const FDNAEffectTimerHandle& Handle) const
+{
+	if (!TimerExists(Handle))
+	{
+		return -1.f;
+	}
+	return (float)(Timers[Handle.Index].ExpireTime - GetWorldTime());
+}
+
+void FDNAEffectTimerWheel::FreeTimer(int32 TimerIndex)
+{
+	// Entries left in the slots are skipped once the serial moves on
+	FTimer& Timer = Timers[TimerIndex];
+	Timer.bActive = false;
+	Timer.Owner.Reset();
+	++Timer.Serial;
+	--NumActiveTimers;
+	FreeTimerIndices.Add(TimerIndex);
+}
+
+void FDNAEffectTimerWheel::InsertEntry(const FSlotEntry& Entry)
+{
+	const int64 TimerTick = GetTickForTime(Timers[Entry.TimerIndex].ExpireTime);
+	const int64 TicksAway = TimerTick - CurrentTick;
+	if (TicksAway <= 0)
+	{
+		DueEntries.Add(Entry);
+		return;
+	}
+
+	for (int32 Level = 0; Level < NumLevels; ++Level)
+	{
+		const int32 LevelShift = SlotBits * Level;
+		if (TicksAway < (int64(1) << (LevelShift + SlotBits)))
+		{
+			// Within one rotation of this level, so the slot is reached before it comes around again
+			Slots[Level][(TimerTick >> LevelShift) & SlotMask].Add(Entry);
+			return;
+		}
+	}
+
+	// Beyond the wheel, wait in the last slot of the top level to come around and be placed again
+	const int32 TopShift = SlotBits * (NumLevels - 1);
+	Slots[NumLevels - 1][((CurrentTick >> TopShift) - 1) & SlotMask].Add(Entry);
+}
+
+void FDNAEffectTimerWheel::Cascade(int32 Level)
+{
+	TArray<FSlotEntry>& Slot = Slots[Level][(CurrentTick >> (SlotBits * Level)) & SlotMask];
+	if (Slot.Num() == 0)
+	{
+		return;
+	}
+
+	TArray<FSlotEntry> Entries = MoveTemp(Slot);
+	Slot.Reset();
+	for (const FSlotEntry& Entry : Entries)
+	{
+		if (IsEntryValid(Entry))
+		{
+			InsertEntry(Entry);
+		}
+	}
+}
+
+void FDNAEffectTimerWheel::AdvanceTo(int64 Tick)
+{
+	if (NumActiveTimers == 0)
+	{
+		// Nothing can be due, skip the empty ticks. Stale entries left behind are ignored when reached
+		CurrentTick = FMath::Max(CurrentTick, Tick);
+		return;
+	}
+
+	while (CurrentTick < Tick)
+	{
+		++CurrentTick;
+
+		// Entering a new slot of a level moves its timers down, the lowest level first like the rotation carries
+		for (int32 Level = 1; Level < NumLevels; ++Level)
+		{
+			if ((CurrentTick & ((int64(1) << (SlotBits * Level)) - 1)) != 0)
+			{
+				break;
+			}
+			Cascade(Level);
+		}
+
+		TArray<FSlotEntry>& Slot = Slots[0][CurrentTick & SlotMask];
+		if (Slot.Num() > 0)
+		{
+			DueEntries.Append(Slot);
+			Slot.Reset();
+		}
+	}
+}
+
+void FDNAEffectTimerWheel::ScheduleTick()
+{
+	UWorld* MyWorld = World.Get();
+	if (!bTickScheduled && MyWorld)
+	{
+		TickTimerHandle = MyWorld->GetTimerManager().SetTimerForNextTick(FTimerDelegate::CreateRaw(this, &FDNAEffectTimerWheel::Tick));
+		bTickScheduled = true;
+	}
+}
+
+void FDNAEffectTimerWheel::Tick()
+{
+	SCOPE_CYCLE_COUNTER(STAT_FDNAEffectTimerWheel_Tick);
+
+	bTickScheduled = false;
+
+	const double Now = GetWorldTime();
+	AdvanceTo(GetTickForTime(Now));
+
+	// Take what is due now, anything the callbacks schedule goes to the next frame
+	TArray<FSlotEntry> FiringEntries;
+	for (int32 EntryIdx = DueEntries.Num() - 1; EntryIdx >= 0; --EntryIdx)
+	{
+		const FSlotEntry& Entry = DueEntries[EntryIdx];
+		if (!IsEntryValid(Entry))
+		{
+			DueEntries.RemoveAtSwap(EntryIdx, 1, false);
+		}
+		else if (Timers[Entry.TimerIndex].ExpireTime <= Now)
+		{
+			FiringEntries.Add(Entry);
+			DueEntries.RemoveAtSwap(EntryIdx, 1, false);
+		}
+	}
+
+	// Fire in expiration order, periods before durations that expire at the same time so an effect gets its last period
+	FiringEntries.Sort([this](const FSlotEntry& A, const FSlotEntry& B)
+	{
+		const FTimer& TimerA = Timers[A.TimerIndex];
+		const FTimer& TimerB = Timers[B.TimerIndex];
+		if (TimerA.ExpireTime != TimerB.ExpireTime)
+		{
+			return TimerA.ExpireTime < TimerB.ExpireTime;
+		}
+		if (TimerA.Type != TimerB.Type)
+		{
+			return TimerA.Type == EDNAEffectTimerType::Period;
+		}
+		return A.TimerIndex < B.TimerIndex;
+	});
+
+	for (const FSlotEntry& Entry : FiringEntries)
+	{
+		// Earlier callbacks can clear this timer, or add timers and move the array
+		if (!IsEntryValid(Entry))
+		{
+			continue;
+		}
+
+		UDNAAbilitySystemComponent* Owner = Timers[Entry.TimerIndex].Owner.Get();
+		const FActiveDNAEffectHandle EffectHandle = Timers[Entry.TimerIndex].EffectHandle;
+		if (!Owner)
+		{
+			FreeTimer(Entry.TimerIndex);
+			continue;
+		}
+
+		if (Timers[Entry.TimerIndex].Type == EDNAEffectTimerType::Duration)
+		{
+			// Freed first, the check usually sets a new duration timer on the same effect
+			FreeTimer(Entry.TimerIndex);
+			Owner->CheckDurationExpired(EffectHandle);
+			continue;
+		}
+
+		// A looping timer fires once for every period that passed, like FTimerManager
+		while (IsEntryValid(Entry) && Timers[Entry.TimerIndex].ExpireTime <= Now)
+		{
+			FTimer& Timer = Timers[Entry.TimerIndex];
+			if (Timer.Period > 0.f)
+			{
+				Timer.ExpireTime += Timer.Period;
+			}
+			else
+			{
+				FreeTimer(Entry.TimerIndex);
+			}
+
+			Owner->ExecutePeriodicEffect(EffectHandle);
+		}
+
+		if (IsEntryValid(Entry))
+		{
+			InsertEntry(Entry);
+		}
+	}
+
+	if (NumActiveTimers > 0)
+	{
+		ScheduleTick();
+	}
+}
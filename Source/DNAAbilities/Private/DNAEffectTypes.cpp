@@ -4,6 +4,7 @@
 #include "DNAEffectTypes.h"
 #include "GameFramework/Pawn.h"
 #include "DNATagAssetInterface.h"
+#include "DNATagsManager.h"
 #include "DNAEffect.h"
 #include "AttributeSet.h"
 #include "GameFramework/Controller.h"
@@ -11,6 +12,7 @@
 #include "AbilitySystemGlobals.h"
 #include "AbilitySystemComponent.h"
 #include "AbilitySystemInterface.h"
+#include "AbilitySystemStats.h"
 
 #if WITH_EDITORONLY_DATA
 const FName FDNAModEvaluationChannelSettings::ForceHideMetadataKey(TEXT("ForceHideEvaluationChannel"));
@@ -363,27 +365,64 @@ FString EDNACueEventToString(int32 Type)
 	return e->GetEnumName(Type);
 }
 
+int32 FDNATagCountContainer::GetTagCount(const FDNATag& Tag) const
+{
+	const int32 TagIndex = UDNATagsManager::Get().GetTagIndex(Tag);
+	if (TagIndex == INDEX_NONE)
+	{
+		// A tag that is not in the dictionary has no parents or children to count, only its explicit count
+		return UnindexedExplicitTagCounts.FindRef(Tag);
+	}
+	return TagCounts.IsValidIndex(TagIndex) ? TagCounts[TagIndex] : 0;
+}
+
+int32 FDNATagCountContainer::GetExplicitTagCount(const FDNATag& Tag) const
+{
+	const int32 TagIndex = UDNATagsManager::Get().GetTagIndex(Tag);
+	if (TagIndex == INDEX_NONE)
+	{
+		return UnindexedExplicitTagCounts.FindRef(Tag);
+	}
+	return ExplicitTagCounts.IsValidIndex(TagIndex) ? ExplicitTagCounts[TagIndex] : 0;
+}
+
 void FDNATagCountContainer::Notify_StackCountChange(const FDNATag& Tag)
 {	
 	// The purpose of this function is to let anyone listening on the EDNATagEventType::AnyCountChange event know that the 
 	// stack count of a GE that was backing this GE has changed. We do not update our internal map/count with this info, since that
 	// map only counts the number of GE/sources that are giving that tag.
-	FDNATagContainer TagAndParentsContainer = Tag.GetDNATagParents();
-	for (auto CompleteTagIt = TagAndParentsContainer.CreateConstIterator(); CompleteTagIt; ++CompleteTagIt)
+	const UDNATagsManager& TagManager = UDNATagsManager::Get();
+	const int32 TagIndex = TagManager.GetTagIndex(Tag);
+	if (TagIndex == INDEX_NONE || DNATagEventMap.Num() == 0)
+	{
+		return;
+	}
+
+	// Copied because the broadcasts below run arbitrary code
+	TArray<int32, TInlineAllocator<8>> TagAndParentIndices(TagManager.GetTagAndParentIndices(TagIndex));
+	for (int32 CurTagIndex : TagAndParentIndices)
 	{
-		const FDNATag& CurTag = *CompleteTagIt;
-		FDelegateInfo* DelegateInfo = DNATagEventMap.Find(CurTag);
+		FDelegateInfo* DelegateInfo = DNATagEventMap.Find(CurTagIndex);
 		if (DelegateInfo)
 		{
-			int32 TagCount = DNATagCountMap.FindOrAdd(CurTag);
-			DelegateInfo->OnAnyChange.Broadcast(CurTag, TagCount);
+			const int32 TagCount = TagCounts.IsValidIndex(CurTagIndex) ? TagCounts[CurTagIndex] : 0;
+			DelegateInfo->OnAnyChange.Broadcast(TagManager.GetTagFromIndex(CurTagIndex), TagCount);
 		}
 	}
 }
 
 FOnDNAEffectTagCountChanged& FDNATagCountContainer::RegisterDNATagEvent(const FDNATag& Tag, EDNATagEventType::Type EventType)
 {
-	FDelegateInfo& Info = DNATagEventMap.FindOrAdd(Tag);
+	const int32 TagIndex = UDNATagsManager::Get().GetTagIndex(Tag);
+	if (TagIndex == INDEX_NONE)
+	{
+		// Would otherwise share one entry with every other tag that is not in the dictionary
+		ABILITY_LOG(Warning, TEXT("RegisterDNATagEvent called with tag %s, which is not in the tag dictionary. Its count changes will not be reported."), *Tag.ToString());
+		UnindexedTagEvent.Clear();
+		return UnindexedTagEvent;
+	}
+
+	FDelegateInfo& Info = DNATagEventMap.FindOrAdd(TagIndex);
 
 	if (EventType == EDNATagEventType::NewOrRemoved)
 	{
@@ -396,14 +435,83 @@ FOnDNAEffectTagCountChanged& FDNATagCountContainer::RegisterDNATagEvent(const FD
 void FDNATagCountContainer::Reset()
 {
 	DNATagEventMap.Reset();
-	DNATagCountMap.Reset();
-	ExplicitTagCountMap.Reset();
+	TagCounts.Reset();
+	ExplicitTagCounts.Reset();
+	UnindexedExplicitTagCounts.Reset();
+	PendingTagChanges.Reset();
+	PendingTagBits.Reset();
 	ExplicitTags.Reset();
+	ActiveTagBits.Reset();
 	OnAnyTagChangeDelegate.Clear();
 }
 
+void FDNATagCountContainer::BeginBatch()
+{
+	++BatchDepth;
+}
+
+DECLARE_CYCLE_STAT(TEXT("FDNATagCountContainer::EndBatch"), STAT_FDNATagCountContainer_EndBatch, STATGROUP_DNAAbilitySystem);
+
+void FDNATagCountContainer::EndBatch()
+{
+	check(BatchDepth > 0);
+	if (--BatchDepth > 0)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_FDNATagCountContainer_EndBatch);
+
+	// Moved out because the broadcasts run arbitrary code, and the counts may change again while they do.
+	// Changes made by the listeners are outside the batch and fire their own delegates right away.
+	TArray<FPendingTagChange> Changes = MoveTemp(PendingTagChanges);
+	PendingTagChanges.Reset();
+
+	for (const FPendingTagChange& Change : Changes)
+	{
+		if (PendingTagBits.IsValidIndex(Change.TagIndex))
+		{
+			PendingTagBits[Change.TagIndex] = false;
+		}
+	}
+
+	for (const FPendingTagChange& Change : Changes)
+	{
+		// A listener may have reset the container, which empties the counts
+		const int32 NewCount = TagCounts.IsValidIndex(Change.TagIndex) ? TagCounts[Change.TagIndex] : 0;
+		BroadcastTagChange(Change.TagIndex, NewCount, (Change.OldCount == 0) != (NewCount == 0));
+	}
+}
+
+void FDNATagCountContainer::BroadcastTagChange(int32 TagIndex, int32 NewCount, bool bSignificantChange)
+{
+	const FDNATag& Tag = UDNATagsManager::Get().GetTagFromIndex(TagIndex);
+
+	if (bSignificantChange)
+	{
+		OnAnyTagChangeDelegate.Broadcast(Tag, NewCount);
+	}
+
+	FDelegateInfo* DelegateInfo = DNATagEventMap.Find(TagIndex);
+	if (DelegateInfo)
+	{
+		// Prior to calling OnAnyChange delegate, copy our OnNewOrRemove delegate, since things listening to OnAnyChange could add or remove 
+		// to this map causing our pointer to become invalid.
+		FOnDNAEffectTagCountChanged OnNewOrRemoveLocalCopy = DelegateInfo->OnNewOrRemove;
+
+		DelegateInfo->OnAnyChange.Broadcast(Tag, NewCount);
+		if (bSignificantChange)
+		{
+			OnNewOrRemoveLocalCopy.Broadcast(Tag, NewCount);
+		}
+	}
+}
+
 bool FDNATagCountContainer::UpdateTagMap_Internal(const FDNATag& Tag, int32 CountDelta)
 {
+	const UDNATagsManager& TagManager = UDNATagsManager::Get();
+	const int32 TagIndex = TagManager.GetTagIndex(Tag);
+
 	const bool bTagAlreadyExplicitlyExists = ExplicitTags.HasTagExact(Tag);
 
 	// Need special case handling to maintain the explicit tag list correctly, adding the tag to the list if it didn't previously exist and a
@@ -414,6 +522,11 @@ bool FDNATagCountContainer::UpdateTagMap_Internal(const FDNATag& Tag, int32 Coun
 		if (CountDelta > 0)
 		{
 			ExplicitTags.AddTag(Tag);
+
+			if (TagIndex != INDEX_NONE)
+			{
+				ActiveTagBits.SetExplicitTagIndex(TagIndex, true);
+			}
 		}
 		// Block attempted reduction of non-explicit tags, as they were never truly added to the container directly
 		else
@@ -427,8 +540,40 @@ bool FDNATagCountContainer::UpdateTagMap_Internal(const FDNATag& Tag, int32 Coun
 		}
 	}
 
-	// Update the explicit tag count map. This has to be separate than the map below because otherwise the count of nested tags ends up wrong
-	int32& ExistingCount = ExplicitTagCountMap.FindOrAdd(Tag);
+	if (TagIndex == INDEX_NONE)
+	{
+		// Not in the dictionary, so there are no parents to count and nothing to notify
+		int32& ExistingCount = UnindexedExplicitTagCounts.FindOrAdd(Tag);
+		ExistingCount = FMath::Max(ExistingCount + CountDelta, 0);
+		if (ExistingCount <= 0)
+		{
+			ExplicitTags.RemoveTag(Tag);
+			UnindexedExplicitTagCounts.Remove(Tag);
+		}
+		return false;
+	}
+
+	// The indices come from the manager's baked parent table, copied because the broadcasts below run arbitrary code
+	TArray<int32, TInlineAllocator<8>> TagAndParentIndices(TagManager.GetTagAndParentIndices(TagIndex));
+
+	// Indices are stable, so the count arrays only need to grow to the highest index counted so far
+	int32 MaxTagIndex = 0;
+	for (int32 CurTagIndex : TagAndParentIndices)
+	{
+		MaxTagIndex = FMath::Max(MaxTagIndex, CurTagIndex);
+	}
+	if (TagCounts.Num() <= MaxTagIndex)
+	{
+		TagCounts.AddZeroed(MaxTagIndex + 1 - TagCounts.Num());
+		ExplicitTagCounts.AddZeroed(MaxTagIndex + 1 - ExplicitTagCounts.Num());
+		while (PendingTagBits.Num() < TagCounts.Num())
+		{
+			PendingTagBits.Add(false);
+		}
+	}
+
+	// Update the explicit tag count. This has to be separate than the counts below because otherwise the count of nested tags ends up wrong
+	int32& ExistingCount = ExplicitTagCounts[TagIndex];
 
 	ExistingCount = FMath::Max(ExistingCount + CountDelta, 0);
 
@@ -437,45 +582,43 @@ bool FDNATagCountContainer::UpdateTagMap_Internal(const FDNATag& Tag, int32 Coun
 	{
 		// Remove from the explicit list
 		ExplicitTags.RemoveTag(Tag);
+		ActiveTagBits.SetExplicitTagIndex(TagIndex, false);
 	}
 
 	// Check if change delegates are required to fire for the tag or any of its parents based on the count change
-	FDNATagContainer TagAndParentsContainer = Tag.GetDNATagParents();
 	bool CreatedSignificantChange = false;
-	for (auto CompleteTagIt = TagAndParentsContainer.CreateConstIterator(); CompleteTagIt; ++CompleteTagIt)
+	for (int32 CurTagIndex : TagAndParentIndices)
 	{
-		const FDNATag& CurTag = *CompleteTagIt;
-
-		// Get the current count of the specified tag. NOTE: Stored as a reference, so subsequent changes propogate to the map.
-		int32& TagCountRef = DNATagCountMap.FindOrAdd(CurTag);
+		const int32 OldCount = TagCounts[CurTagIndex];
 
-		const int32 OldCount = TagCountRef;
-
-		// Apply the delta to the count in the map
-		int32 NewTagCount = FMath::Max(OldCount + CountDelta, 0);
-		TagCountRef = NewTagCount;
+		// Apply the delta to the count
+		const int32 NewTagCount = FMath::Max(OldCount + CountDelta, 0);
+		TagCounts[CurTagIndex] = NewTagCount;
 
 		// If a significant change (new addition or total removal) occurred, trigger related delegates
 		bool SignificantChange = (OldCount == 0 || NewTagCount == 0);
 		CreatedSignificantChange |= SignificantChange;
 		if (SignificantChange)
 		{
-			OnAnyTagChangeDelegate.Broadcast(CurTag, NewTagCount);
+			ActiveTagBits.SetImpliedTagIndex(CurTagIndex, NewTagCount > 0);
 		}
 
-		FDelegateInfo* DelegateInfo = DNATagEventMap.Find(CurTag);
-		if (DelegateInfo)
+		if (BatchDepth > 0)
 		{
-			// Prior to calling OnAnyChange delegate, copy our OnNewOrRemove delegate, since things listening to OnAnyChange could add or remove 
-			// to this map causing our pointer to become invalid.
-			FOnDNAEffectTagCountChanged OnNewOrRemoveLocalCopy = DelegateInfo->OnNewOrRemove;
-
-			DelegateInfo->OnAnyChange.Broadcast(CurTag, NewTagCount);
-			if (SignificantChange)
+			// Fired once with the final count when the batch ends
+			if (!PendingTagBits[CurTagIndex])
 			{
-				OnNewOrRemoveLocalCopy.Broadcast(CurTag, NewTagCount);
+				PendingTagBits[CurTagIndex] = true;
+
+				FPendingTagChange& Change = PendingTagChanges[PendingTagChanges.AddUninitialized()];
+				Change.TagIndex = CurTagIndex;
+				Change.OldCount = OldCount;
 			}
 		}
+		else
+		{
+			BroadcastTagChange(CurTagIndex, NewTagCount, SignificantChange);
+		}
 	}
 
 	return CreatedSignificantChange;
@@ -489,6 +632,68 @@ bool FDNATagRequirements::RequirementsMet(const FDNATagContainer& Container) con
 	return HasRequired && !HasIgnored;
 }
 
+bool FDNATagRequirements::RequirementsMet(const FDNATagBitContainer& ContainerBits) const
+{
+	// A required tag that is not in the dictionary has no bit, and no container can have it
+	bool HasRequired = RequireTags.IsEmpty() || (ContainerBits.HasAll(RequireTagBits.Get(RequireTags)) && !RequireTagBits.HasUnindexedTags());
+	bool HasIgnored = !IgnoreTags.IsEmpty() && ContainerBits.HasAny(IgnoreTagBits.Get(IgnoreTags));
+
+	return HasRequired && !HasIgnored;
+}
+
+void FDNATagRequirements::RequirementsMetBatch(TArrayView<const FDNATagBitContainer* const> Containers, TBitArray<>& OutResults) const
+{
+	const FDNATagBitContainer& RequireBits = RequireTagBits.Get(RequireTags);
+	const FDNATagBitContainer& IgnoreBits = IgnoreTagBits.Get(IgnoreTags);
+
+	// Same as RequirementsMet, a required tag that is not in the dictionary is never met
+	if (RequireTagBits.HasUnindexedTags())
+	{
+		OutResults.Init(false, Containers.Num());
+		return;
+	}
+
+	FDNATagBitBatch Batch;
+	for (int32 WordIndex : RequireBits.GetExplicitWordIndices())
+	{
+		Batch.AddWord(WordIndex);
+	}
+	for (int32 WordIndex : IgnoreBits.GetExplicitWordIndices())
+	{
+		Batch.AddWord(WordIndex);
+	}
+	Batch.Gather(Containers);
+
+	FDNATagBitBatch::FLanes Lanes;
+	Batch.InitLanes(Lanes, true);
+	for (int32 WordIndex : RequireBits.GetExplicitWordIndices())
+	{
+		Batch.TestAll(WordIndex, RequireBits.GetExplicitWord(WordIndex), Lanes);
+	}
+
+	FDNATagBitBatch::FLanes IgnoredLanes;
+	Batch.InitLanes(IgnoredLanes, false);
+	for (int32 WordIndex : IgnoreBits.GetExplicitWordIndices())
+	{
+		Batch.TestAny(WordIndex, IgnoreBits.GetExplicitWord(WordIndex), IgnoredLanes);
+	}
+
+	for (int32 LaneWord = 0; LaneWord < Lanes.Num(); ++LaneWord)
+	{
+		Lanes[LaneWord] &= ~IgnoredLanes[LaneWord];
+	}
+
+	Batch.LanesToBitArray(Lanes, OutResults);
+
+	for (int32 SetIdx = 0; SetIdx < Containers.Num(); ++SetIdx)
+	{
+		if (Containers[SetIdx] == nullptr)
+		{
+			OutResults[SetIdx] = false;
+		}
+	}
+}
+
 bool FDNATagRequirements::IsEmpty() const
 {
 	return (RequireTags.Num() == 0 && IgnoreTags.Num() == 0);
@@ -843,47 +1048,57 @@ const UObject* FDNACueParameters::GetSourceObject() const
 	return EffectContext.GetSourceObject();
 }
 
-bool FMinimalReplicationTagCountMap::NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+bool FMinimalReplicationTagCountMap::NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
 {
-	const int32 CountBits = UDNAAbilitySystemGlobals::Get().MinimalReplicationTagCountBits;
-	const int32 MaxCount = ((1 << CountBits)-1);
+	if (DeltaParms.bUpdateUnmappedObjects)
+	{
+		return true;
+	}
 
-	if (Ar.IsSaving())
+	const UDNAAbilitySystemGlobals& Globals = UDNAAbilitySystemGlobals::Get();
+	const int32 CountBits = Globals.MinimalReplicationTagCountBits;
+
+	if (DeltaParms.Writer)
+	{
+		const int32 MaxCount = ((1 << CountBits)-1);
+		if (TagMap.Num() > MaxCount)
+		{
+			ABILITY_LOG(Error, TEXT("FMinimapReplicationTagCountMap has too many tags (%d). This will cause tags to not replicate. See FMinimapReplicationTagCountMap::NetDeltaSerialize"), TagMap.Num());
+		}
+
+		TArray<FDNATag> Tags;
+		TagMap.GenerateKeyArray(Tags);
+		return FDNATagNetDelta::Write(DeltaParms, Tags, MapID, CountBits, Globals.bDeltaSerializeMinimalReplicationTags);
+	}
+	else if (DeltaParms.Reader)
 	{
-		int32 Count = TagMap.Num();
-		if (Count > MaxCount)
+		bool bFullState = false;
+		TArray<FDNATag> AddedTags;
+		TArray<FDNATag> RemovedTags;
+		if (!FDNATagNetDelta::Read(DeltaParms, CountBits, bFullState, AddedTags, RemovedTags))
 		{
-			ABILITY_LOG(Error, TEXT("FMinimapReplicationTagCountMap has too many tags (%d). This will cause tags to not replicate. See FMinimapReplicationTagCountMap::NetSerialize"), TagMap.Num());
-			Count = MaxCount;
+			return false;
 		}
 
-		Ar.SerializeBits(&Count, CountBits);
-		for(auto& It : TagMap)
+		if (bFullState)
 		{
-			FDNATag& Tag = It.Key;
-			Tag.NetSerialize(Ar, Map, bOutSuccess);
-			if (--Count <= 0)
+			// Reset our local map
+			for(auto& It : TagMap)
 			{
-				break;
+				It.Value = 0;
 			}
 		}
-	}
-	else
-	{
-		int32 Count = TagMap.Num();
-		Ar.SerializeBits(&Count, CountBits);
 
-		// Reset our local map
-		for(auto& It : TagMap)
+		for (const FDNATag& Tag : RemovedTags)
 		{
-			It.Value = 0;
+			if (int32* Count = TagMap.Find(Tag))
+			{
+				*Count = 0;
+			}
 		}
 
-		// See what we have
-		while(Count-- > 0)
+		for (const FDNATag& Tag : AddedTags)
 		{
-			FDNATag Tag;
-			Tag.NetSerialize(Ar, Map, bOutSuccess);
 			TagMap.FindOrAdd(Tag) = 1;
 		}
 
@@ -897,7 +1112,5 @@ bool FMinimalReplicationTagCountMap::NetSerialize(FArchive& Ar, class UPackageMa
 		}
 	}
 
-
-	bOutSuccess = true;
 	return true;
 }
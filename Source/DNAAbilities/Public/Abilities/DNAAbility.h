@@ -741,6 +741,10 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Category = Tags)
 	FDNATagContainer TargetBlockedTags;
 
+	/** Bitsets of ActivationRequiredTags and ActivationBlockedTags, matched against the owner's tag bits in DoesAbilitySatisfyTagRequirements */
+	FDNATagBitContainerCache ActivationRequiredTagBits;
+	FDNATagBitContainerCache ActivationBlockedTagBits;
+
 
 	// ----------------------------------------------------------------------------------------------------------------
 	//
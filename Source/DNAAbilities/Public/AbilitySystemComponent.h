@@ -405,7 +405,7 @@ class DNAABILITIES_API UDNAAbilitySystemComponent : public UDNATasksComponent, p
 	 * 
 	 * @param Handle	Handle of the DNA effect to retrieve target tags from
 	 * 
-	 * @return Target tags from the DNA spec represented by the handle, if possible
+	 * @return Target tags from the DNA spec represented by the handle, if possible. With bSkipUnreadTargetTagCaptures set in the ability system globals, a periodic effect that doesn't read them may still hold the tags from application
 	 */
 	const FDNATagContainer* GetDNAEffectTargetTagsFromHandle(FActiveDNAEffectHandle Handle) const
 	{
@@ -487,6 +487,12 @@ class DNAABILITIES_API UDNAAbilitySystemComponent : public UDNATasksComponent, p
 		TagContainer.AppendTags(DNATagCountContainer.GetExplicitDNATags());
 	}
 
+	/** Returns a bitset view of the owned DNA tags, for fast matching against cached FDNATagBitContainers */
+	FORCEINLINE const FDNATagBitContainer& GetOwnedDNATagBits() const
+	{
+		return DNATagCountContainer.GetActiveTagBits();
+	}
+
 	FORCEINLINE int32 GetTagCount(FDNATag TagToCheck) const
 	{
 		return DNATagCountContainer.GetTagCount(TagToCheck);
@@ -1411,6 +1417,21 @@ public:
 		}
 	}	
 
+	/**
+	 * UpdateTagMap for callers that batch the count updates, see FDNATagCountContainer::BeginBatch. Instead of calling OnTagUpdated right away it adds
+	 * the tags it would be called for to OutUpdatedTags, so the caller can call it after the batch ends and the count delegates have fired, like UpdateTagMap does.
+	 */
+	FORCEINLINE void UpdateTagMapDeferred(const FDNATagContainer& Container, int32 CountDelta, TArray<FDNATag>& OutUpdatedTags)
+	{
+		for (auto TagIt = Container.CreateConstIterator(); TagIt; ++TagIt)
+		{
+			if (DNATagCountContainer.UpdateTagCount(*TagIt, CountDelta))
+			{
+				OutUpdatedTags.Add(*TagIt);
+			}
+		}
+	}
+
 
 #if ENABLE_VISUAL_LOG
 	void ClearDebugInstantEffects();
@@ -1498,6 +1519,7 @@ protected:
 	friend struct FDNAAbilitySpec;
 	friend struct FDNAAbilitySpecContainer;
 	friend struct FAggregator;
+	friend class FDNAEffectTimerWheel;
 
 private:
 	FDelegateHandle MonitoredTagChangedDelegateHandle;
@@ -13,6 +13,7 @@
 #include "AbilitySystemGlobals.generated.h"
 
 class UDNAAbilitySystemComponent;
+class FDNAEffectTimerWheel;
 class UDNACueManager;
 class UDNATagReponseTable;
 struct FDNAAbilityActorInfo;
@@ -72,6 +73,12 @@ class DNAABILITIES_API UDNAAbilitySystemGlobals : public UObject
 		return PredictTargetDNAEffects;
 	}
 
+	/** Returns true if periodic effects that don't read the target's tags should keep the tags captured on application instead of recapturing them on every execution */
+	bool ShouldSkipUnreadTargetTagCaptures() const
+	{
+		return bSkipUnreadTargetTagCaptures;
+	}
+
 	/** Searches the passed in class to look for a UFunction implementing the DNA cue tag, sets MatchedTag to the exact tag found */
 	UFunction* GetDNACueFunction(const FDNATag &Tag, UClass* Class, FName &MatchedTag);
 
@@ -81,6 +88,12 @@ class DNAABILITIES_API UDNAAbilitySystemGlobals : public UObject
 	/** Returns the DNA tag response object, creating if necessary */
 	UDNATagReponseTable* GetDNATagResponseTable();
 
+	/** Returns the wheel that schedules the durations and periods of the active effects in World, creating it if necessary */
+	FDNAEffectTimerWheel& GetEffectTimerWheel(UWorld* World);
+
+	/** Returns the effect timer wheel of World if it has one. Use this to clear timers so a world that is being cleaned up does not get a new wheel */
+	FDNAEffectTimerWheel* FindEffectTimerWheel(UWorld* World) const;
+
 	/** Sets a default DNA cue tag using the asset's name. Returns true if it changed the tag. */
 	static bool DeriveDNACueTagFromAssetName(FString AssetName, FDNATag& DNACueTag, FName& DNACueName);
 
@@ -177,10 +190,14 @@ class DNAABILITIES_API UDNAAbilitySystemGlobals : public UObject
 	UPROPERTY(config)
 	FName ActivateFailNetworkingName;
 
-	/** How many bits to use for "number of tags" in FMinimapReplicationTagCountMap::NetSerialize.  */
+	/** How many bits to use for "number of tags" in FMinimalReplicationTagCountMap::NetDeltaSerialize.  */
 	UPROPERTY(config)
 	int32	MinimalReplicationTagCountBits;
 
+	/** If true, FMinimalReplicationTagCountMap only sends the tags added and removed since the last acknowledged state instead of every tag */
+	UPROPERTY(config)
+	bool	bDeltaSerializeMinimalReplicationTags;
+
 	virtual void InitGlobalTags()
 	{
 		if (ActivateFailCooldownName != NAME_None)
@@ -303,6 +320,13 @@ protected:
 	UPROPERTY(config)
 	bool PredictTargetDNAEffects;
 
+	/**
+	 * Set to true to skip recapturing the target's tags when an active effect executes and nothing reads them. Attribute sets that read
+	 * CapturedTargetTags in PreDNAEffectExecute or PostDNAEffectExecute, and GetDNAEffectTargetTagsFromHandle, then see the tags from application
+	 */
+	UPROPERTY(config)
+	bool bSkipUnreadTargetTagCaptures;
+
 	UPROPERTY()
 	UCurveTable* GlobalCurveTable;
 
@@ -330,6 +354,14 @@ protected:
 	void ResetCachedData();
 	void HandlePreLoadMap(const FString& MapName);
 
+	/** Drops the effect timer wheel of a world that is going away */
+	void HandleWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources);
+
+	/** Effect timer wheels by world, see GetEffectTimerWheel */
+	TMap<TWeakObjectPtr<UWorld>, TSharedPtr<FDNAEffectTimerWheel>> EffectTimerWheels;
+
+	FDelegateHandle WorldCleanupHandle;
+
 #if WITH_EDITORONLY_DATA
 	bool RegisteredReimportCallback;
 #endif
@@ -28,6 +28,10 @@ DECLARE_CYCLE_STAT_EXTERN(TEXT("InitAttributeSetDefaults"), STAT_InitAttributeSe
 DECLARE_CYCLE_STAT_EXTERN(TEXT("TickDNAAbilityTasks"), STAT_TickDNAAbilityTasks, STATGROUP_DNAAbilitySystem, );
 DECLARE_CYCLE_STAT_EXTERN(TEXT("FindAbilitySpecFromHandle"), STAT_FindAbilitySpecFromHandle, STATGROUP_DNAAbilitySystem, );
 DECLARE_CYCLE_STAT_EXTERN(TEXT("Aggregator Evaluate"), STAT_AggregatorEvaluate, STATGROUP_DNAAbilitySystem, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Aggregator Evaluate Cache Hits"), STAT_AggregatorEvaluateCacheHits, STATGROUP_DNAAbilitySystem, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Aggregator Evaluate Cache Misses"), STAT_AggregatorEvaluateCacheMisses, STATGROUP_DNAAbilitySystem, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("DNAEffect Target Tag Captures"), STAT_DNAEffectTargetTagCaptures, STATGROUP_DNAAbilitySystem, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("DNAEffect Target Tag Captures Skipped"), STAT_DNAEffectTargetTagCapturesSkipped, STATGROUP_DNAAbilitySystem, );
 DECLARE_CYCLE_STAT_EXTERN(TEXT("Has Application Immunity To Spec"), STAT_HasApplicationImmunityToSpec, STATGROUP_DNAAbilitySystem, );
 DECLARE_CYCLE_STAT_EXTERN(TEXT("Has Matching DNATag"), STAT_HasMatchingDNATag, STATGROUP_DNAAbilitySystem, );
 DECLARE_CYCLE_STAT_EXTERN(TEXT("DNACueNotify Static"), STAT_HandleDNACueNotifyStatic, STATGROUP_DNAAbilitySystem, );
@@ -310,6 +310,12 @@ public:
 
 	static void InvalidateAllCachedCurves();
 
+	/** Incremented by InvalidateAllCachedCurves, for caches of curve values to know when they are stale */
+	static int32 GetGlobalCachedCurveID()
+	{
+		return GlobalCachedCurveID;
+	}
+
 private:
 
 	// Cached direct pointer to RichCurve we should evaluate
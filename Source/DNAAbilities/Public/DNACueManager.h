@@ -16,6 +16,8 @@
 #include "DNACueTranslator.h"
 #include "DNACueManager.generated.h"
 
+struct FDNATagTreeChangeSet;
+
 #define DNACUE_DEBUG 0
 
 class ADNACueNotify_Actor;
@@ -253,6 +255,9 @@ public:
 
 	bool VerifyNotifyAssetIsInValidPath(FString Path);
 
+	/** Patches the cue sets' acceleration maps when tags are added or removed in the editor */
+	void HandleDNATagTreeChangeSet(const FDNATagTreeChangeSet& ChangeSet);
+
 	bool bAccelerationMapOutdated;
 
 	FOnDNACueNotifyChange	OnDNACueNotifyAddOrRemove;
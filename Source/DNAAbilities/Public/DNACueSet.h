@@ -10,6 +10,8 @@
 #include "DNAEffectTypes.h"
 #include "DNACueSet.generated.h"
 
+struct FDNATagTreeChangeSet;
+
 USTRUCT()
 struct FDNACueNotifyData
 {
@@ -79,6 +81,9 @@ class DNAABILITIES_API UDNACueSet : public UDataAsset
 	/** Updates an existing cue */
 	virtual void UpdateCueByStringRefs(const FStringAssetReference& CueToRemove, FString NewPath);
 
+	/** Patches the acceleration map for tags added to or removed from the tag tree, instead of rebuilding it */
+	virtual void UpdateAccelerationMapForTagChanges(const FDNATagTreeChangeSet& ChangeSet);
+
 #endif
 
 	/** Removes all cues from the set */
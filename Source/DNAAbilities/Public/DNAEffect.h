@@ -15,6 +15,7 @@
 #include "EngineDefines.h"
 #include "DNAEffectTypes.h"
 #include "DNAEffectAggregator.h"
+#include "DNAEffectTimerWheel.h"
 #include "DNAPrediction.h"
 #include "DNATagAssetInterface.h"
 #include "DNAAbilitySpec.h"
@@ -326,6 +327,7 @@ protected:
 	// @hack: @todo: This is temporary to aid in post-load fix-up w/o exposing members publicly
 	friend class UDNAEffect;
 	friend class FDNAEffectModifierMagnitudeDetails;
+	friend struct FDNAEffectPlannedModifier;
 };
 
 /** 
@@ -1239,9 +1241,11 @@ struct DNAABILITIES_API FActiveDNAEffect : public FFastArraySerializerItem
 
 	FOnActiveDNAEffectTimeChange OnTimeChangeDelegate;
 
-	FTimerHandle PeriodHandle;
+	/** Period timer in the world's FDNAEffectTimerWheel */
+	FDNAEffectTimerHandle PeriodHandle;
 
-	FTimerHandle DurationHandle;
+	/** Duration timer in the world's FDNAEffectTimerWheel */
+	FDNAEffectTimerHandle DurationHandle;
 
 	FActiveDNAEffect* PendingNext;
 };
@@ -1518,7 +1522,7 @@ struct DNAABILITIES_API FActiveDNAEffectsContainer : public FFastArraySerializer
 	 * 
 	 * @param Handle	Handle of the DNA effect to retrieve target tags from
 	 * 
-	 * @return Target tags from the DNA spec represented by the handle, if possible
+	 * @return Target tags from the DNA spec represented by the handle, if possible. With bSkipUnreadTargetTagCaptures set in the ability system globals, a periodic effect that doesn't read them may still hold the tags from application
 	 */
 	const FDNATagContainer* GetDNAEffectTargetTagsFromHandle(FActiveDNAEffectHandle Handle) const;
 
@@ -1736,8 +1740,48 @@ private:
 
 	void UpdateAggregatorModMagnitudes(const TSet<FDNAAttribute>& AttributesToUpdate, FActiveDNAEffect& ActiveEffect);
 
+	/** Adds the dependencies the non snapshot captures of the effect's modifiers create to AggregatorDependencies, reporting the ones that would be cyclic */
+	void AddAggregatorDependencies(const FActiveDNAEffect& Effect);
+
+	/** True unless the globals opt in to bSkipUnreadTargetTagCaptures, then only if executing the spec, or the applied and periodic delegates broadcast after it, read the owner's tags from the spec */
+	bool ShouldCaptureTargetTagsOnExecute(const FDNAEffectSpec& Spec) const;
+
 	/** Helper function to find the active GE that the specified spec can stack with, if any */
 	FActiveDNAEffect* FindStackableActiveDNAEffect(const FDNAEffectSpec& Spec);
+
+	/** Identifies the effects that stack with each other: same def, and the same source for AggregateBySource stacking */
+	struct FStackingIndexKey
+	{
+		FStackingIndexKey(const FDNAEffectSpec& Spec);
+
+		const UDNAEffect* Def;
+		const UDNAAbilitySystemComponent* SourceASC;
+
+		bool operator==(const FStackingIndexKey& Other) const
+		{
+			return Def == Other.Def && SourceASC == Other.SourceASC;
+		}
+
+		friend uint32 GetTypeHash(const FStackingIndexKey& Key)
+		{
+			return HashCombine(PointerHash(Key.Def), PointerHash(Key.SourceASC));
+		}
+	};
+
+	struct FStackingIndexEntry
+	{
+		/** The effect FindStackableActiveDNAEffect returns for this key, the first one in iteration order */
+		FActiveDNAEffectHandle Handle;
+
+		/** Active effects with this key. Usually one, predicted and replicated copies of an effect can briefly make it more */
+		int32 NumEffects;
+	};
+
+	void AddToStackingIndex(const FActiveDNAEffect& Effect);
+
+	void RemoveFromStackingIndex(const FActiveDNAEffect& Effect);
+
+	void RebuildStackingIndex();
 	
 	/** Helper function to handle the case of same-effect stacking overflow; Returns true if the overflow application should apply, false if it should not */
 	bool HandleActiveDNAEffectStackOverflow(const FActiveDNAEffect& ActiveStackableGE, const FDNAEffectSpec& OldSpec, const FDNAEffectSpec& OverflowingSpec);
@@ -1747,6 +1791,29 @@ private:
 
 	bool ShouldUseMinimalReplication();
 
+	/** Returns the index of the effect with Handle, as used by GetActiveDNAEffect(int32), or INDEX_NONE. Includes effects pending removal */
+	int32 FindActiveDNAEffectIndex(FActiveDNAEffectHandle Handle) const;
+
+	void RebuildHandleToIndexMap() const;
+
+	/** Removes DNAEffects_Internal[Idx], keeping HandleToIndexMap in sync with the element swapped into its place */
+	void RemoveDNAEffectAtSwap(int32 Idx, bool bAllowShrinking);
+
+	/** Index in DNAEffects_Internal of each handle. Lookups check the entry they land on, and rebuild the map if it is out of date */
+	mutable TMap<FActiveDNAEffectHandle, int32> HandleToIndexMap;
+
+	/** Set when DNAEffects_Internal was changed without updating HandleToIndexMap, as replication does */
+	mutable bool bHandleToIndexMapDirty;
+
+	/** The active stacking effects by stacking key, see FindStackableActiveDNAEffect */
+	TMap<FStackingIndexKey, FStackingIndexEntry> StackingIndex;
+
+	/** Set when an effect's stacking key may have changed without going through the add and remove callbacks, as replication can do */
+	bool bStackingIndexDirty;
+
+	/** How the aggregators of the attributes our effects modify depend on the aggregators they capture, which orders the recompute of dirty aggregators */
+	FAggregatorDependencyGraph AggregatorDependencies;
+
 	mutable int32 ScopedLockCount;
 	int32 PendingRemoves;
 
@@ -1795,6 +1862,83 @@ private:
 #define DNAEFFECT_SCOPE_LOCK()	FScopedActiveDNAEffectLock ActiveScopeLock(*this);
 
 
+// -------------------------------------------------------------------------------------
+
+/** The magnitude of a UDNAEffect modifier as FDNAEffectExecutionPlan baked it */
+struct DNAABILITIES_API FDNAEffectPlannedModifier
+{
+	FDNAEffectPlannedModifier()
+		: BakedCoefficient(0.f)
+		, bMagnitudeScalesWithLevel(false)
+	{
+	}
+
+	/**
+	 * Returns the magnitude baked for the modifier at Level. False if there is none, or if the modifier was changed since it was baked,
+	 * and the magnitude has to be calculated.
+	 */
+	FORCEINLINE bool GetBakedMagnitude(const FDNAModifierInfo& ModDef, float Level, float& OutMagnitude) const
+	{
+		const FDNAEffectModifierMagnitude& Magnitude = ModDef.ModifierMagnitude;
+		if (BakedMagnitudes.Num() == 0 || Magnitude.MagnitudeCalculationType != EDNAEffectMagnitudeCalculation::ScalableFloat
+			|| Magnitude.ScalableFloatMagnitude.Value != BakedCoefficient || !(Magnitude.ScalableFloatMagnitude.Curve == BakedCurve))
+		{
+			return false;
+		}
+
+		if (!bMagnitudeScalesWithLevel)
+		{
+			OutMagnitude = BakedMagnitudes[0];
+			return true;
+		}
+
+		const int32 LevelIdx = FMath::TruncToInt(Level);
+		if (LevelIdx == Level && BakedMagnitudes.IsValidIndex(LevelIdx))
+		{
+			OutMagnitude = BakedMagnitudes[LevelIdx];
+			return true;
+		}
+		return false;
+	}
+
+	/** Scalable float magnitudes at every integer level from 0 if the magnitude has a curve, else a single value for every level. Empty if not baked */
+	TArray<float> BakedMagnitudes;
+
+	/** The scalable float the magnitudes were baked from */
+	float BakedCoefficient;
+	FCurveTableRowHandle BakedCurve;
+
+	bool bMagnitudeScalesWithLevel;
+};
+
+/**
+ * What applying and executing a UDNAEffect needs from its definition, compiled once so specs do not walk the modifiers, executions and cues
+ * every time. Built on first use after the definition is loaded or edited, see UDNAEffect::GetExecutionPlan.
+ */
+struct DNAABILITIES_API FDNAEffectExecutionPlan
+{
+	FDNAEffectExecutionPlan()
+		: bReadsTargetTagsOnExecute(false)
+		, CurveGeneration(INDEX_NONE)
+	{
+	}
+
+	/** Highest level scalable float curves are baked up to, higher levels evaluate the curve */
+	static const int32 MaxBakedLevel = 100;
+
+	/** One for each modifier of the definition, in the same order. Attributes and ops are still read from the definition */
+	TArray<FDNAEffectPlannedModifier> Modifiers;
+
+	/** Attribute capture definitions of the duration, modifiers and executions, without duplicates. Specs of this effect capture exactly these */
+	TArray<FDNAEffectAttributeCaptureDefinition> AttributeCaptureDefinitions;
+
+	/** True if executing the effect reads the target's tags: attribute based or custom calculated modifiers, custom executions and cues */
+	bool bReadsTargetTagsOnExecute;
+
+	/** FScalableFloat curve generation the magnitudes were baked against, the plan is compiled again when curves are reimported */
+	int32 CurveGeneration;
+};
+
 // -------------------------------------------------------------------------------------
 
 /**
@@ -1984,4 +2128,40 @@ public:
 	
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Granted Abilities")
 	TArray<FDNAAbilitySpecDef>	GrantedAbilities;
+
+	// ----------------------------------------------------------------------
+	//	Execution plan
+	// ----------------------------------------------------------------------
+
+	/**
+	 * Returns the compiled plan of this definition, compiling it if the definition was loaded or edited since, or if modifiers were added or removed.
+	 * Code that changes a definition after it was used in a spec should call InvalidateExecutionPlan, baked magnitudes are checked against the definition either way.
+	 */
+	const FDNAEffectExecutionPlan& GetExecutionPlan() const;
+
+	/**
+	 * Attribute capture definitions of the duration, modifiers and executions, without duplicates. Specs of this effect capture exactly these.
+	 * This only caches the list, specs captured the same attributes before it existed
+	 */
+	const TArray<FDNAEffectAttributeCaptureDefinition>& GetAttributeCaptureDefinitions() const
+	{
+		return GetExecutionPlan().AttributeCaptureDefinitions;
+	}
+
+	/** True if executing this effect reads the target's tags: attribute based or custom calculated modifiers, custom executions and cues */
+	bool ReadsTargetTagsOnExecute() const
+	{
+		return GetExecutionPlan().bReadsTargetTagsOnExecute;
+	}
+
+	/** Discards the compiled plan, it is compiled again on next use. Called whenever the definition may have changed */
+	void InvalidateExecutionPlan();
+
+private:
+
+	/** Compiles ExecutionPlan. The calculation class CDOs it asks may not be loaded yet on PostLoad, so this waits for the first spec */
+	void CompileExecutionPlan() const;
+
+	mutable FDNAEffectExecutionPlan ExecutionPlan;
+	mutable bool bExecutionPlanCompiled;
 };
@@ -14,6 +14,8 @@ struct DNAABILITIES_API FAggregatorEvaluateParameters
 		: SourceTags(nullptr)
 		, TargetTags(nullptr)
 		, IncludePredictiveMods(false) 
+		, bSourceTagBitsValid(false)
+		, bTargetTagBitsValid(false)
 	{}
 
 	const FDNATagContainer* SourceTags;
@@ -29,6 +31,26 @@ struct DNAABILITIES_API FAggregatorEvaluateParameters
 	FDNATagContainer AppliedTargetTagFilter;
 
 	bool IncludePredictiveMods;
+
+	/** Bitset view of SourceTags, built the first time a mod with source tag requirements is qualified */
+	const FDNATagBitContainer& GetSourceTagBits() const;
+
+	/** Bitset view of TargetTags, built the first time a mod with target tag requirements is qualified */
+	const FDNATagBitContainer& GetTargetTagBits() const;
+
+	/** Invalidates the bitset views. Called at the start of every channel evaluation, since SourceTags/TargetTags may change between evaluations */
+	void ResetTagBits() const
+	{
+		bSourceTagBitsValid = false;
+		bTargetTagBitsValid = false;
+	}
+
+private:
+
+	mutable FDNATagBitContainer SourceTagBits;
+	mutable FDNATagBitContainer TargetTagBits;
+	mutable bool bSourceTagBitsValid;
+	mutable bool bTargetTagBitsValid;
 };
 
 struct DNAABILITIES_API FAggregatorMod
@@ -45,9 +67,20 @@ struct DNAABILITIES_API FAggregatorMod
 	bool Qualifies(const FAggregatorEvaluateParameters& Parameters) const;
 };
 
-/** Struct representing an individual aggregation channel/depth. Contains mods of all mod op types. */
+/**
+ * Struct representing an individual aggregation channel/depth. Contains mods of all mod op types.
+ *
+ * Besides the mods themselves, the channel keeps a grouped view of its numeric mods that is rebuilt on the first evaluation after a change:
+ * the magnitudes of the mods that always qualify are summed up front, and the others are summed per set of tag requirements, so an evaluation
+ * qualifies each set once instead of every mod. Evaluations that ignore handles or filter by applied tags still qualify mod by mod.
+ */
 struct DNAABILITIES_API FAggregatorModChannel
 {
+	FAggregatorModChannel()
+		: bModGroupsDirty(true)
+	{
+	}
+
 	/**
 	 * Evaluates the channel's mods with the specified base value and evaluation parameters
 	 * 
@@ -126,15 +159,58 @@ struct DNAABILITIES_API FAggregatorModChannel
 	 */
 	static float SumMods(const TArray<FAggregatorMod>& InMods, float Bias, const FAggregatorEvaluateParameters& Parameters);
 
+	/**
+	 * Reports whether any mod in the channel has source or target tag requirements, and so depends on the evaluation tags
+	 * 
+	 * @param bOutUsesSourceTags	[OUT] Set to true if a mod has source tag requirements, left untouched otherwise
+	 * @param bOutUsesTargetTags	[OUT] Set to true if a mod has target tag requirements, left untouched otherwise
+	 */
+	void GetTagRequirementUsage(OUT bool& bOutUsesSourceTags, OUT bool& bOutUsesTargetTags) const;
+
 private:
 
+	/** Numeric mods of one op that have the same tag requirements and prediction, and so qualify or fail together */
+	struct FModGroup
+	{
+		const FDNATagRequirements* SourceTagReqs;
+		const FDNATagRequirements* TargetTagReqs;
+
+		/** Sum of (EvaluatedMagnitude - Bias) over the mods of the group */
+		float Sum;
+		bool bIsPredicted;
+
+		bool Qualifies(const FAggregatorEvaluateParameters& Parameters) const;
+	};
+
+	/** Grouped view of the mods of one numeric op */
+	struct FModOpGroups
+	{
+		/** Sum of (EvaluatedMagnitude - Bias) over the mods without tag requirements that are not predicted */
+		float UnconditionalSum;
+
+		/** Every other mod, one entry per distinct set of requirements */
+		TArray<FModGroup> ConditionalGroups;
+	};
+
+	/** Sums the numeric mods that qualify, from the grouped view when Parameters allow it */
+	void SumNumericMods(const FAggregatorEvaluateParameters& Parameters, OUT float& OutAdditive, OUT float& OutMultiplicitive, OUT float& OutDivision) const;
+
+	/** Rebuilds ModGroups if the mods changed since the last time */
+	void UpdateModGroups() const;
+
 	/** Collection of modifers within the channel, organized by modifier operation */
 	TArray<FAggregatorMod> Mods[EDNAModOp::Max];
+
+	/** Grouped view of Mods for each numeric op, valid while bModGroupsDirty is false */
+	mutable FModOpGroups ModGroups[EDNAModOp::Override];
+	mutable bool bModGroupsDirty;
 };
 
 /** Struct representing a container of modifier channels */
 struct DNAABILITIES_API FAggregatorModChannelContainer
 {
+	FAggregatorModChannelContainer();
+
 	/**
 	 * Find or add a modifier channel for the specified enum value
 	 * 
@@ -218,10 +294,24 @@ struct DNAABILITIES_API FAggregatorModChannelContainer
 	 */
 	void OnActiveEffectDependenciesSwapped(const TMap<FActiveDNAEffectHandle, FActiveDNAEffectHandle>& SwappedDependencies);
 
+	/**
+	 * Reports whether any mod in any channel has source or target tag requirements, and so depends on the evaluation tags
+	 * 
+	 * @param bOutUsesSourceTags	[OUT] True if a mod has source tag requirements
+	 * @param bOutUsesTargetTags	[OUT] True if a mod has target tag requirements
+	 */
+	void GetTagRequirementUsage(OUT bool& bOutUsesSourceTags, OUT bool& bOutUsesTargetTags) const;
+
 private:
 
-	/** Mapping of evaluation channel enumeration to actual struct representation */
-	TMap<EDNAModEvaluationChannel, FAggregatorModChannel> ModChannelsMap;
+	/** Channels that have been added, in ascending channel order */
+	TArray<FAggregatorModChannel> ModChannels;
+
+	/** Evaluation channel of each entry of ModChannels */
+	TArray<EDNAModEvaluationChannel> ModChannelEnums;
+
+	/** Index into ModChannels of each evaluation channel, or INDEX_NONE if it was not added */
+	int8 ModChannelSlots[static_cast<int32>(EDNAModEvaluationChannel::Channel_MAX)];
 };
 
 struct DNAABILITIES_API FAggregator : public TSharedFromThis<FAggregator>
@@ -232,6 +322,11 @@ struct DNAABILITIES_API FAggregator : public TSharedFromThis<FAggregator>
 		: NetUpdateID(0)
 		, BaseValue(InBaseValue)
 		, bIsBroadcastingDirty(false)
+		, DependencyRank(0)
+		, NextCachedEvaluation(0)
+		, bTagRequirementUsageValid(false)
+		, bModsUseSourceTags(false)
+		, bModsUseTargetTags(false)
 	{}
 	
 	~FAggregator();
@@ -251,7 +346,11 @@ struct DNAABILITIES_API FAggregator : public TSharedFromThis<FAggregator>
 	/** Updates the aggregators for the past in handle, this will handle it so the UAttributeSets stats only get one update for the delta change */
 	void UpdateAggregatorMod(FActiveDNAEffectHandle ActiveHandle, const FDNAAttribute& Attribute, const FDNAEffectSpec& Spec, bool bWasLocallyGenerated, FActiveDNAEffectHandle InHandle);
 
-	/** Evaluates the Aggregator with the internal base value and given parameters */
+	/**
+	 * Evaluates the Aggregator with the internal base value and given parameters.
+	 * Results are cached by the evaluation tags the mods actually test, until the base value or the mods change.
+	 * Evaluations that ignore handles or filter by applied tags are not cached.
+	 */
 	float Evaluate(const FAggregatorEvaluateParameters& Parameters) const;
 
 	/** Evaluates the aggregator with the internal base value and given parameters, up to the specified evaluation channel (inclusive) */
@@ -298,8 +397,15 @@ struct DNAABILITIES_API FAggregator : public TSharedFromThis<FAggregator>
 
 private:
 
+	/** Queues this aggregator to be recomputed when the outermost FScopedAggregatorOnDirtyBatch ends, or right away if there is none */
 	void BroadcastOnDirty();
 
+	/** Broadcasts OnDirty and notifies the dependent effects, see FScopedAggregatorOnDirtyBatch::FlushDirtyAggregators */
+	void BroadcastOnDirtyNow();
+
+	/** Logs the aggregators involved in a dirty broadcast that came back around to this one */
+	void ReportCyclicBroadcast();
+
 	float	BaseValue;
 	FAggregatorModChannelContainer ModChannels;
 
@@ -307,9 +413,46 @@ private:
 	TArray<FActiveDNAEffectHandle>	Dependents;
 	bool bIsBroadcastingDirty;
 
+	/** Higher than the rank of every aggregator this one depends on, see FAggregatorDependencyGraph. Dirty aggregators are recomputed in rank order */
+	int32 DependencyRank;
+
+	/** Aggregators with mods that depend on this one, once per dependency that links them. Maintained by FAggregatorDependencyGraph */
+	TArray<TWeakPtr<FAggregator>> DependentAggregators;
+
+	/** A result of Evaluate and the parts of the parameters it depends on */
+	struct FCachedEvaluation
+	{
+		FDNATagContainer SourceTags;
+		FDNATagContainer TargetTags;
+		float Value;
+		bool bHasSourceTags;
+		bool bHasTargetTags;
+		bool bIncludePredictiveMods;
+	};
+
+	/** Drops the cached evaluations. Must be called whenever the base value or the mods change */
+	void InvalidateEvaluationCache();
+
+	/** Returns true and the cached value if Parameters evaluate the same as a cached evaluation */
+	bool FindCachedEvaluation(const FAggregatorEvaluateParameters& Parameters, float& OutValue) const;
+
+	void AddCachedEvaluation(const FAggregatorEvaluateParameters& Parameters, float Value) const;
+
+	/** Callers usually evaluate with one or two sets of tags, so a few entries replaced in turn are enough */
+	static const int32 MaxCachedEvaluations = 4;
+
+	mutable TArray<FCachedEvaluation, TInlineAllocator<MaxCachedEvaluations>> CachedEvaluations;
+	mutable int32 NextCachedEvaluation;
+
+	/** Whether any mod has source or target tag requirements. When none does, those tags are left out of the cache key */
+	mutable bool bTagRequirementUsageValid;
+	mutable bool bModsUseSourceTags;
+	mutable bool bModsUseTargetTags;
+
 	// @todo: Try to eliminate as many of these as possible
 	friend struct FActiveDNAEffectsContainer;
 	friend struct FScopedAggregatorOnDirtyBatch;	// Only outside class that gets to call BroadcastOnDirty()
+	friend struct FAggregatorDependencyGraph;
 	friend class UDNAAbilitySystemComponent;	// Only needed for DisplayDebug()
 };
 
@@ -325,12 +468,67 @@ struct DNAABILITIES_API FAggregatorRef
 	void TakeSnapshotOf(const FAggregatorRef& RefToSnapshot);
 };
 
+/**
+ * The dependencies between attribute aggregators that the active effects of one ability system component create. An effect with a modifier
+ * whose magnitude captures an attribute without snapshotting makes the aggregator of the modified attribute depend on the captured one,
+ * which may belong to another ability system component.
+ *
+ * Every aggregator is ranked above the aggregators it depends on, and ranks are raised as dependencies are added, so
+ * FScopedAggregatorOnDirtyBatch can recompute a batch of dirty aggregators in rank order and each of them once.
+ * A dependency that would close a cycle is refused when it is added, so the caller can report it before it is ever broadcast.
+ */
+struct DNAABILITIES_API FAggregatorDependencyGraph
+{
+	FAggregatorDependencyGraph() { }
+
+	/** Dependencies belong to the effects of one container, a copy starts out empty */
+	FAggregatorDependencyGraph(const FAggregatorDependencyGraph& Other) { }
+	FAggregatorDependencyGraph& operator=(const FAggregatorDependencyGraph& Other) { return *this; }
+
+	~FAggregatorDependencyGraph();
+
+	/**
+	 * Makes To depend on From, for as long as the effect Handle is active
+	 * 
+	 * @return False if From already depends on To, in which case the dependency is not added
+	 */
+	bool AddDependency(FActiveDNAEffectHandle Handle, const FAggregatorRef& From, const FAggregatorRef& To);
+
+	/** Removes the dependencies added for the effect */
+	void RemoveDependencies(FActiveDNAEffectHandle Handle);
+
+	/** Removes every dependency */
+	void Reset();
+
+	/** Number of dependencies, counting each effect separately */
+	int32 Num() const;
+
+	/** Returns true if To depends on From, directly or through other aggregators */
+	static bool DependsOn(const FAggregator& To, const FAggregator& From);
+
+private:
+
+	struct FDependency
+	{
+		TWeakPtr<FAggregator> From;
+		TWeakPtr<FAggregator> To;
+	};
+
+	/** Raises the rank of Aggregator to at least MinRank, and the ranks of everything depending on it to match */
+	static void RaiseRank(FAggregator& Aggregator, int32 MinRank);
+
+	static void RemoveDependency(const FDependency& Dependency);
+
+	/** Dependencies by the effect that added them */
+	TMap<FActiveDNAEffectHandle, TArray<FDependency>> EffectDependencies;
+};
+
 /**
  *	Allows us to batch all aggregator OnDirty calls within a scope. That is, ALL OnDirty() callbacks are
  *	delayed until FScopedAggregatorOnDirtyBatch goes out of scope.
  *	
- *	The only catch is that we store raw FAggregator*. This should only be used in scopes where aggreagtors
- *	are not deleted. There is currently no place that does. If we find to, we could add additional safety checks.
+ *	We store raw FAggregator*, an aggregator that is destroyed while it is dirty or waiting in a flush removes
+ *	itself, see RemoveDestroyedAggregator.
  */
 struct DNAABILITIES_API FScopedAggregatorOnDirtyBatch
 {
@@ -343,9 +541,31 @@ struct DNAABILITIES_API FScopedAggregatorOnDirtyBatch
 	static void BeginNetReceiveLock();
 	static void EndNetReceiveLock();
 
+	/**
+	 * Recomputes the dirty aggregators lowest dependency rank first, so every aggregator a batch dirties, directly or through the effects
+	 * that depend on it, is recomputed once after everything it depends on. Dirtying from the callbacks is batched into the same flush.
+	 */
+	static void FlushDirtyAggregators();
+
 	static int32	GlobalBatchCount;
 	static TSet<FAggregator*>	DirtyAggregators;
 
+	/** Aggregators recomputed by the flush in progress */
+	static TSet<FAggregator*>	RecomputedAggregators;
+
+	/** The aggregator whose dependent effects the flush in progress is notifying, if any */
+	static FAggregator*	NotifyingAggregator;
+
+	/** Aggregators the flush in progress has yet to recompute, a heap ordered by dependency rank */
+	static TArray<FAggregator*>	PendingAggregators;
+	static TSet<FAggregator*>	PendingAggregatorSet;
+
+	/** Forgets an aggregator that is being destroyed, so a flush in progress never touches it again */
+	static void RemoveDestroyedAggregator(FAggregator* Aggregator);
+
+	/** Heap order of PendingAggregators */
+	static bool IsLowerRank(const FAggregator& A, const FAggregator& B);
+
 	static bool		GlobalFromNetworkUpdate;
 	static int32	NetUpdateID;
 };
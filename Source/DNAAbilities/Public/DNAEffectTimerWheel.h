@@ -0,0 +1,157 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Core.h"
+#include "UObject/WeakObjectPtr.h"
+#include "Engine/EngineTypes.h"
+#include "DNAEffectTypes.h"
+
+class UDNAAbilitySystemComponent;
+class UWorld;
+
+/** Identifies a timer scheduled in a FDNAEffectTimerWheel. Stays safe to use after the timer fired or was cleared */
+struct FDNAEffectTimerHandle
+{
+	FDNAEffectTimerHandle()
+		: Index(INDEX_NONE)
+		, Serial(0)
+	{
+	}
+
+	/** True if this handle was ever set. Use FDNAEffectTimerWheel::TimerExists to check if the timer is still pending */
+	bool IsValid() const
+	{
+		return Index != INDEX_NONE;
+	}
+
+	void Invalidate()
+	{
+		Index = INDEX_NONE;
+	}
+
+private:
+	friend class FDNAEffectTimerWheel;
+
+	int32 Index;
+	uint32 Serial;
+};
+
+/** What a FDNAEffectTimerWheel timer does when it fires */
+enum class EDNAEffectTimerType : uint8
+{
+	/** Calls UDNAAbilitySystemComponent::CheckDurationExpired */
+	Duration,
+
+	/** Calls UDNAAbilitySystemComponent::ExecutePeriodicEffect */
+	Period,
+};
+
+/**
+ * Schedules the duration expirations and period ticks of the active effects in one world, see UDNAAbilitySystemGlobals::GetEffectTimerWheel.
+ *
+ * Timers are bucketed by their expiration tick in a hierarchical timing wheel: the lowest level has a slot per tick, and every level above
+ * has a slot per full rotation of the level below, which is moved down a level when time reaches it. Adding, clearing and firing a timer are
+ * constant time, instead of a heap operation in the world's FTimerManager plus a search of the effect list for each callback.
+ * The wheel is advanced once per frame, from a single next tick timer, and fires everything that is due as one batch in expiration order.
+ */
+class DNAABILITIES_API FDNAEffectTimerWheel
+{
+public:
+	explicit FDNAEffectTimerWheel(UWorld* InWorld);
+	~FDNAEffectTimerWheel();
+
+	/**
+	 * Schedules a timer for an active effect, replacing the timer InOutHandle referred to.
+	 *
+	 * @param Delay		Seconds of world time until the timer first fires. Zero or less fires on the next frame
+	 * @param Period	Seconds between firings after the first, or zero to fire only once
+	 */
+	void SetTimer(FDNAEffectTimerHandle& InOutHandle, UDNAAbilitySystemComponent* Owner, FActiveDNAEffectHandle EffectHandle, EDNAEffectTimerType Type, float Delay, float Period = 0.f);
+
+	/** Cancels the timer and invalidates the handle */
+	void ClearTimer(FDNAEffectTimerHandle& InOutHandle);
+
+	/** Returns true if the timer has not fired (or is looping) and was not cleared */
+	bool TimerExists(const FDNAEffectTimerHandle& Handle) const;
+
+	/** Returns the seconds until the timer fires next, or -1 if it does not exist */
+	float GetTimerRemaining(const FDNAEffectTimerHandle& Handle) const;
+
+	/** Number of pending timers */
+	FORCEINLINE int32 GetNumTimers() const
+	{
+		return NumActiveTimers;
+	}
+
+	/** Fires every timer that is due at the world's current time */
+	void Tick();
+
+private:
+	/** Wheel ticks per second of world time. Timers still fire at their exact time, this only sets the bucket width */
+	static const int32 TicksPerSecond = 60;
+
+	/** Each level has 2^SlotBits slots */
+	static const int32 SlotBits = 6;
+	static const int32 NumSlots = 1 << SlotBits;
+	static const int32 SlotMask = NumSlots - 1;
+
+	/** Four levels cover 2^24 ticks, about three days. Later timers wait in the last level and are placed again when it comes around */
+	static const int32 NumLevels = 4;
+
+	struct FTimer
+	{
+		TWeakObjectPtr<UDNAAbilitySystemComponent> Owner;
+		FActiveDNAEffectHandle EffectHandle;
+		double ExpireTime;
+		float Period;
+		uint32 Serial;
+		EDNAEffectTimerType Type;
+		bool bActive;
+	};
+
+	/** A timer in a slot. Clearing a timer bumps its serial, which makes the entries left in slots stale */
+	struct FSlotEntry
+	{
+		int32 TimerIndex;
+		uint32 Serial;
+	};
+
+	double GetWorldTime() const;
+
+	static int64 GetTickForTime(double Time);
+
+	bool IsEntryValid(const FSlotEntry& Entry) const;
+
+	void FreeTimer(int32 TimerIndex);
+
+	/** Puts a timer into the slot for its expiration tick */
+	void InsertEntry(const FSlotEntry& Entry);
+
+	/** Moves the timers of the slot of Level that starts at CurrentTick down the wheel */
+	void Cascade(int32 Level);
+
+	/** Moves the wheel forward to Tick, collecting the timers of every tick passed into DueEntries */
+	void AdvanceTo(int64 Tick);
+
+	/** Makes sure Tick runs next frame */
+	void ScheduleTick();
+
+	TWeakObjectPtr<UWorld> World;
+
+	TArray<FTimer> Timers;
+	TArray<int32> FreeTimerIndices;
+	int32 NumActiveTimers;
+
+	/** Slots of each level, NumSlots per level */
+	TArray<FSlotEntry> Slots[NumLevels][NumSlots];
+
+	/** Timers whose tick was reached, they still fire only once their exact time has passed */
+	TArray<FSlotEntry> DueEntries;
+
+	/** Last wheel tick that was advanced to */
+	int64 CurrentTick;
+
+	FTimerHandle TickTimerHandle;
+	bool bTickScheduled;
+};
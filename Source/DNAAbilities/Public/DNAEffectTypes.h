@@ -10,6 +10,8 @@
 #include "Templates/SubclassOf.h"
 #include "Engine/NetSerialization.h"
 #include "DNATagContainer.h"
+#include "DNATagBitContainer.h"
+#include "DNATagNetDelta.h"
 #include "DNATagAssetInterface.h"
 #include "AttributeSet.h"
 #include "DNAPrediction.h"
@@ -163,6 +165,9 @@ enum class EDNAEffectStackingType : uint8
  * This handle is required for things outside of FActiveDNAEffectsContainer to refer to a specific active DNAEffect
  *	For example if a skill needs to create an active effect and then destroy that specific effect that it created, it has to do so
  *	through a handle. a pointer or index into the active list is not sufficient.
+ *
+ *	The handle is a slot in a global table that records the owning DNAAbilitySystemComponent, plus the generation of that slot.
+ *	Freeing a slot bumps its generation, so old handles to a reused slot no longer match or resolve.
  */
 USTRUCT(BlueprintType)
 struct DNAABILITIES_API FActiveDNAEffectHandle
@@ -171,13 +176,15 @@ struct DNAABILITIES_API FActiveDNAEffectHandle
 
 	FActiveDNAEffectHandle()
 		: Handle(INDEX_NONE),
+		Generation(0),
 		bPassedFiltersAndWasExecuted(false)
 	{
 
 	}
 
-	FActiveDNAEffectHandle(int32 InHandle)
+	FActiveDNAEffectHandle(int32 InHandle, int32 InGeneration = 0)
 		: Handle(InHandle),
+		Generation(InGeneration),
 		bPassedFiltersAndWasExecuted(true)
 	{
 
@@ -195,43 +202,52 @@ struct DNAABILITIES_API FActiveDNAEffectHandle
 
 	static FActiveDNAEffectHandle GenerateNewHandle(UDNAAbilitySystemComponent* OwningComponent);
 
+	/** Frees every slot of the global handle table, so no existing handle resolves anymore */
 	static void ResetGlobalHandleMap();
 
+	/** Returns the component this handle was generated for, or null if the handle was freed or the component is gone */
 	UDNAAbilitySystemComponent* GetOwningDNAAbilitySystemComponent();
 	const UDNAAbilitySystemComponent* GetOwningDNAAbilitySystemComponent() const;
 
+	/** Frees this handle's slot in the global handle table for reuse */
 	void RemoveFromGlobalMap();
 
 	bool operator==(const FActiveDNAEffectHandle& Other) const
 	{
-		return Handle == Other.Handle;
+		return Handle == Other.Handle && Generation == Other.Generation;
 	}
 
 	bool operator!=(const FActiveDNAEffectHandle& Other) const
 	{
-		return Handle != Other.Handle;
+		return Handle != Other.Handle || Generation != Other.Generation;
 	}
 
 	friend uint32 GetTypeHash(const FActiveDNAEffectHandle& InHandle)
 	{
-		return InHandle.Handle;
+		return HashCombine(InHandle.Handle, InHandle.Generation);
 	}
 
 	FString ToString() const
 	{
-		return FString::Printf(TEXT("%d"), Handle);
+		return FString::Printf(TEXT("%d:%d"), Handle, Generation);
 	}
 
 	void Invalidate()
 	{
 		Handle = INDEX_NONE;
+		Generation = 0;
 	}
 
 private:
 
+	/** Slot in the global handle table */
 	UPROPERTY()
 	int32 Handle;
 
+	/** Generation of the slot when this handle was generated */
+	UPROPERTY()
+	int32 Generation;
+
 	UPROPERTY()
 	bool bPassedFiltersAndWasExecuted;
 };
@@ -991,6 +1007,7 @@ namespace EDNATagEventType
 struct DNAABILITIES_API FDNATagCountContainer
 {	
 	FDNATagCountContainer()
+		: BatchDepth(0)
 	{}
 
 	/**
@@ -1002,7 +1019,7 @@ struct DNAABILITIES_API FDNATagCountContainer
 	 */
 	FORCEINLINE bool HasMatchingDNATag(FDNATag TagToCheck) const
 	{
-		return DNATagCountMap.FindRef(TagToCheck) > 0;
+		return GetTagCount(TagToCheck) > 0;
 	}
 
 	/**
@@ -1023,7 +1040,7 @@ struct DNAABILITIES_API FDNATagCountContainer
 		bool AllMatch = true;
 		for (const FDNATag& Tag : TagContainer)
 		{
-			if (DNATagCountMap.FindRef(Tag) <= 0)
+			if (GetTagCount(Tag) <= 0)
 			{
 				AllMatch = false;
 				break;
@@ -1049,7 +1066,7 @@ struct DNAABILITIES_API FDNATagCountContainer
 		bool AnyMatch = false;
 		for (const FDNATag& Tag : TagContainer)
 		{
-			if (DNATagCountMap.FindRef(Tag) > 0)
+			if (GetTagCount(Tag) > 0)
 			{
 				AnyMatch = true;
 				break;
@@ -1058,6 +1075,30 @@ struct DNAABILITIES_API FDNATagCountContainer
 		return AnyMatch;
 	}
 	
+	/**
+	 * Check if the count container has DNA tags that matches against all of the explicit tags in the bit container (expands to include parents of asset tags)
+	 * 
+	 * @param TagBits			Bit container to check for a match. If empty will return true
+	 * 
+	 * @return True if the count container matches all of the DNA tags
+	 */
+	FORCEINLINE bool HasAllMatchingDNATags(const FDNATagBitContainer& TagBits) const
+	{
+		return ActiveTagBits.HasAll(TagBits);
+	}
+
+	/**
+	 * Check if the count container has DNA tags that matches against any of the explicit tags in the bit container (expands to include parents of asset tags)
+	 * 
+	 * @param TagBits			Bit container to check for a match. If empty will return false
+	 * 
+	 * @return True if the count container matches any of the DNA tags
+	 */
+	FORCEINLINE bool HasAnyMatchingDNATags(const FDNATagBitContainer& TagBits) const
+	{
+		return ActiveTagBits.HasAny(TagBits);
+	}
+
 	/**
 	 * Update the specified container of tags by the specified delta, potentially causing an additional or removal from the explicit tag list
 	 * 
@@ -1103,13 +1144,7 @@ struct DNAABILITIES_API FDNATagCountContainer
 	 */
 	FORCEINLINE bool SetTagCount(const FDNATag& Tag, int32 NewCount)
 	{
-		int32 ExistingCount = 0;
-		if (int32* Ptr  = ExplicitTagCountMap.Find(Tag))
-		{
-			ExistingCount = *Ptr;
-		}
-
-		int32 CountDelta = NewCount - ExistingCount;
+		int32 CountDelta = NewCount - GetExplicitTagCount(Tag);
 		if (CountDelta != 0)
 		{
 			return UpdateTagMap_Internal(Tag, CountDelta);
@@ -1125,15 +1160,7 @@ struct DNAABILITIES_API FDNATagCountContainer
 	*
 	* @return the count of the passed in tag
 	*/
-	FORCEINLINE int32 GetTagCount(const FDNATag& Tag) const
-	{
-		if (const int32* Ptr = DNATagCountMap.Find(Tag))
-		{
-			return *Ptr;
-		}
-
-		return 0;
-	}
+	int32 GetTagCount(const FDNATag& Tag) const;
 
 	/**
 	 *	Broadcasts the AnyChange event for this tag. This is called when the stack count of the backing DNA effect change.
@@ -1166,8 +1193,41 @@ struct DNAABILITIES_API FDNATagCountContainer
 		return ExplicitTags;
 	}
 
+	/** Bitset view of the tags in this container: explicit bits are the explicit tags, implied bits are every tag with a count above zero */
+	const FDNATagBitContainer& GetActiveTagBits() const
+	{
+		return ActiveTagBits;
+	}
+
 	void Reset();
 
+	/**
+	 * Starts a batch of count updates. Until the matching EndBatch, delegates are not fired as counts change but queued once per tag,
+	 * then fired with the final count when the outermost batch ends. Counts and the return values of the update functions are not deferred.
+	 */
+	void BeginBatch();
+
+	/** Ends a batch started with BeginBatch, firing the queued delegates if this was the outermost batch */
+	void EndBatch();
+
+	/** Batches the count updates made during its lifetime, see BeginBatch */
+	struct FScopedBatch
+	{
+		explicit FScopedBatch(FDNATagCountContainer& InContainer)
+			: Container(InContainer)
+		{
+			Container.BeginBatch();
+		}
+
+		~FScopedBatch()
+		{
+			Container.EndBatch();
+		}
+
+	private:
+		FDNATagCountContainer& Container;
+	};
+
 private:
 
 	struct FDelegateInfo
@@ -1176,14 +1236,44 @@ private:
 		FOnDNAEffectTagCountChanged	OnAnyChange;
 	};
 
-	/** Map of tag to delegate that will be fired when the count for the key tag changes to or away from zero */
-	TMap<FDNATag, FDelegateInfo> DNATagEventMap;
+	/** A tag whose count changed during a batch */
+	struct FPendingTagChange
+	{
+		int32 TagIndex;
+
+		/** Count before the first change in the batch, to tell if the tag was added or removed overall */
+		int32 OldCount;
+	};
+
+	/** Returns the explicit count of a tag */
+	int32 GetExplicitTagCount(const FDNATag& Tag) const;
 
-	/** Map of tag to active count of that tag */
-	TMap<FDNATag, int32> DNATagCountMap;
+	/** Fires the delegates for a count change of the tag with this index */
+	void BroadcastTagChange(int32 TagIndex, int32 NewCount, bool bSignificantChange);
 
-	/** Map of tag to explicit count of that tag. Cannot share with above map because it's not safe to merge explicit and generic counts */	
-	TMap<FDNATag, int32> ExplicitTagCountMap;
+	/** Map of tag index to delegates that will be fired when the count for the key tag changes. Tags not in the dictionary never notify and are not registered */
+	TMap<int32, FDelegateInfo> DNATagEventMap;
+
+	/** Returned when registering for a tag that is not in the dictionary, cleared every time so nothing stays bound to it */
+	FOnDNAEffectTagCountChanged UnindexedTagEvent;
+
+	/** Active count of each tag by tag index, including the counts implied by child tags. Grown on demand up to the highest index that was counted */
+	TArray<int32> TagCounts;
+
+	/** Explicit count of each tag by tag index. Cannot share with above array because it's not safe to merge explicit and generic counts */
+	TArray<int32> ExplicitTagCounts;
+
+	/** Explicit count of tags that are not in the dictionary and so have no index */
+	TMap<FDNATag, int32> UnindexedExplicitTagCounts;
+
+	/** Tags whose count changed during the current batch, in the order they first changed */
+	TArray<FPendingTagChange> PendingTagChanges;
+
+	/** Set for the tag indices in PendingTagChanges. Grown together with TagCounts */
+	TBitArray<> PendingTagBits;
+
+	/** Number of batches started and not ended yet */
+	int32 BatchDepth;
 
 	/** Delegate fired whenever any tag's count changes to or away from zero */
 	FOnDNAEffectTagCountChanged OnAnyTagChangeDelegate;
@@ -1191,6 +1281,9 @@ private:
 	/** Container of tags that were explicitly added */
 	FDNATagContainer ExplicitTags;
 
+	/** Bitset mirror of ExplicitTags and of the tags in DNATagCountMap with a count above zero */
+	FDNATagBitContainer ActiveTagBits;
+
 	/** Internal helper function to adjust the explicit tag list & corresponding maps/delegates/etc. as necessary */
 	bool UpdateTagMap_Internal(const FDNATag& Tag, int32 CountDelta);
 };
@@ -1215,9 +1308,21 @@ struct DNAABILITIES_API FDNATagRequirements
 	bool	RequirementsMet(const FDNATagContainer& Container) const;
 	bool	IsEmpty() const;
 
+	/** Version of RequirementsMet for a bit container, matched against cached bitsets of RequireTags and IgnoreTags */
+	bool	RequirementsMet(const FDNATagBitContainer& ContainerBits) const;
+
+	/** Runs RequirementsMet against many bit containers at once, such as the owned tags of every target in range. Sets one bit per container, null entries never pass */
+	void	RequirementsMetBatch(TArrayView<const FDNATagBitContainer* const> Containers, TBitArray<>& OutResults) const;
+
 	static FGetDNATags	SnapshotTags(FGetDNATags TagDelegate);
 
 	FString ToString() const;
+
+private:
+
+	/** Bitsets of RequireTags and IgnoreTags, built the first time they are matched against a bit container */
+	FDNATagBitContainerCache RequireTagBits;
+	FDNATagBitContainerCache IgnoreTagBits;
 };
 
 USTRUCT()
@@ -1397,7 +1502,8 @@ struct DNAABILITIES_API FMinimalReplicationTagCountMap
 		}
 	}
 
-	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+	/** Replicates the tags, only sending the tags added and removed since the last acknowledged state if UDNAAbilitySystemGlobals::bDeltaSerializeMinimalReplicationTags is set */
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms);
 
 	TMap<FDNATag, int32>	TagMap;
 
@@ -1425,7 +1531,7 @@ struct TStructOpsTypeTraits<FMinimalReplicationTagCountMap> : public TStructOpsT
 	enum
 	{
 		WithCopy = true,
-		WithNetSerializer = true,
+		WithNetDeltaSerializer = true,
 		WithIdenticalViaEquality = true,
 	};
 };
@@ -0,0 +1,269 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Core.h"
+#include "Containers/ArrayView.h"
+#include "DNATagContainer.h"
+
+/**
+ * A bitset view of a set of DNA tags, keyed by the dense tag index assigned by UDNATagsManager::GetTagIndex.
+ * Explicit tags and implied tags (explicit tags plus all of their parents) are stored as separate bitsets, so HasTag/HasAny/HasAll
+ * become word-wise AND/OR instead of FName scans. This is meant for hot paths that match the same sets over and over, and is not a
+ * replacement for FDNATagContainer, which is still what is serialized and edited.
+ *
+ * Tag indices never change once assigned, so a bit container stays valid if the tag tree is rebuilt.
+ */
+struct DNATAGS_API FDNATagBitContainer
+{
+	FDNATagBitContainer()
+	{
+	}
+
+	/** Builds the bitsets from the explicit tags in Container, expanding parents */
+	explicit FDNATagBitContainer(const FDNATagContainer& Container)
+	{
+		AppendTags(Container);
+	}
+
+	/** Adds a tag, setting the implied bits for all of its parents. Tags not in the dictionary are ignored */
+	void AddTag(const FDNATag& TagToAdd);
+
+	/** Adds all explicit tags of Other */
+	void AppendTags(const FDNATagContainer& Other);
+
+	/** Removes all tags, keeping the allocated words */
+	void Reset();
+
+	/**
+	 * Sets or clears a single explicit bit, without touching the implied bits of its parents.
+	 * Used by containers that track implied tags themselves, such as reference counted ones.
+	 */
+	void SetExplicitTagIndex(int32 TagIndex, bool bValue);
+
+	/** Sets or clears a single implied bit. Used by containers that track implied tags themselves, such as reference counted ones */
+	void SetImpliedTagIndex(int32 TagIndex, bool bValue);
+
+	/** Returns true if the tag with this index is explicitly in the container or is a parent of a tag in the container */
+	FORCEINLINE bool HasTagIndex(int32 TagIndex) const
+	{
+		return TestBit(ImpliedWords, TagIndex);
+	}
+
+	/** Returns true if the tag with this index is explicitly in the container */
+	FORCEINLINE bool HasTagIndexExact(int32 TagIndex) const
+	{
+		return TestBit(ExplicitWords, TagIndex);
+	}
+
+	/**
+	 * Determine if TagToCheck is present in this container, also checking against parent tags
+	 * {"A.1"}.HasTag("A") will return True, {"A"}.HasTag("A.1") will return False
+	 *
+	 * @return True if TagToCheck is in this container, false if it is not
+	 */
+	bool HasTag(const FDNATag& TagToCheck) const;
+
+	/**
+	 * Determine if TagToCheck is explicitly present in this container, only allowing exact matches
+	 *
+	 * @return True if TagToCheck is in this container, false if it is not
+	 */
+	bool HasTagExact(const FDNATag& TagToCheck) const;
+
+	/**
+	 * Checks if this container contains ANY of the explicit tags in ContainerToCheck, also checks against parent tags
+	 * If ContainerToCheck is empty it will always return False
+	 */
+	bool HasAny(const FDNATagBitContainer& ContainerToCheck) const;
+
+	/**
+	 * Checks if this container contains ANY of the explicit tags in ContainerToCheck, only allowing exact matches
+	 * If ContainerToCheck is empty it will always return False
+	 */
+	bool HasAnyExact(const FDNATagBitContainer& ContainerToCheck) const;
+
+	/**
+	 * Checks if this container contains ALL of the explicit tags in ContainerToCheck, also checks against parent tags
+	 * If ContainerToCheck is empty it will always return True
+	 */
+	bool HasAll(const FDNATagBitContainer& ContainerToCheck) const;
+
+	/**
+	 * Checks if this container contains ALL of the explicit tags in ContainerToCheck, only allowing exact matches
+	 * If ContainerToCheck is empty it will always return True
+	 */
+	bool HasAllExact(const FDNATagBitContainer& ContainerToCheck) const;
+
+	/** Returns a word of the implied bits, or zero if the word is past the end. Used to test precomputed masks, see FDNATagQueryProgram */
+	FORCEINLINE uint64 GetImpliedWord(int32 WordIndex) const
+	{
+		return GetWord(ImpliedWords, WordIndex);
+	}
+
+	/** Returns the sorted indices of the non-zero explicit words */
+	FORCEINLINE const TArray<int32, TInlineAllocator<4>>& GetExplicitWordIndices() const
+	{
+		return ExplicitWordIndices;
+	}
+
+	/** Returns a word of the explicit bits, or zero if the word is past the end */
+	FORCEINLINE uint64 GetExplicitWord(int32 WordIndex) const
+	{
+		return GetWord(ExplicitWords, WordIndex);
+	}
+
+	/** Returns true if there are no explicit tags in the container */
+	FORCEINLINE bool IsEmpty() const
+	{
+		return ExplicitWordIndices.Num() == 0;
+	}
+
+	/** Number of bits per storage word */
+	static const int32 BitsPerWord = 64;
+
+private:
+
+	typedef TArray<uint64, TInlineAllocator<4>> FWordArray;
+
+	static FORCEINLINE bool TestBit(const FWordArray& Words, int32 TagIndex)
+	{
+		const int32 WordIndex = TagIndex / BitsPerWord;
+		return TagIndex >= 0 && WordIndex < Words.Num() && (Words[WordIndex] & (1ull << (TagIndex % BitsPerWord))) != 0;
+	}
+
+	static FORCEINLINE uint64 GetWord(const FWordArray& Words, int32 WordIndex)
+	{
+		return WordIndex < Words.Num() ? Words[WordIndex] : 0;
+	}
+
+	/** Sets a bit, growing the word array as needed */
+	static void SetBit(FWordArray& Words, int32 TagIndex);
+
+	/** Clears a bit, returns true if its word is now zero */
+	static bool ClearBit(FWordArray& Words, int32 TagIndex);
+
+	/** Bits of explicitly added tags */
+	FWordArray ExplicitWords;
+
+	/** Bits of explicitly added tags and all of their parents */
+	FWordArray ImpliedWords;
+
+	/** Sorted indices of the non-zero words in ExplicitWords, so matching against this container only visits the words it uses */
+	TArray<int32, TInlineAllocator<4>> ExplicitWordIndices;
+};
+
+/**
+ * A lazily built FDNATagBitContainer for an FDNATagContainer that is matched against far more often than it changes, such as
+ * the tag requirements on effect and ability definitions. The source tags are remembered, so the bits are rebuilt if the
+ * container is modified or the dictionary changes after the bits were cached.
+ */
+struct DNATAGS_API FDNATagBitContainerCache
+{
+	FDNATagBitContainerCache()
+		: CachedDictionarySerial(0)
+		, bCached(false)
+		, bHasUnindexedTags(false)
+	{
+	}
+
+	/** Returns the bit container for Container, rebuilding it if Container has changed since it was last cached */
+	const FDNATagBitContainer& Get(const FDNATagContainer& Container) const;
+
+	/**
+	 * Returns true if the container last passed to Get has tags that are not in the dictionary, which the bits leave out.
+	 * Callers that require all of the tags should treat that as never met, like FDNATagContainer::HasAll does.
+	 */
+	FORCEINLINE bool HasUnindexedTags() const
+	{
+		return bHasUnindexedTags;
+	}
+
+private:
+
+	mutable FDNATagBitContainer Bits;
+
+	/** Copy of the explicit tags the bits were built from */
+	mutable TArray<FDNATag, TInlineAllocator<4>> CachedTags;
+
+	mutable uint32 CachedDictionarySerial;
+
+	mutable bool bCached;
+
+	mutable bool bHasUnindexedTags;
+};
+
+/**
+ * Structure-of-arrays view of many tag sets, used to run one set of tag tests against all of them at once.
+ * Only the implied words the tests need are gathered, one contiguous column per word, and each test produces "lanes": one bit per set,
+ * packed 64 sets to a word, so combining results is plain word-wise AND/OR.
+ *
+ * Usage: AddWord for every word the tests use, Gather the sets, then run TestAny/TestAll and combine the lanes.
+ */
+struct DNATAGS_API FDNATagBitBatch
+{
+	typedef TArray<uint64, TInlineAllocator<4>> FLanes;
+
+	FDNATagBitBatch()
+		: NumSets(0)
+	{
+	}
+
+	/** Removes all words and gathered sets */
+	void Reset();
+
+	/** Registers a word of tag bits that the tests will read. Must be called before Gather */
+	void AddWord(int32 WordIndex);
+
+	/** Gathers the implied words of the containers. Null entries are treated as empty */
+	void Gather(TArrayView<const FDNATagBitContainer* const> Containers);
+
+	/** Gathers the implied words of the containers, expanding parents through the manager's parent table. Null entries are treated as empty */
+	void Gather(TArrayView<const FDNATagContainer* const> Containers);
+
+	/** Number of sets gathered */
+	FORCEINLINE int32 Num() const
+	{
+		return NumSets;
+	}
+
+	/** Number of uint64 words in a lane array */
+	FORCEINLINE int32 GetNumLaneWords() const
+	{
+		return (NumSets + FDNATagBitContainer::BitsPerWord - 1) / FDNATagBitContainer::BitsPerWord;
+	}
+
+	/** Sizes Lanes for this batch, with the bit of every set equal to bValue and unused bits clear */
+	void InitLanes(FLanes& Lanes, bool bValue) const;
+
+	/** Sets the lane bit of every set that has any bit of Mask in the word WordIndex. The word must have been added */
+	void TestAny(int32 WordIndex, uint64 Mask, FLanes& InOutLanes) const;
+
+	/** Clears the lane bit of every set that is missing a bit of Mask in the word WordIndex. The word must have been added */
+	void TestAll(int32 WordIndex, uint64 Mask, FLanes& InOutLanes) const;
+
+	/** Flips the lane bit of every set, leaving the unused bits clear */
+	void InvertLanes(FLanes& InOutLanes) const;
+
+	/** Copies one bit per set into OutResults */
+	void LanesToBitArray(const FLanes& Lanes, TBitArray<>& OutResults) const;
+
+private:
+
+	/** Returns the start of the column for a word */
+	const uint64* GetColumn(int32 WordIndex) const;
+
+	/** Sizes the columns for NumSets sets, zeroed */
+	void InitColumns(int32 InNumSets);
+
+	/** Column slot of each word index, INDEX_NONE if the word is not used */
+	TArray<int32, TInlineAllocator<8>> WordToSlot;
+
+	/** Word index of each column slot */
+	TArray<int32, TInlineAllocator<8>> SlotWords;
+
+	/** NumSets words per slot, slot major */
+	TArray<uint64> Columns;
+
+	int32 NumSets;
+};
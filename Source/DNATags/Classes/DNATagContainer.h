@@ -7,10 +7,12 @@
 #include "UObject/ObjectMacros.h"
 #include "UObject/Object.h"
 #include "UObject/Class.h"
+#include "Containers/ArrayView.h"
 #include "DNATagContainer.generated.h"
 
 class UEditableDNATagQuery;
 struct FDNATagContainer;
+struct FDNATagBitContainer;
 struct FPropertyTag;
 
 DECLARE_LOG_CATEGORY_EXTERN(LogDNATags, Log, All);
@@ -757,6 +759,11 @@ PRAGMA_DISABLE_DEPRECATION_WARNINGS
 				}
 			}			
 		}
+		else if (ContainerMatchType == EDNAContainerMatchType::Any)
+		{
+			// Answered from the tag tree intervals without expanding OtherContainer
+			return DoesTagContainerMatchComplex(OtherContainer, TagMatchType, OtherTagMatchType, ContainerMatchType);
+		}
 		else
 		{
 			FDNATagContainer OtherExpanded = OtherContainer.GetDNATagParents();
@@ -817,6 +824,7 @@ protected:
 	TArray<FDNATag> ParentTags;
 
 	friend class UDNATagsManager;
+	friend class FDNATagDictionarySnapshot;
 	friend struct FDNATagQuery;
 	friend struct FDNATagQueryExpression;
 	friend struct FDNATagNode;
@@ -885,6 +893,78 @@ namespace EDNATagQueryStreamVersion
 	};
 }
 
+/**
+ * Flat, pre-parsed form of an FDNATagQuery token stream. Each expression is one op, with child ops following their parent, so evaluation
+ * walks an array instead of re-parsing the byte stream. Tag set ops also carry sparse (word, mask) pairs of the tag indices they test,
+ * so they can be evaluated against an FDNATagBitContainer with a few word tests.
+ */
+struct DNATAGS_API FDNATagQueryProgram
+{
+	struct FOp
+	{
+		/** EDNATagQueryExprType of the expression */
+		uint8 ExprType;
+
+		/** True if a tag set op references a tag that is not in the dictionary, which a bit container can never have */
+		uint8 bHasUnknownTag : 1;
+
+		/** Number of tags for tag set ops, number of direct child ops for expression set ops */
+		int32 Num;
+
+		/** First entry in Tags for tag set ops */
+		int32 FirstTag;
+
+		/** First entry in MaskWords/Masks for tag set ops */
+		int32 FirstMask;
+
+		/** Number of entries in MaskWords/Masks for tag set ops */
+		int32 NumMasks;
+
+		/** Index of the op after this op's children, used to skip a child when short circuiting */
+		int32 End;
+	};
+
+	FDNATagQueryProgram()
+		: DictionarySerial(0)
+		, bCompiled(0)
+		, bValid(false)
+	{
+	}
+
+	/** Evaluates the program against a tag container, testing tags the same way FDNATagContainer::HasTag does */
+	bool Matches(const FDNATagContainer& Tags) const;
+
+	/** Evaluates the program against a bit container */
+	bool Matches(const FDNATagBitContainer& Tags) const;
+
+	/** Ops in depth first order, empty if the query has no root expression */
+	TArray<FOp> Ops;
+
+	/** Tag operands of all tag set ops */
+	TArray<FDNATag> Tags;
+
+	/** Word index of each mask, sorted within an op */
+	TArray<int32> MaskWords;
+
+	/** Bits of the op's tags that fall in the matching word of MaskWords */
+	TArray<uint64> Masks;
+
+	/** Dictionary serial the masks were built for */
+	uint32 DictionarySerial;
+
+	/** Nonzero if the program has been compiled since the query last changed. Set last when compiling, read with a barrier, so a query shared between threads can be matched concurrently */
+	volatile int32 bCompiled;
+
+	/** False if the token stream could not be parsed, in which case the query is evaluated from the token stream */
+	bool bValid;
+
+#if WITH_EDITOR
+	/** Source of the program. Queries can be edited through property import in the editor, which bypasses the query's own functions */
+	TArray<uint8> CompiledTokenStream;
+	TArray<FDNATag> CompiledTagDictionary;
+#endif
+};
+
 /**
  * An FDNATagQuery is a logical query that can be run against an FDNATagContainer.  A query that succeeds is said to "match".
  * Queries are logical expressions that can test the intersection properties of another tag container (all, any, or none), or the matching state of a set of sub-expressions
@@ -948,6 +1028,18 @@ private:
 		return TagDictionary[TagIdx];
 	}
 
+	/** Compiled form of the token stream, built on demand */
+	mutable FDNATagQueryProgram Program;
+
+	/** Compiles the token stream into Program if it is out of date. Safe to call from several threads matching the same query */
+	const FDNATagQueryProgram& GetProgram() const;
+
+	/** Marks the compiled program as out of date */
+	FORCEINLINE void InvalidateProgram()
+	{
+		Program.bCompiled = 0;
+	}
+
 public:
 
 	/** Replaces existing tags with passed in tags. Does not modify the tag query expression logic. Useful when you need to cache off and update often used query. Must use same sized tag container! */
@@ -956,6 +1048,7 @@ public:
 		ensure(Tags.Num() == TagDictionary.Num());
 		TagDictionary.Reset();
 		TagDictionary.Append(Tags.DNATags);
+		InvalidateProgram();
 	}
 
 	/** Replaces existing tags with passed in tag. Does not modify the tag query expression logic. Useful when you need to cache off and update often used query. */		 
@@ -964,11 +1057,30 @@ public:
 		ensure(1 == TagDictionary.Num());
 		TagDictionary.Reset();
 		TagDictionary.Add(Tag);
+		InvalidateProgram();
 	}
 
 	/** Returns true if the given tags match this query, or false otherwise. */
 	bool Matches(FDNATagContainer const& Tags) const;
 
+	/** Returns true if the given tags match this query, or false otherwise. Evaluates the compiled query with word tests, prefer this when the tags are already in a bit container. */
+	bool Matches(FDNATagBitContainer const& Tags) const;
+
+	/**
+	 * Matches this query against many containers at once, such as the owned tags of every target in range.
+	 * The compiled query is evaluated over all containers together, which is much cheaper than calling Matches on each.
+	 *
+	 * @param Containers	Containers to test, null entries never match
+	 * @param OutResults	Set to one bit per container, true if the container matches
+	 */
+	void MatchesBatch(TArrayView<const FDNATagContainer* const> Containers, TBitArray<>& OutResults) const;
+
+	/** Bit container version of MatchesBatch */
+	void MatchesBatch(TArrayView<const FDNATagBitContainer* const> Containers, TBitArray<>& OutResults) const;
+
+	/** Compiles the query after it is loaded */
+	void PostSerialize(const FArchive& Ar);
+
 	/** Returns true if this query is empty, false otherwise. */
 	bool IsEmpty() const;
 
@@ -1105,7 +1217,8 @@ struct TStructOpsTypeTraits<FDNATagQuery> : public TStructOpsTypeTraitsBase
 {
 	enum
 	{
-		WithCopy = true
+		WithCopy = true,
+		WithPostSerialize = true,
 	};
 };
 
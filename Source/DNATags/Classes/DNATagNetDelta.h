@@ -0,0 +1,49 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Core.h"
+#include "Engine/NetSerialization.h"
+#include "DNATagContainer.h"
+
+/** Base state kept per connection by FDNATagNetDelta: the tags the receiver has once the packet that carried this state is acknowledged */
+class DNATAGS_API FDNATagNetDeltaState : public INetDeltaBaseState
+{
+public:
+	explicit FDNATagNetDeltaState(int32 InStateID)
+		: StateID(InStateID)
+	{
+	}
+
+	virtual bool IsStateEqual(INetDeltaBaseState* OtherState) override;
+
+	/** Tag indices of the tags that were sent, sorted so two states diff in one pass. See UDNATagsManager::GetTagIndex */
+	TArray<int32> TagIndices;
+
+	/** Change counter of the owner when the tags were sent, so an unchanged owner can skip the diff */
+	int32 StateID;
+};
+
+/**
+ * Delta replication of a set of tags, for structs that replicate through WithNetDeltaSerializer such as FMinimalReplicationTagCountMap.
+ * Instead of the whole set, only the tags added and removed since the base state are sent. The engine keeps one base state per connection and
+ * rolls it back to the last acknowledged one when a packet is lost, so the next delta also carries the lost changes. Adds and removes are
+ * absolute (present/absent), which keeps them safe to apply again. Without a base state, or when it would be smaller, the full set is sent.
+ */
+struct DNATAGS_API FDNATagNetDelta
+{
+	/**
+	 * Writes Tags as a delta against DeltaParms.OldState, or as a full set if there is no old state or bAllowDelta is false.
+	 * StateID must change whenever Tags does. Sends at most 2^CountBits - 1 tags. Tags that are not in the dictionary are not sent.
+	 *
+	 * @return False if nothing changed since the old state and nothing was written. If Tags changed and changed back, the old state takes on StateID
+	 */
+	static bool Write(FNetDeltaSerializeInfo& DeltaParms, const TArray<FDNATag>& Tags, int32 StateID, int32 CountBits, bool bAllowDelta);
+
+	/**
+	 * Reads what Write wrote. If bOutFullState is true, OutAddedTags is the complete set and any other tag should be removed.
+	 *
+	 * @return False if the stream was invalid
+	 */
+	static bool Read(FNetDeltaSerializeInfo& DeltaParms, int32 CountBits, bool& bOutFullState, TArray<FDNATag>& OutAddedTags, TArray<FDNATag>& OutRemovedTags);
+};
@@ -0,0 +1,41 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Core.h"
+
+/**
+ * Case insensitive substring search over a list of strings, used by the editor tag pickers through UDNATagsManager::SearchDNATags.
+ * Every three character sequence of every string is posted to the ascending list of entries that contain it, so a search only verifies the entries
+ * posted under the rarest trigram of the search string instead of scanning them all. Search strings shorter than a trigram scan the lowered strings.
+ */
+class DNATAGS_API FDNATagSearchIndex
+{
+public:
+	/** Rebuilds the index, entry N is Strings[N] */
+	void Build(const TArray<FString>& Strings);
+
+	/** Removes all entries */
+	void Reset();
+
+	/** Fills OutEntries with the indices of the entries that contain SearchString, ignoring case, in ascending order. An empty string matches nothing */
+	void Search(const FString& SearchString, TArray<int32>& OutEntries) const;
+
+	/** Number of entries */
+	FORCEINLINE int32 Num() const
+	{
+		return LoweredStrings.Num();
+	}
+
+private:
+	static const int32 TrigramLength = 3;
+
+	/** Packs the trigram starting at Chars, which must be lowered already */
+	static uint64 MakeTrigramKey(const TCHAR* Chars);
+
+	/** Lowercase copy of each entry, to verify candidates */
+	TArray<FString> LoweredStrings;
+
+	/** Ascending entry indices that contain each trigram */
+	TMap<uint64, TArray<int32>> TrigramPostings;
+};
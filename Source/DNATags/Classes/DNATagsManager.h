@@ -7,11 +7,14 @@
 #include "UObject/ObjectMacros.h"
 #include "UObject/Object.h"
 #include "UObject/ScriptMacros.h"
+#include "Containers/ArrayView.h"
 #include "DNATagContainer.h"
+#include "DNATagSearchIndex.h"
 #include "Engine/DataTable.h"
 #include "DNATagsManager.generated.h"
 
 class UDNATagsList;
+class FSHAHash;
 
 /** Simple struct for a table row in the DNA tag table and element in the ini list */
 USTRUCT()
@@ -95,7 +98,7 @@ USTRUCT()
 struct FDNATagNode
 {
 	GENERATED_USTRUCT_BODY()
-	FDNATagNode(){};
+	FDNATagNode() : TagIndex(INDEX_NONE) {};
 
 	/** Simple constructor */
 	FDNATagNode(FName InTag, TSharedPtr<FDNATagNode> InParentNode);
@@ -147,6 +150,13 @@ struct FDNATagNode
 	*/
 	FORCEINLINE FDNATagNetIndex GetNetIndex() const { return NetIndex; }
 
+	/**
+	* Get the dense tag index of this node, see UDNATagsManager::GetTagIndex
+	*
+	* @return The tag index of this node
+	*/
+	FORCEINLINE int32 GetTagIndex() const { return TagIndex; }
+
 	/** Reset the node of all of its values */
 	DNATAGS_API void ResetNode();
 
@@ -166,6 +176,9 @@ private:
 	/** Net Index of this node */
 	FDNATagNetIndex NetIndex;
 
+	/** Dense index of this node, stable across tree rebuilds */
+	int32 TagIndex;
+
 #if WITH_EDITORONLY_DATA
 	/** Package or config file this tag came from. This is the first one added. If None, this is an implicitly added tag */
 	FName SourceName;
@@ -177,6 +190,291 @@ private:
 	friend class UDNATagsManager;
 };
 
+/** Tags added to and removed from the tree by an incremental refresh, see IDNATagsModule::OnDNATagTreeChangeSet */
+struct FDNATagTreeChangeSet
+{
+	/** Tags that are in the tree now and were not before, parents always come before their children */
+	TArray<FDNATag> AddedTags;
+
+	/** Tags that were in the tree before and are not anymore */
+	TArray<FDNATag> RemovedTags;
+
+	FORCEINLINE bool IsEmpty() const
+	{
+		return AddedTags.Num() == 0 && RemovedTags.Num() == 0;
+	}
+};
+
+/** Range of entries in the manager's flat tag-and-parents index table */
+struct FDNATagIndexSpan
+{
+	int32 First;
+	int32 Num;
+};
+
+/** Sorted tree positions of a set of tags, see UDNATagsManager::GetSortedTagTreePositions */
+typedef TArray<int32, TInlineAllocator<16>> FDNATagTreePositions;
+
+/** Pre-order tree positions of every tag index. Never changed once published, a tree change builds a new table, see UDNATagsManager::MatchesTagIndex */
+struct FDNATagTreePositionTable
+{
+	/** Pre-order position of each tag index in the tree, INDEX_NONE if the tag is not in the tree */
+	TArray<int32> First;
+
+	/** Last pre-order position in the subtree of each tag index, so the subtree of a tag is the interval [First, Last] */
+	TArray<int32> Last;
+
+	/** Manager DictionarySerial the table was built for */
+	uint32 Serial;
+};
+
+#if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
+/** Replication settings suggested from recorded tag frequencies, see UDNATagsManager::ComputeNetIndexLayout */
+struct FDNATagNetIndexLayout
+{
+	FDNATagNetIndexLayout()
+		: NetIndexFirstBitSegment(0)
+		, NetIndexTrueBitNum(0)
+		, NumReplicatedTags(0)
+		, UnsplitBitsPerTag(0.f)
+		, CurrentBitsPerTag(0.f)
+		, LayoutBitsPerTag(0.f)
+	{
+	}
+
+	/** Tags to put in CommonlyReplicatedTags, most frequent first. Only as many as fit in the first segment */
+	TArray<FDNATag> CommonlyReplicatedTags;
+
+	/** Length of the first segment, 0 if splitting the net index doesn't pay off */
+	int32 NetIndexFirstBitSegment;
+
+	/** Bits in an unsplit net index for the current dictionary */
+	int32 NetIndexTrueBitNum;
+
+	/** Number of tags replicated in the recording */
+	int64 NumReplicatedTags;
+
+	/** Average bits per replicated tag index without a first segment */
+	float UnsplitBitsPerTag;
+
+	/** Average bits per replicated tag index with the current net indices and settings, 0 if fast replication is off */
+	float CurrentBitsPerTag;
+
+	/** Average bits per replicated tag index with this layout */
+	float LayoutBitsPerTag;
+};
+#endif
+
+/**
+ * Compact per-name record stored inline in FDNATagNameTable, so a name lookup touches a single cache line.
+ * Names of redirected tags have a record too, with no TagIndex of their own and LoadTagIndex pointing at the final tag.
+ */
+struct FDNATagNameRecord
+{
+	FDNATagNameRecord()
+		: TagIndex(INDEX_NONE)
+		, LoadTagIndex(INDEX_NONE)
+		, ParentTagIndex(INDEX_NONE)
+		, Depth(0)
+		, NetIndex(INVALID_TAGNETINDEX)
+	{
+	}
+
+	/** Complete name of the tag, NAME_None for an empty slot */
+	FName TagName;
+
+	/** Stable tag index, INDEX_NONE if the name is only a redirect */
+	int32 TagIndex;
+
+	/** Index of the tag a serialized reference to this name loads as: the end of its redirect chain, or TagIndex if it is not redirected */
+	int32 LoadTagIndex;
+
+	/** Index of the direct parent, INDEX_NONE for root tags */
+	int32 ParentTagIndex;
+
+	/** Number of parents, 0 for root tags */
+	uint16 Depth;
+
+	/** Replication index at the time the table was built, INVALID_TAGNETINDEX if fast replication is off */
+	FDNATagNetIndex NetIndex;
+};
+
+/**
+ * Open addressing hash table from complete tag name to FDNATagNameRecord, built once over a frozen dictionary.
+ * The table is kept at most half full and the hash seed is picked to minimize the longest probe, which in practice
+ * makes most tables perfect (every tag in its home slot). A miss stops at an empty slot or after the longest probe.
+ */
+class DNATAGS_API FDNATagNameTable
+{
+public:
+	FDNATagNameTable()
+		: SlotMask(0)
+		, Seed(0)
+		, MaxProbe(0)
+		, NumRecords(0)
+	{
+	}
+
+	/** Builds the table from the records, which must have unique names */
+	void Build(const TArray<FDNATagNameRecord>& Records);
+
+	/** Finds the record of a tag name, or null if it is not in the table */
+	FORCEINLINE const FDNATagNameRecord* Find(FName TagName) const
+	{
+		if (NumRecords == 0)
+		{
+			return nullptr;
+		}
+
+		const uint32 HomeSlot = HashName(TagName, Seed);
+		for (uint32 Probe = 0; Probe <= MaxProbe; ++Probe)
+		{
+			const FDNATagNameRecord& Record = Slots[(HomeSlot + Probe) & SlotMask];
+			if (Record.TagName.IsNone())
+			{
+				return nullptr;
+			}
+			if (Record.TagName == TagName)
+			{
+				return &Record;
+			}
+		}
+		return nullptr;
+	}
+
+	/** Number of records in the table */
+	FORCEINLINE int32 Num() const
+	{
+		return NumRecords;
+	}
+
+	/** Longest probe sequence of any record, 0 if the hash is perfect for this table */
+	FORCEINLINE uint32 GetMaxProbe() const
+	{
+		return MaxProbe;
+	}
+
+private:
+
+	static FORCEINLINE uint32 HashName(FName TagName, uint32 InSeed)
+	{
+		// Finalizer from MurmurHash3, name indices are small sequential integers so they need mixing
+		uint32 Hash = (uint32)TagName.GetComparisonIndex() * 0x9E3779B1u ^ (uint32)TagName.GetNumber() ^ InSeed;
+		Hash ^= Hash >> 16;
+		Hash *= 0x85EBCA6Bu;
+		Hash ^= Hash >> 13;
+		Hash *= 0xC2B2AE35u;
+		Hash ^= Hash >> 16;
+		return Hash;
+	}
+
+	/** Places the records with a seed, returns the longest probe */
+	uint32 PlaceRecords(const TArray<FDNATagNameRecord>& Records, uint32 InSeed);
+
+	TArray<FDNATagNameRecord> Slots;
+	uint32 SlotMask;
+	uint32 Seed;
+	uint32 MaxProbe;
+	int32 NumRecords;
+};
+
+/**
+ * Frozen, read-only copy of the tag dictionary, published by UDNATagsManager::PublishDictionarySnapshot.
+ * Nothing in a snapshot changes after it is published, so it can be used from any thread without locks, unlike the manager itself.
+ * It reflects the dictionary at the time it was published, GetDictionarySerial can be compared against the manager's to detect that.
+ */
+class DNATAGS_API FDNATagDictionarySnapshot
+{
+public:
+
+	/** Gets the tag with the specified name, or an empty tag if it is not in the dictionary. Unlike the manager this never asserts */
+	FDNATag RequestDNATag(FName TagName) const;
+
+	/** Gets a container with the tag and all of its parents as explicit tags, see UDNATagsManager::RequestDNATagParents */
+	FDNATagContainer RequestDNATagParents(const FDNATag& DNATag) const;
+
+	/** Gets a container with all children of the tag, not including the tag itself, see UDNATagsManager::RequestDNATagChildren */
+	FDNATagContainer RequestDNATagChildren(const FDNATag& DNATag) const;
+
+	/** Same as FDNATag::MatchesTag: true if Tag is TagToCheck or one of its children */
+	bool MatchesTag(const FDNATag& Tag, const FDNATag& TagToCheck) const;
+
+	/** Gets the stable index of a tag, INDEX_NONE if it was not in the dictionary when the snapshot was taken */
+	FORCEINLINE int32 GetTagIndex(const FDNATag& DNATag) const
+	{
+		const FDNATagNameRecord* Record = NameTable.Find(DNATag.GetTagName());
+		return Record ? Record->TagIndex : INDEX_NONE;
+	}
+
+	/** Gets the compact record of a tag name, or null if it was not in the dictionary when the snapshot was taken */
+	FORCEINLINE const FDNATagNameRecord* FindTagRecord(FName TagName) const
+	{
+		const FDNATagNameRecord* Record = NameTable.Find(TagName);
+		return Record && Record->TagIndex != INDEX_NONE ? Record : nullptr;
+	}
+
+	/**
+	 * Gets the record of a tag name as it is found in saved data, following redirects. A single lookup for both tags and redirected names.
+	 * The tag to load is at LoadTagIndex, which differs from TagIndex when the name is redirected.
+	 *
+	 * @return The record, or null if the name is neither a tag nor redirected
+	 */
+	FORCEINLINE const FDNATagNameRecord* FindLoadRecord(FName TagName) const
+	{
+		return NameTable.Find(TagName);
+	}
+
+	/** Same as UDNATagsManager::MatchesTagIndex */
+	FORCEINLINE bool MatchesTagIndex(int32 TagIndex, int32 TagIndexToCheck) const
+	{
+		if (TagIndex == INDEX_NONE || TagIndexToCheck == INDEX_NONE)
+		{
+			return false;
+		}
+
+		const int32 Position = TagTreeFirst[TagIndex];
+		return Position >= TagTreeFirst[TagIndexToCheck] && Position <= TagTreeLast[TagIndexToCheck];
+	}
+
+	/** Same as UDNATagsManager::GetTagAndParentIndices */
+	FORCEINLINE TArrayView<const int32> GetTagAndParentIndices(int32 TagIndex) const
+	{
+		const FDNATagIndexSpan& Span = TagAndParentSpans[TagIndex];
+		return TArrayView<const int32>(TagAndParentIndices.GetData() + Span.First, Span.Num);
+	}
+
+	/** Returns the tag that was assigned the specified index */
+	FORCEINLINE const FDNATag& GetTagFromIndex(int32 TagIndex) const
+	{
+		return IndexedTags[TagIndex];
+	}
+
+	/** The manager's dictionary serial when this snapshot was taken */
+	FORCEINLINE uint32 GetDictionarySerial() const
+	{
+		return DictionarySerial;
+	}
+
+private:
+
+	friend class UDNATagsManager;
+
+	/** Complete tag name to record, for tags that were in the tree and for redirected names */
+	FDNATagNameTable NameTable;
+
+	/** Copies of the manager's index tables, see UDNATagsManager */
+	TArray<FDNATag> IndexedTags;
+	TArray<int32> TagAndParentIndices;
+	TArray<FDNATagIndexSpan> TagAndParentSpans;
+	TArray<int32> TagTreeFirst;
+	TArray<int32> TagTreeLast;
+
+	/** Tag index at each tree position, so the children of a tag are the positions after it up to TagTreeLast */
+	TArray<int32> TreePositionTags;
+
+	uint32 DictionarySerial;
+};
+
 /** Holds data about the tag dictionary, is in a singleton UObject */
 UCLASS(config=Engine)
 class DNATAGS_API UDNATagsManager : public UObject
@@ -220,6 +518,47 @@ class DNATAGS_API UDNATagsManager : public UObject
 	/** Call to flush the list of native tags, once called it is unsafe to add more */
 	void DoneAddingNativeTags();
 
+	/**
+	 * Returns the most recently published dictionary snapshot, or null if none has been published yet.
+	 * The pointer is only guaranteed until the next publish, so hold it on the game thread, or only for the duration of a lookup.
+	 * Other threads that keep a snapshot across lookups should use AcquireDictionarySnapshot.
+	 */
+	FORCEINLINE const FDNATagDictionarySnapshot* GetDictionarySnapshot() const
+	{
+		// Acquire, pairs with the exchange in PublishDictionarySnapshot so the snapshot's contents are visible. The snapshot is immutable after that
+		return (const FDNATagDictionarySnapshot*)FPlatformAtomics::InterlockedCompareExchangePointer((void**)&PublishedSnapshot, nullptr, nullptr);
+	}
+
+	/**
+	 * Returns a reference to the most recently published dictionary snapshot, or null if none has been published yet.
+	 * This is the way to look up or match tags from threads other than the game thread. The snapshot is kept alive for as long as the reference is held.
+	 */
+	TSharedPtr<const FDNATagDictionarySnapshot, ESPMode::ThreadSafe> AcquireDictionarySnapshot() const;
+
+	/**
+	 * Checks that a snapshot reflects the tree as it is now, so lookups can use it instead of the node map.
+	 * Safe to call from the async loading thread, DictionarySerial is read atomically.
+	 */
+	FORCEINLINE bool IsCurrentDictionarySnapshot(const FDNATagDictionarySnapshot* Snapshot) const
+	{
+		const uint32 CurrentSerial = (uint32)FPlatformAtomics::InterlockedCompareExchange((volatile int32*)&DictionarySerial, 0, 0);
+		return Snapshot && Snapshot->GetDictionarySerial() == CurrentSerial;
+	}
+
+	/** Number of snapshots that are still allocated, the current one included */
+	int32 GetNumDictionarySnapshots() const
+	{
+		FScopeLock Lock(&DictionarySnapshotCritical);
+		return DictionarySnapshots.Num();
+	}
+
+	/**
+	 * Takes a snapshot of the current dictionary and publishes it atomically for GetDictionarySnapshot.
+	 * Called after native tags are done and after editor refreshes. Must be called from the game thread, which modifies the tag tree.
+	 * Older snapshots are freed once nothing references them and a few newer ones were published.
+	 */
+	void PublishDictionarySnapshot();
+
 	/**
 	 * Gets a Tag Container containing the supplied tag and all of it's parents as explicit tags
 	 *
@@ -309,6 +648,12 @@ class DNATAGS_API UDNATagsManager : public UObject
 	/** Helper function to construct the DNA tag tree */
 	void ConstructDNATagTree();
 
+	/** Adds the native tags, tag table tags and ini tags to the tree */
+	void PopulateTreeFromSources();
+
+	/** Rebuilds TagRedirects from the redirect settings */
+	void ConstructTagRedirects();
+
 	/** Helper function to destroy the DNA tag tree */
 	void DestroyDNATagTree();
 
@@ -358,6 +703,19 @@ class DNATAGS_API UDNATagsManager : public UObject
 	/** Handles redirectors for a single tag, will also error on invalid tag. This is only called for when individual tags are serialized on their own */
 	void RedirectSingleDNATag(FDNATag& Tag, UProperty* SerializingProperty) const;
 
+	/** Counts of tag references that went through the redirect functions above since the last map load started */
+	struct FTagLoadCounts
+	{
+		/** Tags that were loaded */
+		int32 NumLoadedTags;
+
+		/** Loaded tags that were redirected */
+		int32 NumRedirectedTags;
+	};
+
+	/** Returns how many tags were loaded and redirected since the last map load started */
+	FTagLoadCounts GetTagLoadCounts() const;
+
 	/** Gets a tag name from net index and vice versa, used for replication efficiency */
 	FName GetTagNameFromNetIndex(FDNATagNetIndex Index) const;
 	FDNATagNetIndex GetNetIndexFromTag(const FDNATag &InTag) const;
@@ -376,6 +734,122 @@ class DNATAGS_API UDNATagsManager : public UObject
 
 	const TArray<TSharedPtr<FDNATagNode>>& GetNetworkDNATagNodeIndex() const { return NetworkDNATagNodeIndex; }
 
+	/**
+	 * Gets the dense index of a tag, used as its bit position in FDNATagBitContainer.
+	 * Indices are assigned the first time a tag is inserted into the tree and stay the same for the lifetime of the manager, even if the tree is rebuilt.
+	 * Unlike net indices they exist whether or not fast replication is enabled.
+	 *
+	 * @param DNATag	Tag to get the index of
+	 *
+	 * @return The index of the tag, or INDEX_NONE if it is not in the dictionary
+	 */
+	FORCEINLINE_DEBUGGABLE int32 GetTagIndex(const FDNATag& DNATag) const
+	{
+		const TSharedPtr<FDNATagNode>* Node = DNATagNodeMap.Find(DNATag);
+		if (Node)
+		{
+			return (*Node)->GetTagIndex();
+		}
+#if WITH_EDITOR
+		// Same redirector fallback as FindTagNode
+		if (GIsEditor && DNATag.IsValid())
+		{
+			TSharedPtr<FDNATagNode> RedirectedNode = FindTagNode(DNATag);
+			if (RedirectedNode.IsValid())
+			{
+				return RedirectedNode->GetTagIndex();
+			}
+		}
+#endif
+		return INDEX_NONE;
+	}
+
+	/** Returns the index of the direct parent of the tag with the specified index, or INDEX_NONE if it is a root tag */
+	FORCEINLINE int32 GetParentTagIndex(int32 TagIndex) const
+	{
+		return IndexedTagParents[TagIndex];
+	}
+
+	/**
+	 * Gets the indices of a tag and all of its parents, from a flat table baked as tags are added to the tree.
+	 * The tag itself is first, followed by its parents from the direct parent up to the root. No allocation or hashing is done.
+	 * The view points into memory owned by the manager, and is only valid until more tags are added.
+	 *
+	 * @param TagIndex	Index of the tag, see GetTagIndex
+	 *
+	 * @return View of the tag and parent indices
+	 */
+	FORCEINLINE TArrayView<const int32> GetTagAndParentIndices(int32 TagIndex) const
+	{
+		const FDNATagIndexSpan& Span = TagAndParentSpans[TagIndex];
+		return TArrayView<const int32>(TagAndParentIndices.GetData() + Span.First, Span.Num);
+	}
+
+	/** Returns the tag that was assigned the specified index */
+	FORCEINLINE const FDNATag& GetTagFromIndex(int32 TagIndex) const
+	{
+		return IndexedTags[TagIndex];
+	}
+
+	/** Returns the number of tag indices assigned so far. Every valid index is less than this. Tags removed from the tree keep their index, so this can be more than the number of tags */
+	FORCEINLINE int32 GetNumTagIndices() const
+	{
+		return IndexedTags.Num();
+	}
+
+	/** Returns a serial number that changes whenever tags are added to or removed from the tree, used to invalidate cached tag lookups */
+	FORCEINLINE uint32 GetDictionarySerial() const
+	{
+		return DictionarySerial;
+	}
+
+	/**
+	 * Checks if a tag is the same as or a child of another tag, by comparing its position in a pre-order walk of the tree against the
+	 * interval covered by the other tag's subtree. This is the index version of FDNATag::MatchesTag and costs two compares.
+	 *
+	 * @param TagIndex			Index of the tag to test, see GetTagIndex
+	 * @param TagIndexToCheck	Index of the possible parent
+	 *
+	 * @return True if TagIndex is TagIndexToCheck or one of its children
+	 */
+	FORCEINLINE bool MatchesTagIndex(int32 TagIndex, int32 TagIndexToCheck) const
+	{
+		if (TagIndex == INDEX_NONE || TagIndexToCheck == INDEX_NONE)
+		{
+			return false;
+		}
+
+		const FDNATagTreePositionTable& Positions = ConditionalUpdateTagTreePositions();
+
+		const int32 Position = Positions.First[TagIndex];
+		return Position >= Positions.First[TagIndexToCheck] && Position <= Positions.Last[TagIndexToCheck];
+	}
+
+	/**
+	 * Matches two tag indices using the EDNATagMatchType rules, where IncludeParentTags expands that side to the tag and all of its parents.
+	 * Used by the container and tag APIs that take match types, so they do not need to build expanded containers.
+	 *
+	 * @return True if the two (possibly expanded) sides have a tag in common
+	 */
+	bool TagIndicesMatch(int32 TagIndexOne, TEnumAsByte<EDNATagMatchType::Type> MatchTypeOne, int32 TagIndexTwo, TEnumAsByte<EDNATagMatchType::Type> MatchTypeTwo) const;
+
+	/**
+	 * Fills OutPositions with the pre-order tree positions of the explicit tags in Container, sorted, for range queries with HasTreePositionInSubtree.
+	 * Tags that are not in the dictionary are skipped.
+	 */
+	void GetSortedTagTreePositions(const FDNATagContainer& Container, FDNATagTreePositions& OutPositions) const;
+
+	/**
+	 * Checks if any of the sorted tree positions belongs to the tag with the specified index or one of its children.
+	 * Children of a tag occupy a contiguous range of positions, so this is a single binary search.
+	 *
+	 * @param SortedPositions	Positions from GetSortedTagTreePositions
+	 * @param TagIndex			Index of the parent tag to search under
+	 *
+	 * @return True if the set contains TagIndex or any of its children
+	 */
+	bool HasTreePositionInSubtree(const FDNATagTreePositions& SortedPositions, int32 TagIndex) const;
+
 #if WITH_EDITOR
 	/** Gets a Filtered copy of the DNARootTags Array based on the comma delimited filter string passed in */
 	void GetFilteredDNARootTags(const FString& InFilterString, TArray< TSharedPtr<FDNATagNode> >& OutTagArray) const;
@@ -389,7 +863,22 @@ class DNATAGS_API UDNATagsManager : public UObject
 	/** Returns comment and source for tag. If not found return false */
 	bool GetTagEditorData(FName TagName, FString& OutComment, FName &OutTagSource) const;
 
-	/** Refresh the DNAtag tree due to an editor change */
+	/**
+	 * Finds the tags whose complete name, or optionally dev comment, contains SearchString, ignoring case.
+	 * Goes through search indices that are rebuilt lazily after the tree changes, instead of converting every node to a string.
+	 *
+	 * @param SearchString			Text to search for, an empty string matches nothing
+	 * @param bSearchDevComments	If true, tags whose dev comment contains SearchString match too
+	 * @param OutSortedPositions	Tree positions of the matching tags, sorted, for HasTreePositionInSubtree
+	 */
+	void SearchDNATags(const FString& SearchString, bool bSearchDevComments, FDNATagTreePositions& OutSortedPositions) const;
+
+	/**
+	 * Refresh the DNAtag tree due to an editor change. Only the tags that were added to or removed from the sources are inserted into or removed from
+	 * the tree, unchanged nodes are kept, and IDNATagsModule::OnDNATagTreeChangeSet is broadcast with the changes before OnDNATagTreeChanged.
+	 * Removed tags keep their tag index, and get it back if they are added again. The index tables are not compacted, so they grow by every
+	 * distinct tag name seen during the session. That is a few bytes per name and keeps every index held by a container or query valid.
+	 */
 	void EditorRefreshDNATagTree();
 
 	/** Gets a Tag Container containing the all tags in the hierarchy that are children of this tag, and were explicitly added to the dictionary */
@@ -408,13 +897,7 @@ class DNATAGS_API UDNATagsManager : public UObject
 		}
 		else
 		{
-			// Convert both to their containers and do that match
-			const FDNATagContainer* ContainerOne = GetSingleTagContainer(DNATagOne);
-			const FDNATagContainer* ContainerTwo = GetSingleTagContainer(DNATagTwo);
-			if (ContainerOne && ContainerTwo)
-			{
-				bResult = ContainerOne->DoesTagContainerMatch(*ContainerTwo, MatchTypeOne, MatchTypeTwo, EDNAContainerMatchType::Any);
-			}
+			bResult = TagIndicesMatch(GetTagIndex(DNATagOne), MatchTypeOne, GetTagIndex(DNATagTwo), MatchTypeTwo);
 		}
 		return bResult;
 	}
@@ -425,6 +908,21 @@ class DNATAGS_API UDNATagsManager : public UObject
 	void PrintReplicationFrequencyReport();
 	void NotifyTagReplicated(FDNATag Tag, bool WasInContainer);
 
+	/**
+	 * Computes the CommonlyReplicatedTags order and NetIndexFirstBitSegment that minimize the bits spent replicating tags with the given counts.
+	 * Tags are ranked by frequency, which is optimal for the two segment encoding of SerializeTagNetIndexPacked, and every first segment length is tried.
+	 */
+	FDNATagNetIndexLayout ComputeNetIndexLayout(const TMap<FDNATag, int32>& ReplicationCounts) const;
+
+	/** Writes the layout computed from ReplicationCountMap as a config section that can be pasted into DefaultDNATags.ini */
+	void WriteNetIndexLayout(const FString& FileName) const;
+
+	/** Returns the path WriteNetIndexLayout uses by default */
+	static FString GetNetIndexLayoutPath();
+
+	/** Number of bits SerializeTagNetIndexPacked writes for a net index */
+	static int32 GetPackedNetIndexBits(int32 NetIndex, int32 FirstBitSegment, int32 MaxBits);
+
 	TMap<FDNATag, int32>	ReplicationCountMap;
 	TMap<FDNATag, int32>	ReplicationCountMap_SingleTags;
 	TMap<FDNATag, int32>	ReplicationCountMap_Containers;
@@ -439,6 +937,7 @@ private:
 	static UDNATagsManager* SingletonManager;
 
 	friend class FDNATagTest;
+	friend class FDNATagBenchmark;
 	friend class FDNAEffectsTest;
 	friend class FDNATagsModule;
 	friend class FDNATagsEditorModule;
@@ -461,6 +960,35 @@ private:
 
 	void AddTagTableRow(const FDNATagTableRow& TagRow, FName SourceName);
 
+#if WITH_EDITOR
+	/** A row added by one of the tag sources, gathered by an incremental refresh instead of being inserted */
+	struct FGatheredTagRow
+	{
+		FDNATagTableRow TagRow;
+		FName SourceName;
+	};
+
+	/** Set while an incremental refresh gathers the rows of the tag sources, AddTagTableRow adds rows here instead of to the tree */
+	TArray<FGatheredTagRow>* GatheredTagRows;
+
+	/** Inserts the tags of the rows that are not in the tree and removes the tags no row implies anymore, filling in OutChangeSet */
+	void ApplyGatheredTagRows(const TArray<FGatheredTagRow>& Rows, FDNATagTreeChangeSet& OutChangeSet);
+
+	/** Removes a node from the tree. The caller removes its children first or with it */
+	void RemoveTagNode(const TSharedPtr<FDNATagNode>& Node);
+
+	/** Updates the net indices for an incremental change, only reassigning the indices after the first changed position */
+	void PatchNetIndex(const FDNATagTreeChangeSet& ChangeSet);
+#endif
+
+#if WITH_EDITORONLY_DATA
+	/** Applies the source and comment of a row to the node of its tag. The first source is kept unless the new one is native, and the first comment is kept */
+	static void ApplyTagRowEditorData(FDNATagNode& Node, FName SourceName, const FString& DevComment);
+#endif
+
+	/** Reads the replication and validation settings and the commonly replicated tags, which are used when building the net indices */
+	void ReadTagTreeSettings();
+
 	void AddChildrenTags(FDNATagContainer& TagContainer, TSharedPtr<FDNATagNode> DNATagNode, bool RecurseAll=true, bool OnlyIncludeDictionaryTags=false) const;
 
 	/**
@@ -478,6 +1006,47 @@ private:
 	/** Constructs the net indices for each tag */
 	void ConstructNetIndex();
 
+	/** Assigns net indices in the order of NetworkDNATagNodeIndex and updates the bit counts used to replicate them. Nodes before FirstIndex are assumed to be assigned already */
+	void AssignNetIndices(int32 FirstIndex = 0);
+
+	/** Returns true if the tag tree should be loaded from and saved to the binary tag dictionary cache */
+	bool ShouldUseTagDictionaryCache() const;
+
+	/** Hashes everything the tag tree is built from: native tags, the tag table and ini files by size and timestamp, and the tag list, replication and redirect settings */
+	void HashTagSources(FSHAHash& OutHash) const;
+
+	/** Builds the tree, net index order, redirects and source tag lists from the tag dictionary cache. Returns false without changing anything if the cache is missing, invalid or was built from other sources */
+	bool LoadTagDictionaryCache(const FSHAHash& SourceHash);
+
+	/** Writes the tree, net index order, redirects and source tag lists to the tag dictionary cache, along with how long the full build took */
+	void SaveTagDictionaryCache(const FSHAHash& SourceHash, double BuildSeconds) const;
+
+	/** Returns the path of the tag dictionary cache file */
+	static FString GetTagDictionaryCachePath();
+
+	/** Returns the stable tag index for the tag, assigning a new one if it has never been in the tree */
+	int32 FindOrAddTagIndex(const FDNATag& Tag, int32 ParentTagIndex);
+
+	/**
+	 * Returns the tree positions used by MatchesTagIndex, rebuilding them first if tags have been added or removed since they were last built.
+	 * Safe to call from several threads at once, the returned table does not change while it is used
+	 */
+	FORCEINLINE const FDNATagTreePositionTable& ConditionalUpdateTagTreePositions() const
+	{
+		const FDNATagTreePositionTable* Positions = TagTreePositions;
+		if (Positions == nullptr || Positions->Serial != DictionarySerial)
+		{
+			return UpdateTagTreePositions();
+		}
+		return *Positions;
+	}
+
+	/** Walks the tree to build a new table of the pre-order position and subtree interval of every tag, and publishes it */
+	const FDNATagTreePositionTable& UpdateTagTreePositions() const;
+
+	/** Assigns tree positions to Node and its children, starting at NextPosition */
+	static void AssignTagTreePositions(const TSharedPtr<FDNATagNode>& Node, int32& NextPosition, FDNATagTreePositionTable& Positions);
+
 	/** Roots of DNA tag nodes */
 	TSharedPtr<FDNATagNode> DNARootTag;
 
@@ -512,10 +1081,74 @@ private:
 	/** Sorted list of nodes, used for network replication */
 	TArray<TSharedPtr<FDNATagNode>> NetworkDNATagNodeIndex;
 
+	/** DictionarySerial when the net indices were last assigned, so they are only rebuilt if the tree changed */
+	uint32 NetIndexDictionarySerial;
+
 	/** Holds all of the valid DNA-related tags that can be applied to assets */
 	UPROPERTY()
 	TArray<UDataTable*> DNATagTables;
 
-	/** The map of ini-configured tag redirectors */
+	/** The map of ini-configured tag redirectors. Once a snapshot is published, its name table resolves these in the same lookup as the tags */
 	TMap<FName, FDNATag> TagRedirects;
+
+	/** Tags loaded and redirected through RedirectTagsForContainer and RedirectSingleDNATag, which can run on the async loading thread */
+	mutable FThreadSafeCounter NumLoadedTags;
+	mutable FThreadSafeCounter NumRedirectedTags;
+
+	/** Resets and reports the load counters around map loads */
+	void HandlePreLoadMap(const FString& MapName);
+	void HandlePostLoadMap();
+
+	/** Warns about a tag that is not in the dictionary found while loading a property */
+	void WarnInvalidLoadedTag(FName TagName, UProperty* SerializingProperty) const;
+
+	/** Map of complete tag names to their stable tag index. Never shrinks, so an index always refers to the same tag, including tags since removed from the tree */
+	TMap<FName, int32> TagIndexMap;
+
+	/** Tag for each tag index */
+	TArray<FDNATag> IndexedTags;
+
+	/** Parent tag index for each tag index, INDEX_NONE for root tags */
+	TArray<int32> IndexedTagParents;
+
+	/** Flat table of the tag and parent indices of every tag index, see GetTagAndParentIndices. Tags are named by their parents, so entries never change once added */
+	TArray<int32> TagAndParentIndices;
+
+	/** Span of TagAndParentIndices for each tag index */
+	TArray<FDNATagIndexSpan> TagAndParentSpans;
+
+	/** Incremented whenever the contents of the tree change */
+	uint32 DictionarySerial;
+
+	/** The latest tree positions, built lazily, see MatchesTagIndex. Read without a lock and replaced atomically by UpdateTagTreePositions */
+	mutable const FDNATagTreePositionTable* volatile TagTreePositions;
+
+	/** Every table built since the tree was last destroyed. Replaced tables are kept, a matching thread may still be reading one */
+	mutable TArray<TUniquePtr<FDNATagTreePositionTable>> TagTreePositionTables;
+
+	/** Serializes rebuilding the tree positions. Exists in every build, matching can run on the async loading thread */
+	mutable FCriticalSection TagTreePositionCritical;
+
+#if WITH_EDITOR
+	/** Complete tag names by tag index, for SearchDNATags. Tags that are no longer in the tree have an empty entry */
+	mutable FDNATagSearchIndex TagNameSearchIndex;
+
+	/** Dev comments by tag index, for SearchDNATags */
+	mutable FDNATagSearchIndex TagCommentSearchIndex;
+
+	/** DictionarySerial the search indices were built for, reset when editor data changes without the tree changing */
+	mutable uint32 SearchIndexSerial;
+#endif
+
+	/** Number of the latest snapshots kept even when unreferenced, for GetDictionarySnapshot readers in the middle of a lookup */
+	static const int32 NumRetainedSnapshots = 4;
+
+	/** Published snapshots that are still retained or referenced, oldest first. The last one is the current snapshot */
+	TArray<TSharedPtr<const FDNATagDictionarySnapshot, ESPMode::ThreadSafe>> DictionarySnapshots;
+
+	/** Guards reading the current entry of DictionarySnapshots in AcquireDictionarySnapshot against a publish */
+	mutable FCriticalSection DictionarySnapshotCritical;
+
+	/** The latest entry of DictionarySnapshots, written atomically */
+	const FDNATagDictionarySnapshot* volatile PublishedSnapshot;
 };
@@ -76,6 +76,13 @@ class DNATAGS_API UDNATagsSettings : public UDNATagsList
 	UPROPERTY(config, EditAnywhere, Category = "Advanced Replication")
 	bool FastReplication;
 
+	/**
+	 * If true, games and dedicated servers save the built tag tree to a binary cache under Saved/ and load it on later runs instead of
+	 * parsing the tag tables and ini files again. The cache is rebuilt whenever any tag source changes. Not used by the editor
+	 */
+	UPROPERTY(config, EditAnywhere, Category = DNATags)
+	bool CacheTagDictionary;
+
 	/** List of data tables to load tags from */
 	UPROPERTY(config, EditAnywhere, Category = DNATags, meta = (AllowedClasses = "DataTable"))
 	TArray<FStringAssetReference> DNATagTableList;
@@ -0,0 +1,369 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "Core.h"
+#include "DNATagBitContainer.h"
+#include "DNATagsManager.h"
+
+void FDNATagBitContainer::AddTag(const FDNATag& TagToAdd)
+{
+	const UDNATagsManager& TagManager = UDNATagsManager::Get();
+
+	const int32 TagIndex = TagManager.GetTagIndex(TagToAdd);
+	if (TagIndex != INDEX_NONE)
+	{
+		SetExplicitTagIndex(TagIndex, true);
+
+		for (int32 ImpliedIndex : TagManager.GetTagAndParentIndices(TagIndex))
+		{
+			SetBit(ImpliedWords, ImpliedIndex);
+		}
+	}
+}
+
+void FDNATagBitContainer::AppendTags(const FDNATagContainer& Other)
+{
+	for (const FDNATag& Tag : Other)
+	{
+		AddTag(Tag);
+	}
+}
+
+void FDNATagBitContainer::Reset()
+{
+	ExplicitWords.Reset();
+	ImpliedWords.Reset();
+	ExplicitWordIndices.Reset();
+}
+
+void FDNATagBitContainer::SetExplicitTagIndex(int32 TagIndex, bool bValue)
+{
+	check(TagIndex >= 0);
+	const int32 WordIndex = TagIndex / BitsPerWord;
+
+	if (bValue)
+	{
+		if (GetWord(ExplicitWords, WordIndex) == 0)
+		{
+			// First explicit tag in this word, keep the word list sorted
+			int32 InsertIdx = 0;
+			while (InsertIdx < ExplicitWordIndices.Num() && ExplicitWordIndices[InsertIdx] < WordIndex)
+			{
+				++InsertIdx;
+			}
+			ExplicitWordIndices.Insert(WordIndex, InsertIdx);
+		}
+		SetBit(ExplicitWords, TagIndex);
+	}
+	else if (TestBit(ExplicitWords, TagIndex) && ClearBit(ExplicitWords, TagIndex))
+	{
+		ExplicitWordIndices.RemoveSingle(WordIndex);
+	}
+}
+
+void FDNATagBitContainer::SetImpliedTagIndex(int32 TagIndex, bool bValue)
+{
+	check(TagIndex >= 0);
+
+	if (bValue)
+	{
+		SetBit(ImpliedWords, TagIndex);
+	}
+	else if (TestBit(ImpliedWords, TagIndex))
+	{
+		ClearBit(ImpliedWords, TagIndex);
+	}
+}
+
+bool FDNATagBitContainer::HasTag(const FDNATag& TagToCheck) const
+{
+	if (!TagToCheck.IsValid())
+	{
+		return false;
+	}
+	return HasTagIndex(UDNATagsManager::Get().GetTagIndex(TagToCheck));
+}
+
+bool FDNATagBitContainer::HasTagExact(const FDNATag& TagToCheck) const
+{
+	if (!TagToCheck.IsValid())
+	{
+		return false;
+	}
+	return HasTagIndexExact(UDNATagsManager::Get().GetTagIndex(TagToCheck));
+}
+
+bool FDNATagBitContainer::HasAny(const FDNATagBitContainer& ContainerToCheck) const
+{
+	for (int32 WordIndex : ContainerToCheck.ExplicitWordIndices)
+	{
+		if ((GetWord(ImpliedWords, WordIndex) & ContainerToCheck.ExplicitWords[WordIndex]) != 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool FDNATagBitContainer::HasAnyExact(const FDNATagBitContainer& ContainerToCheck) const
+{
+	for (int32 WordIndex : ContainerToCheck.ExplicitWordIndices)
+	{
+		if ((GetWord(ExplicitWords, WordIndex) & ContainerToCheck.ExplicitWords[WordIndex]) != 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool FDNATagBitContainer::HasAll(const FDNATagBitContainer& ContainerToCheck) const
+{
+	for (int32 WordIndex : ContainerToCheck.ExplicitWordIndices)
+	{
+		const uint64 RequiredBits = ContainerToCheck.ExplicitWords[WordIndex];
+		if ((GetWord(ImpliedWords, WordIndex) & RequiredBits) != RequiredBits)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool FDNATagBitContainer::HasAllExact(const FDNATagBitContainer& ContainerToCheck) const
+{
+	for (int32 WordIndex : ContainerToCheck.ExplicitWordIndices)
+	{
+		const uint64 RequiredBits = ContainerToCheck.ExplicitWords[WordIndex];
+		if ((GetWord(ExplicitWords, WordIndex) & RequiredBits) != RequiredBits)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void FDNATagBitContainer::SetBit(FWordArray& Words, int32 TagIndex)
+{
+	const int32 WordIndex = TagIndex / BitsPerWord;
+	if (WordIndex >= Words.Num())
+	{
+		Words.AddZeroed(WordIndex + 1 - Words.Num());
+	}
+	Words[WordIndex] |= (1ull << (TagIndex % BitsPerWord));
+}
+
+bool FDNATagBitContainer::ClearBit(FWordArray& Words, int32 TagIndex)
+{
+	const int32 WordIndex = TagIndex / BitsPerWord;
+	Words[WordIndex] &= ~(1ull << (TagIndex % BitsPerWord));
+	return Words[WordIndex] == 0;
+}
+
+const FDNATagBitContainer& FDNATagBitContainerCache::Get(const FDNATagContainer& Container) const
+{
+	const uint32 DictionarySerial = UDNATagsManager::Get().GetDictionarySerial();
+
+	bool bUpToDate = bCached && CachedDictionarySerial == DictionarySerial && CachedTags.Num() == Container.Num();
+	if (bUpToDate)
+	{
+		int32 TagIdx = 0;
+		for (const FDNATag& Tag : Container)
+		{
+			if (CachedTags[TagIdx++] != Tag)
+			{
+				bUpToDate = false;
+				break;
+			}
+		}
+	}
+
+	if (!bUpToDate)
+	{
+		Bits.Reset();
+		Bits.AppendTags(Container);
+
+		const UDNATagsManager& TagManager = UDNATagsManager::Get();
+		CachedTags.Reset();
+		bHasUnindexedTags = false;
+		for (const FDNATag& Tag : Container)
+		{
+			CachedTags.Add(Tag);
+			bHasUnindexedTags |= TagManager.GetTagIndex(Tag) == INDEX_NONE;
+		}
+
+		CachedDictionarySerial = DictionarySerial;
+		bCached = true;
+	}
+
+	return Bits;
+}
+
+void FDNATagBitBatch::Reset()
+{
+	WordToSlot.Reset();
+	SlotWords.Reset();
+	Columns.Reset();
+	NumSets = 0;
+}
+
+void FDNATagBitBatch::AddWord(int32 WordIndex)
+{
+	check(WordIndex >= 0);
+	if (WordIndex >= WordToSlot.Num())
+	{
+		const int32 OldNum = WordToSlot.Num();
+		WordToSlot.AddUninitialized(WordIndex + 1 - OldNum);
+		for (int32 Idx = OldNum; Idx < WordToSlot.Num(); ++Idx)
+		{
+			WordToSlot[Idx] = INDEX_NONE;
+		}
+	}
+
+	if (WordToSlot[WordIndex] == INDEX_NONE)
+	{
+		WordToSlot[WordIndex] = SlotWords.Add(WordIndex);
+	}
+}
+
+void FDNATagBitBatch::InitColumns(int32 InNumSets)
+{
+	NumSets = InNumSets;
+	Columns.Reset(SlotWords.Num() * NumSets);
+	Columns.AddZeroed(SlotWords.Num() * NumSets);
+}
+
+void FDNATagBitBatch::Gather(TArrayView<const FDNATagBitContainer* const> Containers)
+{
+	InitColumns(Containers.Num());
+
+	for (int32 Slot = 0; Slot < SlotWords.Num(); ++Slot)
+	{
+		const int32 WordIndex = SlotWords[Slot];
+		uint64* Column = Columns.GetData() + Slot * NumSets;
+
+		for (int32 SetIdx = 0; SetIdx < NumSets; ++SetIdx)
+		{
+			const FDNATagBitContainer* Container = Containers[SetIdx];
+			Column[SetIdx] = Container ? Container->GetImpliedWord(WordIndex) : 0;
+		}
+	}
+}
+
+void FDNATagBitBatch::Gather(TArrayView<const FDNATagContainer* const> Containers)
+{
+	InitColumns(Containers.Num());
+
+	const UDNATagsManager& TagManager = UDNATagsManager::Get();
+
+	for (int32 SetIdx = 0; SetIdx < NumSets; ++SetIdx)
+	{
+		const FDNATagContainer* Container = Containers[SetIdx];
+		if (Container == nullptr)
+		{
+			continue;
+		}
+
+		for (const FDNATag& Tag : *Container)
+		{
+			const int32 TagIndex = TagManager.GetTagIndex(Tag);
+			if (TagIndex == INDEX_NONE)
+			{
+				continue;
+			}
+
+			for (int32 ImpliedIndex : TagManager.GetTagAndParentIndices(TagIndex))
+			{
+				// Only keep the words some test reads
+				const int32 WordIndex = ImpliedIndex / FDNATagBitContainer::BitsPerWord;
+				const int32 Slot = WordToSlot.IsValidIndex(WordIndex) ? WordToSlot[WordIndex] : INDEX_NONE;
+				if (Slot != INDEX_NONE)
+				{
+					Columns[Slot * NumSets + SetIdx] |= (1ull << (ImpliedIndex % FDNATagBitContainer::BitsPerWord));
+				}
+			}
+		}
+	}
+}
+
+void FDNATagBitBatch::InitLanes(FLanes& Lanes, bool bValue) const
+{
+	const int32 NumLaneWords = GetNumLaneWords();
+	Lanes.Reset(NumLaneWords);
+	Lanes.AddZeroed(NumLaneWords);
+
+	if (bValue)
+	{
+		InvertLanes(Lanes);
+	}
+}
+
+const uint64* FDNATagBitBatch::GetColumn(int32 WordIndex) const
+{
+	check(WordToSlot.IsValidIndex(WordIndex) && WordToSlot[WordIndex] != INDEX_NONE);
+	return Columns.GetData() + WordToSlot[WordIndex] * NumSets;
+}
+
+void FDNATagBitBatch::TestAny(int32 WordIndex, uint64 Mask, FLanes& InOutLanes) const
+{
+	const uint64* Column = GetColumn(WordIndex);
+
+	for (int32 LaneWord = 0; LaneWord < InOutLanes.Num(); ++LaneWord)
+	{
+		const int32 FirstSet = LaneWord * FDNATagBitContainer::BitsPerWord;
+		const int32 NumLaneSets = FMath::Min(FDNATagBitContainer::BitsPerWord, NumSets - FirstSet);
+
+		// Branch free so the compiler can vectorize the column walk
+		uint64 LaneBits = 0;
+		for (int32 Bit = 0; Bit < NumLaneSets; ++Bit)
+		{
+			LaneBits |= (uint64)((Column[FirstSet + Bit] & Mask) != 0) << Bit;
+		}
+		InOutLanes[LaneWord] |= LaneBits;
+	}
+}
+
+void FDNATagBitBatch::TestAll(int32 WordIndex, uint64 Mask, FLanes& InOutLanes) const
+{
+	const uint64* Column = GetColumn(WordIndex);
+
+	for (int32 LaneWord = 0; LaneWord < InOutLanes.Num(); ++LaneWord)
+	{
+		const int32 FirstSet = LaneWord * FDNATagBitContainer::BitsPerWord;
+		const int32 NumLaneSets = FMath::Min(FDNATagBitContainer::BitsPerWord, NumSets - FirstSet);
+
+		uint64 LaneBits = 0;
+		for (int32 Bit = 0; Bit < NumLaneSets; ++Bit)
+		{
+			LaneBits |= (uint64)((Column[FirstSet + Bit] & Mask) == Mask) << Bit;
+		}
+		InOutLanes[LaneWord] &= LaneBits;
+	}
+}
+
+void FDNATagBitBatch::InvertLanes(FLanes& InOutLanes) const
+{
+	for (int32 LaneWord = 0; LaneWord < InOutLanes.Num(); ++LaneWord)
+	{
+		InOutLanes[LaneWord] = ~InOutLanes[LaneWord];
+	}
+
+	// Keep the bits past the last set clear
+	const int32 NumTailSets = NumSets % FDNATagBitContainer::BitsPerWord;
+	if (NumTailSets != 0 && InOutLanes.Num() > 0)
+	{
+		InOutLanes.Last() &= (1ull << NumTailSets) - 1;
+	}
+}
+
+void FDNATagBitBatch::LanesToBitArray(const FLanes& Lanes, TBitArray<>& OutResults) const
+{
+	OutResults.Init(false, NumSets);
+
+	for (int32 SetIdx = 0; SetIdx < NumSets; ++SetIdx)
+	{
+		if ((Lanes[SetIdx / FDNATagBitContainer::BitsPerWord] >> (SetIdx % FDNATagBitContainer::BitsPerWord)) & 1)
+		{
+			OutResults[SetIdx] = true;
+		}
+	}
+}
@@ -9,6 +9,7 @@
 #include "UObject/Package.h"
 #include "Engine/NetConnection.h"
 #include "DNATagsManager.h"
+#include "DNATagBitContainer.h"
 #include "DNATagsModule.h"
 #include "Misc/OutputDeviceNull.h"
 
@@ -38,6 +39,8 @@ DEFINE_STAT(STAT_UDNATagsManager_DNATagsMatch);
  *	-Take this list and put it in DefaultDNATags.ini.
  *	-CommonlyReplicatedTags is the ordered list of tags.
  *	-NetIndexFirstBitSegment is the number of bits (not including the "more" bit) for the first segment.
+ *	-Or run "DNATags.WriteNetIndexLayout", or set "DNATags.WriteNetIndexLayoutOnShutdown 1", to write both settings to Saved/DNATags/SuggestedNetIndexLayout.ini
+ *	 along with the projected bits per tag. The suggested layout ranks tags by frequency and picks the first segment length with the lowest total cost.
  *
  */
 void SerializeTagNetIndexPacked(FArchive& Ar, FDNATagNetIndex& Value, const int32 NetIndexFirstBitSegment, const int32 MaxBits)
@@ -117,6 +120,9 @@ public:
 	/** Parses the token stream into an FExpr. */
 	void Read(struct FDNATagQueryExpression& E);
 
+	/** Parses the token stream into a flat program. Returns false if the stream could not be parsed. */
+	bool Compile(FDNATagQueryProgram& OutProgram);
+
 private:
 	FDNATagQuery const& Query;
 	int32 CurStreamIdx;
@@ -133,6 +139,7 @@ private:
 
 	bool EvalExpr(FDNATagContainer const& Tags, bool bSkip = false);
 	void ReadExpr(struct FDNATagQueryExpression& E);
+	void CompileExpr(FDNATagQueryProgram& OutProgram);
 
 #if WITH_EDITOR
 public:
@@ -252,6 +259,109 @@ void FQueryEvaluator::ReadExpr(FDNATagQueryExpression& E)
 }
 
 
+bool FQueryEvaluator::Compile(FDNATagQueryProgram& OutProgram)
+{
+	OutProgram.Ops.Reset();
+	OutProgram.Tags.Reset();
+	OutProgram.MaskWords.Reset();
+	OutProgram.Masks.Reset();
+	CurStreamIdx = 0;
+
+	Version = GetToken();
+	if (!bReadError)
+	{
+		uint8 const bHasRootExpression = GetToken();
+		if (!bReadError && bHasRootExpression)
+		{
+			CompileExpr(OutProgram);
+		}
+	}
+
+	return !bReadError && CurStreamIdx == Query.QueryTokenStream.Num();
+}
+
+void FQueryEvaluator::CompileExpr(FDNATagQueryProgram& OutProgram)
+{
+	const int32 OpIdx = OutProgram.Ops.AddUninitialized();
+	{
+		FDNATagQueryProgram::FOp& Op = OutProgram.Ops[OpIdx];
+		Op.ExprType = GetToken();
+		Op.bHasUnknownTag = false;
+		Op.Num = GetToken();
+		Op.FirstTag = OutProgram.Tags.Num();
+		Op.FirstMask = OutProgram.Masks.Num();
+		Op.NumMasks = 0;
+	}
+	if (bReadError)
+	{
+		return;
+	}
+
+	const EDNATagQueryExprType::Type ExprType = (EDNATagQueryExprType::Type)OutProgram.Ops[OpIdx].ExprType;
+	const int32 Num = OutProgram.Ops[OpIdx].Num;
+
+	if (ExprType == EDNATagQueryExprType::AnyTagsMatch || ExprType == EDNATagQueryExprType::AllTagsMatch || ExprType == EDNATagQueryExprType::NoTagsMatch)
+	{
+		const UDNATagsManager& TagManager = UDNATagsManager::Get();
+
+		for (int32 Idx = 0; Idx < Num; ++Idx)
+		{
+			int32 const TagIdx = GetToken();
+			if (bReadError || !Query.TagDictionary.IsValidIndex(TagIdx))
+			{
+				bReadError = true;
+				return;
+			}
+
+			const FDNATag& Tag = Query.TagDictionary[TagIdx];
+			OutProgram.Tags.Add(Tag);
+
+			const int32 TagIndex = TagManager.GetTagIndex(Tag);
+			if (TagIndex == INDEX_NONE)
+			{
+				OutProgram.Ops[OpIdx].bHasUnknownTag = true;
+				continue;
+			}
+
+			// Merge into this op's sorted word list
+			const int32 WordIndex = TagIndex / FDNATagBitContainer::BitsPerWord;
+			const uint64 Bit = 1ull << (TagIndex % FDNATagBitContainer::BitsPerWord);
+			const int32 FirstMask = OutProgram.Ops[OpIdx].FirstMask;
+
+			int32 MaskIdx = FirstMask;
+			while (MaskIdx < OutProgram.MaskWords.Num() && OutProgram.MaskWords[MaskIdx] < WordIndex)
+			{
+				++MaskIdx;
+			}
+
+			if (MaskIdx < OutProgram.MaskWords.Num() && OutProgram.MaskWords[MaskIdx] == WordIndex)
+			{
+				OutProgram.Masks[MaskIdx] |= Bit;
+			}
+			else
+			{
+				OutProgram.MaskWords.Insert(WordIndex, MaskIdx);
+				OutProgram.Masks.Insert(Bit, MaskIdx);
+			}
+		}
+
+		OutProgram.Ops[OpIdx].NumMasks = OutProgram.Masks.Num() - OutProgram.Ops[OpIdx].FirstMask;
+	}
+	else if (ExprType == EDNATagQueryExprType::AnyExprMatch || ExprType == EDNATagQueryExprType::AllExprMatch || ExprType == EDNATagQueryExprType::NoExprMatch)
+	{
+		for (int32 Idx = 0; Idx < Num && !bReadError; ++Idx)
+		{
+			CompileExpr(OutProgram);
+		}
+	}
+	else
+	{
+		bReadError = true;
+	}
+
+	OutProgram.Ops[OpIdx].End = OutProgram.Ops.Num();
+}
+
 bool FQueryEvaluator::EvalAnyTagsMatch(FDNATagContainer const& Tags, bool bSkip)
 {
 	bool bShortCircuit = bSkip;
@@ -533,19 +643,19 @@ bool FDNATagContainer::ComplexHasTag(FDNATag const& TagToCheck, TEnumAsByte<EDNA
 {
 	check(TagMatchType != EDNATagMatchType::Explicit || TagToCheckMatchType != EDNATagMatchType::Explicit);
 
-	if (TagMatchType == EDNATagMatchType::IncludeParentTags)
-	{
-		FDNATagContainer ExpandedConatiner = GetDNATagParents();
-		return ExpandedConatiner.HasTagFast(TagToCheck, EDNATagMatchType::Explicit, TagToCheckMatchType);
-	}
-	else
+	const UDNATagsManager& TagManager = UDNATagsManager::Get();
+	const int32 TagIndexToCheck = TagManager.GetTagIndex(TagToCheck);
+
+	if (TagIndexToCheck != INDEX_NONE)
 	{
-		const FDNATagContainer* SingleContainer = UDNATagsManager::Get().GetSingleTagContainer(TagToCheck);
-		if (SingleContainer && SingleContainer->DoesTagContainerMatch(*this, EDNATagMatchType::IncludeParentTags, EDNATagMatchType::Explicit, EDNAContainerMatchType::Any))
+		// Match against the tree intervals instead of expanding either side into a container
+		for (const FDNATag& Tag : DNATags)
 		{
-			return true;
+			if (TagManager.TagIndicesMatch(TagManager.GetTagIndex(Tag), TagMatchType, TagIndexToCheck, TagToCheckMatchType))
+			{
+				return true;
+			}
 		}
-
 	}
 	return false;
 }
@@ -570,36 +680,49 @@ bool FDNATagContainer::RemoveTagByExplicitName(const FName& TagName)
 
 FORCEINLINE_DEBUGGABLE void FDNATagContainer::AddParentsForTag(const FDNATag& Tag)
 {
-	const FDNATagContainer* SingleContainer = UDNATagsManager::Get().GetSingleTagContainer(Tag);
+	const UDNATagsManager& TagManager = UDNATagsManager::Get();
+	const int32 TagIndex = TagManager.GetTagIndex(Tag);
 
-	if (SingleContainer)
+	if (TagIndex != INDEX_NONE)
 	{
-		// Add Parent tags from this tag to our own
-		for (const FDNATag& ParentTag : SingleContainer->ParentTags)
+		// Add Parent tags from this tag to our own, the first entry is the tag itself
+		TArrayView<const int32> TagAndParents = TagManager.GetTagAndParentIndices(TagIndex);
+		for (int32 ParentIdx = 1; ParentIdx < TagAndParents.Num(); ++ParentIdx)
 		{
-			ParentTags.AddUnique(ParentTag);
+			ParentTags.AddUnique(TagManager.GetTagFromIndex(TagAndParents[ParentIdx]));
 		}
 	}
 }
 
 DECLARE_CYCLE_STAT(TEXT("FDNATagContainer::FillParentTags"), STAT_FDNATagContainer_FillParentTags, STATGROUP_DNATags);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Parent Tag Fills"), STAT_FDNATagContainer_ParentTagFills, STATGROUP_DNATags);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Parent Tag Fills That Allocated"), STAT_FDNATagContainer_ParentTagAllocatingFills, STATGROUP_DNATags);
 
 void FDNATagContainer::FillParentTags()
 {
 	SCOPE_CYCLE_COUNTER(STAT_FDNATagContainer_FillParentTags);
 
 	ParentTags.Reset();
+	const int32 OldParentTagsMax = ParentTags.Max();
 
 	for (const FDNATag& Tag : DNATags)
 	{
 		AddParentsForTag(Tag);
 	}
+
+	// Reset keeps the allocation, so only fills that outgrew it allocated. Compare against the total to see what inline storage would save
+	INC_DWORD_STAT(STAT_FDNATagContainer_ParentTagFills);
+	if (ParentTags.Max() > OldParentTagsMax)
+	{
+		INC_DWORD_STAT(STAT_FDNATagContainer_ParentTagAllocatingFills);
+	}
 }
 
 FDNATagContainer FDNATagContainer::GetDNATagParents() const
 {
 	FDNATagContainer ResultContainer;
-	ResultContainer.DNATags = DNATags;
+	ResultContainer.DNATags.Reserve(DNATags.Num() + ParentTags.Num());
+	ResultContainer.DNATags.Append(DNATags);
 
 	// Add parent tags to explicit tags, the rest got copied over already
 	for (const FDNATag& Tag : ParentTags)
@@ -668,16 +791,43 @@ FDNATagContainer FDNATagContainer::FilterExact(const FDNATagContainer& OtherCont
 
 bool FDNATagContainer::DoesTagContainerMatchComplex(const FDNATagContainer& OtherContainer, TEnumAsByte<EDNATagMatchType::Type> TagMatchType, TEnumAsByte<EDNATagMatchType::Type> OtherTagMatchType, EDNAContainerMatchType ContainerMatchType) const
 {
-	UDNATagsManager& TagManager = UDNATagsManager::Get();
+	const UDNATagsManager& TagManager = UDNATagsManager::Get();
+
+	if (ContainerMatchType == EDNAContainerMatchType::Any && OtherTagMatchType == EDNATagMatchType::IncludeParentTags)
+	{
+		// One of our tags matches a parent of an other tag if that other tag is in its subtree, which is a range query over the sorted tree positions
+		FDNATagTreePositions OtherPositions;
+		TagManager.GetSortedTagTreePositions(OtherContainer, OtherPositions);
+
+		for (const FDNATag& Tag : DNATags)
+		{
+			int32 TagIndex = TagManager.GetTagIndex(Tag);
+			if (TagIndex != INDEX_NONE && TagMatchType == EDNATagMatchType::IncludeParentTags)
+			{
+				// Our parents are included too, so search under our root
+				TArrayView<const int32> TagAndParents = TagManager.GetTagAndParentIndices(TagIndex);
+				TagIndex = TagAndParents[TagAndParents.Num() - 1];
+			}
+
+			if (TagManager.HasTreePositionInSubtree(OtherPositions, TagIndex))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Explicit matches compare names like DNATagsMatch, so tags that are not in the dictionary still match themselves
+	const bool bBothExplicit = TagMatchType == EDNATagMatchType::Explicit && OtherTagMatchType == EDNATagMatchType::Explicit;
 
 	for (TArray<FDNATag>::TConstIterator OtherIt(OtherContainer.DNATags); OtherIt; ++OtherIt)
 	{
 		bool bTagFound = false;
+		const int32 OtherTagIndex = bBothExplicit ? INDEX_NONE : TagManager.GetTagIndex(*OtherIt);
 
 		for (TArray<FDNATag>::TConstIterator It(this->DNATags); It; ++It)
 		{
-			PRAGMA_DISABLE_DEPRECATION_WARNINGS
-			if (TagManager.DNATagsMatch(*It, TagMatchType, *OtherIt, OtherTagMatchType) == true)
+			if (bBothExplicit ? *It == *OtherIt : TagManager.TagIndicesMatch(TagManager.GetTagIndex(*It), TagMatchType, OtherTagIndex, OtherTagMatchType))
 			{
 				if (ContainerMatchType == EDNAContainerMatchType::Any)
 				{
@@ -689,7 +839,6 @@ bool FDNATagContainer::DoesTagContainerMatchComplex(const FDNATagContainer& Othe
 				// we only need one match per tag in OtherContainer, so don't bother looking for more
 				break;
 			}
-			PRAGMA_ENABLE_DEPRECATION_WARNINGS
 		}
 
 		if (ContainerMatchType == EDNAContainerMatchType::All && bTagFound == false)
@@ -1077,11 +1226,12 @@ bool FDNATag::MatchesTag(const FDNATag& TagToCheck) const
 {
 	SCOPE_CYCLE_COUNTER(STAT_FDNATag_MatchesTag);
 
-	const FDNATagContainer* TagContainer = UDNATagsManager::Get().GetSingleTagContainer(*this);
+	const UDNATagsManager& TagManager = UDNATagsManager::Get();
+	const int32 TagIndex = TagManager.GetTagIndex(*this);
 
-	if (TagContainer)
+	if (TagIndex != INDEX_NONE)
 	{
-		return TagContainer->HasTag(TagToCheck);
+		return TagManager.MatchesTagIndex(TagIndex, TagManager.GetTagIndex(TagToCheck));
 	}
 
 	// This should always be invalid if the node is missing
@@ -1359,6 +1509,7 @@ FDNATagQuery& FDNATagQuery::operator=(FDNATagQuery const& Other)
 		QueryTokenStream = Other.QueryTokenStream;
 		UserDescription = Other.UserDescription;
 		AutoDescription = Other.AutoDescription;
+		Program = Other.Program;
 	}
 	return *this;
 }
@@ -1370,15 +1521,324 @@ FDNATagQuery& FDNATagQuery::operator=(FDNATagQuery&& Other)
 	QueryTokenStream = MoveTemp(Other.QueryTokenStream);
 	UserDescription = MoveTemp(Other.UserDescription);
 	AutoDescription = MoveTemp(Other.AutoDescription);
+	Program = MoveTemp(Other.Program);
 	return *this;
 }
 
+/** Evaluates a compiled query program, TagTester answers the tag set ops */
+template<typename TagTester>
+static bool EvalQueryProgramOp(const FDNATagQueryProgram& Program, int32 OpIdx, const TagTester& Tester)
+{
+	const FDNATagQueryProgram::FOp& Op = Program.Ops[OpIdx];
+
+	switch (Op.ExprType)
+	{
+	case EDNATagQueryExprType::AnyTagsMatch:
+		return Tester.HasAny(Program, Op);
+	case EDNATagQueryExprType::AllTagsMatch:
+		return Tester.HasAll(Program, Op);
+	case EDNATagQueryExprType::NoTagsMatch:
+		return !Tester.HasAny(Program, Op);
+
+	case EDNATagQueryExprType::AnyExprMatch:
+	case EDNATagQueryExprType::AllExprMatch:
+	case EDNATagQueryExprType::NoExprMatch:
+	{
+		// Any stops at the first match, All and No stop at the first fail
+		const bool bStopOnMatch = (Op.ExprType != EDNATagQueryExprType::AllExprMatch);
+		int32 ChildIdx = OpIdx + 1;
+		for (int32 Idx = 0; Idx < Op.Num; ++Idx)
+		{
+			const bool bChildResult = EvalQueryProgramOp(Program, ChildIdx, Tester);
+			if (bChildResult == bStopOnMatch)
+			{
+				return Op.ExprType == EDNATagQueryExprType::AnyExprMatch;
+			}
+			ChildIdx = Program.Ops[ChildIdx].End;
+		}
+		return Op.ExprType != EDNATagQueryExprType::AnyExprMatch;
+	}
+	}
+
+	check(false);
+	return false;
+}
+
+/** Tests tag set ops against a tag container with HasTag, like FQueryEvaluator */
+struct FQueryProgramContainerTester
+{
+	FQueryProgramContainerTester(const FDNATagContainer& InTags)
+		: Tags(InTags)
+	{
+	}
+
+	bool HasAny(const FDNATagQueryProgram& Program, const FDNATagQueryProgram::FOp& Op) const
+	{
+		for (int32 TagIdx = Op.FirstTag; TagIdx < Op.FirstTag + Op.Num; ++TagIdx)
+		{
+			if (Tags.HasTag(Program.Tags[TagIdx]))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool HasAll(const FDNATagQueryProgram& Program, const FDNATagQueryProgram::FOp& Op) const
+	{
+		for (int32 TagIdx = Op.FirstTag; TagIdx < Op.FirstTag + Op.Num; ++TagIdx)
+		{
+			if (!Tags.HasTag(Program.Tags[TagIdx]))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	const FDNATagContainer& Tags;
+};
+
+/** Tests tag set ops against a bit container with the precomputed masks */
+struct FQueryProgramBitTester
+{
+	FQueryProgramBitTester(const FDNATagBitContainer& InTags)
+		: Tags(InTags)
+	{
+	}
+
+	bool HasAny(const FDNATagQueryProgram& Program, const FDNATagQueryProgram::FOp& Op) const
+	{
+		for (int32 MaskIdx = Op.FirstMask; MaskIdx < Op.FirstMask + Op.NumMasks; ++MaskIdx)
+		{
+			if ((Tags.GetImpliedWord(Program.MaskWords[MaskIdx]) & Program.Masks[MaskIdx]) != 0)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool HasAll(const FDNATagQueryProgram& Program, const FDNATagQueryProgram::FOp& Op) const
+	{
+		if (Op.bHasUnknownTag)
+		{
+			return false;
+		}
+
+		for (int32 MaskIdx = Op.FirstMask; MaskIdx < Op.FirstMask + Op.NumMasks; ++MaskIdx)
+		{
+			const uint64 Mask = Program.Masks[MaskIdx];
+			if ((Tags.GetImpliedWord(Program.MaskWords[MaskIdx]) & Mask) != Mask)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	const FDNATagBitContainer& Tags;
+};
+
+bool FDNATagQueryProgram::Matches(const FDNATagContainer& InTags) const
+{
+	return Ops.Num() > 0 && EvalQueryProgramOp(*this, 0, FQueryProgramContainerTester(InTags));
+}
+
+bool FDNATagQueryProgram::Matches(const FDNATagBitContainer& InTags) const
+{
+	return Ops.Num() > 0 && EvalQueryProgramOp(*this, 0, FQueryProgramBitTester(InTags));
+}
+
+DECLARE_CYCLE_STAT(TEXT("FDNATagQuery::GetProgram"), STAT_FDNATagQuery_GetProgram, STATGROUP_DNATags);
+
+/** Serializes compiles of query programs. Compiles are rare, once per query and dictionary change, so one lock is shared by every query */
+static FCriticalSection QueryProgramCompileCritical;
+
+/** True if Program is compiled for the query and dictionary. The acquire pairs with the release in GetProgram, so the compiled arrays are visible */
+static bool IsQueryProgramUpToDate(const FDNATagQueryProgram& Program, uint32 DictionarySerial, const TArray<uint8>& QueryTokenStream, const TArray<FDNATag>& TagDictionary)
+{
+	bool bUpToDate = FPlatformAtomics::InterlockedCompareExchange((volatile int32*)&Program.bCompiled, 0, 0) != 0 && Program.DictionarySerial == DictionarySerial;
+#if WITH_EDITOR
+	bUpToDate = bUpToDate && Program.CompiledTokenStream == QueryTokenStream && Program.CompiledTagDictionary == TagDictionary;
+#endif
+	return bUpToDate;
+}
+
+const FDNATagQueryProgram& FDNATagQuery::GetProgram() const
+{
+	const uint32 DictionarySerial = UDNATagsManager::Get().GetDictionarySerial();
+
+	if (!IsQueryProgramUpToDate(Program, DictionarySerial, QueryTokenStream, TagDictionary))
+	{
+		FScopeLock Lock(&QueryProgramCompileCritical);
+
+		// Another thread may have compiled it while this one waited
+		if (!IsQueryProgramUpToDate(Program, DictionarySerial, QueryTokenStream, TagDictionary))
+		{
+			SCOPE_CYCLE_COUNTER(STAT_FDNATagQuery_GetProgram);
+
+			Program.bCompiled = 0;
+
+			// Empty queries are left to the token stream evaluator, which reports them
+			FQueryEvaluator QE(*this);
+			Program.bValid = QueryTokenStream.Num() > 0 && QE.Compile(Program);
+			Program.DictionarySerial = DictionarySerial;
+#if WITH_EDITOR
+			Program.CompiledTokenStream = QueryTokenStream;
+			Program.CompiledTagDictionary = TagDictionary;
+#endif
+			FPlatformAtomics::InterlockedExchange(&Program.bCompiled, 1);
+		}
+	}
+
+	return Program;
+}
+
 bool FDNATagQuery::Matches(FDNATagContainer const& Tags) const
 {
+	const FDNATagQueryProgram& CompiledProgram = GetProgram();
+	if (CompiledProgram.bValid)
+	{
+		return CompiledProgram.Matches(Tags);
+	}
+
 	FQueryEvaluator QE(*this);
 	return QE.Eval(Tags);
 }
 
+bool FDNATagQuery::Matches(FDNATagBitContainer const& Tags) const
+{
+	const FDNATagQueryProgram& CompiledProgram = GetProgram();
+	return CompiledProgram.bValid && CompiledProgram.Matches(Tags);
+}
+
+/** Evaluates a compiled query program for every set in a batch, writing one lane bit per set */
+static void EvalQueryProgramOpBatch(const FDNATagQueryProgram& Program, int32 OpIdx, const FDNATagBitBatch& Batch, FDNATagBitBatch::FLanes& OutLanes)
+{
+	const FDNATagQueryProgram::FOp& Op = Program.Ops[OpIdx];
+
+	switch (Op.ExprType)
+	{
+	case EDNATagQueryExprType::AnyTagsMatch:
+	case EDNATagQueryExprType::NoTagsMatch:
+		Batch.InitLanes(OutLanes, false);
+		for (int32 MaskIdx = Op.FirstMask; MaskIdx < Op.FirstMask + Op.NumMasks; ++MaskIdx)
+		{
+			Batch.TestAny(Program.MaskWords[MaskIdx], Program.Masks[MaskIdx], OutLanes);
+		}
+		if (Op.ExprType == EDNATagQueryExprType::NoTagsMatch)
+		{
+			Batch.InvertLanes(OutLanes);
+		}
+		return;
+
+	case EDNATagQueryExprType::AllTagsMatch:
+		Batch.InitLanes(OutLanes, !Op.bHasUnknownTag);
+		for (int32 MaskIdx = Op.FirstMask; MaskIdx < Op.FirstMask + Op.NumMasks; ++MaskIdx)
+		{
+			Batch.TestAll(Program.MaskWords[MaskIdx], Program.Masks[MaskIdx], OutLanes);
+		}
+		return;
+
+	case EDNATagQueryExprType::AnyExprMatch:
+	case EDNATagQueryExprType::AllExprMatch:
+	case EDNATagQueryExprType::NoExprMatch:
+	{
+		const bool bAll = (Op.ExprType == EDNATagQueryExprType::AllExprMatch);
+		Batch.InitLanes(OutLanes, bAll);
+
+		FDNATagBitBatch::FLanes ChildLanes;
+		int32 ChildIdx = OpIdx + 1;
+		for (int32 Idx = 0; Idx < Op.Num; ++Idx)
+		{
+			EvalQueryProgramOpBatch(Program, ChildIdx, Batch, ChildLanes);
+			for (int32 LaneWord = 0; LaneWord < OutLanes.Num(); ++LaneWord)
+			{
+				OutLanes[LaneWord] = bAll ? (OutLanes[LaneWord] & ChildLanes[LaneWord]) : (OutLanes[LaneWord] | ChildLanes[LaneWord]);
+			}
+			ChildIdx = Program.Ops[ChildIdx].End;
+		}
+
+		if (Op.ExprType == EDNATagQueryExprType::NoExprMatch)
+		{
+			Batch.InvertLanes(OutLanes);
+		}
+		return;
+	}
+	}
+
+	check(false);
+}
+
+/** Shared body of the MatchesBatch overloads */
+template<typename ContainerType>
+static void MatchesQueryBatch(const FDNATagQuery& Query, const FDNATagQueryProgram& Program, TArrayView<const ContainerType* const> Containers, TBitArray<>& OutResults)
+{
+	if (!Program.bValid || Program.Ops.Num() == 0)
+	{
+		// Nothing can match, unless the stream could not be compiled, in which case fall back to matching one at a time
+		OutResults.Init(false, Containers.Num());
+		if (!Program.bValid)
+		{
+			for (int32 SetIdx = 0; SetIdx < Containers.Num(); ++SetIdx)
+			{
+				OutResults[SetIdx] = Containers[SetIdx] && Query.Matches(*Containers[SetIdx]);
+			}
+		}
+		return;
+	}
+
+	FDNATagBitBatch Batch;
+	for (int32 WordIndex : Program.MaskWords)
+	{
+		Batch.AddWord(WordIndex);
+	}
+	Batch.Gather(Containers);
+
+	FDNATagBitBatch::FLanes Lanes;
+	EvalQueryProgramOpBatch(Program, 0, Batch, Lanes);
+
+	// Null containers never match
+	for (int32 SetIdx = 0; SetIdx < Containers.Num(); ++SetIdx)
+	{
+		if (Containers[SetIdx] == nullptr)
+		{
+			Lanes[SetIdx / FDNATagBitContainer::BitsPerWord] &= ~(1ull << (SetIdx % FDNATagBitContainer::BitsPerWord));
+		}
+	}
+
+	Batch.LanesToBitArray(Lanes, OutResults);
+}
+
+DECLARE_CYCLE_STAT(TEXT("FDNATagQuery::MatchesBatch"), STAT_FDNATagQuery_MatchesBatch, STATGROUP_DNATags);
+
+void FDNATagQuery::MatchesBatch(TArrayView<const FDNATagContainer* const> Containers, TBitArray<>& OutResults) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_FDNATagQuery_MatchesBatch);
+	MatchesQueryBatch(*this, GetProgram(), Containers, OutResults);
+}
+
+void FDNATagQuery::MatchesBatch(TArrayView<const FDNATagBitContainer* const> Containers, TBitArray<>& OutResults) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_FDNATagQuery_MatchesBatch);
+	MatchesQueryBatch(*this, GetProgram(), Containers, OutResults);
+}
+
+void FDNATagQuery::PostSerialize(const FArchive& Ar)
+{
+	if (Ar.IsLoading())
+	{
+		InvalidateProgram();
+
+		if (Ar.IsPersistent())
+		{
+			// Compile loaded queries up front, the same loads that redirect tags in FDNATag::PostSerialize
+			GetProgram();
+		}
+	}
+}
+
 bool FDNATagQuery::IsEmpty() const
 {
 	return (QueryTokenStream.Num() == 0);
@@ -1411,6 +1871,9 @@ void FDNATagQuery::Build(FDNATagQueryExpression& RootQueryExpr, FString InUserDe
 	// emit the query
 	QueryTokenStream.Add(1);		// true to indicate is has a root expression
 	RootQueryExpr.EmitTokens(QueryTokenStream, TagDictionary);
+
+	InvalidateProgram();
+	GetProgram();
 }
 
 // static 
@@ -1628,6 +2091,8 @@ void FDNATagQuery::BuildFromEditableQuery(UEditableDNATagQuery& EditableQuery)
 	// add stream version first
 	QueryTokenStream.Add(EDNATagQueryStreamVersion::LatestVersion);
 	EditableQuery.EmitTokens(QueryTokenStream, TagDictionary, &AutoDescription);
+
+	InvalidateProgram();
 }
 
 FString UEditableDNATagQuery::GetTagQueryExportText(FDNATagQuery const& TagQuery)
@@ -1889,6 +2354,17 @@ FAutoConsoleCommand DNATagPrintReplicationMapCmd(
 	FConsoleCommandDelegate::CreateStatic(DNATagPrintReplicationMap)
 );
 
+static void DNATagWriteNetIndexLayout()
+{
+	UDNATagsManager::Get().WriteNetIndexLayout(UDNATagsManager::GetNetIndexLayoutPath());
+}
+
+FAutoConsoleCommand DNATagWriteNetIndexLayoutCmd(
+	TEXT("DNATags.WriteNetIndexLayout"),
+	TEXT( "Writes the CommonlyReplicatedTags and NetIndexFirstBitSegment settings that minimize the bandwidth of the tags replicated so far" ),
+	FConsoleCommandDelegate::CreateStatic(DNATagWriteNetIndexLayout)
+);
+
 
 static void TagPackingTest()
 {
@@ -0,0 +1,150 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "Core.h"
+#include "DNATagNetDelta.h"
+#include "DNATagsManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("FDNATagNetDelta::Write"), STAT_FDNATagNetDelta_Write, STATGROUP_DNATags);
+
+bool FDNATagNetDeltaState::IsStateEqual(INetDeltaBaseState* OtherState)
+{
+	const FDNATagNetDeltaState* Other = static_cast<FDNATagNetDeltaState*>(OtherState);
+	return TagIndices == Other->TagIndices;
+}
+
+static void WriteTagList(FArchive& Ar, UPackageMap* Map, const TArray<int32>& TagIndices, int32 CountBits)
+{
+	const UDNATagsManager& TagManager = UDNATagsManager::Get();
+
+	uint32 Count = TagIndices.Num();
+	Ar.SerializeBits(&Count, CountBits);
+
+	bool bOutSuccess = true;
+	for (int32 TagIndex : TagIndices)
+	{
+		FDNATag Tag = TagManager.GetTagFromIndex(TagIndex);
+		Tag.NetSerialize(Ar, Map, bOutSuccess);
+	}
+}
+
+static void ReadTagList(FArchive& Ar, UPackageMap* Map, TArray<FDNATag>& OutTags, int32 CountBits)
+{
+	uint32 Count = 0;
+	Ar.SerializeBits(&Count, CountBits);
+
+	bool bOutSuccess = true;
+	OutTags.Reset(Count);
+	for (uint32 TagIdx = 0; TagIdx < Count && !Ar.IsError(); ++TagIdx)
+	{
+		FDNATag Tag;
+		Tag.NetSerialize(Ar, Map, bOutSuccess);
+		OutTags.Add(Tag);
+	}
+}
+
+bool FDNATagNetDelta::Write(FNetDeltaSerializeInfo& DeltaParms, const TArray<FDNATag>& Tags, int32 StateID, int32 CountBits, bool bAllowDelta)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FDNATagNetDelta_Write);
+	check(DeltaParms.Writer && DeltaParms.NewState);
+
+	FDNATagNetDeltaState* OldState = static_cast<FDNATagNetDeltaState*>(DeltaParms.OldState);
+	if (OldState && OldState->StateID == StateID)
+	{
+		return false;
+	}
+
+	const UDNATagsManager& TagManager = UDNATagsManager::Get();
+	const int32 MaxCount = (1 << CountBits) - 1;
+
+	TSharedPtr<FDNATagNetDeltaState> NewState = MakeShareable(new FDNATagNetDeltaState(StateID));
+	TArray<int32>& NewIndices = NewState->TagIndices;
+	NewIndices.Reserve(Tags.Num());
+	for (const FDNATag& Tag : Tags)
+	{
+		const int32 TagIndex = TagManager.GetTagIndex(Tag);
+		if (TagIndex != INDEX_NONE)
+		{
+			NewIndices.Add(TagIndex);
+		}
+		else
+		{
+			ensureMsgf(!Tag.IsValid(), TEXT("FDNATagNetDelta can't replicate %s, it is not in the tag dictionary"), *Tag.ToString());
+		}
+	}
+	NewIndices.Sort();
+	if (NewIndices.Num() > MaxCount)
+	{
+		NewIndices.SetNum(MaxCount, false);
+	}
+
+	// Both lists are sorted, so walk them together
+	TArray<int32> AddedIndices;
+	TArray<int32> RemovedIndices;
+	if (OldState)
+	{
+		const TArray<int32>& OldIndices = OldState->TagIndices;
+		int32 OldIdx = 0;
+		int32 NewIdx = 0;
+		while (OldIdx < OldIndices.Num() || NewIdx < NewIndices.Num())
+		{
+			if (NewIdx == NewIndices.Num() || (OldIdx < OldIndices.Num() && OldIndices[OldIdx] < NewIndices[NewIdx]))
+			{
+				RemovedIndices.Add(OldIndices[OldIdx++]);
+			}
+			else if (OldIdx == OldIndices.Num() || NewIndices[NewIdx] < OldIndices[OldIdx])
+			{
+				AddedIndices.Add(NewIndices[NewIdx++]);
+			}
+			else
+			{
+				++OldIdx;
+				++NewIdx;
+			}
+		}
+
+		if (AddedIndices.Num() == 0 && RemovedIndices.Num() == 0)
+		{
+			// Changed and changed back, the receiver already has these tags. The engine only keeps a new state when something is written,
+			// so the old one is relabeled instead, otherwise every later update would diff against it again
+			OldState->StateID = StateID;
+			return false;
+		}
+	}
+
+	// Only send a delta when it is smaller than the full set, it costs an extra count
+	const bool bFullState = !OldState || !bAllowDelta || AddedIndices.Num() + RemovedIndices.Num() >= NewIndices.Num();
+
+	FBitWriter& Writer = *DeltaParms.Writer;
+	uint8 bWriteFullState = bFullState ? 1 : 0;
+	Writer.WriteBit(bWriteFullState);
+
+	if (bFullState)
+	{
+		WriteTagList(Writer, DeltaParms.Map, NewIndices, CountBits);
+	}
+	else
+	{
+		WriteTagList(Writer, DeltaParms.Map, RemovedIndices, CountBits);
+		WriteTagList(Writer, DeltaParms.Map, AddedIndices, CountBits);
+	}
+
+	*DeltaParms.NewState = NewState;
+	return true;
+}
+
+bool FDNATagNetDelta::Read(FNetDeltaSerializeInfo& DeltaParms, int32 CountBits, bool& bOutFullState, TArray<FDNATag>& OutAddedTags, TArray<FDNATag>& OutRemovedTags)
+{
+	check(DeltaParms.Reader);
+	FBitReader& Reader = *DeltaParms.Reader;
+
+	bOutFullState = Reader.ReadBit() != 0;
+
+	OutRemovedTags.Reset();
+	if (!bOutFullState)
+	{
+		ReadTagList(Reader, DeltaParms.Map, OutRemovedTags, CountBits);
+	}
+	ReadTagList(Reader, DeltaParms.Map, OutAddedTags, CountBits);
+
+	return !Reader.IsError();
+}
@@ -0,0 +1,96 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "Core.h"
+#include "DNATagSearchIndex.h"
+#include "DNATagContainer.h"
+
+DECLARE_CYCLE_STAT(TEXT("FDNATagSearchIndex::Build"), STAT_FDNATagSearchIndex_Build, STATGROUP_DNATags);
+DECLARE_CYCLE_STAT(TEXT("FDNATagSearchIndex::Search"), STAT_FDNATagSearchIndex_Search, STATGROUP_DNATags);
+
+uint64 FDNATagSearchIndex::MakeTrigramKey(const TCHAR* Chars)
+{
+	// 21 bits hold any code point, and a collision only costs an extra candidate to verify
+	const uint64 CharMask = (1 << 21) - 1;
+	return ((uint64(Chars[0]) & CharMask) << 42) | ((uint64(Chars[1]) & CharMask) << 21) | (uint64(Chars[2]) & CharMask);
+}
+
+void FDNATagSearchIndex::Build(const TArray<FString>& Strings)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FDNATagSearchIndex_Build);
+
+	Reset();
+
+	LoweredStrings.Reserve(Strings.Num());
+	for (int32 EntryIdx = 0; EntryIdx < Strings.Num(); ++EntryIdx)
+	{
+		LoweredStrings.Add(Strings[EntryIdx].ToLower());
+		const FString& Lowered = LoweredStrings[EntryIdx];
+
+		const TCHAR* Chars = *Lowered;
+		for (int32 CharIdx = 0; CharIdx + TrigramLength <= Lowered.Len(); ++CharIdx)
+		{
+			// Entries are added in order, so a repeated trigram can only be at the end of the list
+			TArray<int32>& Postings = TrigramPostings.FindOrAdd(MakeTrigramKey(Chars + CharIdx));
+			if (Postings.Num() == 0 || Postings.Last() != EntryIdx)
+			{
+				Postings.Add(EntryIdx);
+			}
+		}
+	}
+}
+
+void FDNATagSearchIndex::Reset()
+{
+	LoweredStrings.Reset();
+	TrigramPostings.Reset();
+}
+
+void FDNATagSearchIndex::Search(const FString& SearchString, TArray<int32>& OutEntries) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_FDNATagSearchIndex_Search);
+
+	OutEntries.Reset();
+
+	const FString Lowered = SearchString.ToLower();
+	if (Lowered.IsEmpty())
+	{
+		return;
+	}
+
+	if (Lowered.Len() < TrigramLength)
+	{
+		for (int32 EntryIdx = 0; EntryIdx < LoweredStrings.Num(); ++EntryIdx)
+		{
+			if (LoweredStrings[EntryIdx].Contains(Lowered, ESearchCase::CaseSensitive))
+			{
+				OutEntries.Add(EntryIdx);
+			}
+		}
+		return;
+	}
+
+	// Every match contains every trigram of the search string, so only the entries of the shortest list can match
+	const TArray<int32>* Candidates = nullptr;
+	const TCHAR* Chars = *Lowered;
+	for (int32 CharIdx = 0; CharIdx + TrigramLength <= Lowered.Len(); ++CharIdx)
+	{
+		const TArray<int32>* Postings = TrigramPostings.Find(MakeTrigramKey(Chars + CharIdx));
+		if (!Postings)
+		{
+			return;
+		}
+
+		if (!Candidates || Postings->Num() < Candidates->Num())
+		{
+			Candidates = Postings;
+		}
+	}
+
+	for (int32 EntryIdx : *Candidates)
+	{
+		if (LoweredStrings[EntryIdx].Contains(Lowered, ESearchCase::CaseSensitive))
+		{
+			OutEntries.Add(EntryIdx);
+		}
+	}
+}
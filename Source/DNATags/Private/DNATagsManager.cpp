@@ -8,6 +8,11 @@
 #include "Misc/ScopeLock.h"
 #include "Stats/StatsMisc.h"
 #include "Misc/ConfigCacheIni.h"
+#include "Misc/FileHelper.h"
+#include "Misc/SecureHash.h"
+#include "Misc/PackageName.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
 #include "UObject/UObjectHash.h"
 #include "UObject/UObjectIterator.h"
 #include "UObject/LinkerLoad.h"
@@ -37,6 +42,14 @@ UDNATagsManager::UDNATagsManager(const FObjectInitializer& ObjectInitializer)
 	NetIndexFirstBitSegment = 16;
 	NetIndexTrueBitNum = 16;
 	NumBitsForContainerSize = 6;
+	DictionarySerial = 0;
+	TagTreePositions = nullptr;
+	NetIndexDictionarySerial = MAX_uint32;
+	PublishedSnapshot = nullptr;
+#if WITH_EDITOR
+	GatheredTagRows = nullptr;
+	SearchIndexSerial = MAX_uint32;
+#endif
 }
 
 void UDNATagsManager::LoadDNATagTables()
@@ -68,7 +81,14 @@ struct FCompareFDNATagNodeByTag
 {
 	FORCEINLINE bool operator()( const TSharedPtr<FDNATagNode>& A, const TSharedPtr<FDNATagNode>& B ) const
 	{
-		return (A->GetSimpleTagName().Compare(B->GetSimpleTagName())) < 0;
+		const int32 SimpleCompare = A->GetSimpleTagName().Compare(B->GetSimpleTagName());
+		if (SimpleCompare != 0)
+		{
+			return SimpleCompare < 0;
+		}
+
+		// Tie break on the complete name so the order is total, an incremental net index update must give the same order as a full sort
+		return A->GetCompleteTagName().Compare(B->GetCompleteTagName()) < 0;
 	}
 };
 
@@ -78,243 +98,313 @@ void UDNATagsManager::ConstructDNATagTree()
 	{
 		DNARootTag = MakeShareable(new FDNATagNode());
 
-		// Add native tags first
-		for (FName TagToAdd : NativeTagsToAdd)
+		const bool bUseCache = ShouldUseTagDictionaryCache();
+		FSHAHash SourceHash;
+		bool bLoadedFromCache = false;
+		if (bUseCache)
 		{
-			AddTagTableRow(FDNATagTableRow(TagToAdd), FDNATagSource::GetNativeName());
+			HashTagSources(SourceHash);
+			bLoadedFromCache = LoadTagDictionaryCache(SourceHash);
 		}
 
+		// Time spent on the work the cache replaces, reported when the cache is used on later runs
+		double BuildSeconds = 0.0;
+
+		if (!bLoadedFromCache)
 		{
-#if STATS
-			FString PerfMessage = FString::Printf(TEXT("UDNATagsManager::ConstructDNATagTree: Construct from data asset"));
-			SCOPE_LOG_TIME_IN_SECONDS(*PerfMessage, nullptr)
-#endif
-		
-			for (auto It(DNATagTables.CreateIterator()); It; It++)
+			const double SourcesStartTime = FPlatformTime::Seconds();
+
+			// InitializeManager leaves the tables unloaded when the cache may be used
+			if (bUseCache)
 			{
-				if (*It)
-				{
-					PopulateTreeFromDataTable(*It);
-				}
+				LoadDNATagTables();
 			}
+
+			PopulateTreeFromSources();
+			BuildSeconds += FPlatformTime::Seconds() - SourcesStartTime;
 		}
 
-		UDNATagsSettings* MutableDefault = GetMutableDefault<UDNATagsSettings>();
-		FString DefaultEnginePath = FString::Printf(TEXT("%sDefaultEngine.ini"), *FPaths::SourceConfigDir());
+		ReadTagTreeSettings();
 
-		// Create native source
-		FindOrAddTagSource(FDNATagSource::GetNativeName(), EDNATagSourceType::Native);
+		// Build the tree positions now rather than on the first match
+		UpdateTagTreePositions();
 
-		if (ShouldImportTagsFromINI())
+		if (ShouldUseFastReplication())
 		{
 #if STATS
-			FString PerfMessage = FString::Printf(TEXT("UDNATagsManager::ConstructDNATagTree: ImportINI"));
+			FString PerfMessage = FString::Printf(TEXT("UDNATagsManager::ConstructDNATagTree: Reconstruct NetIndex"));
 			SCOPE_LOG_TIME_IN_SECONDS(*PerfMessage, nullptr)
 #endif
-			// Copy from deprecated list in DefaultEngine.ini
-			TArray<FString> EngineConfigTags;
-			GConfig->GetArray(TEXT("/Script/DNATags.DNATagsSettings"), TEXT("+DNATags"), EngineConfigTags, DefaultEnginePath);
-			
-			for (const FString& EngineConfigTag : EngineConfigTags)
+			const double NetIndexStartTime = FPlatformTime::Seconds();
+
+			// The cache stores the net index order, so only the indices need to be assigned
+			if (bLoadedFromCache && NetworkDNATagNodeIndex.Num() == DNATagNodeMap.Num())
 			{
-				MutableDefault->DNATagList.AddUnique(FDNATagTableRow(FName(*EngineConfigTag)));
+				AssignNetIndices();
 			}
-
-			// Copy from deprecated list in DefaultGamplayTags.ini
-			EngineConfigTags.Empty();
-			GConfig->GetArray(TEXT("/Script/DNATags.DNATagsSettings"), TEXT("+DNATags"), EngineConfigTags, MutableDefault->GetDefaultConfigFilename());
-
-			for (const FString& EngineConfigTag : EngineConfigTags)
+			else
 			{
-				MutableDefault->DNATagList.AddUnique(FDNATagTableRow(FName(*EngineConfigTag)));
+				ConstructNetIndex();
 			}
 
-#if WITH_EDITOR
-			MutableDefault->SortTags();
+			BuildSeconds += FPlatformTime::Seconds() - NetIndexStartTime;
+		}
+
+		{
+#if STATS
+			FString PerfMessage = FString::Printf(TEXT("UDNATagsManager::ConstructDNATagTree: DNATagTreeChangedEvent.Broadcast"));
+			SCOPE_LOG_TIME_IN_SECONDS(*PerfMessage, nullptr)
 #endif
+			IDNATagsModule::OnDNATagTreeChanged.Broadcast();
+		}
 
-			FName TagSource = FDNATagSource::GetDefaultName();
-			FDNATagSource* DefaultSource = FindOrAddTagSource(TagSource, EDNATagSourceType::DefaultTagList);
 
-			for (const FDNATagTableRow& TableRow : MutableDefault->DNATagList)
+		if (!bLoadedFromCache)
+		{
+			const double RedirectsStartTime = FPlatformTime::Seconds();
+			ConstructTagRedirects();
+			BuildSeconds += FPlatformTime::Seconds() - RedirectsStartTime;
+
+			if (bUseCache)
 			{
-				AddTagTableRow(TableRow, TagSource);
+				SaveTagDictionaryCache(SourceHash, BuildSeconds);
 			}
+		}
+	}
+}
 
-			// Extra tags
-		
-			// Read all tags from the ini
-			TArray<FString> FilesInDirectory;
-			IFileManager::Get().FindFilesRecursive(FilesInDirectory, *(FPaths::GameConfigDir() / TEXT("Tags")), TEXT("*.ini"), true, false);
-			FilesInDirectory.Sort();
-			for (FString& FileName : FilesInDirectory)
+void UDNATagsManager::PopulateTreeFromSources()
+{
+	// Add native tags first
+	for (FName TagToAdd : NativeTagsToAdd)
+	{
+		AddTagTableRow(FDNATagTableRow(TagToAdd), FDNATagSource::GetNativeName());
+	}
+
+	{
+#if STATS
+		FString PerfMessage = FString::Printf(TEXT("UDNATagsManager::ConstructDNATagTree: Construct from data asset"));
+		SCOPE_LOG_TIME_IN_SECONDS(*PerfMessage, nullptr)
+#endif
+	
+		for (auto It(DNATagTables.CreateIterator()); It; It++)
+		{
+			if (*It)
 			{
-				TagSource = FName(*FPaths::GetCleanFilename(FileName));
-				FDNATagSource* FoundSource = FindOrAddTagSource(TagSource, EDNATagSourceType::TagList);
+				PopulateTreeFromDataTable(*It);
+			}
+		}
+	}
 
-				UE_LOG(LogDNATags, Display, TEXT("Loading Tag File: %s"), *FileName);
+	UDNATagsSettings* MutableDefault = GetMutableDefault<UDNATagsSettings>();
+	FString DefaultEnginePath = FString::Printf(TEXT("%sDefaultEngine.ini"), *FPaths::SourceConfigDir());
 
-				// Check deprecated locations
-				TArray<FString> Tags;
-				if (GConfig->GetArray(TEXT("UserTags"), TEXT("DNATags"), Tags, FileName))
-				{
-					for (const FString& Tag : Tags)
-					{
-						FoundSource->SourceTagList->DNATagList.AddUnique(FDNATagTableRow(FName(*Tag)));
-					}
-				}
-				else
-				{
-					// Load from new ini
-					FoundSource->SourceTagList->LoadConfig(UDNATagsList::StaticClass(), *FileName);
-				}
+	// Create native source
+	FindOrAddTagSource(FDNATagSource::GetNativeName(), EDNATagSourceType::Native);
+
+	if (ShouldImportTagsFromINI())
+	{
+#if STATS
+		FString PerfMessage = FString::Printf(TEXT("UDNATagsManager::ConstructDNATagTree: ImportINI"));
+		SCOPE_LOG_TIME_IN_SECONDS(*PerfMessage, nullptr)
+#endif
+		// Copy from deprecated list in DefaultEngine.ini
+		TArray<FString> EngineConfigTags;
+		GConfig->GetArray(TEXT("/Script/DNATags.DNATagsSettings"), TEXT("+DNATags"), EngineConfigTags, DefaultEnginePath);
+		
+		for (const FString& EngineConfigTag : EngineConfigTags)
+		{
+			MutableDefault->DNATagList.AddUnique(FDNATagTableRow(FName(*EngineConfigTag)));
+		}
+
+		// Copy from deprecated list in DefaultGamplayTags.ini
+		EngineConfigTags.Empty();
+		GConfig->GetArray(TEXT("/Script/DNATags.DNATagsSettings"), TEXT("+DNATags"), EngineConfigTags, MutableDefault->GetDefaultConfigFilename());
+
+		for (const FString& EngineConfigTag : EngineConfigTags)
+		{
+			MutableDefault->DNATagList.AddUnique(FDNATagTableRow(FName(*EngineConfigTag)));
+		}
 
 #if WITH_EDITOR
-				if (GIsEditor || IsRunningCommandlet()) // Sort tags for UI Purposes but don't sort in -game scenerio since this would break compat with noneditor cooked builds
-				{
-					FoundSource->SourceTagList->SortTags();
-				}
+		MutableDefault->SortTags();
 #endif
 
-				for (const FDNATagTableRow& TableRow : FoundSource->SourceTagList->DNATagList)
-				{
-					AddTagTableRow(TableRow, TagSource);
-				}
-			}
+		FName TagSource = FDNATagSource::GetDefaultName();
+		FDNATagSource* DefaultSource = FindOrAddTagSource(TagSource, EDNATagSourceType::DefaultTagList);
+
+		for (const FDNATagTableRow& TableRow : MutableDefault->DNATagList)
+		{
+			AddTagTableRow(TableRow, TagSource);
 		}
 
-		// Grab the commonly replicated tags
-		CommonlyReplicatedTags.Empty();
-		for (FName TagName : MutableDefault->CommonlyReplicatedTags)
+		// Extra tags
+	
+		// Read all tags from the ini
+		TArray<FString> FilesInDirectory;
+		IFileManager::Get().FindFilesRecursive(FilesInDirectory, *(FPaths::GameConfigDir() / TEXT("Tags")), TEXT("*.ini"), true, false);
+		FilesInDirectory.Sort();
+		for (FString& FileName : FilesInDirectory)
 		{
-			FDNATag Tag = RequestDNATag(TagName);
-			if (Tag.IsValid())
+			TagSource = FName(*FPaths::GetCleanFilename(FileName));
+			FDNATagSource* FoundSource = FindOrAddTagSource(TagSource, EDNATagSourceType::TagList);
+
+			UE_LOG(LogDNATags, Display, TEXT("Loading Tag File: %s"), *FileName);
+
+			// Check deprecated locations
+			TArray<FString> Tags;
+			if (GConfig->GetArray(TEXT("UserTags"), TEXT("DNATags"), Tags, FileName))
 			{
-				CommonlyReplicatedTags.Add(Tag);
+				for (const FString& Tag : Tags)
+				{
+					FoundSource->SourceTagList->DNATagList.AddUnique(FDNATagTableRow(FName(*Tag)));
+				}
 			}
 			else
 			{
-				UE_LOG(LogDNATags, Warning, TEXT("%s was found in the CommonlyReplicatedTags list but doesn't appear to be a valid tag!"), *TagName.ToString());
+				// Load from new ini
+				FoundSource->SourceTagList->LoadConfig(UDNATagsList::StaticClass(), *FileName);
 			}
-		}
-
-		bUseFastReplication = MutableDefault->FastReplication;
-		bShouldWarnOnInvalidTags = MutableDefault->WarnOnInvalidTags;
-		NumBitsForContainerSize = MutableDefault->NumBitsForContainerSize;
-		NetIndexFirstBitSegment = MutableDefault->NetIndexFirstBitSegment;
 
-		if (ShouldUseFastReplication())
-		{
-#if STATS
-			FString PerfMessage = FString::Printf(TEXT("UDNATagsManager::ConstructDNATagTree: Reconstruct NetIndex"));
-			SCOPE_LOG_TIME_IN_SECONDS(*PerfMessage, nullptr)
+#if WITH_EDITOR
+			if (GIsEditor || IsRunningCommandlet()) // Sort tags for UI Purposes but don't sort in -game scenerio since this would break compat with noneditor cooked builds
+			{
+				FoundSource->SourceTagList->SortTags();
+			}
 #endif
-			ConstructNetIndex();
-		}
 
-		{
-#if STATS
-			FString PerfMessage = FString::Printf(TEXT("UDNATagsManager::ConstructDNATagTree: DNATagTreeChangedEvent.Broadcast"));
-			SCOPE_LOG_TIME_IN_SECONDS(*PerfMessage, nullptr)
-#endif
-			IDNATagsModule::OnDNATagTreeChanged.Broadcast();
+			for (const FDNATagTableRow& TableRow : FoundSource->SourceTagList->DNATagList)
+			{
+				AddTagTableRow(TableRow, TagSource);
+			}
 		}
+	}
+}
 
-		// Update the TagRedirects map
-		TagRedirects.Empty();
+void UDNATagsManager::ConstructTagRedirects()
+{
+	UDNATagsSettings* MutableDefault = GetMutableDefault<UDNATagsSettings>();
+	FString DefaultEnginePath = FString::Printf(TEXT("%sDefaultEngine.ini"), *FPaths::SourceConfigDir());
 
-		// Check the deprecated location
-		bool bFoundDeprecated = false;
-		FConfigSection* PackageRedirects = GConfig->GetSectionPrivate(TEXT("/Script/Engine.Engine"), false, true, DefaultEnginePath);
+	// Update the TagRedirects map
+	TagRedirects.Empty();
 
-		if (PackageRedirects)
+	// Check the deprecated location
+	bool bFoundDeprecated = false;
+	FConfigSection* PackageRedirects = GConfig->GetSectionPrivate(TEXT("/Script/Engine.Engine"), false, true, DefaultEnginePath);
+
+	if (PackageRedirects)
+	{
+		for (FConfigSection::TIterator It(*PackageRedirects); It; ++It)
 		{
-			for (FConfigSection::TIterator It(*PackageRedirects); It; ++It)
+			if (It.Key() == TEXT("+DNATagRedirects"))
 			{
-				if (It.Key() == TEXT("+DNATagRedirects"))
-				{
-					FName OldTagName = NAME_None;
-					FName NewTagName;
+				FName OldTagName = NAME_None;
+				FName NewTagName;
 
-					if (FParse::Value(*It.Value().GetValue(), TEXT("OldTagName="), OldTagName))
+				if (FParse::Value(*It.Value().GetValue(), TEXT("OldTagName="), OldTagName))
+				{
+					if (FParse::Value(*It.Value().GetValue(), TEXT("NewTagName="), NewTagName))
 					{
-						if (FParse::Value(*It.Value().GetValue(), TEXT("NewTagName="), NewTagName))
-						{
-							FDNATagRedirect Redirect;
-							Redirect.OldTagName = OldTagName;
-							Redirect.NewTagName = NewTagName;
+						FDNATagRedirect Redirect;
+						Redirect.OldTagName = OldTagName;
+						Redirect.NewTagName = NewTagName;
 
-							MutableDefault->DNATagRedirects.AddUnique(Redirect);
+						MutableDefault->DNATagRedirects.AddUnique(Redirect);
 
-							bFoundDeprecated = true;
-						}
+						bFoundDeprecated = true;
 					}
 				}
 			}
 		}
+	}
 
-		if (bFoundDeprecated)
-		{
-			UE_LOG(LogDNATags, Log, TEXT("DNATagRedirects is in a deprecated location, after editing DNATags developer settings you must remove these manually"));
-		}
+	if (bFoundDeprecated)
+	{
+		UE_LOG(LogDNATags, Log, TEXT("DNATagRedirects is in a deprecated location, after editing DNATags developer settings you must remove these manually"));
+	}
 
-		// Check settings object
-		for (const FDNATagRedirect& Redirect : MutableDefault->DNATagRedirects)
-		{
-			FName OldTagName = Redirect.OldTagName;
-			FName NewTagName = Redirect.NewTagName;
+	// Check settings object
+	for (const FDNATagRedirect& Redirect : MutableDefault->DNATagRedirects)
+	{
+		FName OldTagName = Redirect.OldTagName;
+		FName NewTagName = Redirect.NewTagName;
 
-			if (ensureMsgf(!TagRedirects.Contains(OldTagName), TEXT("Old tag %s is being redirected to more than one tag. Please remove all the redirections except for one."), *OldTagName.ToString()))
+		if (ensureMsgf(!TagRedirects.Contains(OldTagName), TEXT("Old tag %s is being redirected to more than one tag. Please remove all the redirections except for one."), *OldTagName.ToString()))
+		{
+			FDNATag OldTag = RequestDNATag(OldTagName, false); //< This only succeeds if OldTag is in the Table!
+			if (OldTag.IsValid())
 			{
-				FDNATag OldTag = RequestDNATag(OldTagName, false); //< This only succeeds if OldTag is in the Table!
-				if (OldTag.IsValid())
-				{
-					UE_LOG(LogDNATags, Warning,
-						TEXT("Old tag (%s) which is being redirected still exists in the table!  Generally you should "
-						TEXT("remove the old tags from the table when you are redirecting to new tags, or else users will ")
-						TEXT("still be able to add the old tags to containers.")), *OldTagName.ToString()
-						);
-				}
-
-				FDNATag NewTag = (NewTagName != NAME_None) ? RequestDNATag(NewTagName, false) : FDNATag();
+				UE_LOG(LogDNATags, Warning,
+					TEXT("Old tag (%s) which is being redirected still exists in the table!  Generally you should "
+					TEXT("remove the old tags from the table when you are redirecting to new tags, or else users will ")
+					TEXT("still be able to add the old tags to containers.")), *OldTagName.ToString()
+					);
+			}
 
-				// Basic infinite recursion guard
-				int32 IterationsLeft = 10;
-				while (!NewTag.IsValid() && NewTagName != NAME_None)
-				{
-					bool bFoundRedirect = false;
+			FDNATag NewTag = (NewTagName != NAME_None) ? RequestDNATag(NewTagName, false) : FDNATag();
 
-					// See if it got redirected again
-					for (const FDNATagRedirect& SecondRedirect : MutableDefault->DNATagRedirects)
-					{
-						if (SecondRedirect.OldTagName == NewTagName)
-						{
-							NewTagName = SecondRedirect.NewTagName;
-							NewTag = RequestDNATag(NewTagName, false);
-							bFoundRedirect = true;
-							break;
-						}
-					}
-					IterationsLeft--;
+			// Basic infinite recursion guard
+			int32 IterationsLeft = 10;
+			while (!NewTag.IsValid() && NewTagName != NAME_None)
+			{
+				bool bFoundRedirect = false;
 
-					if (!bFoundRedirect || IterationsLeft <= 0)
+				// See if it got redirected again
+				for (const FDNATagRedirect& SecondRedirect : MutableDefault->DNATagRedirects)
+				{
+					if (SecondRedirect.OldTagName == NewTagName)
 					{
-						UE_LOG(LogDNATags, Warning, TEXT("Invalid new tag %s!  Cannot replace old tag %s."),
-							*Redirect.NewTagName.ToString(), *Redirect.OldTagName.ToString());
+						NewTagName = SecondRedirect.NewTagName;
+						NewTag = RequestDNATag(NewTagName, false);
+						bFoundRedirect = true;
 						break;
 					}
 				}
+				IterationsLeft--;
 
-				if (NewTag.IsValid())
+				if (!bFoundRedirect || IterationsLeft <= 0)
 				{
-					// Populate the map
-					TagRedirects.Add(OldTagName, NewTag);
+					UE_LOG(LogDNATags, Warning, TEXT("Invalid new tag %s!  Cannot replace old tag %s."),
+						*Redirect.NewTagName.ToString(), *Redirect.OldTagName.ToString());
+					break;
 				}
 			}
+
+			if (NewTag.IsValid())
+			{
+				// Populate the map
+				TagRedirects.Add(OldTagName, NewTag);
+			}
 		}
 	}
 }
 
+void UDNATagsManager::ReadTagTreeSettings()
+{
+	const UDNATagsSettings* Settings = GetDefault<UDNATagsSettings>();
+
+	// Grab the commonly replicated tags
+	CommonlyReplicatedTags.Empty();
+	for (FName TagName : Settings->CommonlyReplicatedTags)
+	{
+		FDNATag Tag = RequestDNATag(TagName);
+		if (Tag.IsValid())
+		{
+			CommonlyReplicatedTags.Add(Tag);
+		}
+		else
+		{
+			UE_LOG(LogDNATags, Warning, TEXT("%s was found in the CommonlyReplicatedTags list but doesn't appear to be a valid tag!"), *TagName.ToString());
+		}
+	}
+
+	bUseFastReplication = Settings->FastReplication;
+	bShouldWarnOnInvalidTags = Settings->WarnOnInvalidTags;
+	NumBitsForContainerSize = Settings->NumBitsForContainerSize;
+	NetIndexFirstBitSegment = Settings->NetIndexFirstBitSegment;
+}
+
 void UDNATagsManager::ConstructNetIndex()
 {
 	NetworkDNATagNodeIndex.Empty();
@@ -346,6 +436,11 @@ void UDNATagsManager::ConstructNetIndex()
 		checkf( Found, TEXT("Tag %s not found in NetworkDNATagNodeIndex"), *Tag.ToString() );
 	}
 
+	AssignNetIndices();
+}
+
+void UDNATagsManager::AssignNetIndices(int32 FirstIndex)
+{
 	InvalidTagNetIndex = NetworkDNATagNodeIndex.Num()+1;
 	NetIndexTrueBitNum = FMath::CeilToInt(FMath::Log2(InvalidTagNetIndex));
 	
@@ -360,13 +455,400 @@ void UDNATagsManager::ConstructNetIndex()
 		NetworkDNATagNodeIndex.SetNum(INVALID_TAGNETINDEX - 1);
 	}
 
-	for (FDNATagNetIndex i = 0; i < NetworkDNATagNodeIndex.Num(); i++)
+	for (int32 i = FirstIndex; i < NetworkDNATagNodeIndex.Num(); i++)
 	{
 		if (NetworkDNATagNodeIndex[i].IsValid())
 		{
-			NetworkDNATagNodeIndex[i]->NetIndex = i;
+			NetworkDNATagNodeIndex[i]->NetIndex = (FDNATagNetIndex)i;
+		}
+	}
+
+	NetIndexDictionarySerial = DictionarySerial;
+}
+
+namespace DNATagDictionaryCache
+{
+	/** Identifies a tag dictionary cache file */
+	static const uint32 Magic = 0x44544443;
+
+	/** Bump whenever the file layout or the way sources are hashed changes */
+	static const uint32 Version = 2;
+
+	/** A tag as stored in the cache, in tree pre-order so parents always come before their children */
+	struct FCachedTagNode
+	{
+		FName SimpleTagName;
+		int32 ParentOrdinal;
+		FName SourceName;
+		FString DevComment;
+
+		friend FArchive& operator<<(FArchive& Ar, FCachedTagNode& Node)
+		{
+			Ar << Node.SimpleTagName;
+			Ar << Node.ParentOrdinal;
+			Ar << Node.SourceName;
+			Ar << Node.DevComment;
+			return Ar;
+		}
+	};
+
+	/** A row of a tag list source as stored in the cache */
+	struct FCachedTagRow
+	{
+		FName Tag;
+		FString DevComment;
+
+		friend FArchive& operator<<(FArchive& Ar, FCachedTagRow& Row)
+		{
+			Ar << Row.Tag;
+			Ar << Row.DevComment;
+			return Ar;
+		}
+	};
+
+	/** A tag source as stored in the cache, along with the rows of its tag list if it has one */
+	struct FCachedTagSource
+	{
+		FName SourceName;
+		uint8 SourceType;
+		TArray<FCachedTagRow> TagList;
+
+		friend FArchive& operator<<(FArchive& Ar, FCachedTagSource& Source)
+		{
+			Ar << Source.SourceName;
+			Ar << Source.SourceType;
+			Ar << Source.TagList;
+			return Ar;
+		}
+	};
+
+	/** A resolved redirect as stored in the cache */
+	struct FCachedTagRedirect
+	{
+		FName OldTagName;
+		FName NewTagName;
+
+		friend FArchive& operator<<(FArchive& Ar, FCachedTagRedirect& Redirect)
+		{
+			Ar << Redirect.OldTagName;
+			Ar << Redirect.NewTagName;
+			return Ar;
+		}
+	};
+
+	static void HashString(FSHA1& Sha, const FString& String)
+	{
+		// Include the terminator so adjacent strings can't run together
+		Sha.UpdateWithString(*String, String.Len() + 1);
+	}
+
+	/** Hashes the size and timestamp of a file rather than its contents, so nothing has to be read or loaded to check the cache */
+	static void HashFile(FSHA1& Sha, const FString& FileName)
+	{
+		HashString(Sha, FileName);
+
+		// A missing file has a size of -1 and the minimum timestamp
+		const int64 FileSize = IFileManager::Get().FileSize(*FileName);
+		const int64 FileTicks = IFileManager::Get().GetTimeStamp(*FileName).GetTicks();
+		Sha.Update((const uint8*)&FileSize, sizeof(FileSize));
+		Sha.Update((const uint8*)&FileTicks, sizeof(FileTicks));
+	}
+
+	template<typename T>
+	static void HashValue(FSHA1& Sha, const T& Value)
+	{
+		Sha.Update((const uint8*)&Value, sizeof(Value));
+	}
+}
+
+bool UDNATagsManager::ShouldUseTagDictionaryCache() const
+{
+	// The editor changes tag sources while running and needs the editor-only data the cache doesn't keep up to date
+	return !GIsEditor && !IsRunningCommandlet() && GetDefault<UDNATagsSettings>()->CacheTagDictionary;
+}
+
+FString UDNATagsManager::GetTagDictionaryCachePath()
+{
+	return FPaths::GameSavedDir() / TEXT("DNATags") / TEXT("TagDictionary.bin");
+}
+
+void UDNATagsManager::HashTagSources(FSHAHash& OutHash) const
+{
+#if STATS
+	FString PerfMessage = FString::Printf(TEXT("UDNATagsManager::ConstructDNATagTree: Hash tag sources"));
+	SCOPE_LOG_TIME_IN_SECONDS(*PerfMessage, nullptr)
+#endif
+
+	using namespace DNATagDictionaryCache;
+
+	const UDNATagsSettings* Settings = GetDefault<UDNATagsSettings>();
+	FSHA1 Sha;
+
+	HashValue(Sha, Version);
+
+	for (FName TagName : NativeTagsToAdd)
+	{
+		HashString(Sha, TagName.ToString());
+	}
+
+	// Tag tables are hashed by their package files so they only have to be loaded when the cache misses
+	for (const FStringAssetReference& DataTablePath : Settings->DNATagTableList)
+	{
+		const FString TablePathName = DataTablePath.ToString();
+		HashString(Sha, TablePathName);
+
+		FString PackageFileName;
+		if (FPackageName::DoesPackageExist(FPackageName::ObjectPathToPackageName(TablePathName), nullptr, &PackageFileName))
+		{
+			HashFile(Sha, PackageFileName);
+		}
+	}
+
+	// Deprecated tag lists, tag redirects and import settings can all live in DefaultEngine.ini
+	HashFile(Sha, FString::Printf(TEXT("%sDefaultEngine.ini"), *FPaths::SourceConfigDir()));
+	HashFile(Sha, Settings->GetDefaultConfigFilename());
+
+	const bool bImportFromINI = ShouldImportTagsFromINI();
+	HashValue(Sha, bImportFromINI);
+	if (bImportFromINI)
+	{
+		for (const FDNATagTableRow& TableRow : Settings->DNATagList)
+		{
+			HashString(Sha, TableRow.Tag.ToString());
+			HashString(Sha, TableRow.DevComment);
+		}
+
+		TArray<FString> FilesInDirectory;
+		IFileManager::Get().FindFilesRecursive(FilesInDirectory, *(FPaths::GameConfigDir() / TEXT("Tags")), TEXT("*.ini"), true, false);
+		FilesInDirectory.Sort();
+		for (const FString& FileName : FilesInDirectory)
+		{
+			HashFile(Sha, FileName);
+		}
+	}
+
+	HashValue(Sha, Settings->FastReplication);
+	for (FName TagName : Settings->CommonlyReplicatedTags)
+	{
+		HashString(Sha, TagName.ToString());
+	}
+	for (const FDNATagRedirect& Redirect : Settings->DNATagRedirects)
+	{
+		HashString(Sha, Redirect.OldTagName.ToString());
+		HashString(Sha, Redirect.NewTagName.ToString());
+	}
+
+	Sha.Final();
+	Sha.GetHash(OutHash.Hash);
+}
+
+bool UDNATagsManager::LoadTagDictionaryCache(const FSHAHash& SourceHash)
+{
+	using namespace DNATagDictionaryCache;
+
+	const double StartTime = FPlatformTime::Seconds();
+	const FString CachePath = GetTagDictionaryCachePath();
+
+	TArray<uint8> CacheData;
+	if (!FFileHelper::LoadFileToArray(CacheData, *CachePath, FILEREAD_Silent))
+	{
+		UE_LOG(LogDNATags, Log, TEXT("No tag dictionary cache at %s, building the tag tree from its sources"), *CachePath);
+		return false;
+	}
+
+	FMemoryReader Ar(CacheData);
+
+	uint32 FileMagic = 0;
+	uint32 FileVersion = 0;
+	FSHAHash FileHash;
+	Ar << FileMagic;
+	Ar << FileVersion;
+	if (Ar.IsError() || FileMagic != Magic || FileVersion != Version)
+	{
+		UE_LOG(LogDNATags, Log, TEXT("Tag dictionary cache %s is from another version, building the tag tree from its sources"), *CachePath);
+		return false;
+	}
+
+	Ar.Serialize(FileHash.Hash, sizeof(FileHash.Hash));
+	if (Ar.IsError() || FileHash != SourceHash)
+	{
+		UE_LOG(LogDNATags, Log, TEXT("Tag sources changed since %s was written, building the tag tree from its sources"), *CachePath);
+		return false;
+	}
+
+	double FileBuildSeconds = 0.0;
+	TArray<FCachedTagSource> Sources;
+	TArray<FCachedTagNode> Nodes;
+	TArray<int32> NetIndexOrdinals;
+	TArray<FCachedTagRedirect> Redirects;
+	Ar << FileBuildSeconds;
+	Ar << Sources;
+	Ar << Nodes;
+	Ar << NetIndexOrdinals;
+	Ar << Redirects;
+
+	// Validate everything before touching the tree, so a bad file leaves it empty for the full build
+	bool bValid = !Ar.IsError() && Ar.AtEnd();
+	for (int32 Ordinal = 0; bValid && Ordinal < Nodes.Num(); ++Ordinal)
+	{
+		const int32 ParentOrdinal = Nodes[Ordinal].ParentOrdinal;
+		bValid = !Nodes[Ordinal].SimpleTagName.IsNone() && ParentOrdinal >= INDEX_NONE && ParentOrdinal < Ordinal;
+	}
+	for (int32 NetIndexOrdinal : NetIndexOrdinals)
+	{
+		bValid = bValid && Nodes.IsValidIndex(NetIndexOrdinal);
+	}
+
+	if (!bValid)
+	{
+		UE_LOG(LogDNATags, Warning, TEXT("Tag dictionary cache %s is corrupt, building the tag tree from its sources"), *CachePath);
+		return false;
+	}
+
+	// Fill the tag lists the way PopulateTreeFromSources would, the default list is the settings object so this includes the deprecated ini tags
+	for (const FCachedTagSource& Source : Sources)
+	{
+		FDNATagSource* TagSource = FindOrAddTagSource(Source.SourceName, (EDNATagSourceType)Source.SourceType);
+		if (TagSource->SourceTagList)
+		{
+			TagSource->SourceTagList->DNATagList.Reset(Source.TagList.Num());
+			for (const FCachedTagRow& CachedRow : Source.TagList)
+			{
+				TagSource->SourceTagList->DNATagList.Add(FDNATagTableRow(CachedRow.Tag, CachedRow.DevComment));
+			}
+		}
+	}
+
+	{
+#if WITH_EDITOR
+		// This critical section is to handle an editor-only issue where tag requests come from another thread when async loading from a background thread in FDNATagContainer::Serialize.
+		// This function is not generically threadsafe.
+		FScopeLock Lock(&DNATagMapCritical);
+#endif
+
+		// Nodes are in pre-order from a sorted tree, so appending each one to its parent keeps every child array sorted
+		TArray<TSharedPtr<FDNATagNode>> OrdinalNodes;
+		OrdinalNodes.Reserve(Nodes.Num());
+		DNATagNodeMap.Reserve(Nodes.Num());
+
+		for (const FCachedTagNode& CachedNode : Nodes)
+		{
+			TSharedPtr<FDNATagNode> ParentNode = CachedNode.ParentOrdinal != INDEX_NONE ? OrdinalNodes[CachedNode.ParentOrdinal] : nullptr;
+			TSharedPtr<FDNATagNode> TagNode = MakeShareable(new FDNATagNode(CachedNode.SimpleTagName, ParentNode));
+			(ParentNode.IsValid() ? ParentNode : DNARootTag)->ChildTags.Add(TagNode);
+			OrdinalNodes.Add(TagNode);
+
+#if WITH_EDITORONLY_DATA
+			TagNode->SourceName = CachedNode.SourceName;
+			TagNode->DevComment = CachedNode.DevComment;
+#endif
+
+			const FDNATag& DNATag = TagNode->GetCompleteTag();
+			TagNode->TagIndex = FindOrAddTagIndex(DNATag, ParentNode.IsValid() ? ParentNode->TagIndex : INDEX_NONE);
+			DNATagNodeMap.Add(DNATag, TagNode);
+		}
+		DictionarySerial++;
+
+		NetworkDNATagNodeIndex.Reset(NetIndexOrdinals.Num());
+		for (int32 NetIndexOrdinal : NetIndexOrdinals)
+		{
+			NetworkDNATagNodeIndex.Add(OrdinalNodes[NetIndexOrdinal]);
 		}
 	}
+
+	TagRedirects.Empty(Redirects.Num());
+	for (const FCachedTagRedirect& Redirect : Redirects)
+	{
+		TagRedirects.Add(Redirect.OldTagName, FDNATag(Redirect.NewTagName));
+	}
+
+	const double LoadSeconds = FPlatformTime::Seconds() - StartTime;
+	UE_LOG(LogDNATags, Log, TEXT("Loaded %d tags from tag dictionary cache in %.2f ms, building them from their sources took %.2f ms"),
+		Nodes.Num(), LoadSeconds * 1000.0, FileBuildSeconds * 1000.0);
+
+	return true;
+}
+
+void UDNATagsManager::SaveTagDictionaryCache(const FSHAHash& SourceHash, double BuildSeconds) const
+{
+	using namespace DNATagDictionaryCache;
+
+	const FDNATagTreePositionTable& Positions = ConditionalUpdateTagTreePositions();
+
+	TArray<FCachedTagSource> Sources;
+	for (const FDNATagSource& TagSource : TagSources)
+	{
+		FCachedTagSource& Source = Sources[Sources.AddDefaulted()];
+		Source.SourceName = TagSource.SourceName;
+		Source.SourceType = (uint8)TagSource.SourceType;
+
+		if (TagSource.SourceTagList)
+		{
+			for (const FDNATagTableRow& TableRow : TagSource.SourceTagList->DNATagList)
+			{
+				FCachedTagRow& CachedRow = Source.TagList[Source.TagList.AddDefaulted()];
+				CachedRow.Tag = TableRow.Tag;
+				CachedRow.DevComment = TableRow.DevComment;
+			}
+		}
+	}
+
+	// The tree positions are the pre-order ordinals, so parents are always written before their children
+	TArray<FCachedTagNode> Nodes;
+	Nodes.SetNum(DNATagNodeMap.Num());
+	for (const TPair<FDNATag, TSharedPtr<FDNATagNode>>& NodePair : DNATagNodeMap)
+	{
+		const FDNATagNode& TagNode = *NodePair.Value;
+		const TSharedPtr<FDNATagNode>& ParentNode = TagNode.ParentNode;
+
+		FCachedTagNode& CachedNode = Nodes[Positions.First[TagNode.TagIndex]];
+		CachedNode.SimpleTagName = TagNode.Tag;
+		CachedNode.ParentOrdinal = ParentNode.IsValid() ? Positions.First[ParentNode->TagIndex] : INDEX_NONE;
+#if WITH_EDITORONLY_DATA
+		CachedNode.SourceName = TagNode.SourceName;
+		CachedNode.DevComment = TagNode.DevComment;
+#endif
+	}
+
+	TArray<int32> NetIndexOrdinals;
+	NetIndexOrdinals.Reserve(NetworkDNATagNodeIndex.Num());
+	for (const TSharedPtr<FDNATagNode>& NetNode : NetworkDNATagNodeIndex)
+	{
+		NetIndexOrdinals.Add(Positions.First[NetNode->TagIndex]);
+	}
+
+	TArray<FCachedTagRedirect> Redirects;
+	for (const TPair<FName, FDNATag>& TagRedirect : TagRedirects)
+	{
+		FCachedTagRedirect& Redirect = Redirects[Redirects.AddDefaulted()];
+		Redirect.OldTagName = TagRedirect.Key;
+		Redirect.NewTagName = TagRedirect.Value.GetTagName();
+	}
+
+	TArray<uint8> CacheData;
+	FMemoryWriter Ar(CacheData);
+
+	uint32 FileMagic = Magic;
+	uint32 FileVersion = Version;
+	FSHAHash FileHash = SourceHash;
+	Ar << FileMagic;
+	Ar << FileVersion;
+	Ar.Serialize(FileHash.Hash, sizeof(FileHash.Hash));
+	Ar << BuildSeconds;
+	Ar << Sources;
+	Ar << Nodes;
+	Ar << NetIndexOrdinals;
+	Ar << Redirects;
+
+	const FString CachePath = GetTagDictionaryCachePath();
+	if (FFileHelper::SaveArrayToFile(CacheData, *CachePath))
+	{
+		UE_LOG(LogDNATags, Log, TEXT("Wrote %d tags to tag dictionary cache %s"), Nodes.Num(), *CachePath);
+	}
+	else
+	{
+		UE_LOG(LogDNATags, Warning, TEXT("Failed to write tag dictionary cache %s"), *CachePath);
+	}
 }
 
 FName UDNATagsManager::GetTagNameFromNetIndex(FDNATagNetIndex Index) const
@@ -412,8 +894,64 @@ bool UDNATagsManager::ShouldImportTagsFromINI() const
 	return MutableDefault->ImportTagsFromConfig;
 }
 
+void UDNATagsManager::WarnInvalidLoadedTag(FName TagName, UProperty* SerializingProperty) const
+{
+#if WITH_EDITOR
+	// Warn about invalid tags at load time in editor builds, too late to fix it in cooked builds
+	if (SerializingProperty && ShouldWarnOnInvalidTags())
+	{
+		UE_LOG(LogDNATags, Warning, TEXT("Invalid DNATag %s found while loading property %s."), *TagName.ToString(), *GetPathNameSafe(SerializingProperty));
+	}
+#endif
+}
+
+DECLARE_CYCLE_STAT(TEXT("UDNATagsManager::RedirectTagsForContainer"), STAT_UDNATagsManager_RedirectTagsForContainer, STATGROUP_DNATags);
+
 void UDNATagsManager::RedirectTagsForContainer(FDNATagContainer& Container, UProperty* SerializingProperty) const
 {
+	SCOPE_CYCLE_COUNTER(STAT_UDNATagsManager_RedirectTagsForContainer);
+
+	NumLoadedTags.Add(Container.Num());
+
+	// With a current snapshot each tag takes one lookup, which finds the tag or the end of its redirect chain.
+	// This runs on the async loading thread, so hold a reference for the whole container, a publish can retire the snapshot midway
+	const TSharedPtr<const FDNATagDictionarySnapshot, ESPMode::ThreadSafe> Snapshot = AcquireDictionarySnapshot();
+	if (IsCurrentDictionarySnapshot(Snapshot.Get()))
+	{
+		TArray<const FDNATagNameRecord*, TInlineAllocator<4>> RedirectedRecords;
+		for (auto TagIt = Container.CreateConstIterator(); TagIt; ++TagIt)
+		{
+			const FDNATagNameRecord* Record = Snapshot->FindLoadRecord(TagIt->GetTagName());
+			if (!Record)
+			{
+				WarnInvalidLoadedTag(TagIt->GetTagName(), SerializingProperty);
+			}
+			else if (Record->LoadTagIndex != Record->TagIndex)
+			{
+				RedirectedRecords.Add(Record);
+			}
+		}
+
+		for (const FDNATagNameRecord* Record : RedirectedRecords)
+		{
+			if (Record->TagIndex != INDEX_NONE)
+			{
+				Container.RemoveTag(Snapshot->GetTagFromIndex(Record->TagIndex));
+			}
+			else
+			{
+				Container.RemoveTagByExplicitName(Record->TagName);
+			}
+		}
+		for (const FDNATagNameRecord* Record : RedirectedRecords)
+		{
+			Container.AddTag(Snapshot->GetTagFromIndex(Record->LoadTagIndex));
+		}
+
+		NumRedirectedTags.Add(RedirectedRecords.Num());
+		return;
+	}
+
 	TSet<FName> NamesToRemove;
 	TSet<const FDNATag*> TagsToAdd;
 
@@ -433,11 +971,10 @@ void UDNATagsManager::RedirectTagsForContainer(FDNATagContainer& Container, UPro
 #if WITH_EDITOR
 		else if (SerializingProperty)
 		{
-			// Warn about invalid tags at load time in editor builds, too late to fix it in cooked builds
 			FDNATag OldTag = RequestDNATag(TagName, false);
-			if (!OldTag.IsValid() && ShouldWarnOnInvalidTags())
+			if (!OldTag.IsValid())
 			{
-				UE_LOG(LogDNATags, Warning, TEXT("Invalid DNATag %s found while loading property %s."), *TagName.ToString(), *GetPathNameSafe(SerializingProperty));
+				WarnInvalidLoadedTag(TagName, SerializingProperty);
 			}
 		}
 #endif
@@ -463,32 +1000,84 @@ void UDNATagsManager::RedirectTagsForContainer(FDNATagContainer& Container, UPro
 		check(AddTag);
 		Container.AddTag(*AddTag);
 	}
+
+	NumRedirectedTags.Add(NamesToRemove.Num());
 }
 
 void UDNATagsManager::RedirectSingleDNATag(FDNATag& Tag, UProperty* SerializingProperty) const
 {
 	const FName TagName = Tag.GetTagName();
+	if (TagName == NAME_None)
+	{
+		return;
+	}
+
+	NumLoadedTags.Increment();
+
+	const TSharedPtr<const FDNATagDictionarySnapshot, ESPMode::ThreadSafe> Snapshot = AcquireDictionarySnapshot();
+	if (IsCurrentDictionarySnapshot(Snapshot.Get()))
+	{
+		const FDNATagNameRecord* Record = Snapshot->FindLoadRecord(TagName);
+		if (!Record)
+		{
+			WarnInvalidLoadedTag(TagName, SerializingProperty);
+		}
+		else if (Record->LoadTagIndex != Record->TagIndex)
+		{
+			Tag = Snapshot->GetTagFromIndex(Record->LoadTagIndex);
+			NumRedirectedTags.Increment();
+		}
+		return;
+	}
+
 	const FDNATag* NewTag = TagRedirects.Find(TagName);
 	if (NewTag)
 	{
 		if (NewTag->IsValid())
 		{
 			Tag = *NewTag;
+			NumRedirectedTags.Increment();
 		}
 	}
 #if WITH_EDITOR
-	else if (TagName != NAME_None && SerializingProperty)
+	else if (SerializingProperty)
 	{
-		// Warn about invalid tags at load time in editor builds, too late to fix it in cooked builds
 		FDNATag OldTag = RequestDNATag(TagName, false);
-		if (!OldTag.IsValid() && ShouldWarnOnInvalidTags())
+		if (!OldTag.IsValid())
 		{
-			UE_LOG(LogDNATags, Warning, TEXT("Invalid DNATag %s found while loading property %s."), *TagName.ToString(), *GetPathNameSafe(SerializingProperty));
+			WarnInvalidLoadedTag(TagName, SerializingProperty);
 		}
 	}
 #endif
 }
 
+UDNATagsManager::FTagLoadCounts UDNATagsManager::GetTagLoadCounts() const
+{
+	FTagLoadCounts Counts;
+	Counts.NumLoadedTags = NumLoadedTags.GetValue();
+	Counts.NumRedirectedTags = NumRedirectedTags.GetValue();
+	return Counts;
+}
+
+void UDNATagsManager::HandlePreLoadMap(const FString& MapName)
+{
+	NumLoadedTags.Reset();
+	NumRedirectedTags.Reset();
+}
+
+void UDNATagsManager::HandlePostLoadMap()
+{
+	const FTagLoadCounts Counts = GetTagLoadCounts();
+	if (Counts.NumRedirectedTags > 0)
+	{
+		UE_LOG(LogDNATags, Log, TEXT("Map load redirected %d of %d loaded tags, resave the assets that reference old tag names to avoid this"), Counts.NumRedirectedTags, Counts.NumLoadedTags);
+	}
+	else
+	{
+		UE_LOG(LogDNATags, Verbose, TEXT("Map load loaded %d tags, none were redirected"), Counts.NumLoadedTags);
+	}
+}
+
 void UDNATagsManager::InitializeManager()
 {
 	check(!SingletonManager);
@@ -512,11 +1101,18 @@ void UDNATagsManager::InitializeManager()
 		}
 	}
 
-	SingletonManager->LoadDNATagTables();
+	// A tag dictionary cache hit never needs the tables, so ConstructDNATagTree only loads them on a miss
+	if (!SingletonManager->ShouldUseTagDictionaryCache())
+	{
+		SingletonManager->LoadDNATagTables();
+	}
 	SingletonManager->ConstructDNATagTree();
 
 	// Bind to end of engine init to be done adding native tags
 	UEngine::OnPostEngineInit.AddUObject(SingletonManager, &UDNATagsManager::DoneAddingNativeTags);
+
+	FCoreUObjectDelegates::PreLoadMap.AddUObject(SingletonManager, &UDNATagsManager::HandlePreLoadMap);
+	FCoreUObjectDelegates::PostLoadMap.AddUObject(SingletonManager, &UDNATagsManager::HandlePostLoadMap);
 }
 
 void UDNATagsManager::PopulateTreeFromDataTable(class UDataTable* InTable)
@@ -538,10 +1134,23 @@ void UDNATagsManager::PopulateTreeFromDataTable(class UDataTable* InTable)
 			AddTagTableRow(*TagRow, SourceName);
 		}
 	}
+
+	// Tables can be added after the tree is constructed, build the positions now instead of on the next match
+	ConditionalUpdateTagTreePositions();
 }
 
 void UDNATagsManager::AddTagTableRow(const FDNATagTableRow& TagRow, FName SourceName)
 {
+#if WITH_EDITOR
+	if (GatheredTagRows)
+	{
+		FGatheredTagRow& GatheredRow = (*GatheredTagRows)[GatheredTagRows->AddDefaulted()];
+		GatheredRow.TagRow = TagRow;
+		GatheredRow.SourceName = SourceName;
+		return;
+	}
+#endif
+
 	TSharedPtr<FDNATagNode> CurNode = DNARootTag;
 
 	// Split the tag text on the "." delimiter to establish tag depth and then insert each tag into the
@@ -573,6 +1182,12 @@ void UDNATagsManager::DestroyDNATagTree()
 		DNARootTag->ResetNode();
 		DNARootTag.Reset();
 		DNATagNodeMap.Reset();
+		DictionarySerial++;
+
+		// Freed with the nodes, nothing may match tags while the tree is destroyed
+		FScopeLock Lock(&TagTreePositionCritical);
+		FPlatformAtomics::InterlockedExchangePtr((void**)&TagTreePositions, nullptr);
+		TagTreePositionTables.Reset();
 	}
 }
 
@@ -621,30 +1236,195 @@ int32 UDNATagsManager::InsertTagIntoNodeArray(FName Tag, TSharedPtr<FDNATagNode>
 			// This function is not generically threadsafe.
 			FScopeLock Lock(&DNATagMapCritical);
 #endif
+			TagNode->TagIndex = FindOrAddTagIndex(DNATag, TagNode->ParentNode.IsValid() ? TagNode->ParentNode->TagIndex : INDEX_NONE);
 			DNATagNodeMap.Add(DNATag, TagNode);
+			DictionarySerial++;
 		}
 	}
 
 #if WITH_EDITOR
-	static FName NativeSourceName = FDNATagSource::GetNativeName();
 	// Set/update editor only data
-	if (NodeArray[InsertionIdx]->SourceName.IsNone() && !SourceName.IsNone())
+	ApplyTagRowEditorData(*NodeArray[InsertionIdx], SourceName, DevComment);
+#endif
+
+	return InsertionIdx;
+}
+
+#if WITH_EDITORONLY_DATA
+void UDNATagsManager::ApplyTagRowEditorData(FDNATagNode& Node, FName SourceName, const FString& DevComment)
+{
+	static FName NativeSourceName = FDNATagSource::GetNativeName();
+	if (Node.SourceName.IsNone() && !SourceName.IsNone())
 	{
-		NodeArray[InsertionIdx]->SourceName = SourceName;
+		Node.SourceName = SourceName;
 	}
 	else if (SourceName == NativeSourceName)
 	{
 		// Native overrides other types
-		NodeArray[InsertionIdx]->SourceName = SourceName;
+		Node.SourceName = SourceName;
 	}
 
-	if (NodeArray[InsertionIdx]->DevComment.IsEmpty() && !DevComment.IsEmpty())
+	if (Node.DevComment.IsEmpty() && !DevComment.IsEmpty())
 	{
-		NodeArray[InsertionIdx]->DevComment = DevComment;
+		Node.DevComment = DevComment;
 	}
+}
 #endif
 
-	return InsertionIdx;
+int32 UDNATagsManager::FindOrAddTagIndex(const FDNATag& Tag, int32 ParentTagIndex)
+{
+	if (const int32* ExistingIndex = TagIndexMap.Find(Tag.GetTagName()))
+	{
+		// A tag's parents are implied by its name, so a reused index never needs its parent updated
+		check(IndexedTagParents[*ExistingIndex] == ParentTagIndex);
+		return *ExistingIndex;
+	}
+
+	const int32 NewIndex = IndexedTags.Add(Tag);
+	IndexedTagParents.Add(ParentTagIndex);
+	TagIndexMap.Add(Tag.GetTagName(), NewIndex);
+
+	// Bake this tag's closure: itself followed by its parent's closure, which was added when the parent was inserted
+	FDNATagIndexSpan Span;
+	Span.First = TagAndParentIndices.Add(NewIndex);
+	if (ParentTagIndex != INDEX_NONE)
+	{
+		const FDNATagIndexSpan ParentSpan = TagAndParentSpans[ParentTagIndex];
+		for (int32 ParentIdx = 0; ParentIdx < ParentSpan.Num; ++ParentIdx)
+		{
+			TagAndParentIndices.Add(TagAndParentIndices[ParentSpan.First + ParentIdx]);
+		}
+	}
+	Span.Num = TagAndParentIndices.Num() - Span.First;
+	TagAndParentSpans.Add(Span);
+
+	return NewIndex;
+}
+
+DECLARE_CYCLE_STAT(TEXT("UDNATagsManager::UpdateTagTreePositions"), STAT_UDNATagsManager_UpdateTagTreePositions, STATGROUP_DNATags);
+
+const FDNATagTreePositionTable& UDNATagsManager::UpdateTagTreePositions() const
+{
+	SCOPE_CYCLE_COUNTER(STAT_UDNATagsManager_UpdateTagTreePositions);
+
+	// Matching can run on any thread, the first one to find the positions out of date rebuilds them while the others wait
+	FScopeLock Lock(&TagTreePositionCritical);
+
+	const FDNATagTreePositionTable* CurrentPositions = TagTreePositions;
+	if (CurrentPositions && CurrentPositions->Serial == DictionarySerial)
+	{
+		return *CurrentPositions;
+	}
+
+	// Tags that are no longer in the tree get an empty interval, so they never match
+	FDNATagTreePositionTable* Positions = new FDNATagTreePositionTable();
+	Positions->First.Init(INDEX_NONE, IndexedTags.Num());
+	Positions->Last.Init(INDEX_NONE - 1, IndexedTags.Num());
+	Positions->Serial = DictionarySerial;
+
+	if (DNARootTag.IsValid())
+	{
+		int32 NextPosition = 0;
+		for (const TSharedPtr<FDNATagNode>& ChildNode : DNARootTag->GetChildTagNodes())
+		{
+			AssignTagTreePositions(ChildNode, NextPosition, *Positions);
+		}
+	}
+
+	// Readers that still hold the old table keep using it, it is only freed with the tree
+	TagTreePositionTables.Add(TUniquePtr<FDNATagTreePositionTable>(Positions));
+	FPlatformMisc::MemoryBarrier();
+	FPlatformAtomics::InterlockedExchangePtr((void**)&TagTreePositions, Positions);
+
+	return *Positions;
+}
+
+void UDNATagsManager::AssignTagTreePositions(const TSharedPtr<FDNATagNode>& Node, int32& NextPosition, FDNATagTreePositionTable& Positions)
+{
+	const int32 TagIndex = Node->GetTagIndex();
+	Positions.First[TagIndex] = NextPosition++;
+
+	for (const TSharedPtr<FDNATagNode>& ChildNode : Node->GetChildTagNodes())
+	{
+		AssignTagTreePositions(ChildNode, NextPosition, Positions);
+	}
+
+	Positions.Last[TagIndex] = NextPosition - 1;
+}
+
+bool UDNATagsManager::TagIndicesMatch(int32 TagIndexOne, TEnumAsByte<EDNATagMatchType::Type> MatchTypeOne, int32 TagIndexTwo, TEnumAsByte<EDNATagMatchType::Type> MatchTypeTwo) const
+{
+	if (TagIndexOne == INDEX_NONE || TagIndexTwo == INDEX_NONE)
+	{
+		return false;
+	}
+
+	if (MatchTypeOne == EDNATagMatchType::Explicit)
+	{
+		if (MatchTypeTwo == EDNATagMatchType::Explicit)
+		{
+			return TagIndexOne == TagIndexTwo;
+		}
+
+		// One is in the parent chain of Two
+		return MatchesTagIndex(TagIndexTwo, TagIndexOne);
+	}
+	else if (MatchTypeTwo == EDNATagMatchType::Explicit)
+	{
+		// Two is in the parent chain of One
+		return MatchesTagIndex(TagIndexOne, TagIndexTwo);
+	}
+
+	// Both sides are expanded, and every parent chain ends at a root tag, so they share a tag only if they share a root
+	TArrayView<const int32> TagAndParentsTwo = GetTagAndParentIndices(TagIndexTwo);
+	return MatchesTagIndex(TagIndexOne, TagAndParentsTwo[TagAndParentsTwo.Num() - 1]);
+}
+
+void UDNATagsManager::GetSortedTagTreePositions(const FDNATagContainer& Container, FDNATagTreePositions& OutPositions) const
+{
+	const FDNATagTreePositionTable& Positions = ConditionalUpdateTagTreePositions();
+
+	OutPositions.Reset(Container.Num());
+	for (const FDNATag& Tag : Container)
+	{
+		const int32 TagIndex = GetTagIndex(Tag);
+		if (TagIndex != INDEX_NONE)
+		{
+			OutPositions.Add(Positions.First[TagIndex]);
+		}
+	}
+	OutPositions.Sort();
+}
+
+bool UDNATagsManager::HasTreePositionInSubtree(const FDNATagTreePositions& SortedPositions, int32 TagIndex) const
+{
+	if (TagIndex == INDEX_NONE)
+	{
+		return false;
+	}
+
+	const FDNATagTreePositionTable& Positions = ConditionalUpdateTagTreePositions();
+
+	const int32 SubtreeFirst = Positions.First[TagIndex];
+	const int32 SubtreeLast = Positions.Last[TagIndex];
+
+	// Find the first position not before the subtree, it matches if it is not after it either
+	int32 Low = 0;
+	int32 High = SortedPositions.Num();
+	while (Low < High)
+	{
+		const int32 Mid = Low + (High - Low) / 2;
+		if (SortedPositions[Mid] < SubtreeFirst)
+		{
+			Low = Mid + 1;
+		}
+		else
+		{
+			High = Mid;
+		}
+	}
+
+	return Low < SortedPositions.Num() && SortedPositions[Low] <= SubtreeLast;
 }
 
 #if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
@@ -678,75 +1458,144 @@ void UDNATagsManager::PrintReplicationFrequencyReport()
 		UE_LOG(LogDNATags, Warning, TEXT("%s - %d"), *It.Key.ToString(), It.Value);
 	}
 
-	TMap<int32, int32> SavingsMap;
-	int32 BaselineCost = 0;
-	for (int32 Bits=1; Bits < NetIndexTrueBitNum; ++Bits)
+	const FDNATagNetIndexLayout Layout = ComputeNetIndexLayout(ReplicationCountMap);
+
+	UE_LOG(LogDNATags, Warning, TEXT("\n%lld tags replicated, average bits per tag index:"), Layout.NumReplicatedTags);
+	UE_LOG(LogDNATags, Warning, TEXT("Unsplit (%d bits): %.2f"), Layout.NetIndexTrueBitNum, Layout.UnsplitBitsPerTag);
+	if (ShouldUseFastReplication())
 	{
-		int32 TotalSavings = 0;
-		BaselineCost = 0;
+		UE_LOG(LogDNATags, Warning, TEXT("Current settings: %.2f"), Layout.CurrentBitsPerTag);
+	}
+	UE_LOG(LogDNATags, Warning, TEXT("Suggested settings: %.2f (%.1f%% less than unsplit)"), Layout.LayoutBitsPerTag,
+		Layout.UnsplitBitsPerTag > 0.f ? 100.f * (1.f - Layout.LayoutBitsPerTag / Layout.UnsplitBitsPerTag) : 0.f);
+
+	UE_LOG(LogDNATags, Warning, TEXT("\nSuggested config:"));
+
+	// Write out a nice copy pastable config
+	for (const FDNATag& Tag : Layout.CommonlyReplicatedTags)
+	{
+		UE_LOG(LogDNATags, Warning, TEXT("+CommonlyReplicatedTags=%s"), *Tag.ToString());
+	}
+
+	UE_LOG(LogDNATags, Warning, TEXT("NetIndexFirstBitSegment=%d"), Layout.NetIndexFirstBitSegment);
+
+	UE_LOG(LogDNATags, Warning, TEXT("================================="));
+}
+
+int32 UDNATagsManager::GetPackedNetIndexBits(int32 NetIndex, int32 FirstBitSegment, int32 MaxBits)
+{
+	// Must match SerializeTagNetIndexPacked
+	if (FirstBitSegment <= 0 || FirstBitSegment >= MaxBits)
+	{
+		return MaxBits;
+	}
+	return NetIndex < (1 << FirstBitSegment) ? FirstBitSegment + 1 : MaxBits + 1;
+}
 
-		FDNATagNetIndex ExpectedNetIndex=0;
-		for (auto& It : ReplicationCountMap)
-		{
-			int32 ExpectedCostBits = 0;
-			bool FirstSeg = ExpectedNetIndex < FMath::Pow(2, Bits);
-			if (FirstSeg)
-			{
-				// This would fit in the first Bits segment
-				ExpectedCostBits = Bits+1;
-			}
-			else
-			{
-				// Would go in the second segment, so we pay the +1 cost
-				ExpectedCostBits = NetIndexTrueBitNum+1;
-			}
+FDNATagNetIndexLayout UDNATagsManager::ComputeNetIndexLayout(const TMap<FDNATag, int32>& ReplicationCounts) const
+{
+	FDNATagNetIndexLayout Layout;
 
-			int32 Savings = (NetIndexTrueBitNum - ExpectedCostBits) * It.Value;
-			BaselineCost += NetIndexTrueBitNum * It.Value;
+	// Same as ConstructNetIndex, CommonlyReplicatedTags only reorders the indices so this doesn't depend on the layout
+	Layout.NetIndexTrueBitNum = FMath::CeilToInt(FMath::Log2(DNATagNodeMap.Num() + 1));
+	const int32 MaxBits = Layout.NetIndexTrueBitNum;
 
-			//UE_LOG(LogDNATags, Warning, TEXT("[Bits: %d] Tag %s would save %d bits"), Bits, *It.Key.ToString(), Savings);
-			ExpectedNetIndex++;
-			TotalSavings += Savings;
+	// Only tags that can actually be replicated by index
+	TArray<TPair<FDNATag, int32>> RankedTags;
+	for (const TPair<FDNATag, int32>& Count : ReplicationCounts)
+	{
+		if (Count.Value > 0 && DNATagNodeMap.Contains(Count.Key))
+		{
+			RankedTags.Add(Count);
+			Layout.NumReplicatedTags += Count.Value;
 		}
+	}
 
-		SavingsMap.FindOrAdd(Bits) = TotalSavings;
+	if (Layout.NumReplicatedTags == 0)
+	{
+		return Layout;
 	}
 
-	SavingsMap.ValueSort(TGreater<int32>());
+	RankedTags.Sort([](const TPair<FDNATag, int32>& A, const TPair<FDNATag, int32>& B)
+	{
+		return A.Value != B.Value ? A.Value > B.Value : A.Key.GetTagName().Compare(B.Key.GetTagName()) < 0;
+	});
+
+	// Cost of every split point in one pass over the ranked counts: the first 2^Bits tags cost Bits + 1, the rest MaxBits + 1
+	int64 BestCost = Layout.NumReplicatedTags * MaxBits;
 	int32 BestBits = 0;
-	for (auto& It : SavingsMap)
+	for (int32 Bits = 1; Bits < MaxBits; ++Bits)
 	{
-		if (BestBits == 0)
+		const int32 NumInFirstSegment = FMath::Min(1 << Bits, RankedTags.Num());
+
+		int64 FirstSegmentCount = 0;
+		for (int32 Rank = 0; Rank < NumInFirstSegment; ++Rank)
 		{
-			BestBits = It.Key;
+			FirstSegmentCount += RankedTags[Rank].Value;
 		}
 
-		UE_LOG(LogDNATags, Warning, TEXT("%d bits would save %d (%.2f)"), It.Key, It.Value, (float)It.Value / (float)BaselineCost);
+		const int64 Cost = FirstSegmentCount * (Bits + 1) + (Layout.NumReplicatedTags - FirstSegmentCount) * (MaxBits + 1);
+		if (Cost < BestCost)
+		{
+			BestCost = Cost;
+			BestBits = Bits;
+		}
 	}
 
-	UE_LOG(LogDNATags, Warning, TEXT("\nSuggested config:"));
-
-	// Write out a nice copy pastable config
-	int32 Count=0;
-	for (auto& It : ReplicationCountMap)
+	Layout.NetIndexFirstBitSegment = BestBits;
+	if (BestBits > 0)
 	{
-		UE_LOG(LogDNATags, Warning, TEXT("+CommonlyReplicatedTags=%s"), *It.Key.ToString());
-
-		if (Count == FMath::Pow(2, BestBits))
+		const int32 NumInFirstSegment = FMath::Min(1 << BestBits, RankedTags.Num());
+		for (int32 Rank = 0; Rank < NumInFirstSegment; ++Rank)
 		{
-			// Print a blank line out, indicating tags after this are not necessary but still may be useful if the user wants to manually edit the list.
-			UE_LOG(LogDNATags, Warning, TEXT(""));
+			Layout.CommonlyReplicatedTags.Add(RankedTags[Rank].Key);
 		}
+	}
 
-		if (Count++ >= FMath::Pow(2, BestBits+1))
+	Layout.UnsplitBitsPerTag = (float)MaxBits;
+	Layout.LayoutBitsPerTag = (float)((double)BestCost / (double)Layout.NumReplicatedTags);
+
+	if (ShouldUseFastReplication())
+	{
+		int64 CurrentCost = 0;
+		for (const TPair<FDNATag, int32>& RankedTag : RankedTags)
 		{
-			break;
+			CurrentCost += (int64)GetPackedNetIndexBits(GetNetIndexFromTag(RankedTag.Key), NetIndexFirstBitSegment, NetIndexTrueBitNum) * RankedTag.Value;
 		}
+		Layout.CurrentBitsPerTag = (float)((double)CurrentCost / (double)Layout.NumReplicatedTags);
 	}
 
-	UE_LOG(LogDNATags, Warning, TEXT("NetIndexFirstBitSegment=%d"), BestBits);
+	return Layout;
+}
 
-	UE_LOG(LogDNATags, Warning, TEXT("================================="));
+FString UDNATagsManager::GetNetIndexLayoutPath()
+{
+	return FPaths::GameSavedDir() / TEXT("DNATags") / TEXT("SuggestedNetIndexLayout.ini");
+}
+
+void UDNATagsManager::WriteNetIndexLayout(const FString& FileName) const
+{
+	const FDNATagNetIndexLayout Layout = ComputeNetIndexLayout(ReplicationCountMap);
+
+	FString Config = FString::Printf(TEXT("; %lld tags replicated, %.2f bits per tag index unsplit, %.2f with this layout\r\n"),
+		Layout.NumReplicatedTags, Layout.UnsplitBitsPerTag, Layout.LayoutBitsPerTag);
+	Config += TEXT("[/Script/DNATags.DNATagsSettings]\r\n");
+	Config += TEXT("FastReplication=True\r\n");
+	Config += FString::Printf(TEXT("NetIndexFirstBitSegment=%d\r\n"), Layout.NetIndexFirstBitSegment);
+	Config += TEXT("!CommonlyReplicatedTags=ClearArray\r\n");
+	for (const FDNATag& Tag : Layout.CommonlyReplicatedTags)
+	{
+		Config += FString::Printf(TEXT("+CommonlyReplicatedTags=%s\r\n"), *Tag.ToString());
+	}
+
+	if (FFileHelper::SaveStringToFile(Config, *FileName))
+	{
+		UE_LOG(LogDNATags, Display, TEXT("Wrote suggested tag net index layout to %s"), *FileName);
+	}
+	else
+	{
+		UE_LOG(LogDNATags, Warning, TEXT("Failed to write suggested tag net index layout to %s"), *FileName);
+	}
 }
 
 void UDNATagsManager::NotifyTagReplicated(FDNATag Tag, bool WasInContainer)
@@ -850,11 +1699,253 @@ bool UDNATagsManager::GetTagEditorData(FName TagName, FString& OutComment, FName
 	return false;
 }
 
+DECLARE_CYCLE_STAT(TEXT("UDNATagsManager::SearchDNATags"), STAT_UDNATagsManager_SearchDNATags, STATGROUP_DNATags);
+
+void UDNATagsManager::SearchDNATags(const FString& SearchString, bool bSearchDevComments, FDNATagTreePositions& OutSortedPositions) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_UDNATagsManager_SearchDNATags);
+
+	const FDNATagTreePositionTable& Positions = ConditionalUpdateTagTreePositions();
+
+	if (SearchIndexSerial != DictionarySerial)
+	{
+		TArray<FString> TagNames;
+		TArray<FString> DevComments;
+		TagNames.SetNum(IndexedTags.Num());
+		DevComments.SetNum(IndexedTags.Num());
+
+		for (const TPair<FDNATag, TSharedPtr<FDNATagNode>>& NodePair : DNATagNodeMap)
+		{
+			const int32 TagIndex = NodePair.Value->GetTagIndex();
+			TagNames[TagIndex] = NodePair.Value->GetCompleteTagString();
+			DevComments[TagIndex] = NodePair.Value->DevComment;
+		}
+
+		TagNameSearchIndex.Build(TagNames);
+		TagCommentSearchIndex.Build(DevComments);
+		SearchIndexSerial = DictionarySerial;
+	}
+
+	TArray<int32> MatchingTagIndices;
+	TagNameSearchIndex.Search(SearchString, MatchingTagIndices);
+
+	if (bSearchDevComments)
+	{
+		TArray<int32> CommentTagIndices;
+		TagCommentSearchIndex.Search(SearchString, CommentTagIndices);
+		MatchingTagIndices.Append(CommentTagIndices);
+	}
+
+	OutSortedPositions.Reset(MatchingTagIndices.Num());
+	for (int32 TagIndex : MatchingTagIndices)
+	{
+		// A tag matching both its name and comment is added twice, which range queries do not mind
+		if (Positions.First[TagIndex] != INDEX_NONE)
+		{
+			OutSortedPositions.Add(Positions.First[TagIndex]);
+		}
+	}
+	OutSortedPositions.Sort();
+}
+
 void UDNATagsManager::EditorRefreshDNATagTree()
 {
-	DestroyDNATagTree();
+	// Dev comments can change without any tag being added or removed
+	SearchIndexSerial = MAX_uint32;
+
+	if (!DNARootTag.IsValid())
+	{
+		LoadDNATagTables();
+		ConstructDNATagTree();
+		PublishDictionarySnapshot();
+		return;
+	}
+
+#if STATS
+	FString PerfMessage = FString::Printf(TEXT("UDNATagsManager::EditorRefreshDNATagTree"));
+	SCOPE_LOG_TIME_IN_SECONDS(*PerfMessage, nullptr)
+#endif
+
 	LoadDNATagTables();
-	ConstructDNATagTree();
+
+	// Gather what the sources add now, then only insert and remove the tags that differ from the tree
+	TArray<FGatheredTagRow> Rows;
+	GatheredTagRows = &Rows;
+	PopulateTreeFromSources();
+	GatheredTagRows = nullptr;
+
+	const bool bNetIndexWasCurrent = NetIndexDictionarySerial == DictionarySerial;
+	const bool bHadCommonTags = CommonlyReplicatedTags.Num() > 0;
+
+	FDNATagTreeChangeSet ChangeSet;
+	ApplyGatheredTagRows(Rows, ChangeSet);
+
+	ReadTagTreeSettings();
+	UpdateTagTreePositions();
+
+	if (ShouldUseFastReplication())
+	{
+		// Commonly replicated tags are swapped to the front, which breaks the sorted order an incremental update relies on
+		if (bNetIndexWasCurrent && !bHadCommonTags && CommonlyReplicatedTags.Num() == 0)
+		{
+			PatchNetIndex(ChangeSet);
+		}
+		else
+		{
+			ConstructNetIndex();
+		}
+	}
+
+	ConstructTagRedirects();
+
+	UE_LOG(LogDNATags, Log, TEXT("Refreshed tag tree: %d tags added, %d removed"), ChangeSet.AddedTags.Num(), ChangeSet.RemovedTags.Num());
+
+	if (!ChangeSet.IsEmpty())
+	{
+		IDNATagsModule::OnDNATagTreeChangeSet.Broadcast(ChangeSet);
+	}
+	IDNATagsModule::OnDNATagTreeChanged.Broadcast();
+
+	PublishDictionarySnapshot();
+}
+
+void UDNATagsManager::ApplyGatheredTagRows(const TArray<FGatheredTagRow>& Rows, FDNATagTreeChangeSet& OutChangeSet)
+{
+	TSet<const FDNATagNode*> ExistingNodes;
+	ExistingNodes.Reserve(DNATagNodeMap.Num());
+	for (const TPair<FDNATag, TSharedPtr<FDNATagNode>>& NodePair : DNATagNodeMap)
+	{
+		ExistingNodes.Add(NodePair.Value.Get());
+
+		// Sources and comments are applied again from the rows, the same way a full rebuild would
+		NodePair.Value->SourceName = NAME_None;
+		NodePair.Value->DevComment.Empty();
+	}
+
+	TSet<const FDNATagNode*> WantedNodes;
+	WantedNodes.Reserve(DNATagNodeMap.Num());
+
+	for (const FGatheredTagRow& Row : Rows)
+	{
+		// Straight to the map, FindTagNode would follow redirects in the editor
+		TSharedPtr<FDNATagNode> Node = DNATagNodeMap.FindRef(FDNATag(Row.TagRow.Tag));
+		if (Node.IsValid())
+		{
+			ApplyTagRowEditorData(*Node, Row.SourceName, Row.TagRow.DevComment);
+			for (TSharedPtr<FDNATagNode> ParentNode = Node->ParentNode; ParentNode.IsValid(); ParentNode = ParentNode->ParentNode)
+			{
+				ApplyTagRowEditorData(*ParentNode, NAME_None, Row.TagRow.DevComment);
+			}
+		}
+		else
+		{
+			AddTagTableRow(Row.TagRow, Row.SourceName);
+			Node = DNATagNodeMap.FindRef(FDNATag(Row.TagRow.Tag));
+			if (!Node.IsValid())
+			{
+				// AddTagTableRow skips empty parts of names such as "A..B", look for the tag it actually added
+				TArray<FString> SubTags;
+				Row.TagRow.Tag.ToString().ParseIntoArray(SubTags, TEXT("."), true);
+				Node = DNATagNodeMap.FindRef(FDNATag(FName(*FString::Join(SubTags, TEXT(".")))));
+				if (!Node.IsValid())
+				{
+					continue;
+				}
+			}
+		}
+
+		// Mark the tag and the parents it implies, anything new among them was just inserted. Parents are recorded before their children
+		const int32 FirstNewTag = OutChangeSet.AddedTags.Num();
+		for (const FDNATagNode* CurNode = Node.Get(); CurNode && !WantedNodes.Contains(CurNode); CurNode = CurNode->ParentNode.Get())
+		{
+			WantedNodes.Add(CurNode);
+			if (!ExistingNodes.Contains(CurNode))
+			{
+				OutChangeSet.AddedTags.Insert(CurNode->GetCompleteTag(), FirstNewTag);
+			}
+		}
+	}
+
+	// Whatever is left is not implied by any row, and neither is anything below it
+	TArray<TSharedPtr<FDNATagNode>> NodesToRemove;
+	for (const TPair<FDNATag, TSharedPtr<FDNATagNode>>& NodePair : DNATagNodeMap)
+	{
+		if (!WantedNodes.Contains(NodePair.Value.Get()))
+		{
+			NodesToRemove.Add(NodePair.Value);
+		}
+	}
+
+	for (const TSharedPtr<FDNATagNode>& Node : NodesToRemove)
+	{
+		OutChangeSet.RemovedTags.Add(Node->GetCompleteTag());
+		RemoveTagNode(Node);
+	}
+}
+
+void UDNATagsManager::RemoveTagNode(const TSharedPtr<FDNATagNode>& Node)
+{
+	TArray<TSharedPtr<FDNATagNode>>& SiblingNodes = Node->ParentNode.IsValid() ? Node->ParentNode->ChildTags : DNARootTag->ChildTags;
+	SiblingNodes.Remove(Node);
+
+	{
+		// Same lock as InsertTagIntoNodeArray, tag requests can come from the async loading thread
+		FScopeLock Lock(&DNATagMapCritical);
+		DNATagNodeMap.Remove(Node->GetCompleteTag());
+		DictionarySerial++;
+	}
+
+	// The tag index stays reserved for this tag, and PatchNetIndex finds removed nodes by their cleared net index
+	Node->NetIndex = INVALID_TAGNETINDEX;
+}
+
+void UDNATagsManager::PatchNetIndex(const FDNATagTreeChangeSet& ChangeSet)
+{
+	// Net indices are in sorted order, so removing and inserting only moves the nodes after the first change
+	int32 FirstChangedIndex = NetworkDNATagNodeIndex.Num();
+	if (ChangeSet.RemovedTags.Num() > 0)
+	{
+		for (int32 NetIdx = 0; NetIdx < NetworkDNATagNodeIndex.Num(); ++NetIdx)
+		{
+			if (NetworkDNATagNodeIndex[NetIdx]->NetIndex == INVALID_TAGNETINDEX)
+			{
+				FirstChangedIndex = NetIdx;
+				break;
+			}
+		}
+		NetworkDNATagNodeIndex.RemoveAll([](const TSharedPtr<FDNATagNode>& Node) { return Node->NetIndex == INVALID_TAGNETINDEX; });
+	}
+
+	const FCompareFDNATagNodeByTag Compare;
+	for (const FDNATag& AddedTag : ChangeSet.AddedTags)
+	{
+		TSharedPtr<FDNATagNode> Node = DNATagNodeMap.FindRef(AddedTag);
+		if (!Node.IsValid())
+		{
+			continue;
+		}
+
+		// Upper bound, there are no equal nodes since the order is total
+		int32 Low = 0;
+		int32 High = NetworkDNATagNodeIndex.Num();
+		while (Low < High)
+		{
+			const int32 Mid = Low + (High - Low) / 2;
+			if (Compare(Node, NetworkDNATagNodeIndex[Mid]))
+			{
+				High = Mid;
+			}
+			else
+			{
+				Low = Mid + 1;
+			}
+		}
+
+		NetworkDNATagNodeIndex.Insert(Node, Low);
+		FirstChangedIndex = FMath::Min(FirstChangedIndex, Low);
+	}
+
+	AssignNetIndices(FirstChangedIndex);
 }
 
 FDNATagContainer UDNATagsManager::RequestDNATagChildrenInDictionary(const FDNATag& DNATag) const
@@ -931,13 +2022,21 @@ FDNATag UDNATagsManager::RequestDNATag(FName TagName, bool ErrorIfNotFound) cons
 	FScopeLock Lock(&DNATagMapCritical);
 #endif
 
-	FDNATag PossibleTag(TagName);
-
-	if (DNATagNodeMap.Contains(PossibleTag))
+	// Once a snapshot of the current dictionary is published, its name table answers without touching the node map
+	const FDNATagDictionarySnapshot* Snapshot = GetDictionarySnapshot();
+	if (IsCurrentDictionarySnapshot(Snapshot))
+	{
+		if (Snapshot->FindTagRecord(TagName))
+		{
+			return FDNATag(TagName);
+		}
+	}
+	else if (DNATagNodeMap.Contains(FDNATag(TagName)))
 	{
-		return PossibleTag;
+		return FDNATag(TagName);
 	}
-	else if (ErrorIfNotFound)
+
+	if (ErrorIfNotFound)
 	{
 		static TSet<FName> MissingTagName;
 		if (!MissingTagName.Contains(TagName))
@@ -981,22 +2080,239 @@ void UDNATagsManager::DoneAddingNativeTags()
 	{
 		bDoneAddingNativeTags = true;
 
-		if (ShouldUseFastReplication())
+		// Only native tags added after the tree was built can have changed the net indices
+		if (ShouldUseFastReplication() && NetIndexDictionarySerial != DictionarySerial)
 		{
 			ConstructNetIndex();
 		}
+
+		PublishDictionarySnapshot();
+	}
+}
+
+DECLARE_CYCLE_STAT(TEXT("UDNATagsManager::PublishDictionarySnapshot"), STAT_UDNATagsManager_PublishDictionarySnapshot, STATGROUP_DNATags);
+
+void UDNATagsManager::PublishDictionarySnapshot()
+{
+	SCOPE_CYCLE_COUNTER(STAT_UDNATagsManager_PublishDictionarySnapshot);
+
+	const FDNATagTreePositionTable& Positions = ConditionalUpdateTagTreePositions();
+
+	FDNATagDictionarySnapshot* Snapshot = new FDNATagDictionarySnapshot();
+	Snapshot->IndexedTags = IndexedTags;
+	Snapshot->TagAndParentIndices = TagAndParentIndices;
+	Snapshot->TagAndParentSpans = TagAndParentSpans;
+	Snapshot->TagTreeFirst = Positions.First;
+	Snapshot->TagTreeLast = Positions.Last;
+	Snapshot->DictionarySerial = DictionarySerial;
+
+	// Only tags that are in the tree can be requested, the index tables also hold tags from before the last rebuild
+	TArray<FDNATagNameRecord> Records;
+	Records.Reserve(DNATagNodeMap.Num());
+	Snapshot->TreePositionTags.SetNumUninitialized(DNATagNodeMap.Num());
+	for (const TPair<FDNATag, TSharedPtr<FDNATagNode>>& NodePair : DNATagNodeMap)
+	{
+		const int32 TagIndex = NodePair.Value->GetTagIndex();
+		if (TagIndex == INDEX_NONE || Positions.First[TagIndex] == INDEX_NONE)
+		{
+			continue;
+		}
+
+		FDNATagNameRecord& Record = Records[Records.AddDefaulted()];
+		Record.TagName = NodePair.Key.GetTagName();
+		Record.TagIndex = TagIndex;
+		Record.LoadTagIndex = TagIndex;
+		Record.ParentTagIndex = IndexedTagParents[TagIndex];
+		Record.Depth = (uint16)(TagAndParentSpans[TagIndex].Num - 1);
+		Record.NetIndex = NodePair.Value->GetNetIndex();
+
+		Snapshot->TreePositionTags[Positions.First[TagIndex]] = TagIndex;
+	}
+
+	// Redirects are resolved to the end of their chain when they are constructed, so a redirected name loads with a single lookup.
+	// A redirected tag that is still in the tree keeps its record, loads still take the redirect like they do through TagRedirects.
+	// A target that has left the tree since the redirects were constructed keeps its index, so loads go to it like they do through TagRedirects.
+	TMap<FName, int32> RecordIndexMap;
+	RecordIndexMap.Reserve(TagRedirects.Num());
+	for (int32 RecordIdx = 0; RecordIdx < Records.Num() && TagRedirects.Num() > 0; ++RecordIdx)
+	{
+		if (TagRedirects.Contains(Records[RecordIdx].TagName))
+		{
+			RecordIndexMap.Add(Records[RecordIdx].TagName, RecordIdx);
+		}
+	}
+	for (const TPair<FName, FDNATag>& TagRedirect : TagRedirects)
+	{
+		const int32* NewTagIndex = TagIndexMap.Find(TagRedirect.Value.GetTagName());
+		if (TagRedirect.Key.IsNone() || !ensure(NewTagIndex))
+		{
+			continue;
+		}
+
+		if (const int32* RecordIdx = RecordIndexMap.Find(TagRedirect.Key))
+		{
+			Records[*RecordIdx].LoadTagIndex = *NewTagIndex;
+		}
+		else
+		{
+			FDNATagNameRecord& Record = Records[Records.AddDefaulted()];
+			Record.TagName = TagRedirect.Key;
+			Record.LoadTagIndex = *NewTagIndex;
+		}
+	}
+
+	Snapshot->NameTable.Build(Records);
+
+	check(IsInGameThread());
+
+	FScopeLock Lock(&DictionarySnapshotCritical);
+	DictionarySnapshots.Add(TSharedPtr<const FDNATagDictionarySnapshot, ESPMode::ThreadSafe>(Snapshot));
+	FPlatformAtomics::InterlockedExchangePtr((void**)&PublishedSnapshot, Snapshot);
+
+	// Free the old snapshots nobody holds. New references can only be taken to the current one, so an unreferenced old snapshot stays unreferenced
+	for (int32 SnapshotIdx = DictionarySnapshots.Num() - NumRetainedSnapshots - 1; SnapshotIdx >= 0; --SnapshotIdx)
+	{
+		if (DictionarySnapshots[SnapshotIdx].IsUnique())
+		{
+			DictionarySnapshots.RemoveAt(SnapshotIdx, 1, false);
+		}
+	}
+}
+
+TSharedPtr<const FDNATagDictionarySnapshot, ESPMode::ThreadSafe> UDNATagsManager::AcquireDictionarySnapshot() const
+{
+	FScopeLock Lock(&DictionarySnapshotCritical);
+	if (DictionarySnapshots.Num() == 0)
+	{
+		return nullptr;
+	}
+	return DictionarySnapshots.Last();
+}
+
+FDNATag FDNATagDictionarySnapshot::RequestDNATag(FName TagName) const
+{
+	const FDNATagNameRecord* Record = FindTagRecord(TagName);
+	return Record ? IndexedTags[Record->TagIndex] : FDNATag();
+}
+
+void FDNATagNameTable::Build(const TArray<FDNATagNameRecord>& Records)
+{
+	NumRecords = Records.Num();
+
+	// At most half full keeps the probes short even for an unlucky seed
+	const int32 NumSlots = FMath::Max(8, (int32)FMath::RoundUpToPowerOfTwo(Records.Num() * 2));
+	SlotMask = NumSlots - 1;
+
+	// Try a few seeds and keep the one with the shortest longest probe, stopping early if a seed is perfect
+	uint32 BestSeed = 0;
+	uint32 BestMaxProbe = MAX_uint32;
+	static const int32 NumSeedsToTry = 8;
+	for (int32 SeedIdx = 0; SeedIdx < NumSeedsToTry && BestMaxProbe > 0; ++SeedIdx)
+	{
+		const uint32 TrySeed = (uint32)SeedIdx * 0x27D4EB2Fu;
+		const uint32 TryMaxProbe = PlaceRecords(Records, TrySeed);
+		if (TryMaxProbe < BestMaxProbe)
+		{
+			BestSeed = TrySeed;
+			BestMaxProbe = TryMaxProbe;
+		}
+	}
+
+	if (BestSeed != Seed)
+	{
+		PlaceRecords(Records, BestSeed);
+	}
+}
+
+uint32 FDNATagNameTable::PlaceRecords(const TArray<FDNATagNameRecord>& Records, uint32 InSeed)
+{
+	Slots.Reset(SlotMask + 1);
+	Slots.AddDefaulted(SlotMask + 1);
+	Seed = InSeed;
+	MaxProbe = 0;
+
+	for (const FDNATagNameRecord& Record : Records)
+	{
+		check(!Record.TagName.IsNone());
+
+		uint32 Probe = 0;
+		uint32 Slot = HashName(Record.TagName, InSeed) & SlotMask;
+		while (!Slots[Slot].TagName.IsNone())
+		{
+			checkSlow(Slots[Slot].TagName != Record.TagName);
+			++Probe;
+			Slot = (Slot + 1) & SlotMask;
+		}
+		Slots[Slot] = Record;
+		MaxProbe = FMath::Max(MaxProbe, Probe);
+	}
+
+	return MaxProbe;
+}
+
+FDNATagContainer FDNATagDictionarySnapshot::RequestDNATagParents(const FDNATag& DNATag) const
+{
+	FDNATagContainer ParentTags;
+
+	const int32 TagIndex = GetTagIndex(DNATag);
+	if (TagIndex != INDEX_NONE)
+	{
+		TArrayView<const int32> TagAndParents = GetTagAndParentIndices(TagIndex);
+		ParentTags.DNATags.Reserve(TagAndParents.Num());
+
+		for (int32 CurTagIndex : TagAndParents)
+		{
+			ParentTags.DNATags.Add(IndexedTags[CurTagIndex]);
+		}
+	}
+	return ParentTags;
+}
+
+FDNATagContainer FDNATagDictionarySnapshot::RequestDNATagChildren(const FDNATag& DNATag) const
+{
+	// Note this purposefully does not include the passed in DNATag in the container.
+	FDNATagContainer TagContainer;
+
+	const int32 TagIndex = GetTagIndex(DNATag);
+	if (TagIndex != INDEX_NONE)
+	{
+		// Children follow the tag in tree order, fill the container the same way FDNATagContainer::AddTag would without going through the manager
+		for (int32 Position = TagTreeFirst[TagIndex] + 1; Position <= TagTreeLast[TagIndex]; ++Position)
+		{
+			const int32 ChildIndex = TreePositionTags[Position];
+			TagContainer.DNATags.Add(IndexedTags[ChildIndex]);
+
+			TArrayView<const int32> TagAndParents = GetTagAndParentIndices(ChildIndex);
+			for (int32 ParentIdx = 1; ParentIdx < TagAndParents.Num(); ++ParentIdx)
+			{
+				TagContainer.ParentTags.AddUnique(IndexedTags[TagAndParents[ParentIdx]]);
+			}
+		}
 	}
+	return TagContainer;
+}
+
+bool FDNATagDictionarySnapshot::MatchesTag(const FDNATag& Tag, const FDNATag& TagToCheck) const
+{
+	return MatchesTagIndex(GetTagIndex(Tag), GetTagIndex(TagToCheck));
 }
 
 FDNATagContainer UDNATagsManager::RequestDNATagParents(const FDNATag& DNATag) const
 {
-	const FDNATagContainer* ParentTags = GetSingleTagContainer(DNATag);
+	FDNATagContainer ParentTags;
 
-	if (ParentTags)
+	const int32 TagIndex = GetTagIndex(DNATag);
+	if (TagIndex != INDEX_NONE)
 	{
-		return ParentTags->GetDNATagParents();
+		TArrayView<const int32> TagAndParents = GetTagAndParentIndices(TagIndex);
+		ParentTags.DNATags.Reserve(TagAndParents.Num());
+
+		for (int32 CurTagIndex : TagAndParents)
+		{
+			ParentTags.DNATags.Add(IndexedTags[CurTagIndex]);
+		}
 	}
-	return FDNATagContainer();
+	return ParentTags;
 }
 
 void UDNATagsManager::RequestAllDNATags(FDNATagContainer& TagContainer, bool OnlyIncludeDictionaryTags) const
@@ -1169,6 +2485,7 @@ FDNATagNode::FDNATagNode(FName InTag, TSharedPtr<FDNATagNode> InParentNode)
 	: Tag(InTag)
 	, ParentNode(InParentNode)
 	, NetIndex(INVALID_TAGNETINDEX)
+	, TagIndex(INDEX_NONE)
 {
 	TArray<FDNATag> ParentCompleteTags;
 
@@ -1199,6 +2516,7 @@ void FDNATagNode::ResetNode()
 	Tag = NAME_None;
 	CompleteTagWithParents.Reset();
 	NetIndex = INVALID_TAGNETINDEX;
+	TagIndex = INDEX_NONE;
 
 	for (int32 ChildIdx = 0; ChildIdx < ChildTags.Num(); ++ChildIdx)
 	{
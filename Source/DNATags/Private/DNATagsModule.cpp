@@ -7,6 +7,7 @@
 #include "UObject/Package.h"
 
 FSimpleMulticastDelegate IDNATagsModule::OnDNATagTreeChanged;
+IDNATagsModule::FOnDNATagTreeChangeSet IDNATagsModule::OnDNATagTreeChangeSet;
 FSimpleMulticastDelegate IDNATagsModule::OnTagSettingsChanged;
 
 class FDNATagsModule : public IDNATagsModule
@@ -29,6 +30,9 @@ void FDNATagsModule::StartupModule()
 #if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
 int32 DNATagPrintReportOnShutdown = 0;
 static FAutoConsoleVariableRef CVarDNATagPrintReportOnShutdown(TEXT("DNATags.PrintReportOnShutdown"), DNATagPrintReportOnShutdown, TEXT("Print DNA tag replication report on shutdown"), ECVF_Default );
+
+int32 DNATagWriteNetIndexLayoutOnShutdown = 0;
+static FAutoConsoleVariableRef CVarDNATagWriteNetIndexLayoutOnShutdown(TEXT("DNATags.WriteNetIndexLayoutOnShutdown"), DNATagWriteNetIndexLayoutOnShutdown, TEXT("Write the net index layout suggested by the tags replicated this session on shutdown"), ECVF_Default );
 #endif
 
 
@@ -39,6 +43,11 @@ void FDNATagsModule::ShutdownModule()
 	{
 		UDNATagsManager::Get().PrintReplicationFrequencyReport();
 	}
+
+	if (DNATagWriteNetIndexLayoutOnShutdown)
+	{
+		UDNATagsManager::Get().WriteNetIndexLayout(UDNATagsManager::GetNetIndexLayoutPath());
+	}
 #endif
 
 	UDNATagsManager::SingletonManager = nullptr;
@@ -22,6 +22,7 @@ UDNATagsSettings::UDNATagsSettings(const FObjectInitializer& ObjectInitializer)
 	ImportTagsFromConfig = false;
 	WarnOnInvalidTags = true;
 	FastReplication = false;
+	CacheTagDictionary = false;
 	NumBitsForContainerSize = 6;
 	NetIndexFirstBitSegment = 16;
 }
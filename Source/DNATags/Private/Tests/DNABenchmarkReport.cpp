@@ -0,0 +1,36 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "DNABenchmarkReport.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "DNATagContainer.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+FDNABenchmarkReport::FDNABenchmarkReport(const TCHAR* InName, const TCHAR* SizeColumn, int32 InNumIterations)
+	: Name(InName)
+	, NumIterations(InNumIterations)
+	, Checksum(0.0)
+{
+	CSV = FString::Printf(TEXT("%s,Operation,Iterations,NsPerOp\n"), SizeColumn);
+}
+
+void FDNABenchmarkReport::Report(int32 Size, const TCHAR* Operation, double NsPerOp)
+{
+	UE_LOG(LogDNATags, Display, TEXT("%s,%d,%s,%d,%.1f"), *Name, Size, Operation, NumIterations, NsPerOp);
+	CSV += FString::Printf(TEXT("%d,%s,%d,%.1f\n"), Size, Operation, NumIterations, NsPerOp);
+}
+
+void FDNABenchmarkReport::Finish(FAutomationTestBase& Test) const
+{
+	UE_LOG(LogDNATags, Display, TEXT("%s checksum %f"), *Name, Checksum);
+
+	const FString CSVPath = FPaths::AutomationDir() / (Name + TEXT(".csv"));
+	if (!FFileHelper::SaveStringToFile(CSV, *CSVPath))
+	{
+		Test.AddWarning(FString::Printf(TEXT("Could not write %s"), *CSVPath));
+	}
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,282 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "Core.h"
+#include "UObject/Package.h"
+#include "Misc/AutomationTest.h"
+#include "Engine/DataTable.h"
+#include "DNATagContainer.h"
+#include "DNATagsManager.h"
+#include "DNATagsModule.h"
+#include "DNABenchmarkReport.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/**
+ * Micro-benchmarks of the common tag operations against synthetic dictionaries of increasing size. Run headless with
+ *   UE4Editor-Cmd <Project> -ExecCmds="Automation RunTests System.DNATags.Benchmark;Quit" -unattended -nullrhi
+ * Timings are reported by FDNABenchmarkReport as "DNATagBenchmark,<tags>,<operation>,<iterations>,<ns per op>" and written to DNATagBenchmark.csv.
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDNATagBenchmark, "System.DNATags.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+namespace DNATagBenchmark
+{
+	/** Dictionary sizes to measure, each one extends the previous */
+	static const int32 DictionarySizes[] = { 1000, 10000, 50000 };
+
+	/** Deepest generated tag, counting the root */
+	static const int32 MaxDepth = 6;
+
+	/** Number of containers the container operations cycle through */
+	static const int32 NumContainers = 256;
+
+	/** Explicit tags in each container */
+	static const int32 TagsPerContainer = 8;
+
+	/** Iterations of every operation, the same for every size so the timings compare */
+	static const int32 NumIterations = 100000;
+
+	/** Set once a run has added the synthetic tags. Their indices outlive the tags, and a rerun gets the same ones back because it uses the same names */
+	static bool bSyntheticTagsIndexed = false;
+
+	/** Returns the tags below Root, in an order where every tag comes after its parent so any prefix is a complete tree */
+	static void GenerateTagNames(const FString& Root, int32 NumTags, int32 Seed, TArray<FString>& OutNames)
+	{
+		FRandomStream Random(Seed);
+		TArray<int32> Depths;
+		TArray<int32> Parents;
+
+		OutNames.Reset(NumTags);
+		OutNames.Add(Root);
+		Depths.Add(1);
+		Parents.Add(INDEX_NONE);
+
+		while (OutNames.Num() < NumTags)
+		{
+			// Attaching to a random earlier tag makes early tags wide categories, like hand authored dictionaries. Move up when that would be too deep
+			int32 ParentIdx = Random.RandRange(0, OutNames.Num() - 1);
+			while (Depths[ParentIdx] >= MaxDepth)
+			{
+				ParentIdx = Parents[ParentIdx];
+			}
+
+			OutNames.Add(FString::Printf(TEXT("%s.T%d"), *OutNames[ParentIdx], OutNames.Num()));
+			Depths.Add(Depths[ParentIdx] + 1);
+			Parents.Add(ParentIdx);
+		}
+	}
+
+	/** Adds Names[FirstName, LastName) to the dictionary through a transient data table */
+	static void AddTagsToDictionary(const TArray<FString>& Names, int32 FirstName, int32 LastName)
+	{
+		UDataTable* DataTable = NewObject<UDataTable>(GetTransientPackage(), NAME_None);
+		DataTable->RowStruct = FDNATagTableRow::StaticStruct();
+
+		for (int32 NameIdx = FirstName; NameIdx < LastName; ++NameIdx)
+		{
+			uint8* RowData = (uint8*)FMemory::Malloc(DataTable->RowStruct->PropertiesSize);
+			DataTable->RowStruct->InitializeStruct(RowData);
+
+			FDNATagTableRow* TagRow = (FDNATagTableRow*)RowData;
+			TagRow->Tag = FName(*Names[NameIdx]);
+
+			DataTable->RowMap.Add(FName(*FString::FromInt(NameIdx)), RowData);
+		}
+
+		UDNATagsManager::Get().PopulateTreeFromDataTable(DataTable);
+	}
+}
+
+bool FDNATagBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace DNATagBenchmark;
+
+	UDNATagsManager& Manager = UDNATagsManager::Get();
+
+	// Net indices are 16 bits, on top of a large project dictionary the synthetic tags could overflow them. Every tag in the tree has a tag index,
+	// so the tag indices bound the net indices too. Only the first run in a session assigns new ones
+	const int32 MaxTags = DictionarySizes[ARRAY_COUNT(DictionarySizes) - 1];
+	const int32 NumNewIndices = bSyntheticTagsIndexed ? 0 : MaxTags;
+	if (Manager.GetNumTagIndices() + NumNewIndices >= MAX_uint16)
+	{
+		const FString Message = FString::Printf(TEXT("Skipped, %d synthetic tags do not fit next to the %d tag indices the project dictionary already uses"), MaxTags, Manager.GetNumTagIndices());
+		UE_LOG(LogDNATags, Warning, TEXT("DNATagBenchmark: %s"), *Message);
+		AddWarning(Message);
+		return true;
+	}
+
+	// Containers serialize by net index, like a shipping game
+	const bool bOldUseFastReplication = Manager.bUseFastReplication;
+	Manager.bUseFastReplication = true;
+
+	TArray<FString> Names;
+	GenerateTagNames(TEXT("DNATagBenchmark"), MaxTags, 0x5EED, Names);
+
+	FDNABenchmarkReport Bench(TEXT("DNATagBenchmark"), TEXT("Tags"), NumIterations);
+	int32 NumAddedTags = 0;
+
+	for (int32 NumTags : DictionarySizes)
+	{
+		AddTagsToDictionary(Names, NumAddedTags, NumTags);
+		NumAddedTags = NumTags;
+
+		Manager.ConstructNetIndex();
+		Manager.PublishDictionarySnapshot();
+
+		FRandomStream Random(NumTags);
+
+		TArray<FName> TagNames;
+		TArray<FDNATag> Tags;
+		for (int32 NameIdx = 0; NameIdx < NumTags; ++NameIdx)
+		{
+			TagNames.Add(FName(*Names[NameIdx]));
+			Tags.Add(Manager.RequestDNATag(TagNames[NameIdx]));
+		}
+
+		// Random lookups, so successive iterations do not hit the same cache lines
+		TArray<int32> TagOrder;
+		for (int32 Idx = 0; Idx < NumTags; ++Idx)
+		{
+			TagOrder.Add(Random.RandRange(0, NumTags - 1));
+		}
+
+		TArray<TArray<FDNATag>> TagArrays;
+		TArray<FDNATagContainer> Containers;
+		TArray<FDNATagQuery> Queries;
+		TArray<TArray<uint8>> NetData;
+		TArray<int64> NetBits;
+		for (int32 ContainerIdx = 0; ContainerIdx < NumContainers; ++ContainerIdx)
+		{
+			TArray<FDNATag>& TagArray = TagArrays[TagArrays.AddDefaulted()];
+			for (int32 TagIdx = 0; TagIdx < TagsPerContainer; ++TagIdx)
+			{
+				TagArray.AddUnique(Tags[Random.RandRange(0, NumTags - 1)]);
+			}
+			Containers.Add(FDNATagContainer::CreateFromArray(TagArray));
+
+			// Typical ability requirements: any of a few tags and none of a few others
+			FDNATagContainer RequiredTags;
+			FDNATagContainer BlockedTags;
+			for (int32 TagIdx = 0; TagIdx < 3; ++TagIdx)
+			{
+				RequiredTags.AddTag(Tags[Random.RandRange(0, NumTags - 1)]);
+				BlockedTags.AddTag(Tags[Random.RandRange(0, NumTags - 1)]);
+			}
+			FDNATagQueryExpression RequiredExpr;
+			RequiredExpr.AnyTagsMatch().AddTags(RequiredTags);
+			FDNATagQueryExpression BlockedExpr;
+			BlockedExpr.NoTagsMatch().AddTags(BlockedTags);
+			FDNATagQueryExpression RootExpr;
+			RootExpr.AllExprMatch().AddExpr(RequiredExpr).AddExpr(BlockedExpr);
+			Queries.Add(FDNATagQuery::BuildQuery(RootExpr));
+
+			FBitWriter Writer(0, true);
+			bool bOutSuccess = true;
+			Containers[ContainerIdx].NetSerialize(Writer, nullptr, bOutSuccess);
+			NetData.Add(*Writer.GetBuffer());
+			NetBits.Add(Writer.GetNumBits());
+		}
+
+		Bench.Measure(NumTags, TEXT("RequestDNATag"), [&](int32 Iteration)
+		{
+			return Manager.RequestDNATag(TagNames[TagOrder[Iteration % NumTags]]).IsValid() ? 1 : 0;
+		});
+
+		const TEnumAsByte<EDNATagMatchType::Type> MatchTypes[] = { EDNATagMatchType::Explicit, EDNATagMatchType::IncludeParentTags };
+		const TCHAR* MatchTypeNames[] = { TEXT("Explicit"), TEXT("IncludeParentTags") };
+		for (int32 TagMatchIdx = 0; TagMatchIdx < 2; ++TagMatchIdx)
+		{
+			for (int32 CheckMatchIdx = 0; CheckMatchIdx < 2; ++CheckMatchIdx)
+			{
+				const FString Operation = FString::Printf(TEXT("HasTag %s/%s"), MatchTypeNames[TagMatchIdx], MatchTypeNames[CheckMatchIdx]);
+				Bench.Measure(NumTags, *Operation, [&](int32 Iteration)
+				{
+					const FDNATag& Tag = Tags[TagOrder[Iteration % NumTags]];
+					return Containers[Iteration % NumContainers].HasTag(Tag, MatchTypes[TagMatchIdx], MatchTypes[CheckMatchIdx]) ? 1 : 0;
+				});
+			}
+		}
+
+		Bench.Measure(NumTags, TEXT("DoesTagContainerMatch Any"), [&](int32 Iteration)
+		{
+			const FDNATagContainer& Other = Containers[(Iteration + 1) % NumContainers];
+			return Containers[Iteration % NumContainers].DoesTagContainerMatch(Other, EDNATagMatchType::IncludeParentTags, EDNATagMatchType::Explicit, EDNAContainerMatchType::Any) ? 1 : 0;
+		});
+
+		Bench.Measure(NumTags, TEXT("DoesTagContainerMatch All"), [&](int32 Iteration)
+		{
+			const FDNATagContainer& Other = Containers[(Iteration + 1) % NumContainers];
+			return Containers[Iteration % NumContainers].DoesTagContainerMatch(Other, EDNATagMatchType::IncludeParentTags, EDNATagMatchType::Explicit, EDNAContainerMatchType::All) ? 1 : 0;
+		});
+
+		Bench.Measure(NumTags, TEXT("DoesTagContainerMatch Any IncludeParentTags"), [&](int32 Iteration)
+		{
+			const FDNATagContainer& Other = Containers[(Iteration + 1) % NumContainers];
+			return Containers[Iteration % NumContainers].DoesTagContainerMatch(Other, EDNATagMatchType::IncludeParentTags, EDNATagMatchType::IncludeParentTags, EDNAContainerMatchType::Any) ? 1 : 0;
+		});
+
+		Bench.Measure(NumTags, TEXT("FDNATagQuery::Matches"), [&](int32 Iteration)
+		{
+			return Queries[Iteration % NumContainers].Matches(Containers[(Iteration * 7) % NumContainers]) ? 1 : 0;
+		});
+
+		// Reset keeps the allocation, so this is the cost of merging rather than of allocating
+		FDNATagContainer Scratch;
+		Bench.Measure(NumTags, TEXT("AppendTags"), [&](int32 Iteration)
+		{
+			Scratch.Reset();
+			Scratch.AppendTags(Containers[Iteration % NumContainers]);
+			Scratch.AppendTags(Containers[(Iteration + 1) % NumContainers]);
+			return Scratch.Num();
+		});
+
+		// CreateFromArray is the public way into FillParentTags
+		Bench.Measure(NumTags, TEXT("FillParentTags"), [&](int32 Iteration)
+		{
+			return FDNATagContainer::CreateFromArray(TagArrays[Iteration % NumContainers]).Num();
+		});
+
+		FBitWriter NetWriter(0, true);
+		Bench.Measure(NumTags, TEXT("NetSerialize Write"), [&](int32 Iteration)
+		{
+			NetWriter.Reset();
+			bool bOutSuccess = true;
+			Containers[Iteration % NumContainers].NetSerialize(NetWriter, nullptr, bOutSuccess);
+			return NetWriter.GetNumBits();
+		});
+
+		FDNATagContainer NetContainer;
+		Bench.Measure(NumTags, TEXT("NetSerialize Read"), [&](int32 Iteration)
+		{
+			const int32 ContainerIdx = Iteration % NumContainers;
+			FBitReader Reader(NetData[ContainerIdx].GetData(), NetBits[ContainerIdx]);
+			bool bOutSuccess = true;
+			NetContainer.NetSerialize(Reader, nullptr, bOutSuccess);
+			return NetContainer.Num();
+		});
+	}
+
+	bSyntheticTagsIndexed = true;
+
+	Bench.Finish(*this);
+
+	Manager.bUseFastReplication = bOldUseFastReplication;
+
+	// Drop the synthetic tags again, they do not come from any tag source. This rebuilds the tree and net indices from the sources
+#if WITH_EDITOR
+	Manager.EditorRefreshDNATagTree();
+#else
+	Manager.DestroyDNATagTree();
+	Manager.LoadDNATagTables();
+	Manager.ConstructDNATagTree();
+	Manager.PublishDictionarySnapshot();
+#endif
+
+	// The refresh only indexes for fast replication, which the benchmark forced on
+	Manager.ConstructNetIndex();
+
+	TestFalse(TEXT("Synthetic tags removed from the dictionary"), Manager.RequestDNATag(FName(*Names[0]), false).IsValid());
+
+	return !HasAnyErrors();
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
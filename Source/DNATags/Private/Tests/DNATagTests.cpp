@@ -5,9 +5,14 @@
 #include "Misc/AutomationTest.h"
 #include "Engine/DataTable.h"
 #include "DNATagContainer.h"
+#include "DNATagBitContainer.h"
+#include "DNATagNetDelta.h"
+#include "DNATagSearchIndex.h"
 #include "DNATagsManager.h"
 #include "DNATagsModule.h"
+#include "DNATagsSettings.h"
 #include "Stats/StatsMisc.h"
+#include "Async/TaskGraphInterfaces.h"
 
 #if WITH_DEV_AUTOMATION_TESTS
 
@@ -123,6 +128,14 @@ public:
 		return UDNATagsManager::Get().RequestDNATag(FName(*String));
 	}
 
+	/** Returns a tag with the given name whether or not it is in the dictionary, like one loaded from an asset */
+	FDNATag GetUncheckedTagForString(const FString& String)
+	{
+		FDNATag Tag;
+		Tag.FromExportString(FString::Printf(TEXT("(TagName=\"%s\")"), *String));
+		return Tag;
+	}
+
 	void DNATagTest_SimpleTest()
 	{
 		FName TagName = FName(TEXT("Stack.DiminishingReturns"));
@@ -236,6 +249,799 @@ public:
 		TestTrueExpr(!FilteredTagContainer.HasTagExact(EffectDamage1Tag));
 	}
 
+	void DNATagTest_BitContainerTest()
+	{
+		FDNATag EffectDamageTag = GetTagForString(TEXT("Effect.Damage"));
+		FDNATag EffectDamage1Tag = GetTagForString(TEXT("Effect.Damage.Type1"));
+		FDNATag EffectDamage2Tag = GetTagForString(TEXT("Effect.Damage.Type2"));
+		FDNATag CueTag = GetTagForString(TEXT("DNACue.Burning"));
+		FDNATag EmptyTag;
+
+		FDNATagContainer TagContainer;
+		TagContainer.AddTag(EffectDamage1Tag);
+		TagContainer.AddTag(CueTag);
+
+		FDNATagContainer TagContainer2;
+		TagContainer2.AddTag(EffectDamage2Tag);
+		TagContainer2.AddTag(CueTag);
+
+		FDNATagBitContainer EmptyBits;
+		FDNATagBitContainer TagBits(TagContainer);
+		FDNATagBitContainer TagBits2(TagContainer2);
+		FDNATagBitContainer ParentBits = FDNATagBitContainer(FDNATagContainer(EffectDamageTag));
+
+		TestTrueExpr(UDNATagsManager::Get().GetTagIndex(EffectDamage1Tag) != INDEX_NONE);
+		TestTrueExpr(UDNATagsManager::Get().GetTagIndex(EmptyTag) == INDEX_NONE);
+		TestTrueExpr(UDNATagsManager::Get().GetParentTagIndex(UDNATagsManager::Get().GetTagIndex(EffectDamage1Tag)) == UDNATagsManager::Get().GetTagIndex(EffectDamageTag));
+
+		// Must agree with the FDNATagContainer versions
+		TestTrueExpr(TagBits.HasTag(EffectDamageTag) == TagContainer.HasTag(EffectDamageTag));
+		TestTrueExpr(TagBits.HasTagExact(EffectDamageTag) == TagContainer.HasTagExact(EffectDamageTag));
+		TestTrueExpr(TagBits.HasTagExact(EffectDamage1Tag));
+		TestTrueExpr(!TagBits.HasTag(EmptyTag));
+
+		TestTrueExpr(TagBits.HasAny(TagBits2));
+		TestTrueExpr(TagBits.HasAnyExact(TagBits2));
+		TestTrueExpr(!TagBits.HasAll(TagBits2));
+		TestTrueExpr(!TagBits.HasAllExact(TagBits2));
+		TestTrueExpr(TagBits.HasAll(ParentBits));
+		TestTrueExpr(!TagBits.HasAllExact(ParentBits));
+		TestTrueExpr(!ParentBits.HasAny(TagBits));
+
+		TestTrueExpr(TagBits.HasAll(EmptyBits));
+		TestTrueExpr(!TagBits.HasAny(EmptyBits));
+		TestTrueExpr(!EmptyBits.HasAll(TagBits));
+		TestTrueExpr(EmptyBits.IsEmpty());
+
+		// Low level mutators, as used by reference counted containers
+		FDNATagBitContainer CountedBits;
+		CountedBits.SetExplicitTagIndex(UDNATagsManager::Get().GetTagIndex(EffectDamage1Tag), true);
+		CountedBits.SetImpliedTagIndex(UDNATagsManager::Get().GetTagIndex(EffectDamage1Tag), true);
+		CountedBits.SetImpliedTagIndex(UDNATagsManager::Get().GetTagIndex(EffectDamageTag), true);
+		TestTrueExpr(CountedBits.HasAll(ParentBits));
+		TestTrueExpr(!CountedBits.IsEmpty());
+
+		CountedBits.SetExplicitTagIndex(UDNATagsManager::Get().GetTagIndex(EffectDamage1Tag), false);
+		CountedBits.SetImpliedTagIndex(UDNATagsManager::Get().GetTagIndex(EffectDamageTag), false);
+		TestTrueExpr(!CountedBits.HasAll(ParentBits));
+		TestTrueExpr(CountedBits.IsEmpty());
+
+		// Cache rebuilds when the source container changes
+		FDNATagBitContainerCache BitCache;
+		TestTrueExpr(BitCache.Get(TagContainer).HasTagExact(CueTag));
+		TagContainer.RemoveTag(CueTag);
+		TestTrueExpr(!BitCache.Get(TagContainer).HasTagExact(CueTag));
+	}
+
+	void DNATagTest_ParentTableTest()
+	{
+		UDNATagsManager& Manager = UDNATagsManager::Get();
+
+		FDNATag EffectTag = GetTagForString(TEXT("Effect"));
+		FDNATag EffectDamageTag = GetTagForString(TEXT("Effect.Damage"));
+		FDNATag EffectDamage1Tag = GetTagForString(TEXT("Effect.Damage.Type1"));
+
+		const int32 EffectDamage1Index = Manager.GetTagIndex(EffectDamage1Tag);
+		TArrayView<const int32> TagAndParents = Manager.GetTagAndParentIndices(EffectDamage1Index);
+
+		// Self first, then parents up to the root
+		TestTrueExpr(TagAndParents.Num() == 3);
+		TestTrueExpr(TagAndParents[0] == EffectDamage1Index);
+		TestTrueExpr(TagAndParents[1] == Manager.GetTagIndex(EffectDamageTag));
+		TestTrueExpr(TagAndParents[2] == Manager.GetTagIndex(EffectTag));
+
+		FDNATagContainer ParentContainer = EffectDamage1Tag.GetDNATagParents();
+		TestTrueExpr(ParentContainer.Num() == 3);
+		TestTrueExpr(ParentContainer.HasTagExact(EffectDamage1Tag));
+		TestTrueExpr(ParentContainer.HasTagExact(EffectDamageTag));
+		TestTrueExpr(ParentContainer.HasTagExact(EffectTag));
+	}
+
+	void DNATagTest_TreeIntervalTest()
+	{
+		UDNATagsManager& Manager = UDNATagsManager::Get();
+
+		FDNATag EffectTag = GetTagForString(TEXT("Effect"));
+		FDNATag EffectDamageTag = GetTagForString(TEXT("Effect.Damage"));
+		FDNATag EffectDamage1Tag = GetTagForString(TEXT("Effect.Damage.Type1"));
+		FDNATag EffectShieldTag = GetTagForString(TEXT("Effect.Shield"));
+		FDNATag CueTag = GetTagForString(TEXT("DNACue.Burning"));
+
+		const int32 EffectIndex = Manager.GetTagIndex(EffectTag);
+		const int32 EffectDamageIndex = Manager.GetTagIndex(EffectDamageTag);
+		const int32 EffectDamage1Index = Manager.GetTagIndex(EffectDamage1Tag);
+		const int32 CueIndex = Manager.GetTagIndex(CueTag);
+
+		TestTrueExpr(Manager.MatchesTagIndex(EffectDamage1Index, EffectDamage1Index));
+		TestTrueExpr(Manager.MatchesTagIndex(EffectDamage1Index, EffectDamageIndex));
+		TestTrueExpr(Manager.MatchesTagIndex(EffectDamage1Index, EffectIndex));
+		TestTrueExpr(!Manager.MatchesTagIndex(EffectDamageIndex, EffectDamage1Index));
+		TestTrueExpr(!Manager.MatchesTagIndex(EffectDamage1Index, CueIndex));
+		TestTrueExpr(!Manager.MatchesTagIndex(EffectDamage1Index, INDEX_NONE));
+
+		TestTrueExpr(Manager.TagIndicesMatch(EffectDamageIndex, EDNATagMatchType::Explicit, EffectDamage1Index, EDNATagMatchType::IncludeParentTags));
+		TestTrueExpr(!Manager.TagIndicesMatch(EffectDamage1Index, EDNATagMatchType::Explicit, EffectDamageIndex, EDNATagMatchType::IncludeParentTags));
+		TestTrueExpr(Manager.TagIndicesMatch(EffectDamage1Index, EDNATagMatchType::IncludeParentTags, Manager.GetTagIndex(EffectShieldTag), EDNATagMatchType::IncludeParentTags));
+		TestTrueExpr(!Manager.TagIndicesMatch(EffectDamage1Index, EDNATagMatchType::IncludeParentTags, CueIndex, EDNATagMatchType::IncludeParentTags));
+
+		// Range queries over a container
+		FDNATagContainer TagContainer;
+		TagContainer.AddTag(EffectDamage1Tag);
+		TagContainer.AddTag(CueTag);
+
+		FDNATagTreePositions Positions;
+		Manager.GetSortedTagTreePositions(TagContainer, Positions);
+		TestTrueExpr(Positions.Num() == 2);
+		TestTrueExpr(Manager.HasTreePositionInSubtree(Positions, EffectIndex));
+		TestTrueExpr(Manager.HasTreePositionInSubtree(Positions, EffectDamageIndex));
+		TestTrueExpr(!Manager.HasTreePositionInSubtree(Positions, Manager.GetTagIndex(EffectShieldTag)));
+
+		// The match type APIs must give the same answers as expanding the containers
+		FDNATagContainer ParentContainer(EffectDamageTag);
+		FDNATagContainer ShieldContainer(EffectShieldTag);
+
+		PRAGMA_DISABLE_DEPRECATION_WARNINGS
+		TestTrueExpr(ParentContainer.HasTag(EffectDamage1Tag, EDNATagMatchType::Explicit, EDNATagMatchType::IncludeParentTags));
+		TestTrueExpr(!TagContainer.HasTag(EffectDamageTag, EDNATagMatchType::Explicit, EDNATagMatchType::IncludeParentTags));
+		TestTrueExpr(TagContainer.HasTag(EffectShieldTag, EDNATagMatchType::IncludeParentTags, EDNATagMatchType::IncludeParentTags));
+		PRAGMA_ENABLE_DEPRECATION_WARNINGS
+
+		TestTrueExpr(ParentContainer.DoesTagContainerMatch(TagContainer, EDNATagMatchType::Explicit, EDNATagMatchType::IncludeParentTags, EDNAContainerMatchType::Any));
+		TestTrueExpr(!ShieldContainer.DoesTagContainerMatch(TagContainer, EDNATagMatchType::Explicit, EDNATagMatchType::IncludeParentTags, EDNAContainerMatchType::Any));
+		TestTrueExpr(ShieldContainer.DoesTagContainerMatch(TagContainer, EDNATagMatchType::IncludeParentTags, EDNATagMatchType::IncludeParentTags, EDNAContainerMatchType::Any));
+		TestTrueExpr(!ParentContainer.DoesTagContainerMatch(TagContainer, EDNATagMatchType::IncludeParentTags, EDNATagMatchType::IncludeParentTags, EDNAContainerMatchType::All));
+		TestTrueExpr(!ParentContainer.DoesTagContainerMatch(FDNATagContainer(), EDNATagMatchType::Explicit, EDNATagMatchType::IncludeParentTags, EDNAContainerMatchType::Any));
+	}
+
+	void DNATagTest_QueryTest()
+	{
+		FDNATag EffectDamageTag = GetTagForString(TEXT("Effect.Damage"));
+		FDNATag EffectDamage1Tag = GetTagForString(TEXT("Effect.Damage.Type1"));
+		FDNATag EffectDamage2Tag = GetTagForString(TEXT("Effect.Damage.Type2"));
+		FDNATag EffectShieldTag = GetTagForString(TEXT("Effect.Shield"));
+		FDNATag CueTag = GetTagForString(TEXT("DNACue.Burning"));
+
+		FDNATagContainer TagContainer;
+		TagContainer.AddTag(EffectDamage1Tag);
+		TagContainer.AddTag(CueTag);
+		FDNATagBitContainer TagBits(TagContainer);
+
+		// ALL( ANY( ALL(Effect.Damage, DNACue.Burning), ALL(Effect.Shield) ), NONE(Effect.Damage.Type2) )
+		FDNATagQueryExpression DamageAndCue;
+		DamageAndCue.AllTagsMatch().AddTag(EffectDamageTag).AddTag(CueTag);
+		FDNATagQueryExpression Shield;
+		Shield.AllTagsMatch().AddTag(EffectShieldTag);
+		FDNATagQueryExpression AnyExpr;
+		AnyExpr.AnyExprMatch().AddExpr(DamageAndCue).AddExpr(Shield);
+		FDNATagQueryExpression NoType2;
+		NoType2.NoTagsMatch().AddTag(EffectDamage2Tag);
+		FDNATagQueryExpression RootExpr;
+		RootExpr.AllExprMatch().AddExpr(AnyExpr).AddExpr(NoType2);
+
+		FDNATagQuery Query = FDNATagQuery::BuildQuery(RootExpr);
+		TestTrueExpr(Query.Matches(TagContainer));
+		TestTrueExpr(Query.Matches(TagBits));
+
+		TagContainer.AddTag(EffectDamage2Tag);
+		TagBits.AddTag(EffectDamage2Tag);
+		TestTrueExpr(!Query.Matches(TagContainer));
+		TestTrueExpr(!Query.Matches(TagBits));
+
+		FDNATagQuery AnyQuery = FDNATagQuery::MakeQuery_MatchAnyTags(FDNATagContainer(EffectShieldTag));
+		TestTrueExpr(!AnyQuery.Matches(TagContainer));
+		TestTrueExpr(!AnyQuery.Matches(TagBits));
+
+		// Replacing the tags must rebuild the compiled masks
+		AnyQuery.ReplaceTagFast(EffectDamageTag);
+		TestTrueExpr(AnyQuery.Matches(TagContainer));
+		TestTrueExpr(AnyQuery.Matches(TagBits));
+
+		// Copies carry the compiled program
+		FDNATagQuery CopiedQuery = AnyQuery;
+		TestTrueExpr(CopiedQuery.Matches(TagBits));
+
+		FDNATagQuery AllQuery = FDNATagQuery::MakeQuery_MatchAllTags(TagContainer);
+		TestTrueExpr(AllQuery.Matches(TagContainer));
+		TestTrueExpr(AllQuery.Matches(TagBits));
+		TestTrueExpr(!AllQuery.Matches(FDNATagBitContainer()));
+
+		FDNATagQuery NoQuery = FDNATagQuery::MakeQuery_MatchNoTags(FDNATagContainer(EffectShieldTag));
+		TestTrueExpr(NoQuery.Matches(TagContainer));
+		TestTrueExpr(NoQuery.Matches(TagBits));
+
+		// Batches must agree with matching one container at a time
+		FDNATagContainer ShieldContainer(EffectShieldTag);
+		FDNATagBitContainer ShieldBits(ShieldContainer);
+		FDNATagContainer EmptyContainer;
+		FDNATagBitContainer EmptyBits;
+
+		TArray<const FDNATagContainer*> Containers;
+		TArray<const FDNATagBitContainer*> BitContainers;
+		for (int32 Idx = 0; Idx < 70; ++Idx)
+		{
+			Containers.Add(Idx % 3 == 0 ? &TagContainer : (Idx % 3 == 1 ? &ShieldContainer : &EmptyContainer));
+			BitContainers.Add(Idx % 3 == 0 ? &TagBits : (Idx % 3 == 1 ? &ShieldBits : &EmptyBits));
+		}
+		Containers.Add(nullptr);
+		BitContainers.Add(nullptr);
+
+		const FDNATagQuery* BatchQueries[] = { &Query, &AnyQuery, &AllQuery, &NoQuery };
+		for (const FDNATagQuery* BatchQuery : BatchQueries)
+		{
+			TBitArray<> Results;
+			TBitArray<> BitResults;
+			BatchQuery->MatchesBatch(Containers, Results);
+			BatchQuery->MatchesBatch(BitContainers, BitResults);
+
+			TestTrueExpr(Results.Num() == Containers.Num());
+			TestTrueExpr(BitResults.Num() == BitContainers.Num());
+			for (int32 Idx = 0; Idx < Containers.Num() - 1; ++Idx)
+			{
+				TestTrueExpr(Results[Idx] == BatchQuery->Matches(*Containers[Idx]));
+				TestTrueExpr(BitResults[Idx] == BatchQuery->Matches(*BitContainers[Idx]));
+			}
+			TestTrueExpr(!Results[Containers.Num() - 1]);
+			TestTrueExpr(!BitResults[BitContainers.Num() - 1]);
+		}
+	}
+
+	void DNATagTest_SnapshotTest()
+	{
+		UDNATagsManager& Manager = UDNATagsManager::Get();
+
+		FDNATag EffectTag = GetTagForString(TEXT("Effect"));
+		FDNATag EffectDamageTag = GetTagForString(TEXT("Effect.Damage"));
+		FDNATag EffectDamage1Tag = GetTagForString(TEXT("Effect.Damage.Type1"));
+		FDNATag CueTag = GetTagForString(TEXT("DNACue.Burning"));
+
+		// The test tags were added after native tags were done, so publish them
+		Manager.PublishDictionarySnapshot();
+		const FDNATagDictionarySnapshot* Snapshot = Manager.GetDictionarySnapshot();
+		TestTrueExpr(Snapshot != nullptr);
+		TestTrueExpr(Snapshot->GetDictionarySerial() == Manager.GetDictionarySerial());
+
+		// Must agree with the manager
+		TestTrueExpr(Snapshot->RequestDNATag(FName(TEXT("Effect.Damage.Type1"))) == EffectDamage1Tag);
+		TestTrueExpr(!Snapshot->RequestDNATag(FName(TEXT("Effect.Damage.NotATag"))).IsValid());
+		TestTrueExpr(Snapshot->RequestDNATagParents(EffectDamage1Tag) == Manager.RequestDNATagParents(EffectDamage1Tag));
+		TestTrueExpr(Snapshot->RequestDNATagChildren(EffectDamageTag) == Manager.RequestDNATagChildren(EffectDamageTag));
+		TestTrueExpr(Snapshot->RequestDNATagChildren(EffectDamage1Tag).IsEmpty());
+		TestTrueExpr(Snapshot->MatchesTag(EffectDamage1Tag, EffectTag));
+		TestTrueExpr(!Snapshot->MatchesTag(EffectTag, EffectDamage1Tag));
+		TestTrueExpr(!Snapshot->MatchesTag(EffectDamage1Tag, CueTag));
+
+		// Hammer the read path from worker threads while the game thread publishes new snapshots
+		const int32 NumTasks = 16;
+		const int32 NumIterations = 2000;
+		const int32 NumPublishes = 32;
+		FThreadSafeCounter NumFailures;
+
+		FGraphEventArray ReaderTasks;
+		for (int32 TaskIndex = 0; TaskIndex < NumTasks; ++TaskIndex)
+		{
+			ReaderTasks.Add(FFunctionGraphTask::CreateAndDispatchWhenReady([&]()
+			{
+				for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+				{
+					TSharedPtr<const FDNATagDictionarySnapshot, ESPMode::ThreadSafe> ThreadSnapshot = Manager.AcquireDictionarySnapshot();
+
+					FDNATag Tag = ThreadSnapshot->RequestDNATag(FName(TEXT("Effect.Damage.Type1")));
+					if (Tag != EffectDamage1Tag || !ThreadSnapshot->MatchesTag(Tag, EffectDamageTag) || ThreadSnapshot->MatchesTag(Tag, CueTag))
+					{
+						NumFailures.Increment();
+					}
+
+					if (ThreadSnapshot->RequestDNATagParents(Tag).Num() != 3 || !ThreadSnapshot->RequestDNATagChildren(EffectTag).HasTagExact(Tag))
+					{
+						NumFailures.Increment();
+					}
+				}
+			}, TStatId(), nullptr, ENamedThreads::AnyThread));
+		}
+
+		for (int32 Iteration = 0; Iteration < NumPublishes; ++Iteration)
+		{
+			Manager.PublishDictionarySnapshot();
+		}
+
+		FTaskGraphInterface::Get().WaitUntilTasksComplete(ReaderTasks, ENamedThreads::GameThread);
+
+		// Once the readers let go, only the retained snapshots are left
+		Manager.PublishDictionarySnapshot();
+		TestTrueExpr(Manager.GetNumDictionarySnapshots() <= 4);
+		TestTrueExpr(NumFailures.GetValue() == 0);
+	}
+
+	void DNATagTest_NameTableTest()
+	{
+		UDNATagsManager& Manager = UDNATagsManager::Get();
+
+		FDNATag EffectTag = GetTagForString(TEXT("Effect"));
+		FDNATag EffectDamageTag = GetTagForString(TEXT("Effect.Damage"));
+		FDNATag EffectDamage1Tag = GetTagForString(TEXT("Effect.Damage.Type1"));
+
+		Manager.PublishDictionarySnapshot();
+		const FDNATagDictionarySnapshot* Snapshot = Manager.GetDictionarySnapshot();
+
+		const FDNATagNameRecord* Record = Snapshot->FindTagRecord(EffectDamage1Tag.GetTagName());
+		TestTrueExpr(Record != nullptr);
+		TestTrueExpr(Record->TagName == EffectDamage1Tag.GetTagName());
+		TestTrueExpr(Record->TagIndex == Manager.GetTagIndex(EffectDamage1Tag));
+		TestTrueExpr(Record->ParentTagIndex == Manager.GetTagIndex(EffectDamageTag));
+		TestTrueExpr(Record->Depth == 2);
+		TestTrueExpr(Record->NetIndex == Manager.GetNetIndexFromTag(EffectDamage1Tag));
+
+		const FDNATagNameRecord* RootRecord = Snapshot->FindTagRecord(EffectTag.GetTagName());
+		TestTrueExpr(RootRecord != nullptr);
+		TestTrueExpr(RootRecord->ParentTagIndex == INDEX_NONE);
+		TestTrueExpr(RootRecord->Depth == 0);
+
+		// Misses, including names that differ only by number
+		TestTrueExpr(Snapshot->FindTagRecord(FName(TEXT("Effect.Damage.NotATag"))) == nullptr);
+		TestTrueExpr(Snapshot->FindTagRecord(FName(EffectDamage1Tag.GetTagName(), 3)) == nullptr);
+		TestTrueExpr(Snapshot->FindTagRecord(NAME_None) == nullptr);
+
+		// The manager goes through the table while the snapshot is current, and must give the same answers
+		TestTrueExpr(Manager.RequestDNATag(FName(TEXT("Effect.Damage.Type1"))) == EffectDamage1Tag);
+		TestTrueExpr(!Manager.RequestDNATag(FName(TEXT("Effect.Damage.NotATag")), false).IsValid());
+
+		// Tags that are not redirected load as themselves, with one lookup
+		const FDNATagNameRecord* LoadRecord = Snapshot->FindLoadRecord(EffectDamage1Tag.GetTagName());
+		TestTrueExpr(LoadRecord == Record);
+		TestTrueExpr(LoadRecord->LoadTagIndex == LoadRecord->TagIndex);
+		TestTrueExpr(Snapshot->FindLoadRecord(FName(TEXT("Effect.Damage.NotATag"))) == nullptr);
+
+		const UDNATagsManager::FTagLoadCounts CountsBefore = Manager.GetTagLoadCounts();
+		FDNATag LoadedTag = EffectDamage1Tag;
+		Manager.RedirectSingleDNATag(LoadedTag, nullptr);
+		FDNATagContainer LoadedContainer;
+		LoadedContainer.AddTag(EffectDamageTag);
+		LoadedContainer.AddTag(EffectDamage1Tag);
+		Manager.RedirectTagsForContainer(LoadedContainer, nullptr);
+		const UDNATagsManager::FTagLoadCounts CountsAfter = Manager.GetTagLoadCounts();
+
+		TestTrueExpr(LoadedTag == EffectDamage1Tag);
+		TestTrueExpr(LoadedContainer.Num() == 2);
+		TestTrueExpr(CountsAfter.NumLoadedTags - CountsBefore.NumLoadedTags == 3);
+		TestTrueExpr(CountsAfter.NumRedirectedTags == CountsBefore.NumRedirectedTags);
+	}
+
+	void DNATagTest_RedirectTest()
+	{
+		UDNATagsManager& Manager = UDNATagsManager::Get();
+		UDNATagsSettings* Settings = GetMutableDefault<UDNATagsSettings>();
+		const TArray<FDNATagRedirect> OldRedirects = Settings->DNATagRedirects;
+
+		FDNATag EffectDamageTag = GetTagForString(TEXT("Effect.Damage"));
+		FDNATag EffectDamage1Tag = GetTagForString(TEXT("Effect.Damage.Type1"));
+		FDNATag EffectDamage2Tag = GetTagForString(TEXT("Effect.Damage.Type2"));
+
+		// Renamed goes straight to Type1, Ancient goes through Renamed, Orphaned points at a tag that was never added
+		auto AddRedirect = [Settings](const TCHAR* OldTagName, const TCHAR* NewTagName)
+		{
+			FDNATagRedirect Redirect;
+			Redirect.OldTagName = FName(OldTagName);
+			Redirect.NewTagName = FName(NewTagName);
+			Settings->DNATagRedirects.Add(Redirect);
+		};
+		AddRedirect(TEXT("Effect.Damage.Renamed"), TEXT("Effect.Damage.Type1"));
+		AddRedirect(TEXT("Effect.Damage.Ancient"), TEXT("Effect.Damage.Renamed"));
+		AddRedirect(TEXT("Effect.Damage.Orphaned"), TEXT("Effect.Damage.NotATag"));
+		Manager.ConstructTagRedirects();
+		Manager.PublishDictionarySnapshot();
+
+		const FDNATagDictionarySnapshot* Snapshot = Manager.GetDictionarySnapshot();
+		const FDNATagNameRecord* RenamedRecord = Snapshot->FindLoadRecord(FName(TEXT("Effect.Damage.Renamed")));
+		TestTrueExpr(RenamedRecord != nullptr);
+		TestTrueExpr(RenamedRecord->TagIndex == INDEX_NONE);
+		TestTrueExpr(RenamedRecord->LoadTagIndex == Manager.GetTagIndex(EffectDamage1Tag));
+		TestTrueExpr(Snapshot->FindTagRecord(FName(TEXT("Effect.Damage.Renamed"))) == nullptr);
+		TestTrueExpr(Snapshot->FindLoadRecord(FName(TEXT("Effect.Damage.Orphaned"))) == nullptr);
+
+		const UDNATagsManager::FTagLoadCounts CountsBefore = Manager.GetTagLoadCounts();
+
+		FDNATag RenamedTag = GetUncheckedTagForString(TEXT("Effect.Damage.Renamed"));
+		Manager.RedirectSingleDNATag(RenamedTag, nullptr);
+		TestTrueExpr(RenamedTag == EffectDamage1Tag);
+
+		FDNATag AncientTag = GetUncheckedTagForString(TEXT("Effect.Damage.Ancient"));
+		Manager.RedirectSingleDNATag(AncientTag, nullptr);
+		TestTrueExpr(AncientTag == EffectDamage1Tag);
+
+		// A redirect without a valid target is dropped when it is constructed, the old name loads as it was saved
+		FDNATag OrphanedTag = GetUncheckedTagForString(TEXT("Effect.Damage.Orphaned"));
+		Manager.RedirectSingleDNATag(OrphanedTag, nullptr);
+		TestTrueExpr(OrphanedTag.GetTagName() == FName(TEXT("Effect.Damage.Orphaned")));
+
+		const UDNATagsManager::FTagLoadCounts CountsAfterSingle = Manager.GetTagLoadCounts();
+		TestTrueExpr(CountsAfterSingle.NumLoadedTags - CountsBefore.NumLoadedTags == 3);
+		TestTrueExpr(CountsAfterSingle.NumRedirectedTags - CountsBefore.NumRedirectedTags == 2);
+
+		FDNATagContainer LoadedContainer;
+		LoadedContainer.AddTag(GetUncheckedTagForString(TEXT("Effect.Damage.Ancient")));
+		LoadedContainer.AddTag(EffectDamage2Tag);
+		LoadedContainer.AddTag(GetUncheckedTagForString(TEXT("Effect.Damage.Orphaned")));
+		Manager.RedirectTagsForContainer(LoadedContainer, nullptr);
+
+		TestTrueExpr(LoadedContainer.Num() == 3);
+		TestTrueExpr(LoadedContainer.HasTagExact(EffectDamage1Tag));
+		TestTrueExpr(LoadedContainer.HasTagExact(EffectDamage2Tag));
+		TestTrueExpr(LoadedContainer.HasTag(EffectDamageTag));
+		TestTrueExpr(!LoadedContainer.HasTagExact(GetUncheckedTagForString(TEXT("Effect.Damage.Ancient"))));
+
+		const UDNATagsManager::FTagLoadCounts CountsAfterContainer = Manager.GetTagLoadCounts();
+		TestTrueExpr(CountsAfterContainer.NumLoadedTags - CountsAfterSingle.NumLoadedTags == 3);
+		TestTrueExpr(CountsAfterContainer.NumRedirectedTags - CountsAfterSingle.NumRedirectedTags == 1);
+
+		Settings->DNATagRedirects = OldRedirects;
+		Manager.ConstructTagRedirects();
+		Manager.PublishDictionarySnapshot();
+
+		FDNATag RestoredTag = GetUncheckedTagForString(TEXT("Effect.Damage.Renamed"));
+		Manager.RedirectSingleDNATag(RestoredTag, nullptr);
+		TestTrueExpr(RestoredTag.GetTagName() == FName(TEXT("Effect.Damage.Renamed")));
+	}
+
+#if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
+	void DNATagTest_NetIndexLayoutTest()
+	{
+		UDNATagsManager& Manager = UDNATagsManager::Get();
+
+		FDNATag EffectDamage1Tag = GetTagForString(TEXT("Effect.Damage.Type1"));
+		FDNATag EffectDamage2Tag = GetTagForString(TEXT("Effect.Damage.Type2"));
+		FDNATag CueTag = GetTagForString(TEXT("DNACue.Burning"));
+
+		// Matches SerializeTagNetIndexPacked
+		TestTrueExpr(UDNATagsManager::GetPackedNetIndexBits(3, 0, 10) == 10);
+		TestTrueExpr(UDNATagsManager::GetPackedNetIndexBits(3, 2, 10) == 3);
+		TestTrueExpr(UDNATagsManager::GetPackedNetIndexBits(4, 2, 10) == 11);
+		TestTrueExpr(UDNATagsManager::GetPackedNetIndexBits(3, 4, 10) == 5);
+		TestTrueExpr(UDNATagsManager::GetPackedNetIndexBits(3, 10, 10) == 10);
+
+		TMap<FDNATag, int32> ReplicationCounts;
+		ReplicationCounts.Add(EffectDamage1Tag, 10);
+		ReplicationCounts.Add(CueTag, 1000);
+		ReplicationCounts.Add(EffectDamage2Tag, 100);
+		ReplicationCounts.Add(GetUncheckedTagForString(TEXT("Effect.Damage.NotATag")), 50000);
+
+		FDNATagNetIndexLayout Layout = Manager.ComputeNetIndexLayout(ReplicationCounts);
+
+		// Tags that aren't in the dictionary can't be replicated by index and are ignored
+		TestTrueExpr(Layout.NumReplicatedTags == 1110);
+		TestTrueExpr(Layout.NetIndexFirstBitSegment == 1);
+		TestTrueExpr(Layout.CommonlyReplicatedTags.Num() == 2);
+		TestTrueExpr(Layout.CommonlyReplicatedTags[0] == CueTag);
+		TestTrueExpr(Layout.CommonlyReplicatedTags[1] == EffectDamage2Tag);
+
+		// Cue and Damage2 fit in a 1 bit first segment, Damage1 pays for the whole index plus the more bit
+		const int32 MaxBits = Layout.NetIndexTrueBitNum;
+		const float ExpectedBits = (float)(1100 * 2 + 10 * (MaxBits + 1)) / 1110.f;
+		TestTrueExpr(FMath::IsNearlyEqual(Layout.LayoutBitsPerTag, ExpectedBits, KINDA_SMALL_NUMBER));
+		TestTrueExpr(Layout.LayoutBitsPerTag < Layout.UnsplitBitsPerTag);
+
+		TestTrueExpr(Manager.ComputeNetIndexLayout(TMap<FDNATag, int32>()).NumReplicatedTags == 0);
+
+		// Round trip one tag that fits in the first segment and one that needs the continuation
+		const bool bOldUseFastReplication = Manager.bUseFastReplication;
+		const int32 OldNetIndexFirstBitSegment = Manager.NetIndexFirstBitSegment;
+		Manager.bUseFastReplication = true;
+		Manager.ConstructNetIndex();
+		Manager.NetIndexFirstBitSegment = 2;
+
+		const TArray<TSharedPtr<FDNATagNode>>& NetworkNodes = Manager.GetNetworkDNATagNodeIndex();
+		TestTrueExpr(NetworkNodes.Num() > 4);
+
+		TArray<FDNATag> RoundTripTags;
+		RoundTripTags.Add(NetworkNodes[0]->GetCompleteTag());
+		RoundTripTags.Add(NetworkNodes.Last()->GetCompleteTag());
+
+		for (const FDNATag& Tag : RoundTripTags)
+		{
+			const FDNATagNetIndex NetIndex = Manager.GetNetIndexFromTag(Tag);
+
+			FBitWriter Writer(0, true);
+			bool bOutSuccess = false;
+			FDNATag SavedTag = Tag;
+			SavedTag.NetSerialize(Writer, nullptr, bOutSuccess);
+			TestTrueExpr(bOutSuccess);
+			TestTrueExpr(Writer.GetNumBits() == UDNATagsManager::GetPackedNetIndexBits(NetIndex, Manager.NetIndexFirstBitSegment, Manager.NetIndexTrueBitNum));
+
+			FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+			FDNATag LoadedTag;
+			LoadedTag.NetSerialize(Reader, nullptr, bOutSuccess);
+			TestTrueExpr(bOutSuccess);
+			TestTrueExpr(LoadedTag == Tag);
+			TestTrueExpr(Reader.AtEnd());
+		}
+
+		// The last net index is past the 2 bit first segment, so it was written with the more bit and the full index
+		TestTrueExpr(Manager.GetNetIndexFromTag(RoundTripTags[1]) >= (1 << Manager.NetIndexFirstBitSegment));
+
+		Manager.bUseFastReplication = bOldUseFastReplication;
+		Manager.NetIndexFirstBitSegment = OldNetIndexFirstBitSegment;
+		Manager.ConstructNetIndex();
+	}
+#endif
+
+	void DNATagTest_NetDeltaTest()
+	{
+		UDNATagsManager& Manager = UDNATagsManager::Get();
+
+		// Replicate by index, like a shipping game would
+		const bool bOldUseFastReplication = Manager.bUseFastReplication;
+		const int32 OldNetIndexFirstBitSegment = Manager.NetIndexFirstBitSegment;
+		Manager.bUseFastReplication = true;
+		Manager.ConstructNetIndex();
+
+		TArray<FDNATag> StatusTags;
+		for (int32 TagIdx = 1; TagIdx <= 20; TagIdx++)
+		{
+			StatusTags.Add(GetTagForString(FString::Printf(TEXT("Expensive.Status.Tag.Type.%d"), TagIdx)));
+		}
+
+		const int32 CountBits = 6;
+		const int32 NumSteps = 200;
+
+		TArray<FDNATag> SenderTags;
+		TArray<FDNATag> ReceiverTags;
+		TSharedPtr<INetDeltaBaseState> AckedState;
+		int64 FullBits = 0;
+		int64 DeltaBits = 0;
+		bool bReceiverMatches = true;
+
+		for (int32 Step = 0; Step < NumSteps; ++Step)
+		{
+			// Toggle one tag per step, the common case for gameplay state
+			const FDNATag& ToggledTag = StatusTags[(Step * 7) % StatusTags.Num()];
+			if (SenderTags.Remove(ToggledTag) == 0)
+			{
+				SenderTags.Add(ToggledTag);
+			}
+
+			FDNATagContainer Container;
+			for (const FDNATag& Tag : SenderTags)
+			{
+				Container.AddTag(Tag);
+			}
+
+			FBitWriter FullWriter(0, true);
+			bool bOutSuccess = true;
+			Container.NetSerialize(FullWriter, nullptr, bOutSuccess);
+			FullBits += FullWriter.GetNumBits();
+
+			FBitWriter DeltaWriter(0, true);
+			TSharedPtr<INetDeltaBaseState> NewState;
+			FNetDeltaSerializeInfo WriteParms;
+			WriteParms.Writer = &DeltaWriter;
+			WriteParms.OldState = AckedState.Get();
+			WriteParms.NewState = &NewState;
+			if (!FDNATagNetDelta::Write(WriteParms, SenderTags, Step, CountBits, true))
+			{
+				continue;
+			}
+			DeltaBits += DeltaWriter.GetNumBits();
+
+			// Every fifth packet is lost, so the base state stays at the last acknowledged one and the next delta resends its changes
+			if (Step % 5 == 4)
+			{
+				continue;
+			}
+			AckedState = NewState;
+
+			FBitReader Reader(DeltaWriter.GetData(), DeltaWriter.GetNumBits());
+			FNetDeltaSerializeInfo ReadParms;
+			ReadParms.Reader = &Reader;
+
+			bool bFullState = false;
+			TArray<FDNATag> AddedTags;
+			TArray<FDNATag> RemovedTags;
+			bReceiverMatches &= FDNATagNetDelta::Read(ReadParms, CountBits, bFullState, AddedTags, RemovedTags);
+
+			if (bFullState)
+			{
+				ReceiverTags.Reset();
+			}
+			for (const FDNATag& Tag : RemovedTags)
+			{
+				ReceiverTags.Remove(Tag);
+			}
+			for (const FDNATag& Tag : AddedTags)
+			{
+				ReceiverTags.AddUnique(Tag);
+			}
+
+			bReceiverMatches &= ReceiverTags.Num() == SenderTags.Num();
+			for (const FDNATag& Tag : SenderTags)
+			{
+				bReceiverMatches &= ReceiverTags.Contains(Tag);
+			}
+		}
+
+		UE_LOG(LogDNATags, Display, TEXT("%d container updates: %lld bits full, %lld bits delta"), NumSteps, FullBits, DeltaBits);
+
+		TestTrueExpr(bReceiverMatches);
+		TestTrueExpr(DeltaBits < FullBits);
+
+		// Tags that changed and changed back write nothing, and the acknowledged state takes on the new ID so the next write skips the diff
+		FDNATagNetDeltaState* AckedTagState = static_cast<FDNATagNetDeltaState*>(AckedState.Get());
+		TArray<FDNATag> AckedTags;
+		for (int32 TagIndex : AckedTagState->TagIndices)
+		{
+			AckedTags.Add(Manager.GetTagFromIndex(TagIndex));
+		}
+
+		FBitWriter UnchangedWriter(0, true);
+		TSharedPtr<INetDeltaBaseState> UnchangedState;
+		FNetDeltaSerializeInfo UnchangedParms;
+		UnchangedParms.Writer = &UnchangedWriter;
+		UnchangedParms.OldState = AckedTagState;
+		UnchangedParms.NewState = &UnchangedState;
+		TestTrueExpr(!FDNATagNetDelta::Write(UnchangedParms, AckedTags, NumSteps, CountBits, true));
+		TestTrueExpr(UnchangedWriter.GetNumBits() == 0);
+		TestTrueExpr(AckedTagState->StateID == NumSteps);
+
+		Manager.bUseFastReplication = bOldUseFastReplication;
+		Manager.NetIndexFirstBitSegment = OldNetIndexFirstBitSegment;
+	}
+
+	void DNATagTest_SearchIndexTest()
+	{
+		TArray<FString> Strings;
+		Strings.Add(TEXT("Effect.Damage.Basic"));
+		Strings.Add(TEXT("Effect.Damage.Fire"));
+		Strings.Add(TEXT("Stackable"));
+		Strings.Add(FString());
+		Strings.Add(TEXT("DAMAGEdamage"));
+
+		FDNATagSearchIndex SearchIndex;
+		SearchIndex.Build(Strings);
+		TestTrueExpr(SearchIndex.Num() == Strings.Num());
+
+		TArray<int32> Entries;
+		SearchIndex.Search(TEXT("damage"), Entries);
+		TestTrueExpr(Entries.Num() == 3 && Entries[0] == 0 && Entries[1] == 1 && Entries[2] == 4);
+
+		SearchIndex.Search(TEXT("AGE.f"), Entries);
+		TestTrueExpr(Entries.Num() == 1 && Entries[0] == 1);
+
+		// Shorter than a trigram
+		SearchIndex.Search(TEXT("ck"), Entries);
+		TestTrueExpr(Entries.Num() == 1 && Entries[0] == 2);
+
+		// Every trigram is indexed but the string is not there
+		SearchIndex.Search(TEXT("Damage.Basic.Fire"), Entries);
+		TestTrueExpr(Entries.Num() == 0);
+
+		SearchIndex.Search(FString(), Entries);
+		TestTrueExpr(Entries.Num() == 0);
+
+#if WITH_EDITOR
+		// The manager finds the same tags as checking every tag name
+		UDNATagsManager& Manager = UDNATagsManager::Get();
+		const FString SearchString(TEXT("status.tag.type.1"));
+
+		FDNATagContainer AllTags;
+		Manager.RequestAllDNATags(AllTags, false);
+
+		FDNATagContainer ExpectedTags;
+		for (const FDNATag& Tag : AllTags)
+		{
+			if (Tag.ToString().Contains(SearchString))
+			{
+				ExpectedTags.AddTag(Tag);
+			}
+		}
+
+		FDNATagTreePositions ExpectedPositions;
+		Manager.GetSortedTagTreePositions(ExpectedTags, ExpectedPositions);
+
+		FDNATagTreePositions Positions;
+		Manager.SearchDNATags(SearchString, false, Positions);
+		TestTrueExpr(Positions.Num() >= 11);
+		TestTrueExpr(Positions == ExpectedPositions);
+
+		// What the tag picker asks for each row
+		TestTrueExpr(Manager.HasTreePositionInSubtree(Positions, Manager.GetTagIndex(GetTagForString(TEXT("Expensive.Status")))));
+		TestTrueExpr(!Manager.HasTreePositionInSubtree(Positions, Manager.GetTagIndex(GetTagForString(TEXT("Effect.Damage")))));
+#endif
+	}
+
+#if WITH_EDITOR
+	/** Describes every tag in the tree by its parents, children, net index and whether it was explicitly added */
+	void CaptureTagTree(TMap<FName, FString>& OutTree)
+	{
+		UDNATagsManager& Manager = UDNATagsManager::Get();
+
+		FDNATagContainer AllTags;
+		Manager.RequestAllDNATags(AllTags, false);
+		for (const FDNATag& Tag : AllTags)
+		{
+			OutTree.Add(Tag.GetTagName(), FString::Printf(TEXT("Parents: %s Children: %s NetIndex: %d Explicit: %d"),
+				*Manager.RequestDNATagParents(Tag).ToStringSimple(), *Manager.RequestDNATagChildren(Tag).ToStringSimple(),
+				(int32)Manager.GetNetIndexFromTag(Tag), Manager.IsDictionaryTag(Tag.GetTagName()) ? 1 : 0));
+		}
+	}
+
+	void DNATagTest_IncrementalRefreshTest(UDataTable* TestTagTable)
+	{
+		UDNATagsManager& Manager = UDNATagsManager::Get();
+		UDNATagsSettings* Settings = GetMutableDefault<UDNATagsSettings>();
+		const bool bOldImportTagsFromConfig = Settings->ImportTagsFromConfig;
+		const TArray<FDNATagTableRow> OldTagList = Settings->DNATagList;
+		const bool bOldUseFastReplication = Manager.bUseFastReplication;
+
+		FDNATagTreeChangeSet LastChangeSet;
+		FDelegateHandle ChangeSetHandle = IDNATagsModule::OnDNATagTreeChangeSet.AddLambda([&LastChangeSet](const FDNATagTreeChangeSet& ChangeSet)
+		{
+			LastChangeSet = ChangeSet;
+		});
+
+		// The refresh only sees tag sources, so the test tags go in the settings tag list
+		Settings->ImportTagsFromConfig = true;
+		Manager.bUseFastReplication = true;
+		Settings->DNATagList.Add(FDNATagTableRow(FName(TEXT("RefreshTest.Kept.Child"))));
+		Settings->DNATagList.Add(FDNATagTableRow(FName(TEXT("RefreshTest.Removed.Child"))));
+		Settings->DNATagList.Add(FDNATagTableRow(FName(TEXT("RefreshTest.OldName"))));
+		Manager.EditorRefreshDNATagTree();
+
+		const FDNATag RemovedChildTag = Manager.RequestDNATag(FName(TEXT("RefreshTest.Removed.Child")), false);
+		TestTrueExpr(RemovedChildTag.IsValid());
+		const int32 RemovedChildIndex = Manager.GetTagIndex(RemovedChildTag);
+		const int32 NumTagIndices = Manager.GetNumTagIndices();
+
+		// Remove a branch, rename a leaf and add a branch
+		Settings->DNATagList.RemoveAll([](const FDNATagTableRow& Row)
+		{
+			return Row.Tag == FName(TEXT("RefreshTest.Removed.Child")) || Row.Tag == FName(TEXT("RefreshTest.OldName"));
+		});
+		Settings->DNATagList.Add(FDNATagTableRow(FName(TEXT("RefreshTest.NewName"))));
+		Settings->DNATagList.Add(FDNATagTableRow(FName(TEXT("RefreshTest.Added.Child"))));
+		LastChangeSet = FDNATagTreeChangeSet();
+		Manager.EditorRefreshDNATagTree();
+
+		const FDNATag AddedTag = Manager.RequestDNATag(FName(TEXT("RefreshTest.Added")), false);
+		const FDNATag AddedChildTag = Manager.RequestDNATag(FName(TEXT("RefreshTest.Added.Child")), false);
+		const FDNATag NewNameTag = Manager.RequestDNATag(FName(TEXT("RefreshTest.NewName")), false);
+		TestTrueExpr(AddedTag.IsValid() && AddedChildTag.IsValid() && NewNameTag.IsValid());
+		TestTrueExpr(!Manager.RequestDNATag(FName(TEXT("RefreshTest.Removed")), false).IsValid());
+		TestTrueExpr(!Manager.RequestDNATag(FName(TEXT("RefreshTest.Removed.Child")), false).IsValid());
+		TestTrueExpr(!Manager.RequestDNATag(FName(TEXT("RefreshTest.OldName")), false).IsValid());
+		TestTrueExpr(Manager.RequestDNATag(FName(TEXT("RefreshTest.Kept.Child")), false).IsValid());
+
+		TestTrueExpr(LastChangeSet.AddedTags.Num() == 3);
+		TestTrueExpr(LastChangeSet.AddedTags.Contains(NewNameTag));
+		TestTrueExpr(LastChangeSet.AddedTags.IndexOfByKey(AddedTag) != INDEX_NONE && LastChangeSet.AddedTags.IndexOfByKey(AddedTag) < LastChangeSet.AddedTags.IndexOfByKey(AddedChildTag));
+		TestTrueExpr(LastChangeSet.RemovedTags.Num() == 3);
+
+		// Removed tags keep their index, only names never seen before take one
+		TestTrueExpr(Manager.GetTagFromIndex(RemovedChildIndex) == RemovedChildTag);
+		TestTrueExpr(Manager.GetNumTagIndices() <= NumTagIndices + 3);
+
+		// The patched tree and net indices must match a tree built from scratch
+		TMap<FName, FString> RefreshedTree;
+		CaptureTagTree(RefreshedTree);
+
+		Manager.DestroyDNATagTree();
+		Manager.LoadDNATagTables();
+		Manager.ConstructDNATagTree();
+		Manager.PublishDictionarySnapshot();
+
+		TMap<FName, FString> RebuiltTree;
+		CaptureTagTree(RebuiltTree);
+		TestTrueExpr(RefreshedTree.OrderIndependentCompareEqual(RebuiltTree));
+
+		IDNATagsModule::OnDNATagTreeChangeSet.Remove(ChangeSetHandle);
+		Settings->ImportTagsFromConfig = bOldImportTagsFromConfig;
+		Settings->DNATagList = OldTagList;
+		Manager.bUseFastReplication = bOldUseFastReplication;
+		Manager.EditorRefreshDNATagTree();
+
+		// The refresh dropped the test tags too, they are not in any source
+		Manager.PopulateTreeFromDataTable(TestTagTable);
+		Manager.PublishDictionarySnapshot();
+	}
+#endif
+
 	void DNATagTest_PerfTest()
 	{
 		FDNATag EffectDamageTag = GetTagForString(TEXT("Effect.Damage"));
@@ -346,6 +1152,92 @@ public:
 			}
 		}
 
+		FDNATagBitContainer TagBits(TagContainer);
+		FDNATagBitContainer TagBits2(TagContainer2);
+
+		{
+			FScopeLogTime LogTimePtr(*FString::Printf(TEXT("10000 bit container HasAll checks")), nullptr, FScopeLogTime::ScopeLog_Milliseconds);
+			for (int32 i = 0; i < 10000; i++)
+			{
+				bResult &= TagBits.HasAll(TagBits2);
+			}
+		}
+
+		{
+			FScopeLogTime LogTimePtr(*FString::Printf(TEXT("10000 bit container HasAny checks")), nullptr, FScopeLogTime::ScopeLog_Milliseconds);
+			for (int32 i = 0; i < 10000; i++)
+			{
+				bResult &= TagBits.HasAny(TagBits2);
+			}
+		}
+
+		FDNATagQuery AllQuery = FDNATagQuery::MakeQuery_MatchAllTags(TagContainer2);
+
+		{
+			FScopeLogTime LogTimePtr(*FString::Printf(TEXT("10000 query matches")), nullptr, FScopeLogTime::ScopeLog_Milliseconds);
+			for (int32 i = 0; i < 10000; i++)
+			{
+				bResult &= AllQuery.Matches(TagContainer);
+			}
+		}
+
+		{
+			FScopeLogTime LogTimePtr(*FString::Printf(TEXT("10000 bit container query matches")), nullptr, FScopeLogTime::ScopeLog_Milliseconds);
+			for (int32 i = 0; i < 10000; i++)
+			{
+				bResult &= AllQuery.Matches(TagBits);
+			}
+		}
+
+		TArray<const FDNATagContainer*> BatchContainers;
+		TArray<const FDNATagBitContainer*> BatchBits;
+		for (int32 i = 0; i < 256; i++)
+		{
+			BatchContainers.Add(&TagContainer);
+			BatchBits.Add(&TagBits);
+		}
+		TBitArray<> BatchResults;
+
+		{
+			FScopeLogTime LogTimePtr(*FString::Printf(TEXT("100 x 256 container query matches, scalar")), nullptr, FScopeLogTime::ScopeLog_Milliseconds);
+			for (int32 i = 0; i < 100; i++)
+			{
+				for (const FDNATagContainer* BatchContainer : BatchContainers)
+				{
+					bResult &= AllQuery.Matches(*BatchContainer);
+				}
+			}
+		}
+
+		{
+			FScopeLogTime LogTimePtr(*FString::Printf(TEXT("100 x 256 container query matches, batched")), nullptr, FScopeLogTime::ScopeLog_Milliseconds);
+			for (int32 i = 0; i < 100; i++)
+			{
+				AllQuery.MatchesBatch(BatchContainers, BatchResults);
+			}
+		}
+		bResult &= (BatchResults.Find(false) == INDEX_NONE);
+
+		{
+			FScopeLogTime LogTimePtr(*FString::Printf(TEXT("100 x 256 bit container query matches, scalar")), nullptr, FScopeLogTime::ScopeLog_Milliseconds);
+			for (int32 i = 0; i < 100; i++)
+			{
+				for (const FDNATagBitContainer* BatchContainer : BatchBits)
+				{
+					bResult &= AllQuery.Matches(*BatchContainer);
+				}
+			}
+		}
+
+		{
+			FScopeLogTime LogTimePtr(*FString::Printf(TEXT("100 x 256 bit container query matches, batched")), nullptr, FScopeLogTime::ScopeLog_Milliseconds);
+			for (int32 i = 0; i < 100; i++)
+			{
+				AllQuery.MatchesBatch(BatchBits, BatchResults);
+			}
+		}
+		bResult &= (BatchResults.Find(false) == INDEX_NONE);
+
 		TestTrue(TEXT("Performance Tests succeeded"), bResult);
 	}
 
@@ -363,7 +1255,22 @@ bool FDNATagTest::RunTest(const FString& Parameters)
 	DNATagTest_SimpleTest();
 	DNATagTest_TagComparisonTest();
 	DNATagTest_TagContainerTest();
+	DNATagTest_BitContainerTest();
+	DNATagTest_ParentTableTest();
+	DNATagTest_TreeIntervalTest();
+	DNATagTest_QueryTest();
+	DNATagTest_SnapshotTest();
+	DNATagTest_NameTableTest();
+	DNATagTest_RedirectTest();
+#if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
+	DNATagTest_NetIndexLayoutTest();
+#endif
+	DNATagTest_NetDeltaTest();
+	DNATagTest_SearchIndexTest();
 	DNATagTest_PerfTest();
+#if WITH_EDITOR
+	DNATagTest_IncrementalRefreshTest(DataTable);
+#endif
 
 	return !HasAnyErrors();
 }
@@ -0,0 +1,45 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Core.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+class FAutomationTestBase;
+
+/**
+ * Shared harness of the DNATags and DNAAbilities micro-benchmarks. Every timing is logged as "<Name>,<size>,<operation>,<iterations>,<ns per op>"
+ * and collected as CSV, which Finish writes to <Name>.csv in the automation directory.
+ */
+class DNATAGS_API FDNABenchmarkReport
+{
+public:
+	/** SizeColumn names what the size of each measurement counts, like tags in the dictionary */
+	FDNABenchmarkReport(const TCHAR* InName, const TCHAR* SizeColumn, int32 InNumIterations);
+
+	/** Runs Op NumIterations times and reports the nanoseconds per call. The values Op returns are summed into a checksum so the work is not optimized away */
+	template<typename OpType>
+	void Measure(int32 Size, const TCHAR* Operation, OpType&& Op)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			Checksum += Op(Iteration);
+		}
+		Report(Size, Operation, (FPlatformTime::Seconds() - StartTime) * 1.0e9 / NumIterations);
+	}
+
+	/** Logs the checksum and writes the CSV, adding a warning to Test if the file could not be written */
+	void Finish(FAutomationTestBase& Test) const;
+
+private:
+	void Report(int32 Size, const TCHAR* Operation, double NsPerOp);
+
+	FString Name;
+	int32 NumIterations;
+	double Checksum;
+	FString CSV;
+};
+
+#endif //WITH_DEV_AUTOMATION_TESTS
@@ -7,4 +7,5 @@ MONOLITHIC_HEADER_BOILERPLATE()
 
 #include "DNATagsManager.h"
 #include "DNATagContainer.h"
+#include "DNATagBitContainer.h"
 #include "DNATagAssetInterface.h"
@@ -43,6 +43,11 @@ public:
 	/** Delegate for when assets are added to the tree */
 	static DNATAGS_API FSimpleMulticastDelegate OnDNATagTreeChanged;
 
+	DECLARE_MULTICAST_DELEGATE_OneParam(FOnDNATagTreeChangeSet, const FDNATagTreeChangeSet&);
+
+	/** Delegate for when an incremental refresh adds or removes tags, called before OnDNATagTreeChanged so dependents can patch only what changed */
+	static DNATAGS_API FOnDNATagTreeChangeSet OnDNATagTreeChangeSet;
+
 	/** Delegate that gets called after the settings have changed in the editor */
 	static DNATAGS_API FSimpleMulticastDelegate OnTagSettingsChanged;
 
@@ -33,6 +33,9 @@ void SDNATagWidget::Construct(const FArguments& InArgs, const TArray<FEditableDN
 	PropertyHandle = InArgs._PropertyHandle;
 	bIsAddingNewTag = false;
 	RootFilterString = InArgs._Filter;
+	FilterDictionarySerial = MAX_uint32;
+	bSearchDevComments = false;
+	GConfig->GetBool(*SettingsIniSection, TEXT("SearchDevComments"), bSearchDevComments, GEditorPerProjectIni);
 
 	IDNATagsModule::Get().GetDNATagsManager().GetFilteredDNARootTags(InArgs._Filter, TagItems);
 	bool CanAddFromINI = UDNATagsManager::ShouldImportTagsFromINI(); // We only support adding new tags to the ini files.
@@ -131,6 +134,19 @@ void SDNATagWidget::Construct(const FArguments& InArgs, const TArray<FEditableDN
 					.HintText(LOCTEXT("DNATagWidget_SearchBoxHint", "Search DNA Tags"))
 					.OnTextChanged( this, &SDNATagWidget::OnFilterTextChanged )
 				]
+				+SHorizontalBox::Slot()
+				.VAlign( VAlign_Center )
+				.AutoWidth()
+				[
+					SNew(SCheckBox)
+					.IsChecked(this, &SDNATagWidget::IsSearchDevCommentsChecked)
+					.OnCheckStateChanged(this, &SDNATagWidget::OnSearchDevCommentsChanged)
+					.ToolTipText(LOCTEXT("DNATagWidget_SearchDevCommentsTooltip", "Also show tags whose dev comment contains the search text"))
+					[
+						SNew(STextBlock)
+						.Text(LOCTEXT("DNATagWidget_SearchDevComments", "Search Comments"))
+					]
+				]
 			]
 			+SVerticalBox::Slot()
 			[
@@ -208,6 +224,8 @@ void SDNATagWidget::CreateNewDNATag()
 void SDNATagWidget::OnFilterTextChanged( const FText& InFilterText )
 {
 	FilterString = InFilterText.ToString();	
+	FilterPositions.Reset();
+	FilterDictionarySerial = MAX_uint32;
 
 	if( FilterString.IsEmpty() )
 	{
@@ -241,6 +259,20 @@ void SDNATagWidget::OnFilterTextChanged( const FText& InFilterText )
 	TagTreeWidget->RequestTreeRefresh();	
 }
 
+void SDNATagWidget::OnSearchDevCommentsChanged(ECheckBoxState NewState)
+{
+	bSearchDevComments = NewState == ECheckBoxState::Checked;
+	GConfig->SetBool(*SettingsIniSection, TEXT("SearchDevComments"), bSearchDevComments, GEditorPerProjectIni);
+
+	// Search again with the current text
+	OnFilterTextChanged( SearchTagBox->GetText() );
+}
+
+ECheckBoxState SDNATagWidget::IsSearchDevCommentsChecked() const
+{
+	return bSearchDevComments ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
+}
+
 bool SDNATagWidget::FilterChildrenCheck( TSharedPtr<FDNATagNode> InItem )
 {
 	if( !InItem.IsValid() )
@@ -248,22 +280,20 @@ bool SDNATagWidget::FilterChildrenCheck( TSharedPtr<FDNATagNode> InItem )
 		return false;
 	}
 
-	if( InItem->GetCompleteTag().ToString().Contains( FilterString ) || FilterString.IsEmpty() )
+	if( FilterString.IsEmpty() )
 	{
 		return true;
 	}
 
-	TArray< TSharedPtr<FDNATagNode> > Children = InItem->GetChildTagNodes();
-
-	for( int32 iChild = 0; iChild < Children.Num(); ++iChild )
+	UDNATagsManager& Manager = IDNATagsModule::Get().GetDNATagsManager();
+	if( FilterDictionarySerial != Manager.GetDictionarySerial() )
 	{
-		if( FilterChildrenCheck( Children[iChild] ) )
-		{
-			return true;
-		}
+		Manager.SearchDNATags( FilterString, bSearchDevComments, FilterPositions );
+		FilterDictionarySerial = Manager.GetDictionarySerial();
 	}
 
-	return false;
+	// Children are the positions right after their parent, so one range query covers the whole subtree
+	return Manager.HasTreePositionInSubtree( FilterPositions, InItem->GetTagIndex() );
 }
 
 TSharedRef<ITableRow> SDNATagWidget::OnGenerateRow(TSharedPtr<FDNATagNode> InItem, const TSharedRef<STableViewBase>& OwnerTable)
@@ -70,6 +70,15 @@ private:
 	/* Filter string used during search box */
 	FString FilterString;
 
+	/** Sorted tree positions of the tags matching FilterString, so checking a subtree is a range query */
+	FDNATagTreePositions FilterPositions;
+
+	/** Dictionary serial FilterPositions was searched for */
+	uint32 FilterDictionarySerial;
+
+	/** If true, tags whose dev comment contains FilterString are shown too. Saved in SettingsIniSection */
+	bool bSearchDevComments;
+
 	/** root filter (passed in on creation) */
 	FString RootFilterString;
 
@@ -175,6 +184,12 @@ private:
 	/** Called when the user clicks the "Collapse All" button; Collapses the entire tag tree */
 	FReply OnCollapseAllClicked();
 
+	/** Called when the user toggles the "Search Comments" check box; Searches the dev comments as well as the tag names */
+	void OnSearchDevCommentsChanged(ECheckBoxState NewState);
+
+	/** Returns the state of the "Search Comments" check box */
+	ECheckBoxState IsSearchDevCommentsChecked() const;
+
 	/**
 	 * Helper function to set the expansion state of the tree widget
 	 * 